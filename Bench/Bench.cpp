@@ -0,0 +1,268 @@
+/// \file Bench.cpp
+/// \brief Code for the benchmark harness CBench, and the main entry point.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "Bench.h"
+
+std::vector<BenchDesc> CBench::m_vBench;
+std::string CBench::m_sNote;
+
+/// Register a benchmark.
+/// \param name Benchmark name.
+/// \param fn Benchmark body.
+
+void CBench::Register(const std::string& name, BenchFn fn){
+  BenchDesc b;
+  b.m_sName = name;
+  b.m_fnBody = fn;
+  m_vBench.push_back(b);
+} //Register
+
+/// Note something about the benchmark being run that its time does not
+/// show, such as how close a lossy codec's output is to its input. The note
+/// is shown after the time, and the last one wins.
+/// \param note The note.
+
+void CBench::Note(const std::string& note){
+  m_sNote = note;
+} //Note
+
+/// Measure a benchmark.
+/// \param b The benchmark.
+/// \param minTime Shortest time to run one repetition for, in seconds.
+/// \param repetitions Number of repetitions.
+/// \return Measured result.
+
+BenchResult CBench::Run(const BenchDesc& b, double minTime, size_t repetitions){
+  using clock = std::chrono::steady_clock;
+
+  auto time = [&](size_t n){
+    const clock::time_point t0 = clock::now();
+    b.m_fnBody(n);
+    return std::chrono::duration<double>(clock::now() - t0).count();
+  }; //time
+
+  //find how many operations take at least minTime, which also warms up
+
+  m_sNote.clear();
+
+  size_t n = 1;
+  double t = time(n);
+
+  while(t < minTime && n < ((size_t)1 << 40)){
+    const double scale = t > 0.0? 1.4*minTime/t: 10.0;
+    n = std::max(n + 1, (size_t)(n*std::min(scale, 10.0)));
+    t = time(n);
+  } //while
+
+  std::vector<double> ns(repetitions);
+
+  for(size_t i=0; i<repetitions; i++)
+    ns[i] = time(n)*1e9/n;
+
+  std::sort(ns.begin(), ns.end());
+
+  BenchResult r;
+  r.m_sName = b.m_sName;
+  r.m_nIterations = n;
+  r.m_nRepetitions = repetitions;
+  r.m_fNsPerOp = ns[repetitions/2];
+  r.m_fMinNsPerOp = ns.front();
+  r.m_fMaxNsPerOp = ns.back();
+  r.m_sNote = m_sNote;
+  return r;
+} //Run
+
+/// Read the medians from a JSON file written by an earlier run and attach
+/// them to the matching results. Only the fields this harness writes are
+/// looked for, so this is not a general JSON reader.
+/// \param path File name.
+/// \param results [in, out] Results to attach baselines to.
+/// \return true if the file could be read.
+
+bool CBench::ReadBaseline(const char* path, std::vector<BenchResult>& results){
+  std::ifstream input(path);
+  if(!input)return false;
+
+  std::stringstream ss;
+  ss << input.rdbuf();
+  const std::string s = ss.str();
+
+  const std::string nameKey = "\"name\": \"";
+  const std::string nsKey = "\"ns_per_op\": ";
+
+  for(size_t i=s.find(nameKey); i!=std::string::npos; i=s.find(nameKey, i)){
+    i += nameKey.size();
+    const size_t end = s.find('"', i);
+    const size_t ns = s.find(nsKey, end);
+    if(end == std::string::npos || ns == std::string::npos)break;
+
+    const std::string name = s.substr(i, end - i);
+    const double value = strtod(s.c_str() + ns + nsKey.size(), nullptr);
+
+    for(BenchResult& r: results)
+      if(r.m_sName == name)
+        r.m_fBaselineNsPerOp = value;
+  } //for
+
+  return true;
+} //ReadBaseline
+
+/// Write results as JSON.
+/// \param path File name, or `-` for standard output.
+/// \param results Results.
+/// \return true if the file was written.
+
+bool CBench::WriteJson(const char* path, const std::vector<BenchResult>& results){
+  FILE* output = strcmp(path, "-") == 0? stdout: fopen(path, "w");
+  if(output == nullptr)return false;
+
+  fprintf(output, "{\n  \"context\": {\n");
+#if defined(__clang__)
+  fprintf(output, "    \"compiler\": \"clang %s\",\n", __clang_version__);
+#elif defined(__GNUC__)
+  fprintf(output, "    \"compiler\": \"gcc %s\",\n", __VERSION__);
+#else
+  fprintf(output, "    \"compiler\": \"unknown\",\n");
+#endif
+#ifdef NDEBUG
+  fprintf(output, "    \"build\": \"release\"\n");
+#else
+  fprintf(output, "    \"build\": \"debug\"\n");
+#endif
+  fprintf(output, "  },\n  \"benchmarks\": [\n");
+
+  for(size_t i=0; i<results.size(); i++){
+    const BenchResult& r = results[i];
+
+    fprintf(output, "    {\"name\": \"%s\", \"iterations\": %zu, "
+      "\"repetitions\": %zu, \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, "
+      "\"max_ns_per_op\": %.3f", r.m_sName.c_str(), r.m_nIterations,
+      r.m_nRepetitions, r.m_fNsPerOp, r.m_fMinNsPerOp, r.m_fMaxNsPerOp);
+
+    if(r.m_fBaselineNsPerOp > 0.0)
+      fprintf(output, ", \"baseline_ns_per_op\": %.3f, \"change\": %.4f",
+        r.m_fBaselineNsPerOp, r.m_fNsPerOp/r.m_fBaselineNsPerOp - 1.0);
+
+    if(!r.m_sNote.empty())
+      fprintf(output, ", \"note\": \"%s\"", r.m_sNote.c_str());
+
+    fprintf(output, "}%s\n", i + 1 < results.size()? ",": "");
+  } //for
+
+  fprintf(output, "  ]\n}\n");
+  return output == stdout || fclose(output) == 0;
+} //WriteJson
+
+/// Parse the command line, run the selected benchmarks and report. The exit
+/// code is 2 for a usage error, 1 if `--fail-on-regression` was given and
+/// some benchmark got slower than its baseline by more than the threshold,
+/// and 0 otherwise.
+/// \param argc Number of arguments.
+/// \param argv Arguments.
+/// \return Exit code.
+
+int CBench::Main(int argc, char* argv[]){
+  const char* filter = "";
+  const char* json = nullptr;
+  const char* baseline = nullptr;
+  double minTime = 0.05;
+  size_t repetitions = 5;
+  double threshold = 0.10;
+  bool failOnRegression = false;
+  bool list = false;
+
+  for(int i=1; i<argc; i++){
+    const char* a = argv[i];
+    const bool more = i + 1 < argc;
+
+    if(strcmp(a, "--filter") == 0 && more)filter = argv[++i];
+    else if(strcmp(a, "--json") == 0 && more)json = argv[++i];
+    else if(strcmp(a, "--baseline") == 0 && more)baseline = argv[++i];
+    else if(strcmp(a, "--min-time") == 0 && more)minTime = atof(argv[++i]);
+    else if(strcmp(a, "--repetitions") == 0 && more)
+      repetitions = std::max(1, atoi(argv[++i]));
+    else if(strcmp(a, "--threshold") == 0 && more)threshold = atof(argv[++i]);
+    else if(strcmp(a, "--fail-on-regression") == 0)failOnRegression = true;
+    else if(strcmp(a, "--list") == 0)list = true;
+
+    else{
+      fprintf(stderr, "usage: %s [--filter text] [--json file|-] "
+        "[--baseline file] [--min-time seconds] [--repetitions n] "
+        "[--threshold fraction] [--fail-on-regression] [--list]\n", argv[0]);
+      return 2;
+    } //else
+  } //for
+
+  std::vector<BenchResult> results;
+  FILE* table = json && strcmp(json, "-") == 0? stderr: stdout;
+
+  for(const BenchDesc& b: m_vBench){
+    if(b.m_sName.find(filter) == std::string::npos)continue;
+
+    if(list){
+      fprintf(stdout, "%s\n", b.m_sName.c_str());
+      continue;
+    } //if
+
+    results.push_back(Run(b, minTime, repetitions));
+  } //for
+
+  if(list)return 0;
+
+  if(baseline && !ReadBaseline(baseline, results)){
+    fprintf(stderr, "cannot read baseline %s\n", baseline);
+    return 2;
+  } //if
+
+  bool regressed = false;
+
+  fprintf(table, "%-36s %14s %14s %10s\n", "benchmark", "ns/op", "baseline", "change");
+
+  for(const BenchResult& r: results){
+    fprintf(table, "%-36s %14.1f", r.m_sName.c_str(), r.m_fNsPerOp);
+
+    if(r.m_fBaselineNsPerOp > 0.0){
+      const double change = r.m_fNsPerOp/r.m_fBaselineNsPerOp - 1.0;
+      const bool slower = change > threshold;
+      regressed = regressed || slower;
+
+      fprintf(table, " %14.1f %+9.1f%%%s", r.m_fBaselineNsPerOp, 100.0*change,
+        slower? "  REGRESSED": change < -threshold? "  improved": "");
+    } //if
+
+    if(!r.m_sNote.empty())
+      fprintf(table, "  (%s)", r.m_sNote.c_str());
+
+    fprintf(table, "\n");
+  } //for
+
+  if(json && !WriteJson(json, results)){
+    fprintf(stderr, "cannot write %s\n", json);
+    return 2;
+  } //if
+
+  return failOnRegression && regressed? 1: 0;
+} //Main
+
+/// Register the benchmarks and run them.
+/// \param argc Number of arguments.
+/// \param argv Arguments.
+/// \return Exit code.
+
+int main(int argc, char* argv[]){
+  RegisterCoreBenchmarks();
+  RegisterSoundBenchmarks();
+#ifndef _WIN32
+  RegisterPngBenchmarks();
+  RegisterObjectBenchmarks();
+#endif
+  return CBench::Main(argc, argv);
+} //main
@@ -0,0 +1,83 @@
+/// \file Bench.h
+/// \brief Interface for the benchmark harness CBench.
+
+#ifndef __L4RC_BENCH_BENCH_H__
+#define __L4RC_BENCH_BENCH_H__
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// \brief A benchmark body. It must run the measured operation the given
+/// number of times.
+
+typedef std::function<void(size_t)> BenchFn;
+
+/// \brief A registered benchmark.
+
+struct BenchDesc{
+  std::string m_sName; ///< Name, with `/` separating group from case.
+  BenchFn m_fnBody; ///< Benchmark body.
+}; //BenchDesc
+
+/// \brief The measured result of a benchmark.
+
+struct BenchResult{
+  std::string m_sName; ///< Benchmark name.
+  size_t m_nIterations = 0; ///< Operations per repetition.
+  size_t m_nRepetitions = 0; ///< Number of repetitions.
+  double m_fNsPerOp = 0.0; ///< Median time per operation.
+  double m_fMinNsPerOp = 0.0; ///< Fastest repetition.
+  double m_fMaxNsPerOp = 0.0; ///< Slowest repetition.
+  double m_fBaselineNsPerOp = 0.0; ///< Baseline median, or 0 if none.
+  std::string m_sNote; ///< Note from the benchmark, such as how good its output is.
+}; //BenchResult
+
+/// \brief The benchmark harness.
+///
+/// Each benchmark is first run with a doubling number of operations until
+/// one run takes long enough to time reliably, then timed for a number of
+/// repetitions with that many operations. The median time per operation is
+/// reported, since it is not pulled around by the odd interrupted
+/// repetition. Results are printed as a table and can be written as JSON,
+/// and a JSON file from an earlier run can be given as a baseline to
+/// compare against.
+
+class CBench{
+  private:
+    static std::vector<BenchDesc> m_vBench; ///< Registered benchmarks.
+    static std::string m_sNote; ///< Note from the benchmark being run.
+
+    static BenchResult Run(const BenchDesc& b, double minTime,
+      size_t repetitions); ///< Measure a benchmark.
+    static bool ReadBaseline(const char* path,
+      std::vector<BenchResult>& results); ///< Read a baseline file.
+    static bool WriteJson(const char* path,
+      const std::vector<BenchResult>& results); ///< Write results as JSON.
+
+  public:
+    static void Register(const std::string& name, BenchFn fn); ///< Register a benchmark.
+    static void Note(const std::string& note); ///< Note something about the benchmark being run.
+    static int Main(int argc, char* argv[]); ///< Run from the command line.
+}; //CBench
+
+/// Keep the compiler from optimizing away a value that a benchmark computes
+/// but never uses.
+/// \param v Value.
+
+template<class t> inline void KeepAlive(const t& v){
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(v) : "memory");
+#else
+  const volatile char* p = (const volatile char*)&v;
+  (void)*p;
+#endif
+} //KeepAlive
+
+void RegisterCoreBenchmarks(); ///< Register the benchmarks of the core game code.
+void RegisterSoundBenchmarks(); ///< Register the sound compression benchmarks.
+void RegisterPngBenchmarks(); ///< Register the image decoding benchmarks, headless platform only.
+void RegisterObjectBenchmarks(); ///< Register the game object and settings benchmarks, headless platform only.
+
+#endif //__L4RC_BENCH_BENCH_H__
@@ -0,0 +1,601 @@
+/// \file CoreBench.cpp
+/// \brief Benchmarks for the core game code, which has no engine dependencies.
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+
+#include "AudioSink.h"
+
+#include "BattleSim.h"
+#include "ColumnStore.h"
+#include "Deck.h"
+#include "Ecs.h"
+#include "Encounter.h"
+#include "HandLayout.h"
+#include "MapGenerator.h"
+#include "MapProgress.h"
+#include "Mixer.h"
+#include "Profiler.h"
+#include "Snapshot.h"
+#include "SpscRing.h"
+#include "Telemetry.h"
+
+/// Map generation, as done by `CGame::BeginGame()` for every new game.
+
+static void BenchMapGenerate(size_t n){
+  CRng rng(1);
+  MapDesc map;
+
+  for(size_t i=0; i<n; i++){
+    CMapGenerator::Generate(rng, map);
+    KeepAlive(map.m_nSpecial);
+  } //for
+} //BenchMapGenerate
+
+/// Walking the leftmost path up a map, asking which levels can still reach the
+/// boss at every step, as a mass simulation of runs would.
+
+static void BenchMapProgress(size_t n){
+  CRng rng(1);
+  MapDesc map;
+  CMapGenerator::Generate(rng, map);
+
+  CMapProgress progress;
+  progress.Build(map);
+
+  for(size_t i=0; i<n; i++){
+    progress.Build(map);
+    int level = 0;
+
+    while(progress.GetNext(level) != 0){
+      KeepAlive(progress.GetCanReachBoss());
+      progress.Complete(level);
+
+      const LevelSet next = progress.GetUnlocked();
+      level = 0;
+      while(!(next >> level & 1))++level;
+    } //while
+  } //for
+} //BenchMapProgress
+
+/// A whole battle against a number of enemies, from a fresh simulator and
+/// full health, with a different seed each time.
+/// \param enemies Number of enemies.
+/// \param boss True if the first enemy is the boss.
+
+static BenchFn BenchBattle(int enemies, bool boss){
+  return [=](size_t n){
+    for(size_t i=0; i<n; i++){
+      CBattleSim sim(i + 1);
+      KeepAlive(sim.Fight(enemies, boss).m_nTurns);
+    } //for
+  };
+} //BenchBattle
+
+/// Cloning a battle in progress and playing one move on the clone, which is
+/// the inner loop of a search over moves.
+
+static void BenchBattleClone(size_t n){
+  CBattleSim sim(1);
+  sim.Fight(0, false); //deal a hand with no enemies to fight
+
+  BattleState s = sim.GetState();
+  s.m_nEnemies = 3;
+
+  for(size_t i=0; i<3; i++)
+    s.m_pEnemy[i].m_nHealth = 10;
+
+  BattleAction a;
+  a.m_nSlot = 0;
+
+  for(size_t i=0; i<n; i++){
+    BattleState t = s;
+    t.Step(a);
+    KeepAlive(t.m_nHealth);
+  } //for
+} //BenchBattleClone
+
+/// Dealing a new hand: discard the old hand and draw a new one, which
+/// reshuffles the discard pile back into the draw pile whenever it runs
+/// out, as `CGame::nextHand()` does between turns.
+/// \param cards Number of cards in the deck.
+
+static BenchFn BenchDeckNextHand(size_t cards){
+  return [=](size_t n){
+    CDeck deck;
+    deck.Create(cards);
+    deck.Seed(1);
+
+    for(size_t i=0; i<n; i++){
+      deck.DiscardHand();
+      KeepAlive(deck.Draw(5));
+    } //for
+  };
+} //BenchDeckNextHand
+
+/// Gathering every card back and dealing a fresh hand, as at the start of a
+/// battle. This is what used to be a full shuffle of the deck.
+/// \param cards Number of cards in the deck.
+
+static BenchFn BenchDeckGather(size_t cards){
+  return [=](size_t n){
+    CDeck deck;
+    deck.Create(cards);
+    deck.Seed(1);
+
+    for(size_t i=0; i<n; i++){
+      deck.Gather();
+      KeepAlive(deck.Draw(5));
+    } //for
+  };
+} //BenchDeckGather
+
+/// Laying out a formation and reading back every slot, which is the work
+/// `CObjectManager::PositionEnemies()` does besides moving the sprites.
+/// \param enemies Number of enemies.
+
+static BenchFn BenchFormationArrange(size_t enemies){
+  return [=](size_t n){
+    CFormation f;
+
+    for(size_t i=0; i<n; i++){
+      f.Arrange(enemies);
+
+      for(size_t j=0; j<enemies; j++)
+        KeepAlive(f.GetSlot(j));
+    } //for
+  };
+} //BenchFormationArrange
+
+/// Picking the enemy under the mouse at scattered points.
+/// \param enemies Number of enemies.
+
+static BenchFn BenchFormationPick(size_t enemies){
+  return [=](size_t n){
+    CFormation f;
+    f.Arrange(enemies);
+    CRng rng(1);
+
+    for(size_t i=0; i<n; i++)
+      KeepAlive(f.Pick(400.0f + 600.0f*rng.randf(), 768.0f*rng.randf()));
+  };
+} //BenchFormationPick
+
+/// Area damage to every enemy in an encounter.
+/// \param enemies Number of enemies.
+
+static BenchFn BenchEncounterDamageAll(size_t enemies){
+  return [=](size_t n){
+    CEncounter e;
+    e.Create(enemies, 1 << 30);
+
+    for(size_t i=0; i<n; i++)
+      KeepAlive(e.DamageAll(1));
+  };
+} //BenchEncounterDamageAll
+
+/// Planning every enemy's intent for an enemy turn.
+/// \param enemies Number of enemies.
+
+static BenchFn BenchEncounterPlanTurn(size_t enemies){
+  return [=](size_t n){
+    CEncounter e;
+    e.Create(enemies, 10);
+    CRng rng(1);
+
+    for(size_t i=0; i<n; i++)
+      KeepAlive(e.PlanTurn(15, 0, rng).data());
+  };
+} //BenchEncounterPlanTurn
+
+/// Laying out a row of cards.
+/// \param layout Layout preset.
+/// \param cards Number of cards.
+
+static BenchFn BenchHandArrange(eLayout layout, size_t cards){
+  return [=](size_t n){
+    CHandLayout h(CHandLayout::Preset(layout));
+
+    for(size_t i=0; i<n; i++){
+      h.Arrange(cards);
+      KeepAlive(h.GetSlot(cards - 1));
+    } //for
+  };
+} //BenchHandArrange
+
+/// Finding the card under the mouse at scattered points.
+/// \param cards Number of cards.
+
+static BenchFn BenchHandHitTest(size_t cards){
+  return [=](size_t n){
+    CHandLayout h(CHandLayout::Preset(eLayout::Upgrade));
+    h.Arrange(cards);
+    CRng rng(1);
+
+    for(size_t i=0; i<n; i++)
+      KeepAlive(h.HitTest(1024.0f*rng.randf(), 768.0f*rng.randf()));
+  };
+} //BenchHandHitTest
+
+/// Loading a run snapshot saved in the middle of a battle, and picking the
+/// battle up in the simulator, as the game does on start-up. The snapshot
+/// is saved once, in the working folder, before timing starts.
+/// \param enemies Number of enemies.
+
+static BenchFn BenchSnapshotLoad(size_t enemies){
+  return [=](size_t n){
+    CRng rng(1);
+    MapDesc map;
+    CMapGenerator::Generate(rng, map);
+
+    CDeck deck;
+    deck.Create(10);
+    deck.Seed(1);
+    deck.Draw(5);
+
+    DeckState piles;
+    deck.GetState(piles);
+
+    RunSnapshot s;
+    s.SetMap(map);
+    s.m_vCards.assign(10, SnapCard());
+    s.SetPiles(piles);
+    s.m_vEnemies.assign(enemies, SnapEnemy());
+    s.m_sHeader.m_nHealth = 15;
+    s.m_sHeader.m_nBattle = 1;
+
+    for(SnapEnemy& e: s.m_vEnemies)
+      e.m_nHealth = 10;
+
+    const char* path = "bench_snapshot.bin";
+    SaveSnapshot(path, s);
+
+    CBattleSim sim(1);
+
+    for(size_t i=0; i<n; i++){
+      RunSnapshot t;
+      LoadSnapshot(path, t);
+      KeepAlive(sim.Load(t));
+    } //for
+
+    remove(path);
+  };
+} //BenchSnapshotLoad
+
+/// The overhead of one profiler zone.
+
+static void BenchProfileZone(size_t n){
+  for(size_t i=0; i<n; i++){
+    PROFILE_ZONE("bench");
+  } //for
+} //BenchProfileZone
+
+/// Make a sound for the mixer benchmarks: a minute of mono noise at 44.1 kHz,
+/// long enough that voices seldom end.
+/// \return The sound.
+
+static WavSound MakeNoise(){
+  WavSound s;
+  s.m_nChannels = 1;
+  s.m_nRate = 44100;
+  s.m_vSamples.resize(60*44100);
+
+  CRng rng(1);
+
+  for(float& x: s.m_vSamples)
+    x = 2.0f*rng.randf() - 1.0f;
+
+  return s;
+} //MakeNoise
+
+/// Mixing a block of 512 frames, about 11.6 ms of sound, into a null sink
+/// with a number of voices playing, each at its own gain. Voices that end
+/// are started again.
+/// \param voices Number of voices.
+/// \param pitched True to play each voice at its own pitch, which makes the
+///   mixer resample them all.
+/// \param compressed True to compress the sound with ADPCM, which makes the
+///   mixer decode it for every voice.
+
+static BenchFn BenchMix(size_t voices, bool pitched, bool compressed=false){
+  std::shared_ptr<CMixer> mixer = std::make_shared<CMixer>(voices, 44100); //set up on first run
+
+  return [=](size_t n){
+    if(mixer->GetBytes() == 0){
+      AdpcmSound a;
+
+      if(compressed){
+        EncodeAdpcm(MakeNoise(), a);
+        mixer->SetSound(0, a);
+      } //if
+
+      else mixer->SetSound(0, MakeNoise());
+    } //if
+
+    std::vector<float> block(2*512);
+    CNullSink sink;
+
+    for(size_t i=0; i<n; i++){
+      for(size_t v=mixer->GetActiveCount(); v<voices; v++){
+        VoiceDesc d;
+        d.m_fGain = 1.0f/voices;
+        d.m_fPitch = pitched? 0.75f + 0.5f*v/voices: 1.0f;
+        mixer->Play(0, d);
+      } //for
+
+      mixer->Mix(block.data(), 512);
+      sink.Write(block.data(), 512);
+    } //for
+
+    KeepAlive(sink.GetFrames());
+  };
+} //BenchMix
+
+/// Playing a sound with every voice busy, each time at a higher priority
+/// than the last, so that a voice is stolen each time.
+/// \param voices Number of voices.
+
+static BenchFn BenchSteal(size_t voices){
+  return [=](size_t n){
+    WavSound s;
+    s.m_nChannels = 1;
+    s.m_nRate = 44100;
+    s.m_vSamples.assign(64, 0.0f);
+
+    CMixer mixer(voices, 44100);
+    mixer.SetSound(0, s);
+
+    VoiceDesc d;
+
+    for(size_t v=0; v<voices; v++)
+      mixer.Play(0, d);
+
+    for(size_t i=0; i<n; i++){
+      d.m_nPriority = (int)(i & 0x3FFFFFFF) + 1;
+      KeepAlive(mixer.Play(0, d));
+    } //for
+  };
+} //BenchSteal
+
+/// Making a telemetry record on the game thread, with the writer thread
+/// appending to a log as it does in the game. The game makes a few records
+/// a frame, but this makes them as fast as it can, so the ring fills up
+/// and records are dropped. Notes how many.
+
+static void BenchTelemetryRecord(size_t n){
+  const char* path = "bench_telemetry.bin";
+  size_t dropped = 0;
+
+  {
+    CTelemetry t;
+    t.Open(path);
+
+    for(size_t i=0; i<n; i++)
+      t.Record(eTelemetry::CardPlayed, (int)i, 4, 0, 0, 1);
+
+    dropped = t.GetDropped();
+  } //closed here, which waits for the writer thread
+
+  remove(path);
+  CBench::Note(std::to_string(dropped) + " dropped");
+} //BenchTelemetryRecord
+
+/// Pushing an item into a lock-free ring with another thread popping them
+/// as fast as it can, which is the most the ring can carry between threads.
+/// Each side gives up its core while it waits for the other, in case there
+/// is only one.
+
+static void BenchRingPushPop(size_t n){
+  std::unique_ptr<CSpscRing<TelemetryRecord, 4096>> ring(new CSpscRing<TelemetryRecord, 4096>);
+  std::atomic<bool> done{false};
+
+  std::thread consumer([&](){
+    TelemetryRecord batch[256];
+    while(!done || !ring->IsEmpty())
+      if(ring->TryPop(batch, 256) == 0)
+        std::this_thread::yield(); //the producer may need this core
+  });
+
+  TelemetryRecord r;
+
+  for(size_t i=0; i<n; i++){
+    r.m_nFrame = (uint32_t)i;
+    while(!ring->TryPush(r))
+      std::this_thread::yield();
+  } //for
+
+  done = true;
+  consumer.join();
+} //BenchRingPushPop
+
+/// \brief A component for the entity benchmarks, the size of a transform.
+
+struct BenchBody{
+  float x = 0.0f, y = 0.0f; ///< Position.
+  float m_fXScale = 1.0f, m_fYScale = 1.0f; ///< Scale.
+}; //BenchBody
+
+/// Moving every body in a dense component array, the way the object
+/// manager's systems walk their components.
+/// \param entities Number of entities.
+
+static BenchFn BenchEcsSweep(size_t entities){
+  return [=](size_t n){
+    CEntityPool pool;
+    CComponentArray<BenchBody> bodies;
+
+    for(size_t i=0; i<entities; i++)
+      bodies.Add(pool.Create());
+
+    for(size_t i=0; i<n; i++){
+      for(size_t j=0; j<bodies.Size(); j++){
+        bodies[j].x += 1.5f;
+        bodies[j].y -= 0.5f;
+      } //for
+
+      KeepAlive(bodies[i % entities].x);
+    } //for
+  };
+} //BenchEcsSweep
+
+/// Destroying a tenth of the entities, removing their components in one
+/// pass and creating as many again, as when enemies die and are replaced.
+/// \param entities Number of entities.
+
+static BenchFn BenchEcsCull(size_t entities){
+  return [=](size_t n){
+    CEntityPool pool;
+    CComponentArray<BenchBody> bodies;
+    std::vector<Entity> live;
+
+    for(size_t i=0; i<entities; i++){
+      live.push_back(pool.Create());
+      bodies.Add(live.back());
+    } //for
+
+    for(size_t i=0; i<n; i++){
+      for(size_t j=i%10; j<live.size(); j+=10)
+        pool.Destroy(live[j]);
+
+      bodies.RemoveIf([&](Entity e){ return !pool.IsAlive(e); });
+
+      for(size_t j=i%10; j<live.size(); j+=10)
+        bodies.Add(live[j] = pool.Create());
+
+      KeepAlive(bodies.Size());
+    } //for
+  };
+} //BenchEcsCull
+
+/// Unpacking a row group of one column of a column store.
+/// \param bits Bits per value.
+
+static BenchFn BenchColumnUnpack(int bits){
+  return [=](size_t n){
+    const size_t rows = CColumnStore::GroupRows;
+    std::vector<int32_t> values(rows);
+    CRng rng(1);
+
+    for(int32_t& x: values)
+      x = (int32_t)(rng.next() & (bits == 32? 0xFFFFFFFFu: (1u << bits) - 1));
+
+    std::vector<uint32_t> packed(GetPackedBytes(rows, bits)/4 + 1);
+    PackValues(values.data(), rows, 0, bits, packed.data());
+
+    for(size_t i=0; i<n; i++){
+      UnpackValues(packed.data(), rows, 0, bits, values.data());
+      KeepAlive(values[i % rows]);
+    } //for
+  };
+} //BenchColumnUnpack
+
+/// A query over a table of a million battles like those of the run
+/// statistics tool, filtering on two columns, grouping by a third and adding
+/// up a fourth. The table is written once, in the working folder, before
+/// timing starts.
+/// \param threads Number of threads.
+
+static BenchFn BenchColumnQuery(size_t threads){
+  return [=](size_t n){
+    const char* path = "bench_columns.col";
+    const size_t rows = 1 << 20;
+
+    {
+      CColumnWriter w;
+      w.Open(path, {"layer", "enemies", "won", "damage"});
+      CRng rng(1);
+
+      for(size_t i=0; i<rows; i++){
+        const int32_t enemies = rng.randn(1, 4);
+        const int32_t row[] = {rng.randn(0, 4), enemies, rng.randn(0, 7) != 0, rng.randn(0, 4*enemies)};
+        w.Append(row);
+      } //for
+
+      w.Close();
+    }
+
+    CColumnStore store;
+    store.Open(path);
+
+    ColumnQuery q;
+    q.m_vFilters = {{0, eCompare::GreaterEqual, 2}, {2, eCompare::Equal, 1}};
+    q.m_nGroupBy = 1;
+    q.m_vSums = {3};
+
+    std::vector<QueryGroup> result;
+
+    for(size_t i=0; i<n; i++){
+      store.Run(q, result, threads);
+      KeepAlive(result.size());
+    } //for
+
+    remove(path);
+    CBench::Note(std::to_string(rows) + " rows a query");
+  };
+} //BenchColumnQuery
+
+/// Register the benchmarks of the core game code. Groups ending in a number
+/// are the same benchmark at different sizes.
+
+void RegisterCoreBenchmarks(){
+  CBench::Register("map/generate", BenchMapGenerate);
+  CBench::Register("map/progress", BenchMapProgress);
+
+  CBench::Register("battle/fight/1", BenchBattle(1, false));
+  CBench::Register("battle/fight/3", BenchBattle(3, false));
+  CBench::Register("battle/fight/6", BenchBattle(6, false));
+  CBench::Register("battle/boss", BenchBattle(1, true));
+  CBench::Register("battle/clone_step", BenchBattleClone);
+
+  CBench::Register("deck/next_hand/10", BenchDeckNextHand(10));
+  CBench::Register("deck/next_hand/200", BenchDeckNextHand(200));
+  CBench::Register("deck/gather/10", BenchDeckGather(10));
+  CBench::Register("deck/gather/200", BenchDeckGather(200));
+
+  for(size_t enemies: {6, 50, 500})
+    CBench::Register("formation/arrange/" + std::to_string(enemies),
+      BenchFormationArrange(enemies));
+
+  CBench::Register("formation/pick/500", BenchFormationPick(500));
+
+  CBench::Register("encounter/damage_all/500", BenchEncounterDamageAll(500));
+  CBench::Register("encounter/plan_turn/6", BenchEncounterPlanTurn(6));
+  CBench::Register("encounter/plan_turn/500", BenchEncounterPlanTurn(500));
+
+  CBench::Register("hand/arrange/5", BenchHandArrange(eLayout::Hand, 5));
+  CBench::Register("hand/arrange/64", BenchHandArrange(eLayout::Hand, 64));
+  CBench::Register("hand/arrange/200", BenchHandArrange(eLayout::Upgrade, 200));
+  CBench::Register("hand/hit_test/200", BenchHandHitTest(200));
+
+  CBench::Register("snapshot/load/6", BenchSnapshotLoad(6));
+  CBench::Register("snapshot/load/16", BenchSnapshotLoad(16));
+
+  CBench::Register("profiler/zone", BenchProfileZone);
+
+  CBench::Register("mixer/mix/32", BenchMix(32, false));
+  CBench::Register("mixer/mix/256", BenchMix(256, false));
+  CBench::Register("mixer/mix_pitched/256", BenchMix(256, true));
+  CBench::Register("mixer/mix_adpcm/32", BenchMix(32, false, true));
+  CBench::Register("mixer/mix_adpcm/256", BenchMix(256, false, true));
+  CBench::Register("mixer/mix_adpcm_pitched/256", BenchMix(256, true, true));
+  CBench::Register("mixer/steal/256", BenchSteal(256));
+
+  CBench::Register("telemetry/record", BenchTelemetryRecord);
+  CBench::Register("telemetry/ring_push_pop", BenchRingPushPop);
+
+  CBench::Register("columns/unpack/1", BenchColumnUnpack(1));
+  CBench::Register("columns/unpack/4", BenchColumnUnpack(4));
+  CBench::Register("columns/unpack/13", BenchColumnUnpack(13));
+  CBench::Register("columns/unpack/32", BenchColumnUnpack(32));
+  CBench::Register("columns/query/1", BenchColumnQuery(1));
+  CBench::Register("columns/query/4", BenchColumnQuery(4));
+
+  CBench::Register("ecs/sweep/500", BenchEcsSweep(500));
+  CBench::Register("ecs/cull/500", BenchEcsCull(500));
+} //RegisterCoreBenchmarks
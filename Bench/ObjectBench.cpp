@@ -0,0 +1,189 @@
+/// \file ObjectBench.cpp
+/// \brief Benchmarks for the game objects and the settings file on the
+/// headless platform.
+///
+/// The object manager moves and draws a real player, hand of cards and
+/// enemies into the headless renderer, set up as the game sets them up. The
+/// settings and sprites are read from `Media`, so run the benchmarks from the
+/// repository root.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Bench.h"
+
+#include "BattleState.h"
+#include "ComponentIncludes.h"
+#include "EnemyPolicy.h"
+#include "HandLayout.h"
+#include "ObjectManager.h"
+#include "Rng.h"
+#include "SpriteRenderer.h"
+
+/// \brief The engine components and game objects that the object benchmarks
+/// share.
+///
+/// Deriving from the same bases as the game gives access to the renderer,
+/// timer, sound player and object manager that the game objects use.
+
+class CBenchWorld: public LComponent, public CCommon{
+  public:
+    static void Setup(); ///< Set up the engine components, once.
+    static void Battle(size_t enemies); ///< Start a battle.
+
+    static void Move(){ m_pObjectManager->move(); } ///< Move everything.
+
+    /// Record the draws for a frame, without rasterizing them.
+    /// \return Number of sprites and strings drawn.
+
+    static size_t Draw(){
+      m_pRenderer->BeginFrame();
+      m_pObjectManager->draw();
+      return m_pRenderer->GetDrawCount() + m_pRenderer->GetTextDrawCount();
+    } //Draw
+}; //CBenchWorld
+
+/// Read the settings file, and create the renderer with the battle sprites
+/// loaded, the sound player and the object manager, the first time only.
+/// Quits if the settings file cannot be read, since the sprites would all
+/// be missing.
+
+void CBenchWorld::Setup(){
+  if(m_pObjectManager != nullptr)return;
+
+  if(!LoadSettings()){
+    fprintf(stderr, "run bench from the repository root\n");
+    exit(2);
+  } //if
+
+  static const std::pair<eSprite, const char*> sprite[] = {
+    {eSprite::Player, "player"},
+    {eSprite::PlayerRunning, "PlayerRunning"},
+    {eSprite::Enemy, "enemy"},
+    {eSprite::EnemyRunning, "EnemyRunning"},
+    {eSprite::BookTurning, "BookTurning"},
+    {eSprite::Paper, "paper"},
+    {eSprite::Laptop, "laptop"},
+    {eSprite::Calendar, "calendar"},
+    {eSprite::Card, "card"},
+  }; //sprite
+
+  m_pTimer = new LTimer;
+  m_pAudio = new LSound;
+  m_pAudio->Initialize(eSound::Size);
+
+  m_pRenderer = new LSpriteRenderer(eSpriteMode::Batched2D);
+  m_pRenderer->Initialize(eSprite::Size);
+
+  for(const auto& s: sprite)
+    m_pRenderer->Load(s.first, s.second);
+
+  m_pObjectManager = new CObjectManager;
+} //Setup
+
+/// Start a battle as the game does: the player is created with its deck, a
+/// hand is dealt, and the enemies are put in formation with their intents
+/// decided. Then every enemy starts playing its card in place at once, as
+/// in a fast enemy turn, which is the busiest frame a battle has. The
+/// battle is kept for the next call with the same number of enemies, so
+/// that it is not timed over and over.
+/// \param enemies Number of enemies.
+
+void CBenchWorld::Battle(size_t enemies){
+  static size_t current = SIZE_MAX;
+  if(enemies == current)return;
+  current = enemies;
+
+  Setup();
+  m_pObjectManager->clear();
+  state = GameState::Battle;
+  player = m_pObjectManager->CreatePlayer(Vector2(125, 430));
+
+  CDeck& piles = player.GetPiles();
+  piles.Draw(BattleState::HandSize);
+
+  CHandLayout hand(CHandLayout::Preset(eLayout::Hand));
+  hand.Arrange(piles.GetHandCount());
+
+  for(size_t i=0; i<piles.GetHandCount(); i++){
+    const CardSlot slot = hand.GetSlot(i);
+    player.GetDeck().at(piles.GetHandCard(i)).Show(Vector2(slot.x, slot.y));
+  } //for
+
+  for(size_t i=0; i<enemies; i++)
+    m_pObjectManager->CreateEnemy(Vector2(125, 430));
+
+  m_pObjectManager->PositionEnemies();
+
+  const std::vector<Enemy>& list = m_pObjectManager->GetEnemies();
+  std::vector<EnemyView> views(list.size());
+  std::vector<EnemyCard> intents(list.size());
+
+  for(size_t i=0; i<list.size(); i++){
+    views[i] = list[i].GetView();
+    views[i].m_nPlayerHealth = player.GetHealth();
+  } //for
+
+  CRng rng(1);
+  DecideIntents(views.data(), intents.data(), list.size(), rng);
+
+  for(size_t i=0; i<list.size(); i++){
+    list[i].SetIntent(intents[i]);
+    list[i].PlayCardInPlace(0.0f, 1.0f, false);
+  } //for
+
+  Move(); //out of waiting and into acting
+} //Battle
+
+/// One frame of the object manager's move systems, animation, actors and
+/// damage flashes, in a battle.
+/// \param enemies Number of enemies.
+
+static BenchFn BenchObjectsMove(size_t enemies){
+  return [=](size_t n){
+    CBenchWorld::Battle(enemies);
+
+    for(size_t i=0; i<n; i++)
+      CBenchWorld::Move();
+  };
+} //BenchObjectsMove
+
+/// One frame of the object manager's draw systems in a battle, recording
+/// the sprites and text into the headless renderer. Rasterizing them is
+/// left to the frame gate, which times whole frames.
+/// \param enemies Number of enemies.
+
+static BenchFn BenchObjectsDraw(size_t enemies){
+  return [=](size_t n){
+    CBenchWorld::Battle(enemies);
+    size_t draws = 0;
+
+    for(size_t i=0; i<n; i++)
+      draws += CBenchWorld::Draw();
+
+    KeepAlive(draws);
+  };
+} //BenchObjectsDraw
+
+/// Reading and parsing the game settings file, as the game does on startup
+/// and when the file changes.
+
+static void BenchSettingsLoad(size_t n){
+  for(size_t i=0; i<n; i++)
+    KeepAlive(LSettings::LoadSettings());
+} //BenchSettingsLoad
+
+/// Register the game object and settings benchmarks. The encounters are the
+/// largest ordinary battle and the 500 enemy stress encounter.
+
+void RegisterObjectBenchmarks(){
+  for(size_t enemies: {6, 500}){
+    const std::string suffix = "/" + std::to_string(enemies);
+    CBench::Register("objects/move" + suffix, BenchObjectsMove(enemies));
+    CBench::Register("objects/draw" + suffix, BenchObjectsDraw(enemies));
+  } //for
+
+  CBench::Register("settings/load", BenchSettingsLoad);
+} //RegisterObjectBenchmarks
@@ -0,0 +1,147 @@
+/// \file PngBench.cpp
+/// \brief Benchmarks for decoding the game's images on the headless platform.
+///
+/// The images are read from `Media/Images`, so run the benchmarks from the
+/// repository root. Files are read into memory first, so only decoding is
+/// timed.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#include "Bench.h"
+
+#include "Png.h"
+
+static const char* g_pImageDir = "Media/Images/"; ///< Where the images are.
+
+/// \brief A PNG file read into memory.
+
+struct PngFile{
+  std::string m_strName; ///< File name.
+  std::vector<uint8_t> m_vData; ///< File contents.
+}; //PngFile
+
+/// Read a file into memory, or quit if it cannot be read, since a benchmark
+/// with nothing to decode would time nothing.
+/// \param name File name, in the image folder.
+/// \return The file.
+
+static PngFile ReadPng(const std::string& name){
+  const std::string path = g_pImageDir + name;
+  std::ifstream input(path, std::ios::binary | std::ios::ate);
+
+  if(!input){
+    fprintf(stderr, "cannot read %s, run bench from the repository root\n", path.c_str());
+    exit(2);
+  } //if
+
+  PngFile f;
+  f.m_strName = name;
+  f.m_vData.resize((size_t)input.tellg());
+  input.seekg(0);
+  input.read((char*)f.m_vData.data(), f.m_vData.size());
+  return f;
+} //ReadPng
+
+/// Read every PNG file in the image folder, the first time only.
+/// \return The files, sorted by name.
+
+static const std::vector<PngFile>& GetAllPngs(){
+  static std::vector<PngFile> files;
+  if(!files.empty())return files;
+
+  std::vector<std::string> names;
+  DIR* dir = opendir(g_pImageDir);
+
+  if(dir){
+    while(const dirent* e = readdir(dir)){
+      const size_t len = strlen(e->d_name);
+      if(len > 4 && strcmp(e->d_name + len - 4, ".png") == 0)
+        names.push_back(e->d_name);
+    } //while
+
+    closedir(dir);
+  } //if
+
+  if(names.empty()){
+    fprintf(stderr, "no images in %s, run bench from the repository root\n", g_pImageDir);
+    exit(2);
+  } //if
+
+  std::sort(names.begin(), names.end());
+
+  for(const std::string& name: names)
+    files.push_back(ReadPng(name));
+
+  return files;
+} //GetAllPngs
+
+/// Decoding one image, as the renderer does when it loads a sprite.
+/// \param name File name, in the image folder.
+
+static BenchFn BenchDecode(const std::string& name){
+  std::shared_ptr<PngFile> f = std::make_shared<PngFile>(); //read on first run
+
+  return [=](size_t n){
+    if(f->m_vData.empty())*f = ReadPng(name);
+
+    for(size_t i=0; i<n; i++){
+      LImage img;
+      DecodePng(f->m_vData.data(), f->m_vData.size(), img);
+      KeepAlive(img.m_vPixels.data());
+    } //for
+  };
+} //BenchDecode
+
+/// Decoding every image in the image folder, several at once on a number of
+/// threads, each taking the next image not yet taken, as the asset loader's
+/// workers do. One operation is the whole folder.
+/// \param threads Number of threads, or 0 for one per hardware thread.
+
+static BenchFn BenchDecodeAll(size_t threads){
+  return [=](size_t n){
+    const std::vector<PngFile>& files = GetAllPngs();
+    const size_t count = threads? threads: std::max(1u, std::thread::hardware_concurrency());
+
+    for(size_t i=0; i<n; i++){
+      std::atomic<size_t> next(0);
+
+      auto decode = [&](){
+        for(size_t j=next++; j<files.size(); j=next++){
+          LImage img;
+          DecodePng(files[j].m_vData.data(), files[j].m_vData.size(), img);
+          KeepAlive(img.m_vPixels.data());
+        } //for
+      }; //decode
+
+      std::vector<std::thread> workers;
+
+      for(size_t t=1; t<count; t++)
+        workers.emplace_back(decode);
+
+      decode();
+
+      for(std::thread& t: workers)
+        t.join();
+    } //for
+  };
+} //BenchDecodeAll
+
+/// Register the image decoding benchmarks. The single images are the
+/// biggest ones the game loads.
+
+void RegisterPngBenchmarks(){
+  for(const char* name: {"PlayerSpritesheet.png", "EnemySpritesheet.png",
+    "cardBackground.png", "nerdBackground.png"})
+    CBench::Register(std::string("png/decode/") + name, BenchDecode(name));
+
+  CBench::Register("png/decode_all/1", BenchDecodeAll(1));
+  CBench::Register("png/decode_all/threads", BenchDecodeAll(0));
+} //RegisterPngBenchmarks
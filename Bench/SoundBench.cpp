@@ -0,0 +1,129 @@
+/// \file SoundBench.cpp
+/// \brief Benchmarks for compressing the game's sounds with ADPCM.
+///
+/// The sounds are read from `Media/Sounds`, so run the benchmarks from the
+/// repository root. Sounds are read into memory first, so only encoding and
+/// decoding are timed. Encoding notes how close the sound is to the
+/// original after decoding it again, and how much smaller it is.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "Bench.h"
+
+#include "Adpcm.h"
+#include "Wav.h"
+
+static const char* g_pSoundDir = "Media/Sounds/"; ///< Where the sounds are.
+
+/// The game's sounds, by file name without the extension.
+
+static const char* g_pSoundName[] = {
+  "Auto", "EndlessHomework", "EnemyDamage", "Lame", "PlayerDamage",
+  "PowerNap", "StudyTime", "Time"
+}; //g_pSoundName
+
+/// Read a sound, or quit if it cannot be read, since a benchmark with
+/// nothing to encode would time nothing.
+/// \param name Sound name.
+/// \return The sound.
+
+static WavSound ReadSound(const std::string& name){
+  const std::string path = g_pSoundDir + name + ".wav";
+  WavSound s;
+
+  if(!LoadWav(path.c_str(), s)){
+    fprintf(stderr, "cannot read %s, run bench from the repository root\n", path.c_str());
+    exit(2);
+  } //if
+
+  return s;
+} //ReadSound
+
+/// Describe how well a sound survives compression: the signal to noise
+/// ratio after decoding it again, and how much smaller it is than with
+/// 16-bit samples.
+/// \param s The sound.
+/// \param a The sound compressed.
+/// \return Description.
+
+static std::string DescribeAdpcm(const WavSound& s, const AdpcmSound& a){
+  WavSound d;
+  DecodeAdpcm(a, d);
+
+  double signal = 0.0, noise = 0.0;
+
+  for(size_t i=0; i<s.m_vSamples.size(); i++){
+    const double x = s.m_vSamples[i], e = x - d.m_vSamples[i];
+    signal += x*x;
+    noise += e*e;
+  } //for
+
+  char note[64];
+  snprintf(note, sizeof(note), "snr %.1f dB, %.2fx smaller",
+    10.0*log10(signal/std::max(noise, 1e-30)),
+    2.0*s.m_vSamples.size()/std::max<size_t>(a.m_vData.size(), 1));
+  return note;
+} //DescribeAdpcm
+
+/// Compressing one of the game's sounds.
+/// \param name Sound name.
+
+static BenchFn BenchEncode(const std::string& name){
+  std::shared_ptr<WavSound> sound = std::make_shared<WavSound>(); //read on first run
+
+  return [=](size_t n){
+    if(sound->m_nChannels == 0)
+      *sound = ReadSound(name);
+
+    AdpcmSound a;
+
+    for(size_t i=0; i<n; i++){
+      EncodeAdpcm(*sound, a);
+      KeepAlive(a.m_vData.data());
+    } //for
+
+    CBench::Note(DescribeAdpcm(*sound, a));
+  };
+} //BenchEncode
+
+/// Decoding all of the game's sounds, 512 frames at a time as the mixer
+/// does. Notes how many samples that is.
+
+static void BenchDecodeAll(size_t n){
+  static std::vector<AdpcmSound> sounds; //encoded on first run
+  static size_t samples = 0;
+
+  if(sounds.empty())
+    for(const char* name: g_pSoundName){
+      const WavSound s = ReadSound(name);
+      sounds.emplace_back();
+      EncodeAdpcm(s, sounds.back());
+      samples += s.m_vSamples.size();
+    } //for
+
+  std::vector<float> block(2*512);
+
+  for(size_t i=0; i<n; i++)
+    for(const AdpcmSound& a: sounds){
+      AdpcmDecoder d;
+
+      while(DecodeAdpcm(a, d, block.data(), 512))
+        KeepAlive(block[0]);
+    } //for
+
+  CBench::Note(std::to_string(samples) + " samples");
+} //BenchDecodeAll
+
+/// Register the sound compression benchmarks.
+
+void RegisterSoundBenchmarks(){
+  for(const char* name: g_pSoundName)
+    CBench::Register(std::string("adpcm/encode/") + name, BenchEncode(name));
+
+  CBench::Register("adpcm/decode_all", BenchDecodeAll);
+} //RegisterSoundBenchmarks
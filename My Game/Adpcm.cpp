@@ -0,0 +1,243 @@
+/// \file Adpcm.cpp
+/// \brief Code for the IMA ADPCM sound codec.
+///
+/// A 4-bit code holds a sign and a magnitude q from 0 to 7, and stands for
+/// a step of (2q + 1)/8 of the current step size, which is the middle of
+/// the range of steps that the encoder turns into q. This rounds a little
+/// better than the shifts and adds of the original IMA decoder, and since
+/// the sounds are only ever encoded and decoded here, nothing needs to
+/// match it bit for bit.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+#endif
+
+#include "Adpcm.h"
+
+static const int MaxIndex = 88; ///< Largest step size index.
+static const size_t StepBytes = (AdpcmBlockFrames - 1)/2; ///< Bytes of steps per channel in a block.
+
+/// Step sizes, from the IMA ADPCM standard.
+
+static const int g_pStepSize[MaxIndex + 1] = {
+  7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+  45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209,
+  230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876,
+  963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749,
+  3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
+  9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385,
+  24623, 27086, 29794, 32767
+}; //g_pStepSize
+
+/// Change in step size index for each magnitude, from the IMA ADPCM standard.
+
+static const int g_pIndexStep[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+/// \brief Step and next step size index for every step size index and
+/// code, worked out once so that decoding a sample is one table lookup, an
+/// add and a clamp.
+
+struct StepTable{
+  /// \brief What a code does.
+
+  struct Entry{
+    int16_t m_nStep; ///< Step.
+    uint16_t m_nNext; ///< Next step size index, times 16.
+  }; //Entry
+
+  Entry m_pEntry[(MaxIndex + 1)*16]; ///< Entries, indexed by step size index times 16 plus code.
+
+  /// Work out the entries.
+
+  StepTable(){
+    for(int i=0; i<=MaxIndex; i++)
+      for(int code=0; code<16; code++){
+        const int step = (2*(code & 7) + 1)*g_pStepSize[i] >> 3;
+        const int next = std::min(std::max(i + g_pIndexStep[code & 7], 0), MaxIndex);
+        m_pEntry[16*i + code].m_nStep = (int16_t)(code & 8? -step: step);
+        m_pEntry[16*i + code].m_nNext = (uint16_t)(16*next);
+      } //for
+  } //constructor
+}; //StepTable
+
+static const StepTable g_cStepTable; ///< Steps.
+
+/// Clamp a sample to 16 bits.
+/// \param x Sample.
+/// \return Clamped sample.
+
+static inline int ClampSample(int x){
+  return std::min(std::max(x, -32768), 32767);
+} //ClampSample
+
+/// Turn a float sample into a 16-bit one.
+/// \param x Sample in [-1, 1].
+/// \return Sample.
+
+static inline int ToSample(float x){
+#if defined(__SSE2__) || defined(_M_X64)
+  return ClampSample(_mm_cvtss_si32(_mm_set_ss(x*32768.0f))); //rounds to nearest
+#else
+  return ClampSample((int)lrintf(x*32768.0f));
+#endif
+} //ToSample
+
+/// Compress a sound. The step size index runs on from block to block
+/// rather than starting over, so the start of a block sounds no worse than
+/// the rest.
+/// \param s The sound, mono or stereo.
+/// \param a [out] Compressed sound, or an empty one if `s` has no channels
+///   that can be compressed.
+
+void EncodeAdpcm(const WavSound& s, AdpcmSound& a){
+  a = AdpcmSound();
+  if(s.m_nChannels != 1 && s.m_nChannels != 2)return;
+
+  const size_t channels = (size_t)s.m_nChannels;
+  const size_t frames = s.GetFrames();
+  const size_t blocks = (frames + AdpcmBlockFrames - 1)/AdpcmBlockFrames;
+
+  a.m_nChannels = s.m_nChannels;
+  a.m_nRate = s.m_nRate;
+  a.m_nFrames = frames;
+  a.m_vData.assign(blocks*a.GetBlockBytes(), 0);
+
+  int index[2] = {};
+
+  for(size_t b=0; b<blocks; b++){
+    uint8_t* block = a.m_vData.data() + b*a.GetBlockBytes();
+    const float* x = s.m_vSamples.data() + b*AdpcmBlockFrames*channels;
+    const size_t n = std::min(AdpcmBlockFrames, frames - b*AdpcmBlockFrames);
+
+    for(size_t c=0; c<channels; c++){
+      int sample = ToSample(x[c]);
+      uint8_t* header = block + 4*c;
+      header[0] = (uint8_t)sample;
+      header[1] = (uint8_t)(sample >> 8);
+      header[2] = (uint8_t)index[c];
+
+      uint8_t* steps = block + 4*channels + c*StepBytes;
+
+      for(size_t k=1; k<n; k++){
+        const int step = g_pStepSize[index[c]];
+        const int diff = ToSample(x[k*channels + c]) - sample;
+        const int code = (diff < 0? 8: 0) | std::min(4*std::abs(diff)/step, 7); //no branch on the sign, which is a coin toss
+        const StepTable::Entry& e = g_cStepTable.m_pEntry[16*index[c] + code];
+        sample = ClampSample(sample + e.m_nStep);
+        index[c] = e.m_nNext/16;
+        steps[(k - 1)/2] |= (uint8_t)(code << 4*((k - 1) & 1));
+      } //for
+    } //for
+  } //for
+} //EncodeAdpcm
+
+/// Decode one sample.
+/// \param code Code.
+/// \param x [in, out] Sample before, and after.
+/// \param i [in, out] Step size index times 16.
+/// \param out [out] Sample as a float.
+
+static inline void DecodeStep(int code, int& x, unsigned& i, float* out){
+  const StepTable::Entry e = g_cStepTable.m_pEntry[i + code];
+  x = ClampSample(x + e.m_nStep);
+  i = e.m_nNext;
+
+#if defined(__SSE2__) || defined(_M_X64) //convert into a cleared register, so as not to wait for the last sample
+  _mm_store_ss(out, _mm_mul_ss(_mm_cvtsi32_ss(_mm_setzero_ps(), x), _mm_set_ss(1.0f/32768.0f)));
+#else
+  *out = x*(1.0f/32768.0f);
+#endif
+} //DecodeStep
+
+/// Decode one channel's samples from part of a block, a byte of codes at a
+/// time where it can. Each sample depends on the one before, so this is one
+/// long chain of table lookups and adds.
+/// \param steps The channel's codes in the block.
+/// \param k Index of the first code to decode.
+/// \param n Number of samples.
+/// \param sample [in, out] Last sample decoded.
+/// \param index [in, out] Step size index.
+/// \param out [out] Samples, every `stride` floats.
+/// \param stride Number of channels in the output.
+
+static void DecodeSteps(const uint8_t* steps, size_t k, size_t n, int& sample, int& index,
+  float* out, size_t stride)
+{
+  int x = sample;
+  unsigned i = 16*index;
+  size_t j = 0;
+
+  if(n > 0 && (k & 1)) //high nibble first
+    DecodeStep(steps[k++ >> 1] >> 4, x, i, out + stride*j++);
+
+  for(; j + 2<=n; j+=2, k+=2){
+    const int b = steps[k >> 1];
+    DecodeStep(b & 15, x, i, out + stride*j);
+    DecodeStep(b >> 4, x, i, out + stride*(j + 1));
+  } //for
+
+  if(j < n) //low nibble last
+    DecodeStep(steps[k >> 1] & 15, x, i, out + stride*j);
+
+  sample = x;
+  index = (int)(i/16);
+} //DecodeSteps
+
+/// Decode the next frames of a compressed sound, from where the decoder is
+/// up to, and move the decoder on past them.
+/// \param a Compressed sound.
+/// \param d [in, out] Decoder.
+/// \param out [out] Frames, interleaved if there is more than one channel.
+/// \param frames Most frames to decode.
+/// \return Number of frames decoded, fewer than asked for at the end.
+
+size_t DecodeAdpcm(const AdpcmSound& a, AdpcmDecoder& d, float* out, size_t frames){
+  const size_t channels = (size_t)a.m_nChannels;
+  size_t done = 0;
+
+  while(done < frames && d.m_nFrame < a.m_nFrames){
+    const size_t k = d.m_nFrame%AdpcmBlockFrames;
+    const size_t n = std::min(std::min(frames - done, AdpcmBlockFrames - k),
+      a.m_nFrames - d.m_nFrame);
+    const uint8_t* block = a.m_vData.data() + d.m_nFrame/AdpcmBlockFrames*a.GetBlockBytes();
+
+    for(size_t c=0; c<channels; c++){
+      float* o = out + done*channels + c;
+      size_t m = n;
+
+      if(k == 0){ //the first sample is in the header
+        const uint8_t* header = block + 4*c;
+        d.m_pSample[c] = (int16_t)(header[0] | header[1] << 8);
+        d.m_pIndex[c] = std::min<int>(header[2], MaxIndex);
+        *o = d.m_pSample[c]*(1.0f/32768.0f);
+        o += channels;
+        m--;
+      } //if
+
+      DecodeSteps(block + 4*channels + c*StepBytes, k == 0? 0: k - 1, m,
+        d.m_pSample[c], d.m_pIndex[c], o, channels);
+    } //for
+
+    d.m_nFrame += n;
+    done += n;
+  } //while
+
+  return done;
+} //DecodeAdpcm
+
+/// Decode a whole compressed sound.
+/// \param a Compressed sound.
+/// \param s [out] The sound.
+
+void DecodeAdpcm(const AdpcmSound& a, WavSound& s){
+  s.m_nChannels = a.m_nChannels;
+  s.m_nRate = a.m_nRate;
+  s.m_vSamples.resize(a.m_nFrames*a.m_nChannels);
+
+  AdpcmDecoder d;
+  DecodeAdpcm(a, d, s.m_vSamples.data(), a.m_nFrames);
+} //DecodeAdpcm
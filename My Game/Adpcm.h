@@ -0,0 +1,51 @@
+/// \file Adpcm.h
+/// \brief Interface for the IMA ADPCM sound codec.
+
+#ifndef __L4RC_GAME_ADPCM_H__
+#define __L4RC_GAME_ADPCM_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Wav.h"
+
+static const size_t AdpcmBlockFrames = 1025; ///< Frames per block, one in full and the rest as steps.
+
+/// \brief A sound compressed with IMA ADPCM.
+///
+/// Each sample is stored as a 4-bit step up or down from the one before,
+/// and the size of the steps adapts to the sound, so that a sound takes a
+/// quarter of the memory of 16-bit samples. The frames are cut into blocks
+/// of `AdpcmBlockFrames`. A block starts with 4 bytes for each channel: its
+/// first sample in full, 16 bits, then the step size index and a zero. The
+/// steps to the rest of the samples follow, all of the first channel's and
+/// then all of the second's, two to a byte with the first in the low
+/// nibble. The last block is padded with zero steps.
+
+struct AdpcmSound{
+  int m_nChannels = 0; ///< Number of channels, 1 or 2.
+  int m_nRate = 0; ///< Sample rate in Hz.
+  size_t m_nFrames = 0; ///< Number of sample frames.
+  std::vector<uint8_t> m_vData; ///< Blocks.
+
+  size_t GetBlockBytes() const { return m_nChannels*(4 + (AdpcmBlockFrames - 1)/2); } ///< Get the size of a block.
+}; //AdpcmSound
+
+/// \brief Where a decoder is up to in an ADPCM sound.
+///
+/// Decoding carries on from here, so a sound can be decoded a few frames
+/// at a time from start to end. Set the frame to the start of a block to
+/// go back or skip ahead.
+
+struct AdpcmDecoder{
+  size_t m_nFrame = 0; ///< Next frame to decode.
+  int m_pSample[2] = {}; ///< Last sample decoded, per channel.
+  int m_pIndex[2] = {}; ///< Step size index, per channel.
+}; //AdpcmDecoder
+
+void EncodeAdpcm(const WavSound& s, AdpcmSound& a); ///< Compress a sound.
+size_t DecodeAdpcm(const AdpcmSound& a, AdpcmDecoder& d, float* out, size_t frames); ///< Decode the next frames.
+void DecodeAdpcm(const AdpcmSound& a, WavSound& s); ///< Decode a whole sound.
+
+#endif //__L4RC_GAME_ADPCM_H__
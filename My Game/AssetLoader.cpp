@@ -0,0 +1,336 @@
+/// \file AssetLoader.cpp
+/// \brief Code for the background asset loader CAssetLoader.
+
+#include <chrono>
+
+#include "AssetLoader.h"
+
+/// Give the groups priority in group order. The lowest rank given out so
+/// far is always the rank of the first group.
+
+CAssetLoader::CAssetLoader(){
+  for(size_t i=0; i<MaxGroups; i++)
+    m_pRank[i] = (int)i;
+} //constructor
+
+/// Stop the workers. Jobs that were not decoded are thrown away.
+
+CAssetLoader::~CAssetLoader(){
+  Stop();
+} //destructor
+
+/// Add an asset. All assets must be added before `Start()`.
+/// \param groups Bit mask of the groups that need the asset.
+/// \param decode Decode function, safe to run on any thread, or empty.
+/// \param commit Commit function, run on the main thread.
+/// \param evict Evict function, run on the main thread, or empty if the
+///   asset can never be unloaded.
+
+void CAssetLoader::Add(uint32_t groups, std::function<void()> decode,
+  std::function<void()> commit, std::function<void()> evict)
+{
+  AssetJob job;
+  job.m_nGroups = groups;
+  job.m_fnDecode = std::move(decode);
+  job.m_fnCommit = std::move(commit);
+  job.m_fnEvict = std::move(evict);
+
+  m_vJobs.push_back(std::move(job));
+  m_vStatus.push_back(eStatus::Unloaded);
+} //Add
+
+/// Start decoding on worker threads. With no threads, assets are decoded on
+/// the main thread in `Update()` and `Wait()`.
+/// \param threads Number of worker threads.
+
+void CAssetLoader::Start(size_t threads){
+  m_bStop = false;
+
+  for(size_t i=0; i<threads; i++)
+    m_vWorkers.emplace_back(&CAssetLoader::WorkerLoop, this);
+} //Start
+
+/// Stop the worker threads once they finish the assets they are decoding.
+/// Call this before releasing anything that the decode functions use.
+
+void CAssetLoader::Stop(){
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bStop = true;
+  }
+
+  m_cvQueued.notify_all();
+
+  for(std::thread& t: m_vWorkers)
+    t.join();
+
+  m_vWorkers.clear();
+} //Stop
+
+/// Put a group ahead of every other group, so that its assets are decoded
+/// and committed next.
+/// \param group Group number.
+
+void CAssetLoader::Prioritize(size_t group){
+  if(group >= MaxGroups)return;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(m_pRank[group] != m_nNextRank) //not first already
+    m_pRank[group] = --m_nNextRank;
+} //Prioritize
+
+/// Get a job's priority, which is that of its most urgent group. Call with
+/// the mutex held.
+/// \param i Job index.
+/// \return Rank, lowest first.
+
+int CAssetLoader::GetRank(size_t i) const{
+  int rank = m_nNextRank + (int)MaxGroups;
+
+  for(size_t g=0; g<MaxGroups; g++)
+    if((m_vJobs[i].m_nGroups >> g & 1) && m_pRank[g] < rank)
+      rank = m_pRank[g];
+
+  return rank;
+} //GetRank
+
+/// Get when a job's asset was last used, which is when the most recently
+/// used of its groups was. Call with the mutex held.
+/// \param i Job index.
+/// \return Time, in calls to `Touch()`.
+
+uint64_t CAssetLoader::GetLastUse(size_t i) const{
+  uint64_t t = 0;
+
+  for(size_t g=0; g<MaxGroups; g++)
+    if((m_vJobs[i].m_nGroups >> g & 1) && m_pLastUse[g] > t)
+      t = m_pLastUse[g];
+
+  return t;
+} //GetLastUse
+
+/// Find the job with a given status that should be done next: the one of
+/// highest priority, then the one added first. Call with the mutex held.
+/// \param s Status.
+/// \param groups Only look at jobs in these groups.
+/// \param i [out] Job index.
+/// \return true if there is such a job.
+
+bool CAssetLoader::Find(eStatus s, uint32_t groups, size_t& i) const{
+  bool found = false;
+  int best = 0;
+
+  for(size_t j=0; j<m_vJobs.size(); j++)
+    if(m_vStatus[j] == s && (m_vJobs[j].m_nGroups & groups)){
+      const int rank = GetRank(j);
+
+      if(!found || rank < best){
+        i = j;
+        best = rank;
+        found = true;
+      } //if
+    } //if
+
+  return found;
+} //Find
+
+/// Queue every unloaded job in some groups. Call with the mutex held.
+/// \param groups Bit mask of groups.
+
+void CAssetLoader::Queue(uint32_t groups){
+  for(size_t i=0; i<m_vJobs.size(); i++)
+    if(m_vStatus[i] == eStatus::Unloaded && (m_vJobs[i].m_nGroups & groups))
+      m_vStatus[i] = eStatus::Queued;
+} //Queue
+
+/// Load the assets in some groups in the background. They are committed by
+/// `Update()` once decoded.
+/// \param groups Bit mask of groups.
+
+void CAssetLoader::Request(uint32_t groups){
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Queue(groups);
+  }
+
+  m_cvQueued.notify_all();
+} //Request
+
+/// Mark some groups as used now, which keeps their assets from being the
+/// first to go when memory runs short.
+/// \param groups Bit mask of groups.
+
+void CAssetLoader::Touch(uint32_t groups){
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_nClock++;
+
+  for(size_t g=0; g<MaxGroups; g++)
+    if(groups >> g & 1)
+      m_pLastUse[g] = m_nClock;
+} //Touch
+
+/// Decode a job that has been marked as decoding, then tell anyone waiting.
+/// \param i Job index.
+
+void CAssetLoader::Decode(size_t i){
+  if(m_vJobs[i].m_fnDecode)
+    m_vJobs[i].m_fnDecode();
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_vStatus[i] = eStatus::Decoded;
+  }
+
+  m_cvDecoded.notify_all();
+} //Decode
+
+/// Commit a decoded job. Only the main thread commits.
+/// \param i Job index.
+
+void CAssetLoader::Commit(size_t i){
+  if(m_vJobs[i].m_fnCommit)
+    m_vJobs[i].m_fnCommit();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_vStatus[i] = eStatus::Committed;
+} //Commit
+
+/// Decode jobs, most urgent first, waiting for more when there are none
+/// left, until the loader is stopped.
+
+void CAssetLoader::WorkerLoop(){
+  for(;;){
+    size_t i = 0;
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cvQueued.wait(lock, [&](){return m_bStop || Find(eStatus::Queued, ~0u, i);});
+      if(m_bStop)return;
+      m_vStatus[i] = eStatus::Decoding;
+    }
+
+    Decode(i);
+  } //for
+} //WorkerLoop
+
+/// Commit decoded assets, most urgent first, until there are none left or
+/// the time budget is used up. At least one is committed if any is ready.
+/// Without worker threads, assets are decoded here too.
+/// \param budget Time budget in milliseconds.
+
+void CAssetLoader::Update(double budget){
+  using clock = std::chrono::steady_clock;
+  const clock::time_point t0 = clock::now();
+
+  do{
+    size_t i = 0;
+    bool decode = false;
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      if(!Find(eStatus::Decoded, ~0u, i)){
+        if(!m_vWorkers.empty() || !Find(eStatus::Queued, ~0u, i))return;
+        m_vStatus[i] = eStatus::Decoding;
+        decode = true;
+      } //if
+    }
+
+    if(decode)Decode(i);
+    Commit(i);
+  }while(std::chrono::duration<double, std::milli>(clock::now() - t0).count() < budget);
+} //Update
+
+/// Load every asset in some groups before returning. Assets that nobody is
+/// decoding yet are decoded on this thread rather than waited for.
+/// \param groups Bit mask of groups.
+
+void CAssetLoader::Wait(uint32_t groups){
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Queue(groups);
+  }
+
+  for(;;){
+    size_t i = 0;
+    bool decode = false;
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      if(Find(eStatus::Queued, groups, i)){
+        m_vStatus[i] = eStatus::Decoding;
+        decode = true;
+      } //if
+
+      else if(!Find(eStatus::Decoded, groups, i)){
+        if(!Find(eStatus::Decoding, groups, i))return;
+        m_cvDecoded.wait(lock);
+        continue;
+      } //else if
+    }
+
+    if(decode)Decode(i);
+    Commit(i);
+  } //for
+} //Wait
+
+/// Test whether every asset in some groups has been committed.
+/// \param groups Bit mask of groups.
+/// \return true if they are all loaded.
+
+bool CAssetLoader::IsReady(uint32_t groups){
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  for(size_t i=0; i<m_vJobs.size(); i++)
+    if((m_vJobs[i].m_nGroups & groups) && m_vStatus[i] != eStatus::Committed)
+      return false;
+
+  return true;
+} //IsReady
+
+/// Test whether `Update()` has anything to do: an asset decoded and waiting
+/// to be committed or, without worker threads, one waiting to be decoded.
+/// \return true if there is an asset to commit.
+
+bool CAssetLoader::HasWork(){
+  std::lock_guard<std::mutex> lock(m_mutex);
+  size_t i = 0;
+
+  return Find(eStatus::Decoded, ~0u, i) ||
+    (m_vWorkers.empty() && Find(eStatus::Queued, ~0u, i));
+} //HasWork
+
+/// Unload the asset that was used least recently, leaving alone those in
+/// some groups and those that cannot be unloaded.
+/// \param keep Bit mask of groups whose assets are kept.
+/// \return true if an asset was unloaded, false if none can be.
+
+bool CAssetLoader::Evict(uint32_t keep){
+  size_t victim = 0;
+  bool found = false;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t oldest = 0;
+
+    for(size_t i=0; i<m_vJobs.size(); i++)
+      if(m_vStatus[i] == eStatus::Committed && m_vJobs[i].m_fnEvict &&
+        !(m_vJobs[i].m_nGroups & keep))
+      {
+        const uint64_t t = GetLastUse(i);
+
+        if(!found || t < oldest){
+          victim = i;
+          oldest = t;
+          found = true;
+        } //if
+      } //if
+
+    if(!found)return false;
+    m_vStatus[victim] = eStatus::Unloaded;
+  }
+
+  m_vJobs[victim].m_fnEvict();
+  return true;
+} //Evict
@@ -0,0 +1,93 @@
+/// \file AssetLoader.h
+/// \brief Interface for the background asset loader CAssetLoader.
+
+#ifndef __L4RC_GAME_ASSETLOADER_H__
+#define __L4RC_GAME_ASSETLOADER_H__
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// \brief An asset to be loaded.
+///
+/// Loading is cut in two. The decode function does the slow part, such as
+/// reading and decompressing a file, and must be safe to run on any thread.
+/// The commit function hands the result to the engine and always runs on
+/// the thread that calls `CAssetLoader::Update()` and `CAssetLoader::Wait()`,
+/// as does the evict function, which unloads the asset again.
+
+struct AssetJob{
+  uint32_t m_nGroups = 0; ///< Bit mask of the groups that need the asset.
+  std::function<void()> m_fnDecode; ///< Decode, on any thread, or empty.
+  std::function<void()> m_fnCommit; ///< Commit, on the main thread.
+  std::function<void()> m_fnEvict; ///< Unload, on the main thread, or empty to keep the asset.
+}; //AssetJob
+
+/// \brief The background asset loader.
+///
+/// Assets are put in groups, such as the game states that draw them. An
+/// asset is not loaded until a group that it belongs to is requested. It is
+/// then decoded on a worker thread, the group with the highest priority
+/// first, and committed a few at a time each frame, so that loading never
+/// holds up a frame for long, or all at once when a group that is needed
+/// right now is waited for. An asset may belong to more than one group, in
+/// which case it goes with the one of highest priority.
+///
+/// The loader also keeps track of when each group was last used, so that
+/// when memory runs short the assets of the group used least recently can
+/// be evicted, see `Evict()`. How much memory assets take is up to the
+/// caller to measure.
+
+class CAssetLoader{
+  public:
+    static const size_t MaxGroups = 32; ///< Number of groups.
+
+  private:
+    enum class eStatus{Unloaded, Queued, Decoding, Decoded, Committed}; ///< Job status.
+
+    std::vector<AssetJob> m_vJobs; ///< Jobs, in the order added.
+    std::vector<eStatus> m_vStatus; ///< Job status, guarded by the mutex.
+    int m_pRank[MaxGroups] = {}; ///< Group priority, lowest first.
+    int m_nNextRank = 0; ///< Rank for the next group to be put first.
+    uint64_t m_pLastUse[MaxGroups] = {}; ///< When each group was last used.
+    uint64_t m_nClock = 0; ///< Number of calls to `Touch()`.
+
+    std::vector<std::thread> m_vWorkers; ///< Decoding threads.
+    std::mutex m_mutex; ///< Guards job status and ranks.
+    std::condition_variable m_cvQueued; ///< Signals a job queued, or stop.
+    std::condition_variable m_cvDecoded; ///< Signals a job decoded.
+    bool m_bStop = false; ///< Tell the workers to quit.
+
+    int GetRank(size_t i) const; ///< Get a job's priority.
+    uint64_t GetLastUse(size_t i) const; ///< Get when a job's asset was last used.
+    bool Find(eStatus s, uint32_t groups, size_t& i) const; ///< Find the job to do next.
+    void Queue(uint32_t groups); ///< Queue the unloaded jobs in groups.
+    void Decode(size_t i); ///< Decode a job, taken from the queue.
+    void Commit(size_t i); ///< Commit a decoded job.
+    void WorkerLoop(); ///< Worker thread body.
+
+  public:
+    CAssetLoader(); ///< Constructor.
+    ~CAssetLoader(); ///< Destructor.
+
+    void Add(uint32_t groups, std::function<void()> decode,
+      std::function<void()> commit, std::function<void()> evict=nullptr); ///< Add an asset.
+    void Start(size_t threads); ///< Start decoding.
+    void Stop(); ///< Stop decoding.
+
+    void Prioritize(size_t group); ///< Put a group first.
+    void Request(uint32_t groups); ///< Load groups in the background.
+    void Touch(uint32_t groups); ///< Mark groups as used now.
+    void Update(double budget); ///< Commit decoded assets for a while.
+    void Wait(uint32_t groups); ///< Load groups now.
+    bool Evict(uint32_t keep); ///< Unload the asset used least recently.
+
+    bool IsReady(uint32_t groups); ///< Test whether groups are loaded.
+    bool HasWork(); ///< Test whether there is an asset to commit.
+}; //CAssetLoader
+
+#endif //__L4RC_GAME_ASSETLOADER_H__
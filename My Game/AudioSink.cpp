@@ -0,0 +1,75 @@
+/// \file AudioSink.cpp
+/// \brief Code for the audio sinks.
+
+#include <algorithm>
+#include <cmath>
+
+#include "AudioSink.h"
+
+/// Throw frames away, counting them.
+/// \param samples Frames, left then right.
+/// \param frames Number of frames.
+
+void CNullSink::Write(const float* samples, size_t frames){
+  (void)samples;
+  m_nFrames += frames;
+} //Write
+
+/// Open a WAV file and write a header for an empty sound, to be filled in
+/// later.
+/// \param path File name.
+/// \param rate Sample rate in Hz.
+
+CWavSink::CWavSink(const char* path, int rate): m_nRate(rate){
+  m_pFile = fopen(path, "wb");
+  if(m_pFile)WriteHeader();
+} //constructor
+
+/// Fill in the header and close the file.
+
+CWavSink::~CWavSink(){
+  if(m_pFile == nullptr)return;
+
+  fseek(m_pFile, 0, SEEK_SET);
+  WriteHeader();
+  fclose(m_pFile);
+} //destructor
+
+/// Write the file header, with the number of frames written so far.
+
+void CWavSink::WriteHeader(){
+  const uint32_t data = (uint32_t)std::min<uint64_t>(m_nFrames*4, 0xFFFFFFFF - 36);
+  const uint32_t fields[] = {0x46464952, 36 + data, 0x45564157, 0x20746D66, 16,
+    1 | 2 << 16, (uint32_t)m_nRate, (uint32_t)m_nRate*4, 4 | 16 << 16,
+    0x61746164, data}; //RIFF, WAVE, fmt, PCM stereo, 16 bits, data
+
+  for(uint32_t f: fields){
+    const uint8_t b[4] = {(uint8_t)f, (uint8_t)(f >> 8), (uint8_t)(f >> 16), (uint8_t)(f >> 24)};
+    fwrite(b, 1, 4, m_pFile);
+  } //for
+} //WriteHeader
+
+/// Write frames to the file as 16-bit samples.
+/// \param samples Frames, left then right, in [-1, 1].
+/// \param frames Number of frames.
+
+void CWavSink::Write(const float* samples, size_t frames){
+  if(m_pFile == nullptr)return;
+
+  uint8_t buffer[1024];
+
+  for(size_t i=0; i<2*frames;){
+    const size_t n = std::min<size_t>(2*frames - i, sizeof(buffer)/2);
+
+    for(size_t j=0; j<n; j++){
+      const int16_t x = (int16_t)lrintf(samples[i + j]*32767.0f);
+      buffer[2*j] = (uint8_t)x;
+      buffer[2*j + 1] = (uint8_t)(x >> 8);
+    } //for
+
+    fwrite(buffer, 2, n, m_pFile);
+    i += n;
+  } //for
+
+  m_nFrames += frames;
+} //Write
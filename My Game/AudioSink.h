@@ -0,0 +1,58 @@
+/// \file AudioSink.h
+/// \brief Interface for the audio sinks, which take the mixer's output.
+
+#ifndef __L4RC_GAME_AUDIOSINK_H__
+#define __L4RC_GAME_AUDIOSINK_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/// \brief Audio sink interface.
+///
+/// An audio sink takes stereo frames of float samples from the mixer, as
+/// a sound card would.
+
+class CAudioSink{
+  public:
+    virtual ~CAudioSink(){} ///< Destructor.
+    virtual void Write(const float* samples, size_t frames) = 0; ///< Take frames.
+}; //CAudioSink
+
+/// \brief An audio sink that throws its frames away, which is all there is
+/// to hear without a sound card.
+
+class CNullSink: public CAudioSink{
+  private:
+    uint64_t m_nFrames = 0; ///< Number of frames taken.
+
+  public:
+    void Write(const float* samples, size_t frames) override; ///< Take frames.
+    uint64_t GetFrames() const { return m_nFrames; } ///< Get number of frames taken.
+}; //CNullSink
+
+/// \brief An audio sink that writes a WAV file, 16-bit stereo.
+///
+/// The file's header is filled in when the sink is destroyed, so a file
+/// from a run that crashed has the samples but says it has none.
+
+class CWavSink: public CAudioSink{
+  private:
+    FILE* m_pFile = nullptr; ///< Output file.
+    int m_nRate = 0; ///< Sample rate in Hz.
+    uint64_t m_nFrames = 0; ///< Number of frames written.
+
+    void WriteHeader(); ///< Write the file header.
+
+  public:
+    CWavSink(const char* path, int rate); ///< Constructor.
+    ~CWavSink(); ///< Destructor.
+
+    CWavSink(const CWavSink&) = delete; ///< No copying.
+    CWavSink& operator=(const CWavSink&) = delete; ///< No copying.
+
+    bool IsOpen() const { return m_pFile != nullptr; } ///< Test whether the file is open.
+    void Write(const float* samples, size_t frames) override; ///< Take frames.
+}; //CWavSink
+
+#endif //__L4RC_GAME_AUDIOSINK_H__
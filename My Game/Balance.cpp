@@ -0,0 +1,118 @@
+/// \file Balance.cpp
+/// \brief Code for the balance parameters Balance.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "Balance.h"
+#include "EnemyPolicy.h"
+
+static Balance g_sBalance; ///< The current balance.
+
+/// Every balance parameter, in balance file order. The ranges keep a tuner
+/// away from sets that make no sense, such as enemies that heal for nothing.
+
+static const BalanceField g_pField[] = {
+  {"player_health", &Balance::m_nPlayerHealth, 5, 40},
+  {"enemy_health", &Balance::m_nEnemyHealth, 3, 30},
+  {"boss_health", &Balance::m_nBossHealth, 5, 60},
+  {"attack", &Balance::m_nAttack, 1, 6},
+  {"attack_min", &Balance::m_nAttackMin, -2, 0},
+  {"attack_max", &Balance::m_nAttackMax, 0, 3},
+  {"boss_attack", &Balance::m_nBossAttack, 1, 8},
+  {"boss_attack_min", &Balance::m_nBossAttackMin, -2, 0},
+  {"boss_attack_max", &Balance::m_nBossAttackMax, 0, 3},
+  {"heal", &Balance::m_nHeal, 0, 5},
+  {"heal_min", &Balance::m_nHealMin, 0, 0},
+  {"heal_max", &Balance::m_nHealMax, 0, 3},
+  {"heal_below", &Balance::m_nHealBelow, 0, 10},
+  {"heal_chance", &Balance::m_nHealChance, 0, 100},
+  {"upgrade", &Balance::m_nUpgrade, 0, 3},
+  {"upgrade_all", &Balance::m_nUpgradeAll, 0, 4},
+  {"guard_enemies", &Balance::m_nGuardEnemies, 1, 6},
+}; //g_pField
+
+/// Get the balance the game is played with.
+/// \return The current balance.
+
+const Balance& GetBalance(){
+  return g_sBalance;
+} //GetBalance
+
+/// Replace the balance the game is played with, and rebuild the default
+/// enemy policies to match. Not thread safe: call it before starting games
+/// or simulations, not while they run.
+/// \param b The new balance.
+
+void SetBalance(const Balance& b){
+  g_sBalance = b;
+  BalanceEnemyPolicies(b);
+} //SetBalance
+
+/// Get the table of balance parameters.
+/// \param n [out] Number of parameters.
+/// \return Pointer to the first parameter.
+
+const BalanceField* GetBalanceFields(size_t& n){
+  n = sizeof(g_pField)/sizeof(g_pField[0]);
+  return g_pField;
+} //GetBalanceFields
+
+/// Read a balance file, one `name value` pair per line. Parameters that the
+/// file does not mention keep their values, so a file need only list the
+/// ones that were changed. Lines starting with `#` are comments.
+/// \param path File name.
+/// \param b [in, out] Balance.
+/// \return false if the file cannot be read or has a line that is not a
+/// known parameter and a number, in which case b is unchanged.
+
+bool LoadBalance(const char* path, Balance& b){
+  std::ifstream input(path);
+  if(!input)return false;
+
+  size_t n = 0;
+  const BalanceField* field = GetBalanceFields(n);
+  Balance loaded = b;
+  std::string line;
+
+  while(std::getline(input, line)){
+    const size_t start = line.find_first_not_of(" \t\r");
+    if(start == std::string::npos || line[start] == '#')continue;
+
+    char name[32];
+    int value = 0;
+
+    if(sscanf(line.c_str() + start, "%31s %d", name, &value) != 2)
+      return false;
+
+    size_t i = 0;
+    while(i < n && strcmp(name, field[i].m_pName) != 0)
+      i++;
+
+    if(i == n)return false;
+    loaded.*field[i].m_pValue = value;
+  } //while
+
+  b = loaded;
+  return true;
+} //LoadBalance
+
+/// Write every parameter of a balance to a file that `LoadBalance()` reads.
+/// \param path File name.
+/// \param b Balance.
+/// \return true if the file was written.
+
+bool SaveBalance(const char* path, const Balance& b){
+  std::ofstream output(path);
+  if(!output)return false;
+
+  size_t n = 0;
+  const BalanceField* field = GetBalanceFields(n);
+
+  for(size_t i=0; i<n; i++)
+    output << field[i].m_pName << " " << b.*field[i].m_pValue << "\n";
+
+  return (bool)output;
+} //SaveBalance
@@ -0,0 +1,55 @@
+/// \file Balance.h
+/// \brief Interface for the balance parameters Balance.
+
+#ifndef __L4RC_GAME_BALANCE_H__
+#define __L4RC_GAME_BALANCE_H__
+
+#include <cstddef>
+
+/// \brief The numbers that decide how hard the game is.
+///
+/// Enemy cards are a base value plus a random bonus in [min, max]. The
+/// defaults are the values the game shipped with. The game, the battle
+/// simulator and the map generator all read the current set from
+/// `GetBalance()`, so a tuned set changes all of them at once.
+
+struct Balance{
+  int m_nPlayerHealth = 15; ///< Player health at the start of a run.
+  int m_nEnemyHealth = 10; ///< Health of an ordinary enemy.
+  int m_nBossHealth = 20; ///< Health of the boss.
+
+  int m_nAttack = 2; ///< Ordinary enemy attack.
+  int m_nAttackMin = -1; ///< Smallest ordinary enemy attack bonus.
+  int m_nAttackMax = 1; ///< Largest ordinary enemy attack bonus.
+  int m_nBossAttack = 3; ///< Boss attack.
+  int m_nBossAttackMin = 0; ///< Smallest boss attack bonus.
+  int m_nBossAttackMax = 1; ///< Largest boss attack bonus.
+
+  int m_nHeal = 1; ///< Enemy heal.
+  int m_nHealMin = 0; ///< Smallest enemy heal bonus.
+  int m_nHealMax = 2; ///< Largest enemy heal bonus.
+  int m_nHealBelow = 3; ///< Enemies may heal below this health.
+  int m_nHealChance = 70; ///< Percent chance that an enemy that may heal does.
+
+  int m_nUpgrade = 1; ///< Added to the card upgraded after a battle.
+  int m_nUpgradeAll = 2; ///< Added to every card at the special card level.
+  int m_nGuardEnemies = 4; ///< Fewest enemies in a level leading to the special card level.
+}; //Balance
+
+/// \brief A named balance parameter with the range it may take.
+
+struct BalanceField{
+  const char* m_pName; ///< Name in balance files.
+  int Balance::* m_pValue; ///< The parameter.
+  int m_nMin; ///< Smallest sensible value.
+  int m_nMax; ///< Largest sensible value.
+}; //BalanceField
+
+const Balance& GetBalance(); ///< Get the current balance.
+void SetBalance(const Balance&); ///< Replace the current balance.
+
+const BalanceField* GetBalanceFields(size_t& n); ///< Get the parameter table.
+bool LoadBalance(const char* path, Balance& b); ///< Read a balance file.
+bool SaveBalance(const char* path, const Balance& b); ///< Write a balance file.
+
+#endif //__L4RC_GAME_BALANCE_H__
@@ -0,0 +1,212 @@
+/// \file BattleSim.cpp
+/// \brief Code for the headless battle simulator CBattleSim.
+
+#include <algorithm>
+
+#include "Balance.h"
+#include "BattleSim.h"
+
+const int CBattleSim::MaxTurns; ///< Definition, since `std::min()` takes it by reference.
+
+/// Construct a simulator with the starting deck and full health.
+/// \param seed Seed for the card draws and enemy decisions.
+
+CBattleSim::CBattleSim(uint64_t seed){
+  m_sState.m_nEnemyRng = CRng(seed).GetState();
+  m_sState.m_nDrawRng = CRng(seed ^ 0x5DEECE66DULL).GetState();
+  m_sState.m_nHealth = (int16_t)GetBalance().m_nPlayerHealth;
+  SetStartDeck();
+} //constructor
+
+/// Get the same starting deck as `Player::CreateStartDeck()`: five damage
+/// cards, four shield cards and one health card.
+/// \return The starting deck.
+
+std::vector<SimCard> CBattleSim::GetStartDeck(){
+  std::vector<SimCard> deck(10);
+
+  for(int i=0; i<5; i++)deck[i].m_nDamage = 4;
+  for(int i=5; i<9; i++)deck[i].m_nShield = 2;
+  deck[9].m_nHealth = 1;
+
+  return deck;
+} //GetStartDeck
+
+/// Use the game's starting deck.
+
+void CBattleSim::SetStartDeck(){
+  SetDeck(GetStartDeck());
+} //SetStartDeck
+
+/// Replace the deck. All cards go back into the draw pile. Cards past
+/// `BattleState::MaxCards` are left out.
+/// \param deck The new deck.
+
+void CBattleSim::SetDeck(const std::vector<SimCard>& deck){
+  const size_t n = std::min(deck.size(), BattleState::MaxCards);
+
+  for(size_t i=0; i<n; i++){
+    m_sState.m_pCard[i].m_nDamage = (int8_t)deck[i].m_nDamage;
+    m_sState.m_pCard[i].m_nShield = (int8_t)deck[i].m_nShield;
+    m_sState.m_pCard[i].m_nHealth = (int8_t)deck[i].m_nHealth;
+    m_sState.m_pOrder[i] = (uint8_t)i;
+  } //for
+
+  m_sState.m_nCards = (uint8_t)n;
+  m_sState.m_pCount[0] = (uint8_t)n;
+  m_sState.m_pCount[1] = m_sState.m_pCount[2] = m_sState.m_pCount[3] = 0;
+  m_sState.m_nPlayedMask = m_sState.m_nExhaustMask = 0;
+  m_bDealt = false;
+} //SetDeck
+
+/// Greedy card choice. Heal when health is low, otherwise play the biggest
+/// damage card, otherwise the biggest shield card, otherwise whatever is left.
+/// \return Hand slot of the chosen card, or -1 if every card has been played.
+
+int CBattleSim::ChooseCard() const{
+  int best = -1;
+  int bestScore = -1;
+
+  for(size_t i=0; i<m_sState.GetHandCount(); i++){
+    const size_t card = m_sState.GetHandCard(i);
+    if(m_sState.IsPlayed(card))continue;
+
+    const StateCard& c = m_sState.m_pCard[card];
+    int score = 0;
+
+    if(c.m_nHealth > 0 && m_sState.m_nHealth <= 5)
+      score = 3000 + c.m_nHealth;
+    else if(c.m_nDamage > 0)
+      score = 2000 + c.m_nDamage;
+    else if(c.m_nShield > 0)
+      score = 1000 + c.m_nShield;
+    else score = c.m_nHealth;
+
+    if(score > bestScore){
+      bestScore = score;
+      best = (int)i;
+    } //if
+  } //for
+
+  return best;
+} //ChooseCard
+
+/// Choose the weakest enemy, so that enemies are finished off one at a time.
+/// \return Index of the target enemy.
+
+size_t CBattleSim::ChooseTarget() const{
+  size_t target = 0;
+
+  for(size_t i=1; i<m_sState.m_nEnemies; i++)
+    if(m_sState.m_pEnemy[i].m_nHealth < m_sState.m_pEnemy[target].m_nHealth)
+      target = i;
+
+  return target;
+} //ChooseTarget
+
+/// Play a battle to the end. The player keeps their health from the previous
+/// battle, as in the game.
+/// \param numEnemies Number of enemies, at most `BattleState::MaxEnemies`.
+/// \param boss True if the first enemy is the boss.
+/// \return The outcome of the battle.
+
+BattleResult CBattleSim::Fight(int numEnemies, bool boss){
+  const size_t n = std::min((size_t)std::max(numEnemies, 0), BattleState::MaxEnemies);
+  m_sState.m_nEnemies = (uint8_t)n;
+
+  for(size_t i=0; i<n; i++){
+    m_sState.m_pEnemy[i].m_nAttack = (uint8_t)EnemyAttack::EndlessHomework;
+    m_sState.m_pEnemy[i].m_nHealth = (int16_t)GetBalance().m_nEnemyHealth;
+  } //for
+
+  if(boss && n > 0){
+    m_sState.m_pEnemy[0].m_nAttack = (uint8_t)EnemyAttack::Lame;
+    m_sState.m_pEnemy[0].m_nHealth = (int16_t)GetBalance().m_nBossHealth;
+  } //if
+
+  m_sState.m_nShield = 0;
+  m_bDealt = false;
+
+  return Resume();
+} //Fight
+
+/// Pick up from a snapshot saved by the game. The deck, its piles, the
+/// player's health and shield and the random number generators are all
+/// restored. If the snapshot was taken in a battle, so are the enemies and
+/// the cards already played from the current hand, and `Resume()` will
+/// finish that battle exactly as the game would have.
+/// \param s Snapshot.
+/// \return `eLoad::Battle` if the snapshot was taken in a battle,
+/// `eLoad::Map` if it was taken between battles, and `eLoad::Failed` if
+/// its piles or enemies do not fit in a `BattleState`, in which case the
+/// simulator must not be resumed.
+
+eLoad CBattleSim::Load(const RunSnapshot& s){
+  std::vector<SimCard> deck(s.m_vCards.size());
+
+  for(size_t i=0; i<deck.size(); i++){
+    deck[i].m_nDamage = s.m_vCards[i].m_nDamage;
+    deck[i].m_nShield = s.m_vCards[i].m_nShield;
+    deck[i].m_nHealth = s.m_vCards[i].m_nHealth;
+  } //for
+
+  SetDeck(deck);
+  m_bDealt = false;
+
+  DeckState piles;
+  s.GetPiles(piles);
+  if(!m_sState.SetPiles(piles))return eLoad::Failed;
+
+  m_sState.m_nEnemyRng = s.m_sHeader.m_nEnemyRng;
+  m_sState.m_nHealth = s.m_sHeader.m_nHealth;
+  m_sState.m_nShield = s.m_sHeader.m_nShield;
+  m_sState.m_nPlayed = s.m_sHeader.m_nTurn;
+  m_sState.m_nEnemies = 0;
+
+  if(s.m_sHeader.m_nBattle == 0)return eLoad::Map;
+  if(s.m_vEnemies.size() > BattleState::MaxEnemies)return eLoad::Failed;
+
+  for(const SnapEnemy& e: s.m_vEnemies){
+    if(e.m_nAttack >= (uint8_t)EnemyAttack::Size)return eLoad::Failed;
+    StateEnemy& enemy = m_sState.m_pEnemy[m_sState.m_nEnemies++];
+    enemy.m_nAttack = e.m_nAttack;
+    enemy.m_nHealth = e.m_nHealth;
+  } //for
+
+  m_bDealt = true;
+  return eLoad::Battle;
+} //Load
+
+/// Play the current battle to the end. If the current hand has already been
+/// dealt, it is played first with the cards already played from it counted
+/// against this turn. The turn count and damage taken are counted from here.
+/// \return The outcome of the battle.
+
+BattleResult CBattleSim::Resume(){
+  BattleResult result;
+  const int startHealth = m_sState.m_nHealth;
+
+  if(!m_bDealt)
+    m_sState.Deal();
+
+  m_bDealt = false;
+  const int start = m_sState.m_nTurns - 1;
+
+  while(!m_sState.IsOver() && m_sState.m_nTurns - start <= MaxTurns){
+    BattleAction a;
+    const int slot = ChooseCard();
+
+    if(slot >= 0){
+      a.m_nSlot = (uint8_t)slot;
+      a.m_nTarget = (uint8_t)ChooseTarget();
+    } //if
+
+    m_sState.Step(a);
+  } //while
+
+  result.m_bWon = m_sState.IsWon();
+  result.m_nTurns = std::min(m_sState.m_nTurns - start, MaxTurns);
+  result.m_nPlayerHealth = m_sState.m_nHealth;
+  result.m_nDamageTaken = std::max(0, startHealth - m_sState.m_nHealth);
+  return result;
+} //Resume
@@ -0,0 +1,78 @@
+/// \file BattleSim.h
+/// \brief Interface for the headless battle simulator CBattleSim.
+
+#ifndef __L4RC_GAME_BATTLESIM_H__
+#define __L4RC_GAME_BATTLESIM_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "BattleState.h"
+#include "Snapshot.h"
+
+/// \brief A card as the rules see it.
+
+struct SimCard{
+  int m_nDamage = 0; ///< Damage dealt to an enemy.
+  int m_nShield = 0; ///< Shield given to the player.
+  int m_nHealth = 0; ///< Health given to the player.
+}; //SimCard
+
+/// \brief The outcome of a simulated battle.
+
+struct BattleResult{
+  bool m_bWon = false; ///< True if the player won.
+  int m_nTurns = 0; ///< Number of turns taken.
+  int m_nPlayerHealth = 0; ///< Player health at the end.
+  int m_nDamageTaken = 0; ///< Health lost by the player.
+}; //BattleResult
+
+/// \brief What the simulator found in a snapshot.
+
+enum class eLoad: uint8_t{
+  Battle, ///< A battle, which `CBattleSim::Resume()` will finish.
+  Map, ///< The map between battles.
+  Failed ///< Something the simulator cannot hold, such as too many enemies.
+}; //eLoad
+
+/// \brief The headless battle simulator.
+///
+/// Plays battles by the same rules as `CGame`, with the same card piles and
+/// the same enemy policies, but with no renderer, sound or animation. The
+/// player's cards are chosen by a simple greedy strategy. Used to try out
+/// enemy AI and balance changes on many battles before they ship. The
+/// battle itself is a `BattleState`, which can be copied out for searches
+/// and what-if questions and copied back in to carry on from.
+
+class CBattleSim{
+  public:
+    static const int HandSize = BattleState::HandSize; ///< Cards dealt per hand.
+    static const int CardsPerTurn = BattleState::CardsPerTurn; ///< Cards played per turn.
+    static const int MaxTurns = 200; ///< Battles longer than this are lost.
+
+  private:
+    BattleState m_sState; ///< The battle.
+    bool m_bDealt = false; ///< The current hand has been dealt.
+
+    int ChooseCard() const; ///< Choose a card from the hand.
+    size_t ChooseTarget() const; ///< Choose an enemy to attack.
+
+  public:
+    CBattleSim(uint64_t seed); ///< Constructor.
+
+    static std::vector<SimCard> GetStartDeck(); ///< Get the game's starting deck.
+
+    void SetStartDeck(); ///< Use the game's starting deck.
+    void SetDeck(const std::vector<SimCard>&); ///< Use a given deck.
+    void SetPlayerHealth(int h){ m_sState.m_nHealth = (int16_t)h; } ///< Set player health.
+    int GetPlayerHealth() const { return m_sState.m_nHealth; } ///< Get player health.
+
+    const BattleState& GetState() const { return m_sState; } ///< Get the battle.
+    void SetState(const BattleState& s){ m_sState = s; m_bDealt = true; } ///< Carry on from a battle.
+
+    eLoad Load(const RunSnapshot&); ///< Pick up from a saved battle.
+    BattleResult Fight(int numEnemies, bool boss); ///< Play a battle.
+    BattleResult Resume(); ///< Play the current battle to the end.
+}; //CBattleSim
+
+#endif //__L4RC_GAME_BATTLESIM_H__
@@ -0,0 +1,244 @@
+/// \file BattleState.cpp
+/// \brief Code for the compact battle state BattleState.
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "BattleState.h"
+
+static_assert(std::is_trivially_copyable<BattleState>::value, "battle state must be memcpy-able");
+static_assert(sizeof(BattleState) <= 256, "battle state must stay small");
+static_assert(BattleState::MaxCards <= 16, "masks hold 16 cards");
+
+const size_t BattleState::MaxCards; ///< Definition, since `std::min()` takes it by reference.
+const size_t BattleState::MaxEnemies; ///< Definition, since `std::min()` takes it by reference.
+
+/// Move the hand to the discard pile, except for played cards that exhaust,
+/// which go to the exhaust pile instead. Same as `CDeck::DiscardHand()`.
+/// \param s Battle state.
+
+static void DiscardHand(BattleState& s){
+  uint8_t* order = s.m_pOrder;
+  const size_t d = s.m_pCount[0];
+  const size_t h = s.m_pCount[1];
+  size_t x = s.m_pCount[2];
+  size_t e = s.m_pCount[3];
+
+  uint8_t hand[BattleState::MaxCards];
+  memcpy(hand, order + d, h);
+  memmove(order + d, order + d + h, x + e); //close the gap left by the hand
+
+  for(size_t i=0; i<h; i++){
+    const uint8_t card = hand[i];
+
+    if(s.IsPlayed(card) && (s.m_nExhaustMask >> card & 1))
+      order[d + x + e++] = card;
+
+    else{
+      memmove(order + d + x + 1, order + d + x, e);
+      order[d + x++] = card;
+    } //else
+  } //for
+
+  s.m_pCount[1] = 0;
+  s.m_pCount[2] = (uint8_t)x;
+  s.m_pCount[3] = (uint8_t)e;
+  s.m_nPlayedMask = 0;
+} //DiscardHand
+
+/// Draw a card into the back of the hand, pouring the discard pile into the
+/// draw pile first if the draw pile is empty. Same as one step of
+/// `CDeck::Draw()`.
+/// \param s Battle state.
+/// \param rng Card draw random number generator.
+/// \return true if a card was drawn.
+
+static bool DrawCard(BattleState& s, CRng& rng){
+  uint8_t* order = s.m_pOrder;
+
+  if(s.m_pCount[0] == 0){ //move the discard pile in front of the hand
+    std::rotate(order, order + s.m_pCount[1], order + s.m_pCount[1] + s.m_pCount[2]);
+    s.m_pCount[0] = s.m_pCount[2];
+    s.m_pCount[2] = 0;
+  } //if
+
+  const size_t d = s.m_pCount[0];
+  if(d == 0)return false; //everything is in the hand or exhausted
+
+  const size_t j = rng.randn(0, (int)d - 1);
+  std::swap(order[0], order[j]);
+  std::rotate(order, order + 1, order + d + s.m_pCount[1]); //front card to back of hand
+
+  --s.m_pCount[0];
+  ++s.m_pCount[1];
+  return true;
+} //DrawCard
+
+/// Discard the hand and deal a new one, starting a new turn.
+
+void BattleState::Deal(){
+  DiscardHand(*this);
+
+  CRng rng;
+  rng.SetState(m_nDrawRng);
+
+  for(int i=0; i<HandSize && DrawCard(*this, rng); i++);
+
+  m_nDrawRng = rng.GetState();
+  m_nPlayed = 0;
+  ++m_nTurns;
+} //Deal
+
+/// Apply damage to the player the same way as `Player::TakeDamage()`. Any
+/// shield absorbs as much of the hit as it can and is then used up.
+/// \param amount Amount of damage.
+
+void BattleState::TakeDamage(int amount){
+  if(m_nShield > 0){
+    const int left = m_nShield - amount;
+    if(left < 0)m_nHealth = (int16_t)std::max(0, m_nHealth + left);
+    m_nShield = 0;
+  } //if
+
+  else m_nHealth = (int16_t)std::max(0, m_nHealth - amount);
+} //TakeDamage
+
+/// Decide every enemy's card for this turn in one pass.
+/// \param intent [out] Array of `m_nEnemies` cards, in enemy order.
+
+void BattleState::PlanEnemyTurn(EnemyCard* intent){
+  EnemyView view[MaxEnemies];
+
+  for(size_t i=0; i<m_nEnemies; i++){
+    view[i].m_eAttack = (EnemyAttack)m_pEnemy[i].m_nAttack;
+    view[i].m_nHealth = m_pEnemy[i].m_nHealth;
+    view[i].m_nPlayerHealth = m_nHealth;
+    view[i].m_nPlayerShield = m_nShield;
+  } //for
+
+  CRng rng;
+  rng.SetState(m_nEnemyRng);
+  DecideIntents(view, intent, m_nEnemies, rng);
+  m_nEnemyRng = rng.GetState();
+} //PlanEnemyTurn
+
+/// Carry out an enemy's card: hit the player, or heal the enemy.
+/// \param i Enemy index.
+/// \param card The enemy's card.
+
+void BattleState::PlayEnemyCard(size_t i, const EnemyCard& card){
+  if(card.type == EnemyCardType::Attack)
+    TakeDamage(card.value);
+
+  else if(card.type == EnemyCardType::Heal)
+    m_pEnemy[i].m_nHealth = (int16_t)(m_pEnemy[i].m_nHealth + card.value);
+} //PlayEnemyCard
+
+/// Decide every enemy's intent in one pass and then carry them out in enemy
+/// order. The player's shield wears off at the end of the enemy turn.
+
+void BattleState::EnemyTurn(){
+  EnemyCard intent[MaxEnemies];
+  PlanEnemyTurn(intent);
+
+  for(size_t i=0; i<m_nEnemies; i++){
+    PlayEnemyCard(i, intent[i]);
+    if(IsLost())return;
+  } //for
+
+  EndEnemyTurn();
+} //EnemyTurn
+
+/// Play a card from the hand, at an enemy if it deals damage. An enemy
+/// brought down to no health is removed, keeping the others in order. The
+/// turn does not end, even on the last card of it.
+/// \param a The move, which must not be `BattleAction::EndTurn`.
+/// \return false if the move is not allowed, in which case nothing changes.
+
+bool BattleState::Play(const BattleAction& a){
+  if(IsOver() || a.m_nSlot >= GetHandCount())return false;
+
+  const size_t card = GetHandCard(a.m_nSlot);
+  const StateCard& c = m_pCard[card];
+
+  if(IsPlayed(card) || (c.m_nDamage > 0 && a.m_nTarget >= m_nEnemies))
+    return false;
+
+  m_nPlayedMask |= (uint16_t)(1 << card);
+  ++m_nPlayed;
+  m_nShield = (int16_t)(m_nShield + c.m_nShield);
+  m_nHealth = (int16_t)(m_nHealth + c.m_nHealth);
+
+  if(c.m_nDamage > 0){
+    StateEnemy& e = m_pEnemy[a.m_nTarget];
+    e.m_nHealth = (int16_t)std::max(0, e.m_nHealth - c.m_nDamage);
+
+    if(e.m_nHealth == 0){ //remove it, keeping the others in order
+      memmove(&e, &e + 1, (m_nEnemies - a.m_nTarget - 1)*sizeof(StateEnemy));
+      --m_nEnemies;
+    } //if
+  } //if
+
+  return true;
+} //Play
+
+/// Apply a move. Playing the last card of a turn, or ending the turn, plays
+/// the enemies' turn and deals the next hand, as `CGame` does.
+/// \param a The move.
+/// \return false if the move is not allowed, in which case nothing changes.
+
+bool BattleState::Step(const BattleAction& a){
+  if(IsOver())return false;
+
+  if(a.m_nSlot != BattleAction::EndTurn){
+    if(!Play(a))return false;
+    if(IsWon() || m_nPlayed < CardsPerTurn)return true;
+  } //if
+
+  EnemyTurn();
+  if(!IsLost())Deal();
+
+  return true;
+} //Step
+
+/// Restore the piles and the card draw generator from a deck's saved state.
+/// \param s Saved deck state.
+/// \return false if the deck has more than `MaxCards` cards.
+
+bool BattleState::SetPiles(const DeckState& s){
+  if(s.m_nCards > MaxCards)return false;
+
+  m_nCards = (uint8_t)s.m_nCards;
+  m_nPlayedMask = m_nExhaustMask = 0;
+
+  for(size_t p=0; p<4; p++)
+    m_pCount[p] = (uint8_t)s.m_pCount[p];
+
+  memcpy(m_pOrder, s.m_pOrder, m_nCards);
+
+  for(size_t i=0; i<m_nCards; i++){
+    if(s.m_pFlags[i] & 1)m_nPlayedMask |= (uint16_t)(1 << i);
+    if(s.m_pFlags[i] & 2)m_nExhaustMask |= (uint16_t)(1 << i);
+  } //for
+
+  m_nDrawRng = s.m_nRng;
+  return true;
+} //SetPiles
+
+/// Save the piles and the card draw generator in the form `CDeck` uses.
+/// \param s [out] Saved deck state.
+
+void BattleState::GetPiles(DeckState& s) const{
+  s.m_nCards = m_nCards;
+
+  for(size_t p=0; p<4; p++)
+    s.m_pCount[p] = m_pCount[p];
+
+  memcpy(s.m_pOrder, m_pOrder, m_nCards);
+
+  for(size_t i=0; i<m_nCards; i++)
+    s.m_pFlags[i] = (uint8_t)((IsPlayed(i)? 1: 0) | ((m_nExhaustMask >> i & 1)? 2: 0));
+
+  s.m_nRng = m_nDrawRng;
+} //GetPiles
@@ -0,0 +1,104 @@
+/// \file BattleState.h
+/// \brief Interface for the compact battle state BattleState.
+
+#ifndef __L4RC_GAME_BATTLESTATE_H__
+#define __L4RC_GAME_BATTLESTATE_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Deck.h"
+#include "EnemyPolicy.h"
+
+/// \brief A card in a battle state.
+
+struct StateCard{
+  int8_t m_nDamage = 0; ///< Damage dealt to an enemy.
+  int8_t m_nShield = 0; ///< Shield given to the player.
+  int8_t m_nHealth = 0; ///< Health given to the player.
+  uint8_t m_nReserved = 0; ///< Zero.
+}; //StateCard
+
+/// \brief An enemy in a battle state.
+
+struct StateEnemy{
+  int16_t m_nHealth = 0; ///< Health.
+  uint8_t m_nAttack = 0; ///< Enemy kind, an `EnemyAttack`.
+  uint8_t m_nReserved = 0; ///< Zero.
+}; //StateEnemy
+
+/// \brief A move in a battle.
+///
+/// Either play the card in a hand slot, at an enemy if it deals damage, or
+/// end the turn without playing any more cards.
+
+struct BattleAction{
+  static const uint8_t EndTurn = 0xFF; ///< Slot value for ending the turn.
+
+  uint8_t m_nSlot = EndTurn; ///< Hand slot of the card to play, or `EndTurn`.
+  uint8_t m_nTarget = 0; ///< Enemy to attack.
+}; //BattleAction
+
+/// \brief The whole state of a battle in one small block of memory.
+///
+/// Everything the rules need to know about a battle: the player's health and
+/// shield, the deck and which pile each card is in, the enemies and both
+/// random number generators. There are no pointers, so a copy is a plain
+/// `memcpy` of under 256 bytes and can be made millions of times a second
+/// for searches, hints and undo. `Step()` applies the rules to it.
+///
+/// `CGame` fights its battles on one, playing each card and each enemy card
+/// through it as the animations get to them, and its player and enemies only
+/// show what the battle state holds. `Step()` and `EnemyTurn()` are made of
+/// the same parts, `Play()`, `PlanEnemyTurn()`, `PlayEnemyCard()` and
+/// `EndEnemyTurn()`, so that the game and the simulator play by one set of
+/// rules.
+///
+/// The piles are kept in `m_pOrder` one after another, the draw pile first,
+/// then the hand, the discard pile and the exhaust pile, each front first,
+/// and cards are moved between them exactly as `CDeck` moves them, so that
+/// the same seed deals the same hands.
+
+struct BattleState{
+  static const size_t MaxCards = 16; ///< Largest deck.
+  static const size_t MaxEnemies = 16; ///< Most enemies.
+  static const int HandSize = 5; ///< Cards dealt per hand.
+  static const int CardsPerTurn = 3; ///< Cards played per turn.
+
+  uint64_t m_nEnemyRng = 1; ///< Enemy decision random number generator state.
+  uint64_t m_nDrawRng = 1; ///< Card draw random number generator state.
+  int16_t m_nHealth = 15; ///< Player health.
+  int16_t m_nShield = 0; ///< Player shield.
+  uint16_t m_nTurns = 0; ///< Hands dealt so far.
+  uint16_t m_nPlayedMask = 0; ///< Cards played from this hand, one bit per card.
+  uint16_t m_nExhaustMask = 0; ///< Cards that exhaust, one bit per card.
+  uint8_t m_nCards = 0; ///< Number of cards.
+  uint8_t m_nEnemies = 0; ///< Number of living enemies.
+  uint8_t m_nPlayed = 0; ///< Cards played this turn.
+  uint8_t m_pCount[4] = {0, 0, 0, 0}; ///< Draw, hand, discard and exhaust pile sizes.
+  uint8_t m_pOrder[MaxCards] = {}; ///< Card indices, pile by pile.
+  StateCard m_pCard[MaxCards]; ///< Cards, by deck index.
+  StateEnemy m_pEnemy[MaxEnemies]; ///< Living enemies, in turn order.
+
+  void Deal(); ///< Discard the hand and deal a new one.
+  bool Step(const BattleAction&); ///< Apply a move.
+  bool Play(const BattleAction&); ///< Play a card, without ending the turn.
+  void EnemyTurn(); ///< Play the enemies' turn.
+  void PlanEnemyTurn(EnemyCard*); ///< Decide every enemy's card.
+  void PlayEnemyCard(size_t, const EnemyCard&); ///< Carry out an enemy's card.
+  void EndEnemyTurn(){ m_nShield = 0; } ///< Wear off the player's shield.
+  void TakeDamage(int); ///< Apply enemy damage to the player.
+
+  bool IsWon() const { return m_nEnemies == 0; } ///< Test for all enemies dead.
+  bool IsLost() const { return m_nHealth <= 0; } ///< Test for player dead.
+  bool IsOver() const { return IsWon() || IsLost(); } ///< Test for end of battle.
+
+  bool IsPlayed(size_t card) const { return (m_nPlayedMask >> card & 1) != 0; } ///< Test for played.
+  size_t GetHandCount() const { return m_pCount[1]; } ///< Get hand size.
+  size_t GetHandCard(size_t slot) const { return m_pOrder[m_pCount[0] + slot]; } ///< Get card in hand slot.
+
+  bool SetPiles(const DeckState&); ///< Restore the piles from a deck.
+  void GetPiles(DeckState&) const; ///< Save the piles for a deck.
+}; //BattleState
+
+#endif //__L4RC_GAME_BATTLESTATE_H__
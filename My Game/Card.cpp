@@ -1,331 +1,145 @@
 #include "Card.h"
-#include "Enemy.h"
-#include "Player.h"
+#include "Balance.h"
+#include "ObjectManager.h"
 
-Card::Card(const Vector2& p) : CObject(eSprite::Card, p)
+template<class t> t& Card::Get() const
 {
-	dmgAmount = 0;
-	shieldAmount = 0;
-	healthAmount = 0;
-
-	Unselect();
-	hovered = false;
+	return m_pObjectManager->Get<t>(entity);
 }
 
-void Card::createCard(int dAmount, int sAmount, int hAmount)
+void Card::createCard(int dAmount, int sAmount, int hAmount) const
 {
-	dmgAmount = dAmount;
-	shieldAmount = sAmount;
-	healthAmount = hAmount;
+	CardInfo& card = Get<CardInfo>();
+	card.m_nDamage = dAmount;
+	card.m_nShield = sAmount;
+	card.m_nHealth = hAmount;
 
-	if (dmgAmount > 0)
+	if (card.m_nDamage > 0)
 	{
-		m_nSpriteIndex = (UINT)eSprite::CardDamage;
+		Get<Sprite>().m_nIndex = (UINT)eSprite::CardDamage;
 	}
-	else if (shieldAmount > 0)
+	else if (card.m_nShield > 0)
 	{
-		m_nSpriteIndex = (UINT)eSprite::CardShield;
+		Get<Sprite>().m_nIndex = (UINT)eSprite::CardShield;
 	}
-	else if (healthAmount > 0)
+	else if (card.m_nHealth > 0)
 	{
-		m_nSpriteIndex = (UINT)eSprite::CardHealth;
+		Get<Sprite>().m_nIndex = (UINT)eSprite::CardHealth;
 	}
 }
 
-int Card::dealDamage()
+int Card::dealDamage() const
 {
-	return dmgAmount;
+	return Get<CardInfo>().m_nDamage;
 }
 
-int Card::giveShield()
+int Card::giveShield() const
 {
-	return shieldAmount;
+	return Get<CardInfo>().m_nShield;
 }
 
-int Card::giveHealth()
+int Card::giveHealth() const
 {
-	return healthAmount;
+	return Get<CardInfo>().m_nHealth;
 }
 
-void Card::draw()
+//Place the card at a slot computed by the hand layout and make it visible
+void Card::Show(const Vector2& pos) const
 {
-	if (state == GameState::Battle || state == GameState::NewCard)
-	{
-		CObject::draw();
-		std::string s;
-
-		if (this->dmgAmount != 0) {
-			s = std::to_string(this->dmgAmount);
-		}
-		else if (this->shieldAmount != 0) {
-			s = std::to_string(this->shieldAmount);
-		}
-		else if (this->healthAmount != 0) {
-			s = std::to_string(this->healthAmount);
-		}
-		
-		m_pRenderer->DrawScreenText(s.c_str(), Vector2(m_vPos.x - 13, LSettings::m_nWinHeight - m_vPos.y - 30), Colors::Black); //draw to screen
-	}
+	Get<Transform>().m_vPos = pos;
+	Get<CardInfo>().m_bHovered = false;
+	Get<Sprite>().m_bHidden = false;
 }
 
-void Card::RemoveCard(int pos)
+//Take the card out of play; hidden cards are skipped when drawing
+void Card::Hide() const
 {
-	switch (pos) {
-	case 0:
-		m_vPos.y -= 515;
-		break;
-	case 1:
-		m_vPos.x -= 80;
-		m_vPos.y -= 515;
-		break;
-	case 2:
-		m_vPos.x -= 160;
-		m_vPos.y -= 515;
-		break;
-	case 3:
-		m_vPos.x -= 240;
-		m_vPos.y -= 515;
-		break;
-	case 4:
-		m_vPos.x -= 320;
-		m_vPos.y -= 515;
-		break;
-	case 5:
-		m_vPos.y -= 515;
-		break;
-	case 6:
-		m_vPos.x -= 80;
-		m_vPos.y -= 515;
-		break;
-	case 7:
-		m_vPos.x -= 160;
-		m_vPos.y -= 515;
-		break;
-	case 8:
-		m_vPos.x -= 240;
-		m_vPos.y -= 515;
-		break;
-	case 9:
-		m_vPos.x -= 320;
-		m_vPos.y -= 515;
-		break;
-	default:
-		break;
-	}
+	Get<Sprite>().m_bHidden = true;
 }
 
-void Card::ReplaceCard()
+bool Card::IsHidden() const
 {
-	m_vPos.y += 515;
-}
-
-void Card::RepositionCard(int pos) {
-	switch (pos) {
-	case 1:
-		m_vPos.x += 80;
-		break;
-	case 2:
-		m_vPos.x += 160;
-		break;
-	case 3:
-		m_vPos.x += 240;
-		break;
-	case 4:
-		m_vPos.x += 320;
-		break;
-	case 6:
-		m_vPos.x += 80;
-		break;
-	case 7:
-		m_vPos.x += 160;
-		break;
-	case 8:
-		m_vPos.x += 240;
-		break;
-	case 9:
-		m_vPos.x += 320;
-		break;
-	default:
-		break;
-	}
-}
-
-void Card::AddCardMove(int pos) {
-	switch (pos) {
-	case 0:
-		m_vPos.x -= 200;
-		m_vPos.y += 725;
-		break;
-	case 1:
-		m_vPos.x -= 120;
-		m_vPos.y += 725;
-		break;
-	case 2:
-		m_vPos.x -= 40;
-		m_vPos.y += 725;
-		break;
-	case 3:
-		m_vPos.x += 40;
-		m_vPos.y += 725;
-		break;
-	case 4:
-		m_vPos.x += 120;
-		m_vPos.y += 725;
-		break;
-	case 5:
-		m_vPos.x += 200;
-		m_vPos.y += 725;
-		break;
-	case 6:
-		m_vPos.x += 280;
-		m_vPos.y += 725;
-		break;
-	case 7:
-		m_vPos.x += 360;
-		m_vPos.y += 725;
-		break;
-	case 8:
-		m_vPos.x += 440;
-		m_vPos.y += 725;
-		break;
-	case 9:
-		m_vPos.x += 520;
-		m_vPos.y += 725;
-		break;
-	default:
-		break;
-	}
+	return Get<Sprite>().m_bHidden;
 }
 
-void Card::AddCardRemove(int pos) {
-	switch (pos) {
-	case 0:
-		m_vPos.x += 200;
-		m_vPos.y -= 725;
-		break;
-	case 1:
-		m_vPos.x += 120;
-		m_vPos.y -= 725;
-		break;
-	case 2:
-		m_vPos.x += 40;
-		m_vPos.y -= 725;
-		break;
-	case 3:
-		m_vPos.x -= 40;
-		m_vPos.y -= 725;
-		break;
-	case 4:
-		m_vPos.x -= 120;
-		m_vPos.y -= 725;
-		break;
-	case 5:
-		m_vPos.x -= 200;
-		m_vPos.y -= 725;
-		break;
-	case 6:
-		m_vPos.x -= 280;
-		m_vPos.y -= 725;
-		break;
-	case 7:
-		m_vPos.x -= 360;
-		m_vPos.y -= 725;
-		break;
-	case 8:
-		m_vPos.x -= 440;
-		m_vPos.y -= 725;
-		break;
-	case 9:
-		m_vPos.x -= 520;
-		m_vPos.y -= 725;
-		break;
-	default:
-		break;
-	}
-}
-
-void Card::ReplaceAllCards() {
-	if (m_vPos.y < 0)
-		m_vPos.y += 515;
-}
-
-void Card::RemoveAllCards() {
-	if (m_vPos.y > 0)
-		m_vPos.y -= 515;
-}
-
-void Card::Select()
+void Card::Select() const
 {
-	m_f4Tint = Vector4(0.05, 0.05, 0.7, 1.0); 
-	//m_vPos.y += 15;
+	Get<Sprite>().m_f4Tint = Vector4(0.05, 0.05, 0.7, 1.0); 
 }
 
-void Card::Unselect()
+void Card::Unselect() const
 {
-	m_f4Tint = Vector4(0.05, 0.7, 0.05, 1.0); 
-	hovered = true;
+	Get<Sprite>().m_f4Tint = Vector4(0.05, 0.7, 0.05, 1.0); 
+	Get<CardInfo>().m_bHovered = true;
 }
 
-void Card::SetUsed()
+void Card::SetUsed() const
 {
-	m_f4Tint = Vector4(0.05, 0.7, 0.05, 1.0);
-	m_vPos.y -= 15;
-	hovered = false;
+	Get<Sprite>().m_f4Tint = Vector4(0.05, 0.7, 0.05, 1.0);
+	Get<Transform>().m_vPos.y -= 15;
+	Get<CardInfo>().m_bHovered = false;
 }
 
-void Card::Hover()
+void Card::Hover() const
 {
-	if (!hovered)
+	CardInfo& card = Get<CardInfo>();
+
+	if (!card.m_bHovered)
 	{
-		m_vPos.y += 15;
-		hovered = true;
+		Get<Transform>().m_vPos.y += 15;
+		card.m_bHovered = true;
 	}
 }
 
-void Card::Unhover()
+void Card::Unhover() const
 {
-	if (hovered)
+	CardInfo& card = Get<CardInfo>();
+
+	if (card.m_bHovered)
 	{
-		m_vPos.y -= 15;
-		hovered = false;
+		Get<Transform>().m_vPos.y -= 15;
+		card.m_bHovered = false;
 	}
 }
 
-void Card::UpgradeAllCards()
+void Card::UpgradeAllCards() const
 {
-	if (dmgAmount > 0)
+	CardInfo& card = Get<CardInfo>();
+
+	if (card.m_nDamage > 0)
 	{
-		dmgAmount += 2;
+		card.m_nDamage += GetBalance().m_nUpgradeAll;
 	}
-	else if (healthAmount > 0)
+	else if (card.m_nHealth > 0)
 	{
-		healthAmount += 2;
+		card.m_nHealth += GetBalance().m_nUpgradeAll;
 	}
-	else if (shieldAmount > 0)
+	else if (card.m_nShield > 0)
 	{
-		shieldAmount += 2;
+		card.m_nShield += GetBalance().m_nUpgradeAll;
 	}
 }
 
-void Card::UpgradeCard()
+void Card::UpgradeCard() const
 {
-	if (dmgAmount > 0)
+	CardInfo& card = Get<CardInfo>();
+
+	if (card.m_nDamage > 0)
 	{
-		dmgAmount += 1;
+		card.m_nDamage += GetBalance().m_nUpgrade;
 	}
-	else if (healthAmount > 0)
+	else if (card.m_nHealth > 0)
 	{
-		healthAmount += 1;
+		card.m_nHealth += GetBalance().m_nUpgrade;
 	}
-	else if (shieldAmount > 0)
+	else if (card.m_nShield > 0)
 	{
-		shieldAmount += 1;
+		card.m_nShield += GetBalance().m_nUpgrade;
 	}
 }
 
-void Card::Reset()
+void Card::Reset() const
 {
-	//Unselect();
 	Unhover();
-	m_f4Tint = Vector4(0.05, 0.7, 0.05, 1.0);
+	Get<Sprite>().m_f4Tint = Vector4(0.05, 0.7, 0.05, 1.0);
 }
@@ -1,40 +1,41 @@
 #pragma once
 
-#include "Object.h"
+#include "GameDefines.h"
+#include "Common.h"
+#include "Ecs.h"
 
-class Card : public CObject, LSettings
+//A card is an entity with a transform, a sprite and card info. This is a
+//handle to it, so it is cheap to copy. Its data lives in the object
+//manager's component arrays, so changing the card does not change the handle
+class Card : CCommon
 {
 private:
-	int dmgAmount;
-	int shieldAmount;
-	int healthAmount;
+	Entity entity;
 
-	bool hovered;
+	template<class t> t& Get() const;
 
 public:
-	Card(const Vector2& p);
-	void createCard(int, int, int);
+	Card() {}
+	explicit Card(Entity e) : entity(e) {}
+	Entity GetEntity() const { return entity; }
 
-	int dealDamage();
-	int giveShield();
-	int giveHealth();
+	void createCard(int, int, int) const;
 
-	void Select();
-	void Unselect();
+	int dealDamage() const;
+	int giveShield() const;
+	int giveHealth() const;
+
+	void Select() const;
+	void Unselect() const;
 	
-	void draw();
-	void RemoveCard(int pos);
-	void RemoveAllCards();
-	void ReplaceCard();
-	void RepositionCard(int pos);
-	void ReplaceAllCards();
-	void AddCardMove(int);
-	void AddCardRemove(int);
-
-	void Hover();
-	void Unhover();
-	void SetUsed();
-	void UpgradeAllCards();
-	void UpgradeCard();
-	void Reset();
+	void Show(const Vector2& pos) const;
+	void Hide() const;
+	bool IsHidden() const;
+
+	void Hover() const;
+	void Unhover() const;
+	void SetUsed() const;
+	void UpgradeAllCards() const;
+	void UpgradeCard() const;
+	void Reset() const;
 };
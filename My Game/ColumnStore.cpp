@@ -0,0 +1,684 @@
+/// \file ColumnStore.cpp
+/// \brief Code for the column store CColumnStore and its writer
+/// CColumnWriter.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <thread>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+#endif
+
+#include "ColumnStore.h"
+
+static_assert(sizeof(ColumnStoreHeader) == 32, "column store header layout");
+static_assert(sizeof(ColumnName) == 24, "column name layout");
+static_assert(sizeof(ColumnChunk) == 24, "column chunk layout");
+
+const size_t CColumnStore::GroupRows; ///< Definition, since `std::min()` takes it by reference.
+
+/// Round up to a multiple of 128, the number of values in a packed block.
+/// \param n Number of values.
+/// \return n rounded up.
+
+static inline size_t RoundUp128(size_t n){
+  return (n + 127) & ~(size_t)127;
+} //RoundUp128
+
+/// Get the size of a chunk of packed values, in whole blocks of 128.
+/// \param n Number of values.
+/// \param bits Bits per value.
+/// \return Size in bytes.
+
+size_t GetPackedBytes(size_t n, int bits){
+  return RoundUp128(n)/128*16*bits;
+} //GetPackedBytes
+
+/// Pack values as a chunk, see `ColumnChunk`. The last block is padded with
+/// the base value.
+/// \param in Values.
+/// \param n Number of values.
+/// \param base Smallest value.
+/// \param bits Bits per value, enough for the largest value less the base.
+/// \param out [out] Packed values, `GetPackedBytes(n, bits)` bytes.
+
+void PackValues(const int32_t* in, size_t n, int32_t base, int bits, uint32_t* out){
+  for(size_t b=0; b<RoundUp128(n); b+=128){
+    for(size_t lane=0; lane<4; lane++){
+      uint32_t* o = out + lane;
+      uint32_t word = 0;
+      int shift = 0;
+
+      for(size_t k=0; k<32; k++){
+        const size_t i = b + 4*k + lane;
+        const uint32_t x = i < n? (uint32_t)in[i] - (uint32_t)base: 0;
+
+        word |= x << shift;
+        shift += bits;
+
+        if(shift >= 32){ //word full, start the next with what spilled over
+          *o = word;
+          o += 4;
+          shift -= 32;
+          word = shift > 0? x >> (bits - shift): 0;
+        } //if
+      } //for
+    } //for
+
+    out += 4*bits;
+  } //for
+} //PackValues
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+/// Unpack a block of 128 values, four at a time, one from each lane. The
+/// number of bits is a template parameter so that the loop is unrolled
+/// with every shift known.
+/// \tparam bits Bits per value.
+/// \param in Packed block.
+/// \param base Smallest value.
+/// \param out [out] 128 values.
+
+template<int bits> static void UnpackBlock(const uint32_t* in, int32_t b, int32_t* out){
+  const __m128i base = _mm_set1_epi32(b);
+
+  if(bits == 0){
+    for(int k=0; k<32; k++)
+      _mm_storeu_si128((__m128i*)(out + 4*k), base);
+
+    return;
+  } //if
+
+  const __m128i mask = _mm_set1_epi32(bits == 32? -1: (int)((1u << (bits & 31)) - 1));
+  __m128i w = _mm_loadu_si128((const __m128i*)in);
+  int shift = 0;
+
+  for(int k=0; k<32; k++){
+    __m128i v = _mm_srli_epi32(w, shift);
+    shift += bits;
+
+    if(shift >= 32 && k < 31){ //on to the next word, taking the bits that spilled into it
+      shift -= 32;
+      in += 4;
+      w = _mm_loadu_si128((const __m128i*)in);
+
+      if(shift > 0)
+        v = _mm_or_si128(v, _mm_slli_epi32(w, bits - shift));
+    } //if
+
+    _mm_storeu_si128((__m128i*)(out + 4*k), _mm_add_epi32(_mm_and_si128(v, mask), base));
+  } //for
+} //UnpackBlock
+
+typedef void (*UnpackFn)(const uint32_t*, int32_t, int32_t*); ///< Block unpacker.
+
+/// Make the table of block unpackers, one for each number of bits.
+/// \return Table.
+
+template<size_t... i> static constexpr std::array<UnpackFn, sizeof...(i)> MakeUnpackers(std::index_sequence<i...>){
+  return {{&UnpackBlock<(int)i>...}};
+} //MakeUnpackers
+
+static const std::array<UnpackFn, 33> g_pUnpack = MakeUnpackers(std::make_index_sequence<33>()); ///< Block unpackers.
+
+#endif
+
+/// Unpack a chunk, see `ColumnChunk`.
+/// \param in Packed values.
+/// \param n Number of values.
+/// \param base Smallest value.
+/// \param bits Bits per value.
+/// \param out [out] Values, room for n rounded up to a multiple of 128.
+
+void UnpackValues(const uint32_t* in, size_t n, int32_t base, int bits, int32_t* out){
+#if defined(__SSE2__) || defined(_M_X64)
+  const UnpackFn f = g_pUnpack[bits];
+
+  for(size_t i=0; i<RoundUp128(n); i+=128){
+    f(in, base, out + i);
+    in += 4*bits;
+  } //for
+#else
+  const uint32_t mask = bits == 32? ~0u: (1u << bits) - 1;
+
+  for(size_t i=0; i<RoundUp128(n); i+=128){
+    for(size_t lane=0; lane<4; lane++){
+      const uint32_t* p = in + lane;
+      int shift = 0;
+
+      for(size_t k=0; k<32; k++){
+        uint32_t v = bits? *p >> shift: 0;
+        shift += bits;
+
+        if(shift >= 32 && k < 31){
+          shift -= 32;
+          p += 4;
+          if(shift > 0)v |= *p << (bits - shift);
+        } //if
+
+        out[i + 4*k + lane] = (int32_t)((v & mask) + (uint32_t)base);
+      } //for
+    } //for
+
+    in += 4*bits;
+  } //for
+#endif
+} //UnpackValues
+
+/// Tell whether a filter passes every row of a chunk, none of them, or some,
+/// from its smallest and largest values alone.
+/// \param f Filter.
+/// \param lo Smallest value.
+/// \param hi Largest value.
+/// \return 1 if every row passes, 0 if none do, -1 if some may.
+
+static int ZoneTest(const ColumnFilter& f, int32_t lo, int32_t hi){
+  const int32_t x = f.m_nValue;
+
+  switch(f.m_eCompare){
+    case eCompare::Equal: return x < lo || x > hi? 0: lo == hi? 1: -1;
+    case eCompare::NotEqual: return x < lo || x > hi? 1: lo == hi? 0: -1;
+    case eCompare::Less: return hi < x? 1: lo >= x? 0: -1;
+    case eCompare::LessEqual: return hi <= x? 1: lo > x? 0: -1;
+    case eCompare::Greater: return lo > x? 1: hi <= x? 0: -1;
+    case eCompare::GreaterEqual: return lo >= x? 1: hi < x? 0: -1;
+  } //switch
+
+  return -1;
+} //ZoneTest
+
+/// Clear the selection bytes of the rows that fail a filter.
+/// \param v Values.
+/// \param n Number of rows, a multiple of 16.
+/// \param f Filter.
+/// \param sel [in, out] Selection, 0xFF for a row that passes so far and 0
+///   for one that does not.
+
+static void FilterRows(const int32_t* v, size_t n, const ColumnFilter& f, uint8_t* sel){
+  const eCompare op = f.m_eCompare;
+  const int32_t x = f.m_nValue;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i c = _mm_set1_epi32(x);
+  const bool invert = op == eCompare::NotEqual || op == eCompare::LessEqual || op == eCompare::GreaterEqual;
+
+  for(size_t i=0; i<n; i+=16){
+    __m128i m[4];
+
+    for(size_t j=0; j<4; j++){
+      const __m128i a = _mm_loadu_si128((const __m128i*)(v + i + 4*j));
+
+      switch(op){ //the same every time round, so well predicted
+        case eCompare::Equal: case eCompare::NotEqual: m[j] = _mm_cmpeq_epi32(a, c); break;
+        case eCompare::Less: case eCompare::GreaterEqual: m[j] = _mm_cmplt_epi32(a, c); break;
+        default: m[j] = _mm_cmpgt_epi32(a, c); break;
+      } //switch
+    } //for
+
+    const __m128i bytes = _mm_packs_epi16(_mm_packs_epi32(m[0], m[1]), _mm_packs_epi32(m[2], m[3]));
+    const __m128i s = _mm_loadu_si128((const __m128i*)(sel + i));
+    _mm_storeu_si128((__m128i*)(sel + i), invert? _mm_andnot_si128(bytes, s): _mm_and_si128(bytes, s));
+  } //for
+#else
+  for(size_t i=0; i<n; i++){
+    bool pass = false;
+
+    switch(op){
+      case eCompare::Equal: pass = v[i] == x; break;
+      case eCompare::NotEqual: pass = v[i] != x; break;
+      case eCompare::Less: pass = v[i] < x; break;
+      case eCompare::LessEqual: pass = v[i] <= x; break;
+      case eCompare::Greater: pass = v[i] > x; break;
+      case eCompare::GreaterEqual: pass = v[i] >= x; break;
+    } //switch
+
+    if(!pass)sel[i] = 0;
+  } //for
+#endif
+} //FilterRows
+
+/// Count the rows selected.
+/// \param sel Selection.
+/// \param n Number of rows, a multiple of 16.
+/// \return Number of rows selected.
+
+static uint64_t CountRows(const uint8_t* sel, size_t n){
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i one = _mm_set1_epi8(1);
+  __m128i acc = _mm_setzero_si128();
+
+  for(size_t i=0; i<n; i+=16){
+    const __m128i s = _mm_and_si128(_mm_loadu_si128((const __m128i*)(sel + i)), one);
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(s, _mm_setzero_si128()));
+  } //for
+
+  return (uint64_t)_mm_cvtsi128_si64(acc) + (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc));
+#else
+  uint64_t count = 0;
+
+  for(size_t i=0; i<n; i++)
+    count += sel[i] & 1;
+
+  return count;
+#endif
+} //CountRows
+
+/// Add up the values of the rows selected.
+/// \param v Values.
+/// \param sel Selection.
+/// \param n Number of rows, a multiple of 16.
+/// \return Sum.
+
+static int64_t SumRows(const int32_t* v, const uint8_t* sel, size_t n){
+#if defined(__SSE2__) || defined(_M_X64)
+  __m128i acc = _mm_setzero_si128();
+
+  for(size_t i=0; i<n; i+=16){
+    const __m128i s = _mm_loadu_si128((const __m128i*)(sel + i));
+    const __m128i lo = _mm_unpacklo_epi8(s, s), hi = _mm_unpackhi_epi8(s, s);
+    const __m128i m[4] = {
+      _mm_unpacklo_epi16(lo, lo), _mm_unpackhi_epi16(lo, lo),
+      _mm_unpacklo_epi16(hi, hi), _mm_unpackhi_epi16(hi, hi)
+    }; //m
+
+    for(size_t j=0; j<4; j++){ //widen to 64 bits so that the sum cannot overflow
+      const __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i*)(v + i + 4*j)), m[j]);
+      const __m128i sign = _mm_srai_epi32(a, 31);
+      acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(a, sign));
+      acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(a, sign));
+    } //for
+  } //for
+
+  return _mm_cvtsi128_si64(acc) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc));
+#else
+  int64_t sum = 0;
+
+  for(size_t i=0; i<n; i++)
+    sum += sel[i]? v[i]: 0;
+
+  return sum;
+#endif
+} //SumRows
+
+/// Map a column store file and check it: the header, the directory and
+/// that every chunk lies within the file.
+/// \param path File name.
+/// \return true if the column store was opened.
+
+bool CColumnStore::Open(const char* path){
+  m_sHeader = ColumnStoreHeader();
+  m_pName = nullptr;
+  m_pChunk = nullptr;
+
+  if(!m_cFile.Open(path) || m_cFile.GetSize() < sizeof(ColumnStoreHeader))
+    return false;
+
+  ColumnStoreHeader h;
+  memcpy(&h, m_cFile.GetData(), sizeof(h));
+
+  const uint64_t size = m_cFile.GetSize();
+  const uint64_t chunks = (uint64_t)h.m_nGroups*h.m_nColumns;
+  const uint64_t names = sizeof(ColumnStoreHeader) + (uint64_t)h.m_nColumns*sizeof(ColumnName);
+
+  bool valid = h.m_nMagic == Magic && h.m_nVersion == Version &&
+    h.m_nHeaderSize == sizeof(ColumnStoreHeader) &&
+    h.m_nGroups == (h.m_nRows + GroupRows - 1)/GroupRows &&
+    h.m_nDirectory % 8 == 0 && h.m_nDirectory >= names &&
+    h.m_nDirectory <= size && (size - h.m_nDirectory)/sizeof(ColumnChunk) == chunks &&
+    (size - h.m_nDirectory)%sizeof(ColumnChunk) == 0;
+
+  const ColumnChunk* chunk = valid? (const ColumnChunk*)(m_cFile.GetData() + h.m_nDirectory): nullptr;
+
+  for(uint64_t i=0; i<chunks && valid; i++){
+    const ColumnChunk& c = chunk[i];
+    const size_t rows = (size_t)std::min<uint64_t>(GroupRows, h.m_nRows - i/h.m_nColumns*GroupRows);
+
+    valid = c.m_nBits <= 32 && c.m_nOffset%16 == 0 && c.m_nOffset >= names &&
+      c.m_nOffset + GetPackedBytes(rows, c.m_nBits) <= h.m_nDirectory;
+  } //for
+
+  if(!valid){
+    m_cFile.Close();
+    return false;
+  } //if
+
+  m_sHeader = h;
+  m_pName = (const ColumnName*)(m_cFile.GetData() + sizeof(ColumnStoreHeader));
+  m_pChunk = chunk;
+  return true;
+} //Open
+
+/// Get the number of rows in a row group. Every group is full but the last.
+/// \param g Row group.
+/// \return Number of rows.
+
+size_t CColumnStore::GetGroupRows(size_t g) const{
+  return (size_t)std::min<uint64_t>(GroupRows, GetRows() - g*GroupRows);
+} //GetGroupRows
+
+/// Get a column name.
+/// \param c Column.
+/// \return Name.
+
+std::string CColumnStore::GetName(size_t c) const{
+  return std::string(m_pName[c].m_pName, strnlen(m_pName[c].m_pName, ColumnName::NameSize));
+} //GetName
+
+/// Find a column by name.
+/// \param name Name.
+/// \return Column, or -1 if there is none by that name.
+
+int CColumnStore::Find(const char* name) const{
+  for(size_t c=0; c<GetColumns(); c++)
+    if(GetName(c) == name)
+      return (int)c;
+
+  return -1;
+} //Find
+
+/// Get the smallest and largest values of a column, from the zone maps.
+/// \param c Column.
+/// \param lo [out] Smallest value, 0 if there are no rows.
+/// \param hi [out] Largest value, 0 if there are no rows.
+
+void CColumnStore::GetRange(size_t c, int32_t& lo, int32_t& hi) const{
+  lo = hi = 0;
+
+  for(size_t g=0; g<GetGroups(); g++){
+    const ColumnChunk& k = GetChunk(g, c);
+    lo = g == 0? k.m_nMin: std::min(lo, k.m_nMin);
+    hi = g == 0? k.m_nMax: std::max(hi, k.m_nMax);
+  } //for
+} //GetRange
+
+/// Unpack a chunk.
+/// \param g Row group.
+/// \param c Column.
+/// \param out [out] Values, room for `GroupRows`. Past the rows in the
+///   group, up to the next multiple of 128, they are the smallest value.
+
+void CColumnStore::Decode(size_t g, size_t c, int32_t* out) const{
+  const ColumnChunk& k = GetChunk(g, c);
+  UnpackValues((const uint32_t*)(m_cFile.GetData() + k.m_nOffset), GetGroupRows(g),
+    k.m_nMin, k.m_nBits, out);
+} //Decode
+
+/// Run a query over the row groups given to one thread, adding to that
+/// thread's counts and sums. A chunk is unpacked at most once per row group
+/// however many times the query uses its column.
+/// \param q Query.
+/// \param first Smallest value of the group by column.
+/// \param keys Number of group keys.
+/// \param thread This thread.
+/// \param threads Number of threads, each of which takes every this many
+///   row groups.
+/// \param count [in, out] Rows by group key.
+/// \param sum [in, out] Sums by column, then group key.
+
+void CColumnStore::RunGroups(const ColumnQuery& q, int32_t first, size_t keys,
+  size_t thread, size_t threads, std::vector<uint64_t>& count, std::vector<int64_t>& sum) const
+{
+  std::vector<std::vector<int32_t>> buffer(GetColumns());
+  std::vector<size_t> decoded(GetColumns(), SIZE_MAX); //row group each buffer holds
+  std::vector<uint8_t> sel(GroupRows);
+  std::vector<const int32_t*> v(q.m_vSums.size());
+
+  auto column = [&](size_t g, size_t c){ //unpack a chunk, unless it already is
+    if(decoded[c] != g){
+      buffer[c].resize(GroupRows);
+      Decode(g, c, buffer[c].data());
+      decoded[c] = g;
+    } //if
+
+    return (const int32_t*)buffer[c].data();
+  }; //column
+
+  for(size_t g=thread; g<GetGroups(); g+=threads){
+    const size_t rows = GetGroupRows(g);
+    const size_t n = RoundUp128(rows);
+    int pass = 1;
+
+    for(const ColumnFilter& f: q.m_vFilters){ //the zone maps first, which cost nothing
+      const ColumnChunk& k = GetChunk(g, f.m_nColumn);
+      const int t = ZoneTest(f, k.m_nMin, k.m_nMax);
+      if(t == 0){pass = 0; break;}
+      if(t < 0)pass = -1;
+    } //for
+
+    if(pass == 0)continue;
+
+    memset(sel.data(), 0xFF, rows);
+    memset(sel.data() + rows, 0, n - rows);
+
+    if(pass < 0)
+      for(const ColumnFilter& f: q.m_vFilters){
+        const ColumnChunk& k = GetChunk(g, f.m_nColumn);
+
+        if(ZoneTest(f, k.m_nMin, k.m_nMax) < 0)
+          FilterRows(column(g, f.m_nColumn), n, f, sel.data());
+      } //for
+
+    for(size_t j=0; j<q.m_vSums.size(); j++)
+      v[j] = column(g, q.m_vSums[j]);
+
+    const ColumnChunk* key = q.m_nGroupBy >= 0? &GetChunk(g, q.m_nGroupBy): nullptr;
+
+    if(key == nullptr || key->m_nMin == key->m_nMax){ //one key in the whole row group
+      const size_t k = key? (size_t)((int64_t)key->m_nMin - first): 0;
+      count[k] += pass > 0? rows: CountRows(sel.data(), n);
+
+      for(size_t j=0; j<v.size(); j++)
+        sum[j*keys + k] += SumRows(v[j], sel.data(), n);
+    } //if
+
+    else{ //scatter into the groups without branching on the selection
+      const int32_t* kv = column(g, q.m_nGroupBy);
+
+      for(size_t i=0; i<rows; i++){
+        const size_t k = (size_t)((int64_t)kv[i] - first);
+        const uint64_t s = sel[i] & 1;
+        count[k] += s;
+
+        for(size_t j=0; j<v.size(); j++)
+          sum[j*keys + k] += v[j][i] & -(int64_t)s;
+      } //for
+    } //else
+  } //for
+} //RunGroups
+
+/// Run a query. The row groups are shared out between threads, each with
+/// counts and sums of its own, which are added up at the end.
+/// \param q Query.
+/// \param out [out] One result per group key with rows, in key order, or
+///   exactly one result if the query has no group by column.
+/// \param threads Number of threads.
+/// \return false if the query names a column that does not exist, or its
+///   group by column has more than `MaxGroupKeys` values.
+
+bool CColumnStore::Run(const ColumnQuery& q, std::vector<QueryGroup>& out, size_t threads) const{
+  out.clear();
+
+  for(const ColumnFilter& f: q.m_vFilters)
+    if(f.m_nColumn >= GetColumns())return false;
+
+  for(size_t c: q.m_vSums)
+    if(c >= GetColumns())return false;
+
+  int32_t first = 0, last = 0;
+
+  if(q.m_nGroupBy >= 0){
+    if((size_t)q.m_nGroupBy >= GetColumns())return false;
+    GetRange(q.m_nGroupBy, first, last);
+  } //if
+
+  const size_t keys = (size_t)((int64_t)last - first + 1);
+  if(keys > MaxGroupKeys)return false;
+
+  threads = std::max<size_t>(1, std::min(threads, GetGroups()));
+
+  std::vector<std::vector<uint64_t>> count(threads, std::vector<uint64_t>(keys));
+  std::vector<std::vector<int64_t>> sum(threads, std::vector<int64_t>(keys*q.m_vSums.size()));
+  std::vector<std::thread> pool;
+
+  for(size_t t=1; t<threads; t++)
+    pool.emplace_back(&CColumnStore::RunGroups, this, std::cref(q), first, keys, t, threads,
+      std::ref(count[t]), std::ref(sum[t]));
+
+  RunGroups(q, first, keys, 0, threads, count[0], sum[0]);
+
+  for(std::thread& t: pool)
+    t.join();
+
+  for(size_t k=0; k<keys; k++){
+    QueryGroup r;
+    r.m_nKey = q.m_nGroupBy >= 0? (int32_t)(first + (int64_t)k): 0;
+    r.m_vSum.assign(q.m_vSums.size(), 0);
+
+    for(size_t t=0; t<threads; t++){
+      r.m_nCount += count[t][k];
+
+      for(size_t j=0; j<q.m_vSums.size(); j++)
+        r.m_vSum[j] += sum[t][j*keys + k];
+    } //for
+
+    if(r.m_nCount > 0 || q.m_nGroupBy < 0)
+      out.push_back(std::move(r));
+  } //for
+
+  return true;
+} //Run
+
+/// Close the file if it is still open, finishing it.
+
+CColumnWriter::~CColumnWriter(){
+  Close();
+} //destructor
+
+/// Start writing a column store, replacing any file of that name. Space is
+/// left for the header, which is written last.
+/// \param path File name.
+/// \param columns Column names, shorter than `ColumnName::NameSize`.
+/// \return true if the file was opened and every name fits.
+
+bool CColumnWriter::Open(const char* path, const std::vector<std::string>& columns){
+  Close();
+
+  for(const std::string& s: columns)
+    if(s.empty() || s.size() >= ColumnName::NameSize)
+      return false;
+
+  m_pFile = fopen(path, "wb");
+  if(m_pFile == nullptr)return false;
+
+  m_nColumns = columns.size();
+  m_vBuffer.assign(m_nColumns*CColumnStore::GroupRows, 0);
+  m_nBuffered = 0;
+  m_nRows = 0;
+  m_nOffset = 0;
+  m_vDirectory.clear();
+
+  const ColumnStoreHeader h;
+  Write(&h, sizeof(h));
+
+  for(const std::string& s: columns){
+    ColumnName name;
+    memcpy(name.m_pName, s.data(), s.size());
+    Write(&name, sizeof(name));
+  } //for
+
+  return true;
+} //Open
+
+/// Write to the end of the file.
+/// \param data Data.
+/// \param size Size in bytes.
+
+void CColumnWriter::Write(const void* data, size_t size){
+  fwrite(data, 1, size, m_pFile);
+  m_nOffset += size;
+} //Write
+
+/// Pad the file with zeros to a multiple of n bytes.
+/// \param n Alignment, at most 16.
+
+void CColumnWriter::Align(size_t n){
+  static const uint8_t zero[16] = {};
+  Write(zero, (size_t)((n - m_nOffset%n)%n));
+} //Align
+
+/// Add a row.
+/// \param row One value per column.
+
+void CColumnWriter::Append(const int32_t* row){
+  if(m_pFile == nullptr)return;
+
+  for(size_t c=0; c<m_nColumns; c++)
+    m_vBuffer[c*CColumnStore::GroupRows + m_nBuffered] = row[c];
+
+  m_nRows++;
+
+  if(++m_nBuffered == CColumnStore::GroupRows)
+    WriteGroup();
+} //Append
+
+/// Compress the rows kept, column by column, and write them as a row group.
+
+void CColumnWriter::WriteGroup(){
+  for(size_t c=0; c<m_nColumns && m_nBuffered>0; c++){
+    const int32_t* v = m_vBuffer.data() + c*CColumnStore::GroupRows;
+    const auto range = std::minmax_element(v, v + m_nBuffered);
+
+    ColumnChunk k;
+    k.m_nMin = *range.first;
+    k.m_nMax = *range.second;
+
+    const uint32_t span = (uint32_t)k.m_nMax - (uint32_t)k.m_nMin;
+    while(k.m_nBits < 32 && (span >> k.m_nBits) != 0)k.m_nBits++;
+
+    Align(16);
+    k.m_nOffset = m_nOffset;
+
+    m_vPacked.resize(GetPackedBytes(m_nBuffered, k.m_nBits)/4);
+    PackValues(v, m_nBuffered, k.m_nMin, k.m_nBits, m_vPacked.data());
+    Write(m_vPacked.data(), 4*m_vPacked.size());
+
+    m_vDirectory.push_back(k);
+  } //for
+
+  m_nBuffered = 0;
+} //WriteGroup
+
+/// Write the last row group, the directory and the header, and close the
+/// file.
+/// \return true if everything was written.
+
+bool CColumnWriter::Close(){
+  if(m_pFile == nullptr)return false;
+
+  WriteGroup();
+  Align(8);
+
+  ColumnStoreHeader h;
+  h.m_nMagic = CColumnStore::Magic;
+  h.m_nVersion = CColumnStore::Version;
+  h.m_nHeaderSize = (uint16_t)sizeof(h);
+  h.m_nColumns = (uint32_t)m_nColumns;
+  h.m_nGroups = (uint32_t)((m_nRows + CColumnStore::GroupRows - 1)/CColumnStore::GroupRows);
+  h.m_nRows = m_nRows;
+  h.m_nDirectory = m_nOffset;
+
+  Write(m_vDirectory.data(), m_vDirectory.size()*sizeof(ColumnChunk));
+
+  bool ok = fseek(m_pFile, 0, SEEK_SET) == 0;
+  ok = ok && fwrite(&h, sizeof(h), 1, m_pFile) == 1;
+  ok = !ferror(m_pFile) && ok;
+  ok = fclose(m_pFile) == 0 && ok;
+
+  m_pFile = nullptr;
+  m_vBuffer.clear();
+  m_vBuffer.shrink_to_fit();
+  return ok;
+} //Close
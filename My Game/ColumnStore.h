@@ -0,0 +1,169 @@
+/// \file ColumnStore.h
+/// \brief Interface for the column store CColumnStore, which holds tables
+/// of integer records compressed by column, and its writer CColumnWriter.
+
+#ifndef __L4RC_GAME_COLUMNSTORE_H__
+#define __L4RC_GAME_COLUMNSTORE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+/// \brief Column store file header.
+///
+/// The file starts with this header, followed by the column names, then the
+/// chunks and last of all the chunk directory. The rows are cut into groups
+/// of `CColumnStore::GroupRows`, and each column of each group is a chunk,
+/// so reading one column only touches that column's chunks. The directory
+/// has an entry for every chunk, group by group, and within a group column
+/// by column. Every field is little-endian and naturally aligned, so the
+/// file can be read in place from a memory mapping.
+
+struct ColumnStoreHeader{
+  uint32_t m_nMagic = 0; ///< Must be `CColumnStore::Magic`.
+  uint16_t m_nVersion = 0; ///< Format version.
+  uint16_t m_nHeaderSize = 0; ///< Size of this header.
+  uint32_t m_nColumns = 0; ///< Number of columns.
+  uint32_t m_nGroups = 0; ///< Number of row groups.
+  uint64_t m_nRows = 0; ///< Number of rows.
+  uint64_t m_nDirectory = 0; ///< Offset of the chunk directory.
+}; //ColumnStoreHeader
+
+/// \brief A column name in a column store file.
+
+struct ColumnName{
+  static const size_t NameSize = 24; ///< Name buffer size, including the terminator.
+
+  char m_pName[NameSize] = {}; ///< Name, zero padded.
+}; //ColumnName
+
+/// \brief A chunk in the chunk directory.
+///
+/// The values are stored as their difference from the smallest, in just
+/// enough bits for the largest difference, and packed 128 at a time across
+/// four 32-bit lanes: value i goes to lane i%4, so that four values can be
+/// unpacked at once with the same shifts. Each lane holds its 32 values
+/// one after the other from the low bit up, spilling from word to word, and
+/// the words of the four lanes are interleaved. A block of 128 values thus
+/// takes `16*m_nBits` bytes. The smallest and largest values double as a
+/// zone map, which lets a query skip chunks without unpacking them.
+
+struct ColumnChunk{
+  uint64_t m_nOffset = 0; ///< Offset of the packed values, a multiple of 16.
+  int32_t m_nMin = 0; ///< Smallest value.
+  int32_t m_nMax = 0; ///< Largest value.
+  uint8_t m_nBits = 0; ///< Bits per value, from 0 to 32.
+  uint8_t m_pReserved[7] = {}; ///< Zero.
+}; //ColumnChunk
+
+/// \brief How a filter compares a column with a value.
+
+enum class eCompare: uint8_t{
+  Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual
+}; //eCompare
+
+/// \brief A filter on one column.
+
+struct ColumnFilter{
+  size_t m_nColumn = 0; ///< Column.
+  eCompare m_eCompare = eCompare::Equal; ///< Comparison.
+  int32_t m_nValue = 0; ///< Value to compare with.
+}; //ColumnFilter
+
+/// \brief A query: which rows, grouped how, and what to add up.
+
+struct ColumnQuery{
+  std::vector<ColumnFilter> m_vFilters; ///< Rows must pass every filter.
+  int m_nGroupBy = -1; ///< Column to group rows by, or -1 for one group.
+  std::vector<size_t> m_vSums; ///< Columns to add up in each group.
+}; //ColumnQuery
+
+/// \brief The result of a query for one group.
+
+struct QueryGroup{
+  int32_t m_nKey = 0; ///< Value of the group by column, 0 for one group.
+  uint64_t m_nCount = 0; ///< Number of rows.
+  std::vector<int64_t> m_vSum; ///< Sums, in the order of `ColumnQuery::m_vSums`.
+}; //QueryGroup
+
+/// \brief A column store, read in place from a memory mapping.
+///
+/// Holds a table of records, each a row of 32-bit integers, column by
+/// column. Columns are compressed chunk by chunk, see `ColumnChunk`, which
+/// suits game statistics well: small counts and flags take a few bits each.
+/// Queries filter rows on any columns, then count them and add up columns,
+/// grouped by a column if asked. Each row group is unpacked into a buffer
+/// and filtered and added up with SIMD kernels, on as many threads as asked
+/// for, and chunks that the zone maps rule in or out are never unpacked.
+
+class CColumnStore{
+  public:
+    static const uint32_t Magic = 0x4C4F4353; ///< "SCOL" in file byte order.
+    static const uint16_t Version = 1; ///< Current format version.
+    static const size_t GroupRows = 16384; ///< Rows in a row group, a multiple of 128.
+    static const size_t MaxGroupKeys = 65536; ///< Most values of a group by column.
+
+  private:
+    CMappedFile m_cFile; ///< The mapped file.
+    ColumnStoreHeader m_sHeader; ///< Header.
+    const ColumnName* m_pName = nullptr; ///< Column names.
+    const ColumnChunk* m_pChunk = nullptr; ///< Chunk directory.
+
+    void RunGroups(const ColumnQuery& q, int32_t first, size_t keys, size_t thread,
+      size_t threads, std::vector<uint64_t>& count, std::vector<int64_t>& sum) const; ///< Query some row groups.
+
+  public:
+    bool Open(const char* path); ///< Open a column store.
+
+    size_t GetColumns() const { return m_sHeader.m_nColumns; } ///< Get number of columns.
+    uint64_t GetRows() const { return m_sHeader.m_nRows; } ///< Get number of rows.
+    size_t GetGroups() const { return m_sHeader.m_nGroups; } ///< Get number of row groups.
+    size_t GetGroupRows(size_t g) const; ///< Get number of rows in a row group.
+    std::string GetName(size_t c) const; ///< Get a column name.
+    int Find(const char* name) const; ///< Find a column by name.
+
+    const ColumnChunk& GetChunk(size_t g, size_t c) const { return m_pChunk[g*GetColumns() + c]; } ///< Get a chunk.
+    void GetRange(size_t c, int32_t& lo, int32_t& hi) const; ///< Get the range of a column.
+    void Decode(size_t g, size_t c, int32_t* out) const; ///< Unpack a chunk.
+
+    bool Run(const ColumnQuery& q, std::vector<QueryGroup>& out, size_t threads=1) const; ///< Run a query.
+}; //CColumnStore
+
+/// \brief Writes a column store, a row at a time.
+///
+/// Rows are kept until a row group is full, then it is compressed and
+/// written, so memory use does not grow with the number of rows. The
+/// directory and header are written last, by `Close()`.
+
+class CColumnWriter{
+  private:
+    FILE* m_pFile = nullptr; ///< The file.
+    size_t m_nColumns = 0; ///< Number of columns.
+    std::vector<int32_t> m_vBuffer; ///< Rows not yet written, column by column.
+    size_t m_nBuffered = 0; ///< Number of rows not yet written.
+    uint64_t m_nRows = 0; ///< Number of rows.
+    uint64_t m_nOffset = 0; ///< Size of the file so far.
+    std::vector<ColumnChunk> m_vDirectory; ///< Chunks written.
+    std::vector<uint32_t> m_vPacked; ///< Packing buffer.
+
+    void Write(const void* data, size_t size); ///< Write to the end of the file.
+    void Align(size_t n); ///< Pad the file to a multiple of n bytes.
+    void WriteGroup(); ///< Compress and write the rows kept.
+
+  public:
+    ~CColumnWriter(); ///< Destructor.
+
+    bool Open(const char* path, const std::vector<std::string>& columns); ///< Start a column store.
+    void Append(const int32_t* row); ///< Add a row.
+    bool Close(); ///< Finish the column store.
+}; //CColumnWriter
+
+size_t GetPackedBytes(size_t n, int bits); ///< Get the size of packed values.
+void PackValues(const int32_t* in, size_t n, int32_t base, int bits, uint32_t* out); ///< Pack values.
+void UnpackValues(const uint32_t* in, size_t n, int32_t base, int bits, int32_t* out); ///< Unpack values.
+
+#endif //__L4RC_GAME_COLUMNSTORE_H__
@@ -2,10 +2,10 @@
 /// \brief Code for the class CCommon.
 
 #include "Common.h"
+#include "Player.h"
 
 LSpriteRenderer* CCommon::m_pRenderer = nullptr;
 CObjectManager* CCommon::m_pObjectManager = nullptr;
-Player* CCommon::player = nullptr;
-LRandom* CCommon::rng = nullptr;
+Player CCommon::player;
 int CCommon::enemyUpdateIndex = -1;
 GameState CCommon::state = GameState::Menu;
\ No newline at end of file
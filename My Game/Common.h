@@ -9,7 +9,6 @@
 class CObjectManager; 
 class LSpriteRenderer;
 class Player;
-class LRandom;
 
 enum GameState { Map, Battle, GameOver, Menu, NewCard, Intro, Nerd };
 
@@ -26,8 +25,7 @@ class CCommon{
   protected:  
     static LSpriteRenderer* m_pRenderer; ///< Pointer to renderer.
     static CObjectManager* m_pObjectManager; ///< Pointer to object manager.
-    static Player* player;
-    static LRandom* rng;
+    static Player player; ///< The player.
     static int enemyUpdateIndex;
     static GameState state;
 }; //CCommon
@@ -0,0 +1,141 @@
+/// \file Components.h
+/// \brief The components that game entities are made of.
+
+#ifndef __L4RC_GAME_COMPONENTS_H__
+#define __L4RC_GAME_COMPONENTS_H__
+
+#include <vector>
+
+#include "GameDefines.h"
+#include "Common.h"
+#include "Card.h"
+#include "Deck.h"
+#include "EnemyPolicy.h"
+
+/// Get the bit for a game state in a set of game states.
+/// \param s Game state.
+/// \return Bit mask.
+
+inline UINT StateBit(GameState s){
+  return 1U << (UINT)s;
+} //StateBit
+
+/// \brief Where an entity is and how big it is.
+///
+/// Every entity has one, and has it in step with its `Sprite`, so that the
+/// two arrays can be walked side by side.
+
+struct Transform{
+  Vector2 m_vPos; ///< Position of the center, y up.
+  float m_fXScale = 1.0f; ///< Horizontal scale.
+  float m_fYScale = 1.0f; ///< Vertical scale.
+}; //Transform
+
+/// \brief How an entity looks.
+
+struct Sprite{
+  UINT m_nIndex = 0; ///< Sprite index.
+  UINT m_nFrame = 0; ///< Animation frame.
+  Vector4 m_f4Tint = Vector4(1.0f, 1.0f, 1.0f, 1.0f); ///< Color multiplier.
+  float m_fAlpha = 1.0f; ///< Opacity.
+  UINT m_nStates = 0; ///< Game states to draw it in, see `StateBit()`.
+  bool m_bHidden = false; ///< Not drawn in any state.
+}; //Sprite
+
+/// \brief Hit points.
+
+struct Health{
+  int m_nValue = 0; ///< Hit points, 0 for dead.
+}; //Health
+
+/// \brief Damage that is taken before hit points.
+
+struct Shield{
+  int m_nValue = 0; ///< Shield points.
+}; //Shield
+
+/// \brief What a card does when it is played.
+
+struct CardInfo{
+  int m_nDamage = 0; ///< Damage dealt to an enemy.
+  int m_nShield = 0; ///< Shield given to the player.
+  int m_nHealth = 0; ///< Hit points given to the player.
+  bool m_bHovered = false; ///< Raised because the mouse is over it.
+}; //CardInfo
+
+/// \brief A level on the map.
+
+struct NodeInfo{
+  int m_nEnemies = 0; ///< Number of enemies in the level.
+  bool m_bComplete = false; ///< Level has been won.
+}; //NodeInfo
+
+/// \brief What an animation counts.
+
+enum class eAnimate: uint8_t{
+  None, ///< Nothing, the animation is stopped.
+  Loop, ///< Sprite frames, round and round.
+  Count ///< Ticks, in `Animation::m_nCount`.
+}; //eAnimate
+
+/// \brief An animation, which ticks at regular intervals of game time.
+
+struct Animation{
+  float m_fInterval = 0.1f; ///< Time between ticks in seconds.
+  float m_fLastTime = 0.0f; ///< Time of the last tick.
+  eAnimate m_eMode = eAnimate::None; ///< What the ticks count.
+  int m_nCount = 0; ///< Ticks counted in `eAnimate::Count` mode.
+}; //Animation
+
+/// \brief What an actor is doing.
+
+enum class eAct: uint8_t{
+  Idle, ///< At home, waiting for its turn.
+  Moving, ///< Moving to the target to act there.
+  Waiting, ///< Waiting to act where it is.
+  Acting, ///< Playing a card.
+  Returning, ///< Moving back home.
+  Returned ///< Back home, done with its turn.
+}; //eAct
+
+/// \brief Something that takes turns in a battle: it moves out, plays a card,
+/// and moves back.
+
+struct Actor{
+  eAct m_eState = eAct::Idle; ///< What it is doing.
+  Vector2 m_vTarget; ///< Where it is moving to.
+  Vector2 m_vHome; ///< Where it acts from.
+  float m_fSpeed = 460.0f; ///< Speed in pixels per second.
+  float m_fTime = 0.0f; ///< Time spent acting, or left to wait.
+  float m_fLength = 2.5f; ///< How long acting takes, if it is timed.
+  eSound m_eSound = eSound::Size; ///< Sound to play on starting to act, `eSound::Size` for none.
+  bool m_bCount = false; ///< Count animation ticks while acting.
+  UINT m_nIdleSprite = 0; ///< Sprite when at home.
+  UINT m_nRunSprite = 0; ///< Sprite when moving.
+}; //Actor
+
+/// \brief A tint that shows for a moment after being hit.
+
+struct Flash{
+  float m_fTime = 0.0f; ///< Time left to show it.
+}; //Flash
+
+/// \brief An enemy, as its policy sees it and as its intent shows.
+
+struct EnemyInfo{
+  EnemyAttack m_eAttack = EnemyAttack::EndlessHomework; ///< Kind of attack.
+  EnemyCard m_sCard; ///< Card it will play next.
+  bool m_bIntent = false; ///< Show the next card.
+  float m_fBaseScale = 1.0f; ///< Scale at full size.
+  float m_fFormationScale = 1.0f; ///< Scale to fit the formation.
+}; //EnemyInfo
+
+/// \brief The player's cards.
+
+struct PlayerInfo{
+  std::vector<Card> m_vDeck; ///< Every card the player owns.
+  CDeck m_cPiles; ///< Draw, hand and discard piles, of indices into the deck.
+  int m_nCard = -10; ///< Card being played.
+}; //PlayerInfo
+
+#endif //__L4RC_GAME_COMPONENTS_H__
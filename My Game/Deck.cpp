@@ -0,0 +1,175 @@
+/// \file Deck.cpp
+/// \brief Code for the card pile classes CCardRing and CDeck.
+
+#include <utility>
+
+#include "Deck.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// CCardRing functions
+
+/// Add a card to the back of the ring. The ring must not be full.
+/// \param card Card index.
+
+void CCardRing::PushBack(size_t card){
+  m_pCard[(uint8_t)(m_nHead + m_nSize)] = (uint8_t)card;
+  ++m_nSize;
+} //PushBack
+
+/// Remove the card at the front of the ring. The ring must not be empty.
+/// \return Card index.
+
+size_t CCardRing::PopFront(){
+  const size_t card = m_pCard[m_nHead++];
+  --m_nSize;
+  return card;
+} //PopFront
+
+///////////////////////////////////////////////////////////////////////////////
+// CDeck functions
+
+/// Start a new deck with every card in the draw pile.
+/// \param n Number of cards, at most `CCardRing::Capacity`.
+
+void CDeck::Create(size_t n){
+  m_nCards = n < CCardRing::Capacity? n: CCardRing::Capacity;
+  m_bsExhausts.reset();
+  Gather();
+} //Create
+
+/// Add a new card to the deck. It goes into the discard pile, so it will be
+/// drawn after the next reshuffle.
+/// \return Index of the new card, or `CCardRing::Capacity` if the deck is full.
+
+size_t CDeck::Add(){
+  if(m_nCards >= CCardRing::Capacity)
+    return CCardRing::Capacity;
+
+  m_cDiscard.PushBack(m_nCards);
+  return m_nCards++;
+} //Add
+
+/// Put every card back into the draw pile, emptying the other piles.
+
+void CDeck::Gather(){
+  m_cDraw.Clear();
+  m_cHand.Clear();
+  m_cDiscard.Clear();
+  m_cExhaust.Clear();
+  m_bsPlayed.reset();
+
+  for(size_t i=0; i<m_nCards; i++)
+    m_cDraw.PushBack(i);
+} //Gather
+
+/// Pour the discard pile into the draw pile. There is no need to shuffle
+/// here since `Draw()` picks cards from the draw pile at random.
+
+void CDeck::Recycle(){
+  while(!m_cDiscard.Empty())
+    m_cDraw.PushBack(m_cDiscard.PopFront());
+} //Recycle
+
+/// Draw cards into the hand, recycling the discard pile if the draw pile runs
+/// out. Each draw is a single Fisher-Yates step on the draw pile.
+/// \param n Number of cards to draw.
+/// \return Number of cards actually drawn.
+
+size_t CDeck::Draw(size_t n){
+  size_t drawn = 0;
+
+  for(; drawn<n; drawn++){
+    if(m_cDraw.Empty())
+      Recycle();
+
+    if(m_cDraw.Empty())
+      break; //everything is in the hand or exhausted
+
+    const size_t j = m_cRng.randn(0, (int)m_cDraw.Size() - 1);
+    std::swap(m_cDraw[0], m_cDraw[j]);
+    m_cHand.PushBack(m_cDraw.PopFront());
+  } //for
+
+  return drawn;
+} //Draw
+
+/// Move every card in the hand to the discard pile, except for played cards
+/// that exhaust, which go to the exhaust pile instead.
+
+void CDeck::DiscardHand(){
+  while(!m_cHand.Empty()){
+    const size_t card = m_cHand.PopFront();
+
+    if(m_bsPlayed.test(card) && m_bsExhausts.test(card))
+      m_cExhaust.PushBack(card);
+    else m_cDiscard.PushBack(card);
+  } //while
+
+  m_bsPlayed.reset();
+} //DiscardHand
+
+/// Mark a card in the hand as played. It stays in its hand slot until the
+/// hand is discarded.
+/// \param card Card index.
+
+void CDeck::Play(size_t card){
+  m_bsPlayed.set(card);
+} //Play
+
+/// Set whether a card goes to the exhaust pile instead of the discard pile
+/// after it is played.
+/// \param card Card index.
+/// \param b True if the card exhausts.
+
+void CDeck::SetExhausts(size_t card, bool b){
+  m_bsExhausts.set(card, b);
+} //SetExhausts
+
+/// Save the piles, the card flags and the random number generator state.
+/// \param s [out] Saved state.
+
+void CDeck::GetState(DeckState& s) const{
+  const CCardRing* pile[4] = {&m_cDraw, &m_cHand, &m_cDiscard, &m_cExhaust};
+  size_t k = 0;
+
+  s.m_nCards = (uint16_t)m_nCards;
+
+  for(size_t p=0; p<4; p++){
+    s.m_pCount[p] = (uint16_t)pile[p]->Size();
+
+    for(size_t i=0; i<pile[p]->Size(); i++)
+      s.m_pOrder[k++] = (uint8_t)(*pile[p])[i];
+  } //for
+
+  for(size_t i=0; i<m_nCards; i++)
+    s.m_pFlags[i] = (uint8_t)((m_bsPlayed.test(i)? 1: 0) | (m_bsExhausts.test(i)? 2: 0));
+
+  s.m_nRng = m_cRng.GetState();
+} //GetState
+
+/// Restore the piles from a saved state.
+/// \param s Saved state.
+
+void CDeck::SetState(const DeckState& s){
+  CCardRing* pile[4] = {&m_cDraw, &m_cHand, &m_cDiscard, &m_cExhaust};
+  size_t k = 0;
+
+  m_nCards = s.m_nCards < CCardRing::Capacity? s.m_nCards: CCardRing::Capacity;
+
+  for(size_t p=0; p<4; p++){
+    pile[p]->Clear();
+
+    for(size_t i=0; i<s.m_pCount[p] && k<m_nCards; i++)
+      pile[p]->PushBack(s.m_pOrder[k++]);
+  } //for
+
+  m_bsPlayed.reset();
+  m_bsExhausts.reset();
+
+  for(size_t i=0; i<m_nCards; i++){
+    m_bsPlayed.set(i, (s.m_pFlags[i] & 1) != 0);
+    m_bsExhausts.set(i, (s.m_pFlags[i] & 2) != 0);
+  } //for
+
+  m_cRng.SetState(s.m_nRng);
+} //SetState
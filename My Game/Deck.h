@@ -0,0 +1,104 @@
+/// \file Deck.h
+/// \brief Interface for the card pile classes CCardRing and CDeck.
+
+#ifndef __L4RC_GAME_DECK_H__
+#define __L4RC_GAME_DECK_H__
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#include "Rng.h"
+
+/// \brief A ring buffer of card indices.
+///
+/// Cards are referred to by their index into the player's deck. The capacity
+/// is 256 so that an 8-bit head index wraps around for free.
+
+class CCardRing{
+  public:
+    static const size_t Capacity = 256; ///< Maximum number of cards.
+
+  private:
+    uint8_t m_pCard[Capacity]; ///< Card indices.
+    uint8_t m_nHead = 0; ///< Index of the front card.
+    size_t m_nSize = 0; ///< Number of cards.
+
+  public:
+    void Clear(){ m_nHead = 0; m_nSize = 0; } ///< Remove all cards.
+    void PushBack(size_t card); ///< Add a card at the back.
+    size_t PopFront(); ///< Remove the card at the front.
+
+    /// Get a reference to the card at a given distance from the front.
+    /// \param i Position, from 0 at the front.
+    /// \return Reference to the card index.
+
+    uint8_t& operator[](size_t i){ return m_pCard[(uint8_t)(m_nHead + i)]; }
+    size_t operator[](size_t i) const{ return m_pCard[(uint8_t)(m_nHead + i)]; }
+
+    size_t Size() const { return m_nSize; } ///< Get number of cards.
+    bool Empty() const { return m_nSize == 0; } ///< Test for no cards.
+}; //CCardRing
+
+/// \brief The card piles in a form that can be saved and restored.
+
+struct DeckState{
+  uint16_t m_nCards = 0; ///< Number of cards in the deck.
+  uint16_t m_pCount[4] = {0, 0, 0, 0}; ///< Sizes of the draw pile, hand, discard and exhaust piles.
+  uint8_t m_pOrder[CCardRing::Capacity]; ///< Card indices, pile by pile, front first.
+  uint8_t m_pFlags[CCardRing::Capacity]; ///< Per card, bit 0 for played and bit 1 for exhausts.
+  uint64_t m_nRng = 0; ///< Random number generator state.
+}; //DeckState
+
+/// \brief The card piles.
+///
+/// Keeps track of which pile each card in the deck is in: the draw pile, the
+/// hand, the discard pile or the exhaust pile. Nothing is ever shuffled up
+/// front. Instead each draw does one step of a Fisher-Yates shuffle, picking
+/// a random card from the draw pile and swapping it to the front, so the
+/// cost of shuffling is only paid for cards that are actually drawn. When the
+/// draw pile runs out the discard pile is poured back into it. Cards played
+/// from the current hand are tracked in a bitset indexed by card.
+
+class CDeck{
+  private:
+    CCardRing m_cDraw; ///< Draw pile.
+    CCardRing m_cHand; ///< Hand, in slot order.
+    CCardRing m_cDiscard; ///< Discard pile.
+    CCardRing m_cExhaust; ///< Exhaust pile.
+
+    std::bitset<CCardRing::Capacity> m_bsPlayed; ///< Played from this hand.
+    std::bitset<CCardRing::Capacity> m_bsExhausts; ///< Exhausted when played.
+
+    size_t m_nCards = 0; ///< Number of cards in the deck.
+    CRng m_cRng; ///< Random number generator for draws.
+
+    void Recycle(); ///< Move the discard pile to the draw pile.
+
+  public:
+    void Create(size_t n); ///< Put n cards into the draw pile.
+    void Seed(uint64_t seed){ m_cRng.Seed(seed); } ///< Seed the draws.
+    size_t Add(); ///< Add a new card to the discard pile.
+    void Gather(); ///< Return every card to the draw pile.
+
+    size_t Draw(size_t n); ///< Draw cards into the hand.
+    void DiscardHand(); ///< Discard the hand.
+    void Play(size_t card); ///< Mark a card in the hand as played.
+    void SetExhausts(size_t card, bool b); ///< Set whether a card exhausts.
+
+    void GetState(DeckState&) const; ///< Save the piles.
+    void SetState(const DeckState&); ///< Restore the piles.
+
+    bool IsPlayed(size_t card) const { return m_bsPlayed.test(card); } ///< Test for played.
+    size_t GetHandCard(size_t slot) const { return m_cHand[slot]; } ///< Get card in hand slot.
+
+    size_t GetCardCount() const { return m_nCards; } ///< Get deck size.
+    size_t GetHandCount() const { return m_cHand.Size(); } ///< Get hand size.
+    size_t GetDrawCount() const { return m_cDraw.Size(); } ///< Get draw pile size.
+    size_t GetDiscardCount() const { return m_cDiscard.Size(); } ///< Get discard pile size.
+    size_t GetExhaustCount() const { return m_cExhaust.Size(); } ///< Get exhaust pile size.
+
+    CRng& GetRng(){ return m_cRng; } ///< Get the random number generator.
+}; //CDeck
+
+#endif //__L4RC_GAME_DECK_H__
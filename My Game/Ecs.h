@@ -0,0 +1,196 @@
+/// \file Ecs.h
+/// \brief Interface and code for the entity pool CEntityPool and the
+/// component array CComponentArray.
+
+#ifndef __L4RC_GAME_ECS_H__
+#define __L4RC_GAME_ECS_H__
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/// \brief An entity, which is nothing more than a name for a set of
+/// components.
+///
+/// The index names a slot in the entity pool and the generation tells apart
+/// the entities that have used the slot, so that an entity that has been
+/// destroyed is never mistaken for a newer one in the same slot. The default
+/// entity is the null entity, which is never alive.
+
+struct Entity{
+  uint32_t m_nIndex = 0; ///< Slot in the entity pool.
+  uint32_t m_nGeneration = 0; ///< Generation of the slot, 0 for the null entity.
+
+  bool operator==(const Entity& e) const { return m_nIndex == e.m_nIndex && m_nGeneration == e.m_nGeneration; } ///< Equality.
+  bool operator!=(const Entity& e) const { return !(*this == e); } ///< Inequality.
+}; //Entity
+
+/// \brief The entity pool.
+///
+/// Hands out entities and takes them back. A slot that is given back goes
+/// on a free list with its generation moved on, so that the old entity is no
+/// longer alive, and is reused by the next entity created.
+
+class CEntityPool{
+  private:
+    std::vector<uint32_t> m_vGeneration; ///< Generation of each slot.
+    std::vector<uint32_t> m_vFree; ///< Free slots, the next to use at the back.
+
+  public:
+    /// Create an entity.
+    /// \return The entity.
+
+    Entity Create(){
+      Entity e;
+
+      if(m_vFree.empty()){
+        e.m_nIndex = (uint32_t)m_vGeneration.size();
+        m_vGeneration.push_back(1);
+      } //if
+
+      else{
+        e.m_nIndex = m_vFree.back();
+        m_vFree.pop_back();
+      } //else
+
+      e.m_nGeneration = m_vGeneration[e.m_nIndex];
+      return e;
+    } //Create
+
+    /// Destroy an entity. Destroying one that is not alive does nothing.
+    /// \param e Entity.
+
+    void Destroy(Entity e){
+      if(!IsAlive(e))return;
+      m_vGeneration[e.m_nIndex]++;
+      m_vFree.push_back(e.m_nIndex);
+    } //Destroy
+
+    /// Test whether an entity is alive.
+    /// \param e Entity.
+    /// \return true if it has been created and not destroyed.
+
+    bool IsAlive(Entity e) const{
+      return e.m_nIndex < m_vGeneration.size() && m_vGeneration[e.m_nIndex] == e.m_nGeneration;
+    } //IsAlive
+
+    /// Destroy every entity. The slots are kept for reuse, lowest first.
+
+    void Clear(){
+      m_vFree.clear();
+
+      for(size_t i=m_vGeneration.size(); i-->0;){
+        m_vGeneration[i]++;
+        m_vFree.push_back((uint32_t)i);
+      } //for
+    } //Clear
+}; //CEntityPool
+
+/// \brief A dense array of components of one type.
+///
+/// The components are packed together with no gaps, so that a system can
+/// walk through all of them in order, and a sparse table indexed by entity
+/// slot finds the component of any one entity in constant time. Removal
+/// keeps the order the components were added in, so that arrays given
+/// components for the same entities in the same order stay in step and can
+/// be walked side by side. Removing entities one at a time is slow; mark
+/// them and remove them all at once with `RemoveIf()`.
+/// \tparam t Component type.
+
+template<class t> class CComponentArray{
+  private:
+    static const uint32_t None = 0xFFFFFFFF; ///< Sparse table entry for no component.
+
+    std::vector<t> m_vData; ///< Components.
+    std::vector<Entity> m_vEntity; ///< Entity of each component.
+    std::vector<uint32_t> m_vSparse; ///< Component index of each entity slot, or `None`.
+
+  public:
+    /// Give an entity a component. It must not have one already.
+    /// \param e Entity.
+    /// \param c Component.
+    /// \return Reference to the component in the array.
+
+    t& Add(Entity e, const t& c=t()){
+      assert(!Has(e));
+
+      if(e.m_nIndex >= m_vSparse.size())
+        m_vSparse.resize(e.m_nIndex + 1, (uint32_t)None);
+
+      m_vSparse[e.m_nIndex] = (uint32_t)m_vData.size();
+      m_vEntity.push_back(e);
+      m_vData.push_back(c);
+      return m_vData.back();
+    } //Add
+
+    /// Test whether an entity has a component.
+    /// \param e Entity.
+    /// \return true if it has one.
+
+    bool Has(Entity e) const{
+      return e.m_nIndex < m_vSparse.size() && m_vSparse[e.m_nIndex] != None &&
+        m_vEntity[m_vSparse[e.m_nIndex]] == e;
+    } //Has
+
+    /// Get the component of an entity, which must have one.
+    /// \param e Entity.
+    /// \return Reference to the component.
+
+    t& Get(Entity e){
+      assert(Has(e));
+      return m_vData[m_vSparse[e.m_nIndex]];
+    } //Get
+
+    /// Get the component of an entity, which must have one.
+    /// \param e Entity.
+    /// \return Reference to the component.
+
+    const t& Get(Entity e) const{
+      assert(Has(e));
+      return m_vData[m_vSparse[e.m_nIndex]];
+    } //Get
+
+    /// Remove the components of the entities that a test picks out, in one
+    /// pass, keeping the rest in order.
+    /// \param remove Test that takes an entity and returns true to remove it.
+
+    template<class f> void RemoveIf(f remove){
+      size_t j = 0;
+
+      for(size_t i=0; i<m_vData.size(); i++){
+        const Entity e = m_vEntity[i];
+
+        if(remove(e))
+          m_vSparse[e.m_nIndex] = None;
+
+        else{
+          if(i != j){
+            m_vData[j] = std::move(m_vData[i]);
+            m_vEntity[j] = e;
+          } //if
+
+          m_vSparse[e.m_nIndex] = (uint32_t)j++;
+        } //else
+      } //for
+
+      m_vData.resize(j);
+      m_vEntity.resize(j);
+    } //RemoveIf
+
+    /// Remove every component.
+
+    void Clear(){
+      m_vData.clear();
+      m_vEntity.clear();
+      m_vSparse.clear();
+    } //Clear
+
+    size_t Size() const { return m_vData.size(); } ///< Get number of components.
+    t& operator[](size_t i){ return m_vData[i]; } ///< Get a component by index.
+    const t& operator[](size_t i) const { return m_vData[i]; } ///< Get a component by index.
+    Entity GetEntity(size_t i) const { return m_vEntity[i]; } ///< Get the entity of a component by index.
+}; //CComponentArray
+
+#endif //__L4RC_GAME_ECS_H__
@@ -0,0 +1,93 @@
+/// \file Encounter.cpp
+/// \brief Code for the large encounter class CEncounter.
+
+#include <algorithm>
+
+#include "Encounter.h"
+
+/// Create an encounter of ordinary enemies and lay them out.
+/// \param n Number of enemies.
+/// \param health Starting health of each enemy.
+
+void CEncounter::Create(size_t n, int health){
+  m_vHealth.assign(n, health);
+  m_vAttack.assign(n, EnemyAttack::EndlessHomework);
+  m_cFormation.Arrange(n);
+} //Create
+
+/// Damage a single enemy.
+/// \param i Enemy index.
+/// \param amount Amount of damage.
+/// \return 1 if the enemy died, otherwise 0.
+
+size_t CEncounter::Damage(size_t i, int amount){
+  m_vHealth[i] = std::max(0, m_vHealth[i] - amount);
+  return m_vHealth[i] == 0? 1: 0;
+} //Damage
+
+/// Apply area damage to every enemy. The loop body has no branches so that
+/// it compiles to packed subtract, max and compare instructions.
+/// \param amount Amount of damage.
+/// \return Number of enemies that are now dead.
+
+size_t CEncounter::DamageAll(int amount){
+  int32_t* h = m_vHealth.data();
+  const size_t n = m_vHealth.size();
+  size_t dead = 0;
+
+  for(size_t i=0; i<n; i++){
+    h[i] = std::max(h[i] - amount, 0);
+    dead += h[i] == 0;
+  } //for
+
+  return dead;
+} //DamageAll
+
+/// Remove dead enemies, keeping the survivors in order, and lay out the
+/// survivors again.
+
+void CEncounter::RemoveDead(){
+  size_t j = 0;
+
+  for(size_t i=0; i<m_vHealth.size(); i++)
+    if(m_vHealth[i] > 0){
+      m_vHealth[j] = m_vHealth[i];
+      m_vAttack[j] = m_vAttack[i];
+      ++j;
+    } //if
+
+  m_vHealth.resize(j);
+  m_vAttack.resize(j);
+  m_cFormation.Arrange(j);
+} //RemoveDead
+
+/// Find the enemy under a point.
+/// \param x Horizontal position in world space.
+/// \param y Vertical position in world space.
+/// \return Enemy index, or -1 if the point is not on an enemy.
+
+int CEncounter::Pick(float x, float y) const{
+  return m_cFormation.Pick(x, y);
+} //Pick
+
+/// Decide every enemy's intent for the coming enemy turn in one pass.
+/// \param hp Player health.
+/// \param shield Player shield.
+/// \param rng Random number generator.
+/// \return Intents, indexed by enemy.
+
+const std::vector<EnemyCard>& CEncounter::PlanTurn(int hp, int shield, CRng& rng){
+  const size_t n = m_vHealth.size();
+  m_vViews.resize(n);
+  m_vIntents.resize(n);
+
+  for(size_t i=0; i<n; i++){
+    m_vViews[i].m_eAttack = m_vAttack[i];
+    m_vViews[i].m_nHealth = m_vHealth[i];
+    m_vViews[i].m_nPlayerHealth = hp;
+    m_vViews[i].m_nPlayerShield = shield;
+  } //for
+
+  DecideIntents(m_vViews.data(), m_vIntents.data(), n, rng);
+  return m_vIntents;
+} //PlanTurn
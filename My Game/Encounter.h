@@ -0,0 +1,52 @@
+/// \file Encounter.h
+/// \brief Interface for the large encounter class CEncounter.
+
+#ifndef __L4RC_GAME_ENCOUNTER_H__
+#define __L4RC_GAME_ENCOUNTER_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "EnemyPolicy.h"
+#include "Formation.h"
+
+/// \brief A large encounter.
+///
+/// The enemies of an encounter stored as structure-of-arrays, one array per
+/// field, laid out in a `CFormation`. Area damage is a single branch-free
+/// pass over the health array that the compiler can vectorize, and dead
+/// enemies are removed in one stable compaction pass afterwards so that the
+/// survivors keep their order, and therefore their turn order. The game
+/// keeps one for any battle with more enemies or cards than a `BattleState`
+/// holds, and works out damage and enemy intents here, with the enemy
+/// objects showing the result.
+
+class CEncounter{
+  public:
+    static const size_t BenchmarkSize = 500; ///< Enemies in the benchmark encounter.
+
+  private:
+    std::vector<int32_t> m_vHealth; ///< Enemy health.
+    std::vector<EnemyAttack> m_vAttack; ///< Enemy kind.
+    std::vector<EnemyView> m_vViews; ///< Enemy views for planning.
+    std::vector<EnemyCard> m_vIntents; ///< Planned enemy cards.
+    CFormation m_cFormation; ///< Enemy formation.
+
+  public:
+    void Create(size_t n, int health); ///< Create n ordinary enemies.
+    void Clear(){ Create(0, 0); } ///< Remove every enemy.
+    void SetHealth(size_t i, int h){ m_vHealth[i] = h; } ///< Set enemy health.
+    void SetAttack(size_t i, EnemyAttack a){ m_vAttack[i] = a; } ///< Set enemy kind.
+    size_t Damage(size_t i, int amount); ///< Damage one enemy.
+    size_t DamageAll(int amount); ///< Damage every enemy.
+    void RemoveDead(); ///< Remove dead enemies.
+    int Pick(float x, float y) const; ///< Get enemy under a point.
+
+    const std::vector<EnemyCard>& PlanTurn(int hp, int shield, CRng& rng); ///< Decide intents.
+
+    size_t GetCount() const { return m_vHealth.size(); } ///< Get number of enemies.
+    int GetHealth(size_t i) const { return m_vHealth[i]; } ///< Get enemy health.
+    const CFormation& GetFormation() const { return m_cFormation; } ///< Get formation.
+}; //CEncounter
+
+#endif //__L4RC_GAME_ENCOUNTER_H__
@@ -1,229 +1,192 @@
 #include "Enemy.h"
+#include "Balance.h"
 #include "ComponentIncludes.h"
-#include "Helpers.h"
+#include "ObjectManager.h"
 
-Enemy::Enemy(const Vector2& p, float height) : CObject(eSprite::Enemy, p)
+template<class t> t& Enemy::Get() const
 {
-	health = 10;
-	state = EnemyState::InPosition;
-	this->height = height;
-	animationTimer = new LEventTimer(0.1f);
-	attack = EnemyAttack::EndlessHomework;
-	damageTimer = new LEventTimer(0.3f);
+	return m_pObjectManager->Get<t>(entity);
 }
 
-bool Enemy::TakeDamage(int amount)
+//Take a hit whose damage has already been worked out, by the battle state or,
+//for a whole large encounter at once, by the encounter, leaving the given
+//health. Die if there is none left. The enemy's components are kept until
+//the end of the next move, so it can still be asked about. Returns true if
+//it died
+bool Enemy::Hit(int health) const
 {
-	health = std::max(0, health - amount);
+	Get<Health>().m_nValue = health;
 
 	if (health == 0)
-		m_bDead = true;
+		Kill();
 
-	m_f4Tint = Vector4(0.9f, 0.4f, 0.4f, 1.0f);
-	damageTimer = new LEventTimer(0.3f);
+	Get<Sprite>().m_f4Tint = Vector4(0.9f, 0.4f, 0.4f, 1.0f);
+	Get<Flash>().m_fTime = 0.3f;
 	m_pAudio->play(eSound::EnemyDamage);
 
-	return m_bDead;
+	return health == 0;
 }
 
-EnemyCard Enemy::GetCard()
+EnemyCard Enemy::GetCard() const
 {
-	return nextCard;
+	return Get<EnemyInfo>().m_sCard;
 }
 
-void Enemy::PlayCard(const Vector2& center)
+//Describe this enemy to its policy
+EnemyView Enemy::GetView() const
 {
-	state = EnemyState::MovingTowardsCenter;
-	target = center;
-	oldPosition = m_vPos;
+	EnemyView view;
+	view.m_eAttack = Get<EnemyInfo>().m_eAttack;
+	view.m_nHealth = Get<Health>().m_nValue;
+	return view;
+}
+
+//Set the card this enemy will play on its next turn; it is shown over the
+//enemy's head until the card has been played
+void Enemy::SetIntent(const EnemyCard& card) const
+{
+	Get<EnemyInfo>().m_sCard = card;
+	Get<EnemyInfo>().m_bIntent = true;
+}
+
+void Enemy::PlayCard(const Vector2& center) const
+{
+	Actor& actor = Get<Actor>();
+	actor.m_eState = eAct::Moving;
+	actor.m_vTarget = center;
+	actor.m_vHome = Get<Transform>().m_vPos;
+	actor.m_fLength = 2.5f;
+	actor.m_eSound = GetCardSound();
+
+	Sprite& sprite = Get<Sprite>();
 
+	if (sprite.m_nIndex == actor.m_nIdleSprite)
+		sprite.m_nIndex = actor.m_nRunSprite;
 
-	if (m_nSpriteIndex == (UINT)eSprite::Enemy)
-		m_nSpriteIndex = (UINT)eSprite::EnemyRunning;
+	if (actor.m_nRunSprite != actor.m_nIdleSprite)
+		Get<Animation>().m_eMode = eAnimate::Loop;
 }
 
-void Enemy::ReturnToPosition()
+//Play the card without leaving the formation, after waiting for the given
+//delay, for fast combat
+void Enemy::PlayCardInPlace(float delay, float duration, bool sound) const
 {
-	state = EnemyState::Returning;
-	target = oldPosition;
+	Actor& actor = Get<Actor>();
+	actor.m_eState = eAct::Waiting;
+	actor.m_fTime = delay;
+	actor.m_fLength = duration;
+	actor.m_eSound = sound ? GetCardSound() : eSound::Size;
 }
 
-void Enemy::draw()
+void Enemy::ReturnToPosition() const
 {
-	if (CCommon::state == GameState::Battle)
+	Actor& actor = Get<Actor>();
+	actor.m_eState = eAct::Returning;
+	actor.m_vTarget = actor.m_vHome;
+
+	if (actor.m_nRunSprite != actor.m_nIdleSprite)
+		Get<Animation>().m_eMode = eAnimate::Loop;
+}
+
+EnemyState Enemy::GetState() const
+{
+	switch (Get<Actor>().m_eState)
 	{
-		CObject::draw();
-
-		const std::string s = this->getHeadText();
-		m_pRenderer->DrawScreenText(s.c_str(), Vector2(m_vPos.x - 25, height - m_vPos.y - 125), Colors::White); //draw to screen
-
-		if (state == EnemyState::PlayingCard)
-		{
-			if (nextCard.type == EnemyCardType::Attack)
-			{
-				if (attack == EnemyAttack::EndlessHomework)
-				{
-					LSpriteDesc2D paperDesc;
-					paperDesc.m_nSpriteIndex = (UINT)eSprite::Paper;
-					paperDesc.m_fXScale = 0.35f;
-					paperDesc.m_fYScale = 0.35f;
-
-					Vector2 base = m_vPos;// +Vector2(m_pRenderer->GetWidth(eSprite::EnemyRunning) * cosf(attackingTime), m_pRenderer->GetHeight(eSprite::EnemyRunning) * sinf(attackingTime));
-
-					const float width = m_pRenderer->GetWidth(m_nSpriteIndex);
-					const float height = m_pRenderer->GetHeight(m_nSpriteIndex);
-
-					Vector2 rotation = Vector2(width * cosf(attackingTime), height * sinf(attackingTime));
-
-					paperDesc.m_vPos = base + rotation;
-					m_pRenderer->Draw(&paperDesc);
-
-					rotation = Vector2(width * cosf((attackingTime + 3.14 / 2.0f)), height * sinf((attackingTime + 3.14 / 2.0f)));
-					paperDesc.m_vPos = base + rotation;
-					m_pRenderer->Draw(&paperDesc);
-
-					rotation = Vector2(width * cosf((attackingTime + 3.14)), height * sinf((attackingTime + 3.14)));
-					paperDesc.m_vPos = base + rotation;
-					m_pRenderer->Draw(&paperDesc);
-
-					rotation = Vector2(width * cosf((attackingTime + 3.0f * 3.14 / 2.0f)), height * sinf((attackingTime + 3.0f * 3.14 / 2.0f)));
-					paperDesc.m_vPos = base + rotation;
-					m_pRenderer->Draw(&paperDesc);
-				}
-				else if (attack == EnemyAttack::Lame)
-				{
-					const std::string lameText = "LAME!!!";
-					Vector2 lamePosition = Vector2(m_vPos.x - 100 * attackingTime, height - m_vPos.y - 80);
-					m_pRenderer->DrawScreenText(lameText.c_str(), lamePosition, Colors::White);
-				}
-			}
-			else if (nextCard.type == EnemyCardType::Heal)
-			{
-				LSpriteDesc2D laptop;
-				laptop.m_nSpriteIndex = (UINT)eSprite::Laptop;
-				laptop.m_fXScale = 0.18f;
-				laptop.m_fYScale = 0.18f;
-				laptop.m_vPos = m_vPos + Vector2(0, 120 + 60 * attackingTime);
-
-				m_pRenderer->Draw(&laptop);
-			}
-		}
+		case eAct::Moving: return EnemyState::MovingTowardsCenter;
+		case eAct::Waiting: return EnemyState::Waiting;
+		case eAct::Acting: return EnemyState::PlayingCard;
+		case eAct::Returning: return EnemyState::Returning;
+		case eAct::Returned: return EnemyState::Returned;
+		default: return EnemyState::InPosition;
 	}
 }
 
-void Enemy::move()
+void Enemy::SetBack() const
 {
-	const float t = m_pTimer->GetFrameTime();
+	Get<Actor>().m_eState = eAct::Idle;
+	Get<EnemyInfo>().m_bIntent = false;
+}
 
-	Vector2 direction;
+const Vector2& Enemy::GetPos() const
+{
+	return Get<Transform>().m_vPos;
+}
 
-	switch (state)
-	{
-		case EnemyState::MovingTowardsCenter:
-			UpdateFrame();
-			direction = (target - m_vPos);
-			direction.Normalize();
-			m_vPos += direction * speed * t;
-
-			if ((m_vPos - target).LengthSquared() < diff)
-			{
-				state = EnemyState::PlayingCard;
-				attackingTime = 0;
-
-				//If health is low, heal with random chance; otherwise, attack
-				if (health < 3 && rng->randn(1, 10) <= 7)
-				{
-					nextCard.type = EnemyCardType::Heal;
-					nextCard.value = 1 + rng->randn(0, 2);
-					m_pAudio->play(eSound::Auto);
-				}
-				else
-				{
-					if (attack == EnemyAttack::EndlessHomework)
-					{
-						m_pAudio->play(eSound::EndlessHomework);
-						nextCard.value = 2 + rng->randn(-1, 1);
-					}
-					else if (attack == EnemyAttack::Lame)
-					{
-						m_pAudio->play(eSound::Lame);
-						nextCard.value = 3 + rng->randn(0, 1);
-					}
-
-					nextCard.type = EnemyCardType::Attack;
-				}
-			}
-			break;
-		case EnemyState::PlayingCard:
-			attackingTime += t;
-			break;
-		case EnemyState::Returning:
-			UpdateFrame();
-			direction = (target - m_vPos);
-			direction.Normalize();
-			m_vPos += direction * speed * t;
-
-			if ((m_vPos - target).LengthSquared() < diff)
-			{
-				state = EnemyState::Returned;
-
-				if (m_nSpriteIndex == (UINT)eSprite::EnemyRunning)
-				{
-					m_nSpriteIndex = (UINT)eSprite::Enemy;
-					m_nCurrentFrame = 0;
-				}
-			}
-			break;
-	}
+int Enemy::GetHealth() const
+{
+	return Get<Health>().m_nValue;
+}
 
-	if (damageTimer->Triggered())
-		m_f4Tint = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
+void Enemy::SetHealth(int h) const
+{
+	Get<Health>().m_nValue = h;
 }
 
-void Enemy::UpdateFrame()
+//The card was chosen by the enemy's policy at the start of the turn
+eSound Enemy::GetCardSound() const
 {
-	if (m_nSpriteIndex == (UINT)eSprite::Boss)
-		return;
+	const EnemyInfo& info = Get<EnemyInfo>();
 
-	const size_t numFrames = m_pRenderer->GetNumFrames(m_nSpriteIndex);
+	if (info.m_sCard.type == EnemyCardType::Heal)
+		return eSound::Auto;
+	else if (info.m_eAttack == EnemyAttack::EndlessHomework)
+		return eSound::EndlessHomework;
+	else if (info.m_eAttack == EnemyAttack::Lame)
+		return eSound::Lame;
 
-	if (animationTimer->Triggered())
-	{
-		m_nCurrentFrame++;
-		m_nCurrentFrame %= numFrames;
-	}
+	return eSound::Size;
+}
+
+bool Enemy::FinishedAttacking() const
+{
+	const Actor& actor = Get<Actor>();
+	return actor.m_eState == eAct::Acting && actor.m_fTime >= actor.m_fLength;
+}
+
+//The boss does not run, so it has no running animation
+void Enemy::SetBoss() const
+{
+	EnemyInfo& info = Get<EnemyInfo>();
+	info.m_eAttack = EnemyAttack::Lame;
+	info.m_fBaseScale = 0.75f;
+
+	Get<Sprite>().m_nIndex = (UINT)eSprite::Boss;
+	Get<Actor>().m_nIdleSprite = (UINT)eSprite::Boss;
+	Get<Actor>().m_nRunSprite = (UINT)eSprite::Boss;
+	Get<Health>().m_nValue = GetBalance().m_nBossHealth;
+	SetFormationScale(info.m_fFormationScale);
 }
 
-bool Enemy::FinishedAttacking()
+void Enemy::SetPosition(const Vector2& pos) const
 {
-	return attackingTime >= attackEnd;
+	Get<Transform>().m_vPos = pos;
 }
 
-void Enemy::SetBoss()
+//Shrink the enemy to fit a large formation
+void Enemy::SetFormationScale(float scale) const
 {
-	attack = EnemyAttack::Lame;
-	m_nSpriteIndex = (UINT)eSprite::Boss;
-	m_fXScale = 0.75;
-	m_fYScale = 0.75;
-	health = 20;
+	EnemyInfo& info = Get<EnemyInfo>();
+	info.m_fFormationScale = scale;
+	Get<Transform>().m_fXScale = info.m_fBaseScale * scale;
+	Get<Transform>().m_fYScale = info.m_fBaseScale * scale;
 }
 
-void Enemy::Heal(int amount)
+void Enemy::Heal(int amount) const
 {
-	health += amount;
+	Get<Health>().m_nValue += amount;
 }
 
-void Enemy::SetUnavailable()
+void Enemy::SetUnavailable() const
 {
-	m_fAlpha = 0.5f;
+	Get<Sprite>().m_fAlpha = 0.5f;
 }
 
-void Enemy::SetNormal()
+void Enemy::SetNormal() const
 {
-	m_fAlpha = 1.0f;
+	Get<Sprite>().m_fAlpha = 1.0f;
 }
 
-void Enemy::Kill()
+void Enemy::Kill() const
 {
-	m_bDead = true;
+	m_pObjectManager->Destroy(entity);
 }
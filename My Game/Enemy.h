@@ -1,57 +1,50 @@
 #pragma once
 
-#include "Object.h"
-#include "Random.h"
-#include "EventTimer.h"
-
-enum class EnemyState { InPosition, MovingTowardsCenter, PlayingCard, Returning, Returned };
-enum class EnemyAttack { EndlessHomework, Lame };
-
-enum class EnemyCardType { Attack, Heal };
-
-struct EnemyCard
-{
-	EnemyCardType type;
-	int value;
-};
-
-class Enemy : public CObject
+#include "GameDefines.h"
+#include "Common.h"
+#include "Component.h"
+#include "Ecs.h"
+#include "EnemyPolicy.h"
+
+enum class EnemyState { InPosition, MovingTowardsCenter, PlayingCard, Returning, Returned, Waiting };
+
+//An enemy is an entity with a transform, a sprite, health, an animation, an
+//actor, a damage flash and enemy info. This is a handle to it, so it is cheap
+//to copy, and the object manager's systems move and draw it
+class Enemy : public LComponent, CCommon
 {
 	public:
-		Enemy(const Vector2& p, float height);
-		bool TakeDamage(int);
-		EnemyCard GetCard();
-		void draw();
-		void move();
-		void PlayCard(const Vector2& center);
-		void ReturnToPosition();
-		EnemyState GetState() { return state; }
-		void SetBack() { state = EnemyState::InPosition; }
-
-		int health;
-		std::string getHeadText() { return std::to_string(health); }
-
-		bool FinishedAttacking();
-		void SetBoss();
-		void Heal(int amount);
-
-		void SetUnavailable();
-		void SetNormal();
-		void Kill();
+		Enemy() {}
+		explicit Enemy(Entity e) : entity(e) {}
+		Entity GetEntity() const { return entity; }
+
+		bool Hit(int health) const;
+		EnemyCard GetCard() const;
+		void PlayCard(const Vector2& center) const;
+		void PlayCardInPlace(float delay, float duration, bool sound) const;
+		void ReturnToPosition() const;
+		EnemyState GetState() const;
+		void SetBack() const;
+		EnemyView GetView() const;
+		void SetIntent(const EnemyCard& card) const;
+
+		const Vector2& GetPos() const;
+		int GetHealth() const;
+		void SetHealth(int h) const;
+
+		bool FinishedAttacking() const;
+		void SetBoss() const;
+		void SetPosition(const Vector2& pos) const;
+		void SetFormationScale(float scale) const;
+		void Heal(int amount) const;
+
+		void SetUnavailable() const;
+		void SetNormal() const;
+		void Kill() const;
 
 	private:
-		EnemyState state;
-		const float speed = 460.0f;
-		const float diff = 15.0f;
-		Vector2 target;
-		Vector2 oldPosition;
-		float height;
-		LEventTimer* animationTimer = nullptr;
-		float attackingTime;
-		const float attackEnd = 2.5f;
-		EnemyAttack attack;
-		LEventTimer* damageTimer = nullptr;
-		EnemyCard nextCard;
-
-		void UpdateFrame();
+		Entity entity;
+
+		template<class t> t& Get() const;
+		eSound GetCardSound() const;
 };
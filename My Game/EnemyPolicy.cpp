@@ -0,0 +1,137 @@
+/// \file EnemyPolicy.cpp
+/// \brief Code for the enemy AI policies.
+
+#include <climits>
+
+#include "Balance.h"
+#include "EnemyPolicy.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Behaviour tables. To change how an enemy kind behaves, edit its table here
+// or install a different policy with `SetEnemyPolicy()`. The numbers come
+// from the balance, see `Balance`.
+
+/// By default, ordinary enemies heal 1-3 with a 70% chance when their health
+/// drops below 3, and otherwise attack for 1-3.
+/// \param b Balance.
+/// \return Behaviour rules.
+
+static std::vector<BehaviourRule> HomeworkRules(const Balance& b){
+  return {
+    {b.m_nHealBelow, b.m_nHealChance, {{EnemyCardType::Heal, b.m_nHeal, b.m_nHealMin, b.m_nHealMax, 1}}},
+    {INT_MAX, 100, {{EnemyCardType::Attack, b.m_nAttack, b.m_nAttackMin, b.m_nAttackMax, 1}}},
+  };
+} //HomeworkRules
+
+/// The boss heals like an ordinary enemy, and by default otherwise attacks
+/// for 3-4.
+/// \param b Balance.
+/// \return Behaviour rules.
+
+static std::vector<BehaviourRule> LameRules(const Balance& b){
+  return {
+    {b.m_nHealBelow, b.m_nHealChance, {{EnemyCardType::Heal, b.m_nHeal, b.m_nHealMin, b.m_nHealMax, 1}}},
+    {INT_MAX, 100, {{EnemyCardType::Attack, b.m_nBossAttack, b.m_nBossAttackMin, b.m_nBossAttackMax, 1}}},
+  };
+} //LameRules
+
+static CTablePolicy g_cHomeworkPolicy(HomeworkRules(Balance())); ///< Ordinary enemy policy.
+static CTablePolicy g_cLamePolicy(LameRules(Balance())); ///< Boss policy.
+
+/// Policy for each enemy kind, indexed by `EnemyAttack`.
+
+static const CEnemyPolicy* g_pPolicy[(size_t)EnemyAttack::Size] = {
+  &g_cHomeworkPolicy, &g_cLamePolicy
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CTablePolicy functions
+
+/// Construct a table policy from its behaviour rules.
+/// \param rules Behaviour rules in priority order.
+
+CTablePolicy::CTablePolicy(const std::vector<BehaviourRule>& rules):
+  m_vRules(rules){
+} //constructor
+
+/// Try each rule in order and use the first one that fires to choose a card.
+/// \param v What the enemy can see.
+/// \param rng Random number generator.
+/// \return The card the enemy will play.
+
+EnemyCard CTablePolicy::Decide(const EnemyView& v, CRng& rng) const{
+  EnemyCard card;
+
+  for(const BehaviourRule& rule: m_vRules){
+    if(v.m_nHealth >= rule.m_nHealthBelow || rule.m_vEntries.empty())
+      continue;
+
+    if(rule.m_nChance < 100 && rng.randn(1, 100) > rule.m_nChance)
+      continue;
+
+    int total = 0;
+    for(const IntentEntry& e: rule.m_vEntries)
+      total += e.m_nWeight;
+
+    int pick = total > 1? rng.randn(0, total - 1): 0;
+    const IntentEntry* p = &rule.m_vEntries.back();
+
+    for(const IntentEntry& e: rule.m_vEntries){
+      if(pick < e.m_nWeight){
+        p = &e;
+        break;
+      } //if
+      pick -= e.m_nWeight;
+    } //for
+
+    card.type = p->m_eType;
+    card.value = p->m_nBase + rng.randn(p->m_nMinBonus, p->m_nMaxBonus);
+    break;
+  } //for
+
+  return card;
+} //Decide
+
+///////////////////////////////////////////////////////////////////////////////
+// Policy registry
+
+/// Get the policy used by an enemy kind.
+/// \param t Enemy kind.
+/// \return Pointer to the policy.
+
+const CEnemyPolicy* GetEnemyPolicy(EnemyAttack t){
+  return g_pPolicy[(size_t)t];
+} //GetEnemyPolicy
+
+/// Replace the policy used by an enemy kind. The caller keeps ownership of
+/// the policy and must keep it alive while it is installed.
+/// \param t Enemy kind.
+/// \param p Pointer to the new policy, or nullptr to restore the default.
+
+void SetEnemyPolicy(EnemyAttack t, const CEnemyPolicy* p){
+  static const CEnemyPolicy* const defaults[] = {&g_cHomeworkPolicy, &g_cLamePolicy};
+  g_pPolicy[(size_t)t] = p? p: defaults[(size_t)t];
+} //SetEnemyPolicy
+
+/// Rebuild the default policies from a balance. Policies installed with
+/// `SetEnemyPolicy()` are left alone.
+/// \param b Balance.
+
+void BalanceEnemyPolicies(const Balance& b){
+  g_cHomeworkPolicy.GetRules() = HomeworkRules(b);
+  g_cLamePolicy.GetRules() = LameRules(b);
+} //BalanceEnemyPolicies
+
+/// Decide the intents of every enemy for the coming enemy turn in a single
+/// pass, in enemy order, so that the random number sequence and therefore
+/// the outcome is the same whether enemies later act one at a time or all
+/// together.
+/// \param pView Array of enemy views.
+/// \param pIntent [out] Array of enemy intents.
+/// \param n Number of enemies.
+/// \param rng Random number generator.
+
+void DecideIntents(const EnemyView* pView, EnemyCard* pIntent, size_t n, CRng& rng){
+  for(size_t i=0; i<n; i++)
+    pIntent[i] = g_pPolicy[(size_t)pView[i].m_eAttack]->Decide(pView[i], rng);
+} //DecideIntents
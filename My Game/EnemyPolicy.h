@@ -0,0 +1,92 @@
+/// \file EnemyPolicy.h
+/// \brief Interface for the enemy AI policies.
+
+#ifndef __L4RC_GAME_ENEMYPOLICY_H__
+#define __L4RC_GAME_ENEMYPOLICY_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "Rng.h"
+
+struct Balance;
+
+enum class EnemyAttack { EndlessHomework, Lame, Size };
+enum class EnemyCardType { Attack, Heal };
+
+/// \brief The card an enemy plays on its turn, also shown as its intent.
+
+struct EnemyCard{
+  EnemyCardType type = EnemyCardType::Attack; ///< Card type.
+  int value = 0; ///< Damage dealt or health restored.
+}; //EnemyCard
+
+/// \brief What an enemy policy gets to look at when making a decision.
+
+struct EnemyView{
+  EnemyAttack m_eAttack = EnemyAttack::EndlessHomework; ///< Enemy kind.
+  int m_nHealth = 0; ///< Enemy health.
+  int m_nPlayerHealth = 0; ///< Player health.
+  int m_nPlayerShield = 0; ///< Player shield.
+}; //EnemyView
+
+/// \brief One weighted row of a behaviour table.
+///
+/// The card value is `m_nBase` plus a random number in
+/// [`m_nMinBonus`, `m_nMaxBonus`].
+
+struct IntentEntry{
+  EnemyCardType m_eType; ///< Card type.
+  int m_nBase; ///< Base value.
+  int m_nMinBonus; ///< Smallest random bonus.
+  int m_nMaxBonus; ///< Largest random bonus.
+  int m_nWeight; ///< Relative chance of choosing this row.
+}; //IntentEntry
+
+/// \brief One rule of a behaviour table.
+///
+/// A rule applies when the enemy's health is below `m_nHealthBelow`, and then
+/// fires with a `m_nChance` percent chance. A rule that fires picks one of its
+/// entries at random by weight.
+
+struct BehaviourRule{
+  int m_nHealthBelow; ///< Health threshold, exclusive.
+  int m_nChance; ///< Percent chance of firing.
+  std::vector<IntentEntry> m_vEntries; ///< Weighted entries.
+}; //BehaviourRule
+
+/// \brief Enemy policy interface.
+///
+/// An enemy policy decides which card an enemy will play next. Policies are
+/// used by both the rendered game and the headless battle simulator, so they
+/// must not depend on the engine.
+
+class CEnemyPolicy{
+  public:
+    virtual ~CEnemyPolicy(){} ///< Destructor.
+    virtual EnemyCard Decide(const EnemyView&, CRng&) const = 0; ///< Choose a card.
+}; //CEnemyPolicy
+
+/// \brief A data-defined enemy policy.
+///
+/// A table of behaviour rules which are tried in order. The first rule that
+/// fires decides the card. If no rule fires the enemy attacks for zero.
+
+class CTablePolicy: public CEnemyPolicy{
+  private:
+    std::vector<BehaviourRule> m_vRules; ///< Behaviour rules in priority order.
+
+  public:
+    CTablePolicy(const std::vector<BehaviourRule>& rules); ///< Constructor.
+    EnemyCard Decide(const EnemyView&, CRng&) const; ///< Choose a card.
+
+    std::vector<BehaviourRule>& GetRules(){ return m_vRules; } ///< Get rules.
+}; //CTablePolicy
+
+const CEnemyPolicy* GetEnemyPolicy(EnemyAttack); ///< Get policy for an enemy kind.
+void SetEnemyPolicy(EnemyAttack, const CEnemyPolicy*); ///< Replace policy for an enemy kind.
+
+void BalanceEnemyPolicies(const Balance&); ///< Rebuild the default policies.
+void DecideIntents(const EnemyView*, EnemyCard*, size_t, CRng&); ///< Decide all intents.
+
+#endif //__L4RC_GAME_ENEMYPOLICY_H__
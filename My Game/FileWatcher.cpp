@@ -0,0 +1,196 @@
+/// \file FileWatcher.cpp
+/// \brief Code for the file watcher CFileWatcher.
+
+#include <algorithm>
+#include <cstdint>
+
+#include "FileWatcher.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#elif defined(__linux__)
+  #include <sys/inotify.h>
+  #include <unistd.h>
+#endif
+
+/// \brief A watched folder.
+
+struct CFileWatcher::Folder{
+  std::string m_strPath; ///< Folder name, as given to `Watch()`.
+
+#ifdef _WIN32
+  HANDLE m_hFolder = INVALID_HANDLE_VALUE; ///< Folder handle.
+  OVERLAPPED m_sOverlapped = {}; ///< The read of changes in progress.
+  DWORD m_pBuffer[4096]; ///< Changes, DWORD aligned as `ReadDirectoryChangesW()` requires.
+#elif defined(__linux__)
+  int m_nWatch = -1; ///< inotify watch descriptor.
+#endif
+}; //Folder
+
+/// Join a folder and a file name. Files in the working folder are given by
+/// name alone.
+/// \param folder Folder.
+/// \param name File name.
+/// \return Path.
+
+static std::string JoinPath(const std::string& folder, const std::string& name){
+  return folder == "."? name: folder + "/" + name;
+} //JoinPath
+
+/// Add a path to a list unless it is there already.
+/// \param list List.
+/// \param path Path.
+
+static void AddOnce(std::vector<std::string>& list, const std::string& path){
+  if(std::find(list.begin(), list.end(), path) == list.end())
+    list.push_back(path);
+} //AddOnce
+
+#ifdef _WIN32
+
+/// Ask Windows for the next changes to a folder, without waiting for them.
+/// \param folder Folder handle.
+/// \param buffer Buffer for the changes.
+/// \param size Buffer size in bytes.
+/// \param o Overlapped read, whose event is set once there are changes.
+/// \return true if the request was made.
+
+static bool Listen(HANDLE folder, DWORD* buffer, DWORD size, OVERLAPPED* o){
+  return ReadDirectoryChangesW(folder, buffer, size, FALSE,
+    FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
+    nullptr, o, nullptr) != 0;
+} //Listen
+
+#endif
+
+/// Start with nothing watched.
+
+CFileWatcher::CFileWatcher(){
+} //constructor
+
+/// Stop watching.
+
+CFileWatcher::~CFileWatcher(){
+  Close();
+} //destructor
+
+/// Watch a folder for files that are written. Subfolders are not watched.
+/// \param folder Folder name.
+/// \return true if the folder is being watched.
+
+bool CFileWatcher::Watch(const char* folder){
+  std::unique_ptr<Folder> f(new Folder);
+  f->m_strPath = folder;
+
+#ifdef _WIN32
+  f->m_hFolder = CreateFileA(folder, FILE_LIST_DIRECTORY,
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+    OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+
+  if(f->m_hFolder == INVALID_HANDLE_VALUE)return false;
+
+  f->m_sOverlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+  if(f->m_sOverlapped.hEvent == nullptr ||
+    !Listen(f->m_hFolder, f->m_pBuffer, sizeof(f->m_pBuffer), &f->m_sOverlapped))
+  {
+    if(f->m_sOverlapped.hEvent)CloseHandle(f->m_sOverlapped.hEvent);
+    CloseHandle(f->m_hFolder);
+    return false;
+  } //if
+#elif defined(__linux__)
+  if(m_nInotify < 0)
+    m_nInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+  if(m_nInotify < 0)return false;
+
+  f->m_nWatch = inotify_add_watch(m_nInotify, folder, IN_CLOSE_WRITE | IN_MOVED_TO);
+  if(f->m_nWatch < 0)return false;
+#else
+  return false;
+#endif
+
+  m_vFolders.push_back(std::move(f));
+  return true;
+} //Watch
+
+/// Stop watching every folder.
+
+void CFileWatcher::Close(){
+#ifdef _WIN32
+  for(std::unique_ptr<Folder>& f: m_vFolders){
+    DWORD bytes = 0;
+    CancelIoEx(f->m_hFolder, &f->m_sOverlapped);
+    GetOverlappedResult(f->m_hFolder, &f->m_sOverlapped, &bytes, TRUE); //the buffer is written until the read ends
+    CloseHandle(f->m_sOverlapped.hEvent);
+    CloseHandle(f->m_hFolder);
+  } //for
+#elif defined(__linux__)
+  if(m_nInotify >= 0)
+    close(m_nInotify); //and with it the watches
+
+  m_nInotify = -1;
+#endif
+
+  m_vFolders.clear();
+} //Close
+
+/// Get the files in the watched folders that were written, or moved or
+/// renamed in, since the last poll. Never waits. Each file is listed once,
+/// however many times it was written.
+/// \param changed [out] Paths of the files, which start with the folder
+///   name unless it is the working folder.
+/// \return Number of files.
+
+size_t CFileWatcher::Poll(std::vector<std::string>& changed){
+  changed.clear();
+
+#ifdef _WIN32
+  for(std::unique_ptr<Folder>& f: m_vFolders){
+    DWORD bytes = 0;
+
+    if(!GetOverlappedResult(f->m_hFolder, &f->m_sOverlapped, &bytes, FALSE))
+      continue; //no changes yet
+
+    const uint8_t* p = (const uint8_t*)f->m_pBuffer;
+
+    while(bytes > 0){ //none if the buffer overflowed, in which case changes are lost
+      const FILE_NOTIFY_INFORMATION* e = (const FILE_NOTIFY_INFORMATION*)p;
+
+      if(e->Action == FILE_ACTION_ADDED || e->Action == FILE_ACTION_MODIFIED ||
+        e->Action == FILE_ACTION_RENAMED_NEW_NAME)
+      {
+        const int n = (int)(e->FileNameLength/sizeof(WCHAR));
+        const int len = WideCharToMultiByte(CP_UTF8, 0, e->FileName, n, nullptr, 0, nullptr, nullptr);
+        std::string name((size_t)len, '\0');
+        WideCharToMultiByte(CP_UTF8, 0, e->FileName, n, &name[0], len, nullptr, nullptr);
+        AddOnce(changed, JoinPath(f->m_strPath, name));
+      } //if
+
+      if(e->NextEntryOffset == 0)break;
+      p += e->NextEntryOffset;
+    } //while
+
+    Listen(f->m_hFolder, f->m_pBuffer, sizeof(f->m_pBuffer), &f->m_sOverlapped);
+  } //for
+#elif defined(__linux__)
+  if(m_nInotify < 0)return 0;
+
+  alignas(inotify_event) char buffer[4096];
+  ssize_t n;
+
+  while((n = read(m_nInotify, buffer, sizeof(buffer))) > 0)
+    for(const char* p=buffer; p<buffer + n; ){
+      const inotify_event* e = (const inotify_event*)p;
+      p += sizeof(inotify_event) + e->len;
+
+      if(e->len == 0 || (e->mask & IN_ISDIR))continue;
+
+      for(const std::unique_ptr<Folder>& f: m_vFolders)
+        if(f->m_nWatch == e->wd)
+          AddOnce(changed, JoinPath(f->m_strPath, e->name));
+    } //for
+#endif
+
+  return changed.size();
+} //Poll
@@ -0,0 +1,45 @@
+/// \file FileWatcher.h
+/// \brief Interface for the file watcher CFileWatcher.
+
+#ifndef __L4RC_GAME_FILEWATCHER_H__
+#define __L4RC_GAME_FILEWATCHER_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/// \brief Watches folders for files that are written.
+///
+/// The operating system says when a file in a watched folder is written, or
+/// moved or renamed into it, so watching costs nothing until something
+/// changes, and polling for changes never waits. Linux uses inotify and is
+/// told once the writer closes the file. Windows uses
+/// `ReadDirectoryChangesW()` and may be told more than once while a file is
+/// being written, so a file that cannot be read yet should be left alone
+/// until the next change. Elsewhere nothing is watched.
+
+class CFileWatcher{
+  private:
+    struct Folder; ///< A watched folder, whose contents depend on the platform.
+
+    std::vector<std::unique_ptr<Folder>> m_vFolders; ///< Watched folders.
+
+#ifdef __linux__
+    int m_nInotify = -1; ///< inotify descriptor.
+#endif
+
+  public:
+    CFileWatcher(); ///< Constructor.
+    ~CFileWatcher(); ///< Destructor.
+
+    CFileWatcher(const CFileWatcher&) = delete; ///< No copying.
+    CFileWatcher& operator=(const CFileWatcher&) = delete; ///< No copying.
+
+    bool Watch(const char* folder); ///< Watch a folder.
+    void Close(); ///< Stop watching.
+    bool IsOpen() const { return !m_vFolders.empty(); } ///< Test whether anything is watched.
+
+    size_t Poll(std::vector<std::string>& changed); ///< Get the files written since the last poll.
+}; //CFileWatcher
+
+#endif //__L4RC_GAME_FILEWATCHER_H__
@@ -0,0 +1,106 @@
+/// \file Formation.cpp
+/// \brief Code for the enemy formation class CFormation.
+
+#include <algorithm>
+#include <cmath>
+
+#include "Formation.h"
+
+/// Create an empty formation with default parameters.
+
+CFormation::CFormation(){
+} //default constructor
+
+/// Create an empty formation.
+/// \param d Formation descriptor.
+
+CFormation::CFormation(const FormationDesc& d):
+  m_sDesc(d){
+} //constructor
+
+/// Choose the column length and scale for a number of enemies. Columns start
+/// at their full-size length and get longer, shrinking the enemies to fit
+/// the available height, until the columns fit the available width.
+/// \param n Number of enemies.
+
+void CFormation::Arrange(size_t n){
+  m_nCount = n;
+  m_nRows = std::max<size_t>(1, std::min(n, m_sDesc.m_nPerColumn));
+  m_fScale = 1.0f;
+
+  const float w = m_sDesc.m_fBackX - m_sDesc.m_fMinX;
+
+  for(size_t r=m_nRows; r<=std::max<size_t>(n, 1); r++){
+    m_nRows = r;
+    m_fScale = std::min(1.0f, m_sDesc.m_fHeight/(r*m_sDesc.m_fCellHeight));
+    m_nCols = (n + r - 1)/r;
+
+    if(m_nCols <= 1 || (m_nCols - 1)*m_sDesc.m_fCellWidth*m_fScale <= w)
+      break;
+  } //for
+
+  m_nCols = (n + m_nRows - 1)/m_nRows;
+} //Arrange
+
+/// Get the number of enemies in a column. Every column is full except
+/// possibly the front one.
+/// \param col Column index, from 0 at the back.
+/// \return Number of enemies in that column.
+
+size_t CFormation::ColumnCount(size_t col) const{
+  const size_t first = col*m_nRows;
+  return first < m_nCount? std::min(m_nRows, m_nCount - first): 0;
+} //ColumnCount
+
+/// Get the vertical position of the first enemy in a column, chosen so that
+/// the column is centered.
+/// \param col Column index.
+/// \return Vertical position of the first enemy.
+
+float CFormation::ColumnTop(size_t col) const{
+  const float dy = m_sDesc.m_fCellHeight*m_fScale;
+  return m_sDesc.m_fCenterY + 0.5f*((float)ColumnCount(col) - 1.0f)*dy;
+} //ColumnTop
+
+/// Get the position of an enemy in the formation.
+/// \param i Enemy index.
+/// \return Position of the enemy.
+
+EnemySlot CFormation::GetSlot(size_t i) const{
+  const size_t col = i/m_nRows;
+  const size_t row = i%m_nRows;
+
+  EnemySlot s;
+  s.x = m_sDesc.m_fBackX - col*m_sDesc.m_fCellWidth*m_fScale;
+  s.y = ColumnTop(col) - row*m_sDesc.m_fCellHeight*m_fScale;
+  return s;
+} //GetSlot
+
+/// Find the enemy under a point by computing its column and row directly.
+/// \param x Horizontal position in world space.
+/// \param y Vertical position in world space.
+/// \return Enemy index, or -1 if the point is not on an enemy.
+
+int CFormation::Pick(float x, float y) const{
+  if(m_nCount == 0)return -1;
+
+  const float dx = m_sDesc.m_fCellWidth*m_fScale;
+  const float dy = m_sDesc.m_fCellHeight*m_fScale;
+
+  const float c = std::floor((m_sDesc.m_fBackX - x)/dx + 0.5f);
+  if(c < 0.0f || c >= (float)m_nCols)return -1;
+  const size_t col = (size_t)c;
+
+  const float top = ColumnTop(col);
+  const float r = std::floor((top - y)/dy + 0.5f);
+  if(r < 0.0f || r >= (float)ColumnCount(col))return -1;
+  const size_t row = (size_t)r;
+
+  const EnemySlot s = GetSlot(col*m_nRows + row);
+
+  if(std::fabs(x - s.x) > 0.5f*m_sDesc.m_fHitWidth*m_fScale ||
+     std::fabs(y - s.y) > 0.5f*m_sDesc.m_fHitHeight*m_fScale)
+    return -1;
+
+  return (int)(col*m_nRows + row);
+} //Pick
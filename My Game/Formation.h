@@ -0,0 +1,68 @@
+/// \file Formation.h
+/// \brief Interface for the enemy formation class CFormation.
+
+#ifndef __L4RC_GAME_FORMATION_H__
+#define __L4RC_GAME_FORMATION_H__
+
+#include <cstddef>
+
+/// \brief The position of an enemy in world space (y up).
+
+struct EnemySlot{
+  float x = 0.0f; ///< Horizontal position.
+  float y = 0.0f; ///< Vertical position.
+}; //EnemySlot
+
+/// \brief Enemy formation descriptor.
+///
+/// Enemies stand in columns on the right of the battle screen, starting with
+/// the back column at `m_fBackX` and filling towards the player. The cell
+/// and hit box sizes are for enemies drawn at full size.
+
+struct FormationDesc{
+  float m_fBackX = 900.0f; ///< Horizontal position of the back column.
+  float m_fMinX = 420.0f; ///< Columns may not come closer than this.
+  float m_fCenterY = 384.0f; ///< Vertical center of every column.
+  float m_fHeight = 688.0f; ///< Height available to a column.
+  float m_fCellWidth = 150.0f; ///< Distance between columns.
+  float m_fCellHeight = 225.0f; ///< Distance between enemies in a column.
+  float m_fHitWidth = 88.0f; ///< Width of an enemy's hit box.
+  float m_fHitHeight = 160.0f; ///< Height of an enemy's hit box.
+  size_t m_nPerColumn = 3; ///< Enemies per column at full size.
+}; //FormationDesc
+
+/// \brief The enemy formation.
+///
+/// Lays out any number of enemies in a grid of columns. Up to six enemies
+/// stand in two columns of three at full size, exactly as before. Larger
+/// encounters get longer columns and a smaller scale, chosen so that the grid
+/// fits the space in front of the player. All of the work is done in
+/// `Arrange()`, so that finding a slot or picking the enemy under the mouse
+/// is constant time however many enemies there are.
+
+class CFormation{
+  private:
+    FormationDesc m_sDesc; ///< Formation parameters.
+    size_t m_nCount = 0; ///< Number of enemies.
+    size_t m_nRows = 1; ///< Number of enemies in a full column.
+    size_t m_nCols = 0; ///< Number of columns.
+    float m_fScale = 1.0f; ///< Enemy scale.
+
+    size_t ColumnCount(size_t col) const; ///< Number of enemies in a column.
+    float ColumnTop(size_t col) const; ///< Position of first enemy in a column.
+
+  public:
+    CFormation(); ///< Default constructor.
+    CFormation(const FormationDesc&); ///< Constructor.
+
+    void Arrange(size_t n); ///< Compute the formation for n enemies.
+    EnemySlot GetSlot(size_t i) const; ///< Get position of enemy i.
+    int Pick(float x, float y) const; ///< Get enemy under a point.
+
+    float GetScale() const { return m_fScale; } ///< Get enemy scale.
+    size_t GetCount() const { return m_nCount; } ///< Get number of enemies.
+    size_t GetColumns() const { return m_nCols; } ///< Get number of columns.
+    size_t GetRows() const { return m_nRows; } ///< Get column length.
+}; //CFormation
+
+#endif //__L4RC_GAME_FORMATION_H__
@@ -0,0 +1,170 @@
+/// \file FrameGate.cpp
+/// \brief Code for the frame cost gate CFrameGate.
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "FrameGate.h"
+
+/// Record the cost of a frame drawn on a screen.
+/// \param screen Screen name.
+/// \param c Cost of the frame.
+
+void CFrameGate::Add(const char* screen, const FrameCost& c){
+  size_t i = 0;
+
+  while(i < m_vNames.size() && m_vNames[i] != screen)
+    i++;
+
+  if(i == m_vNames.size()){
+    m_vNames.push_back(screen);
+    m_vFrames.emplace_back();
+  } //if
+
+  m_vFrames[i].push_back(c);
+} //Add
+
+/// Get the cost of each screen: the median frame time and the largest
+/// counts of any frame.
+/// \return Screen costs, in the order the screens were first seen.
+
+std::vector<ScreenCost> CFrameGate::GetCosts() const{
+  std::vector<ScreenCost> v(m_vNames.size());
+
+  for(size_t i=0; i<v.size(); i++){
+    const std::vector<FrameCost>& frames = m_vFrames[i];
+    FrameCost& c = v[i].m_sCost;
+    std::vector<double> t;
+
+    for(const FrameCost& f: frames){
+      t.push_back(f.m_fMilliseconds);
+      c.m_nDraws = std::max(c.m_nDraws, f.m_nDraws);
+      c.m_nTextureSwitches = std::max(c.m_nTextureSwitches, f.m_nTextureSwitches);
+      c.m_nTextDraws = std::max(c.m_nTextDraws, f.m_nTextDraws);
+      c.m_nAllocations = std::max(c.m_nAllocations, f.m_nAllocations);
+    } //for
+
+    std::nth_element(t.begin(), t.begin() + t.size()/2, t.end());
+    c.m_fMilliseconds = t[t.size()/2];
+    v[i].m_strName = m_vNames[i];
+  } //for
+
+  return v;
+} //GetCosts
+
+/// Compare the cost of each screen with its budget and write one line per
+/// screen to a report, measured cost over budget for each number. A screen
+/// with no budget fails, so that a new screen cannot slip past the gate.
+/// \param budgets Budgets.
+/// \param report File to write the report to, or nullptr for none.
+/// \return true if every screen is within its budget.
+
+bool CFrameGate::Check(const std::vector<ScreenCost>& budgets, FILE* report) const{
+  bool passed = true;
+
+  for(const ScreenCost& s: GetCosts()){
+    auto p = std::find_if(budgets.begin(), budgets.end(),
+      [&](const ScreenCost& b){ return b.m_strName == s.m_strName; });
+
+    if(p == budgets.end()){
+      if(report)fprintf(report, "%-10s no budget FAILED\n", s.m_strName.c_str());
+      passed = false;
+      continue;
+    } //if
+
+    const FrameCost& c = s.m_sCost;
+    const FrameCost& b = p->m_sCost;
+
+    const bool ok = c.m_fMilliseconds <= b.m_fMilliseconds &&
+      c.m_nDraws <= b.m_nDraws && c.m_nTextureSwitches <= b.m_nTextureSwitches &&
+      c.m_nTextDraws <= b.m_nTextDraws && c.m_nAllocations <= b.m_nAllocations;
+
+    if(report)
+      fprintf(report, "%-10s ms %.2f/%.2f draws %zu/%zu switches %zu/%zu "
+        "texts %zu/%zu allocs %zu/%zu %s\n", s.m_strName.c_str(),
+        c.m_fMilliseconds, b.m_fMilliseconds, c.m_nDraws, b.m_nDraws,
+        c.m_nTextureSwitches, b.m_nTextureSwitches, c.m_nTextDraws, b.m_nTextDraws,
+        c.m_nAllocations, b.m_nAllocations, ok? "ok": "FAILED");
+
+    passed = passed && ok;
+  } //for
+
+  return passed;
+} //Check
+
+/// Read a budget file. Each line is a screen name followed by its budget:
+/// milliseconds, draws, texture switches, text draws and allocations per
+/// frame. Lines starting with `#` are comments.
+/// \param path File name.
+/// \param v [out] Budgets.
+/// \return false if the file cannot be read or has a line that does not
+/// parse.
+
+bool CFrameGate::LoadBudgets(const char* path, std::vector<ScreenCost>& v){
+  std::ifstream input(path);
+  if(!input)return false;
+
+  std::vector<ScreenCost> loaded;
+  std::string line;
+
+  while(std::getline(input, line)){
+    const size_t start = line.find_first_not_of(" \t\r");
+    if(start == std::string::npos || line[start] == '#')continue;
+
+    char name[32];
+    ScreenCost s;
+    FrameCost& c = s.m_sCost;
+
+    if(sscanf(line.c_str() + start, "%31s %lf %zu %zu %zu %zu", name, &c.m_fMilliseconds,
+      &c.m_nDraws, &c.m_nTextureSwitches, &c.m_nTextDraws, &c.m_nAllocations) != 6)
+      return false;
+
+    s.m_strName = name;
+    loaded.push_back(s);
+  } //while
+
+  v = loaded;
+  return true;
+} //LoadBudgets
+
+/// Write budgets to a file that `LoadBudgets()` reads.
+/// \param path File name.
+/// \param v Budgets.
+/// \return true if the file was written.
+
+bool CFrameGate::SaveBudgets(const char* path, const std::vector<ScreenCost>& v){
+  FILE* output = fopen(path, "w");
+  if(output == nullptr)return false;
+
+  fprintf(output, "# screen       ms draws switches texts allocs\n");
+
+  for(const ScreenCost& s: v){
+    const FrameCost& c = s.m_sCost;
+    fprintf(output, "%-10s %6.1f %5zu %8zu %5zu %6zu\n", s.m_strName.c_str(),
+      c.m_fMilliseconds, c.m_nDraws, c.m_nTextureSwitches, c.m_nTextDraws, c.m_nAllocations);
+  } //for
+
+  return fclose(output) == 0;
+} //SaveBudgets
+
+/// Make budgets from measured costs. The counts do not depend on the
+/// machine, so they are kept as they are. Frame times do, so they get some
+/// headroom and half a millisecond on top, for screens that cost next to
+/// nothing, rounded up to a tenth of a millisecond.
+/// \param costs Measured costs.
+/// \param headroom Fraction of the frame time to allow on top.
+/// \return Budgets.
+
+std::vector<ScreenCost> CFrameGate::MakeBudgets(const std::vector<ScreenCost>& costs,
+  double headroom)
+{
+  std::vector<ScreenCost> v(costs);
+
+  for(ScreenCost& s: v){
+    double& t = s.m_sCost.m_fMilliseconds;
+    t = ceil((t*(1.0 + headroom) + 0.5)*10.0)/10.0;
+  } //for
+
+  return v;
+} //MakeBudgets
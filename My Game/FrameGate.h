@@ -0,0 +1,55 @@
+/// \file FrameGate.h
+/// \brief Interface for the frame cost gate CFrameGate.
+
+#ifndef __L4RC_GAME_FRAMEGATE_H__
+#define __L4RC_GAME_FRAMEGATE_H__
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// \brief What it costs to draw a frame.
+
+struct FrameCost{
+  double m_fMilliseconds = 0.0; ///< CPU time.
+  size_t m_nDraws = 0; ///< Sprite draw calls.
+  size_t m_nTextureSwitches = 0; ///< Draws that use a different texture from the one before.
+  size_t m_nTextDraws = 0; ///< Text draw calls.
+  size_t m_nAllocations = 0; ///< Heap allocations.
+}; //FrameCost
+
+/// \brief The cost of a screen, or the most it is allowed to cost.
+
+struct ScreenCost{
+  std::string m_strName; ///< Screen name.
+  FrameCost m_sCost; ///< Cost per frame.
+}; //ScreenCost
+
+/// \brief The frame cost gate.
+///
+/// Collects the cost of every frame drawn on each screen, then compares
+/// each screen with its budget. A screen costs the median of its frame
+/// times, so that a frame or two lost to the operating system does not fail
+/// the gate, and the most draws, texture switches, text draws and
+/// allocations of any of its frames. Budgets are kept in a text file, one
+/// screen per line, so that a change that makes a screen dearer has to
+/// change the file too.
+
+class CFrameGate{
+  private:
+    std::vector<std::string> m_vNames; ///< Screen names, in the order first seen.
+    std::vector<std::vector<FrameCost>> m_vFrames; ///< Frame costs by screen.
+
+  public:
+    void Add(const char* screen, const FrameCost& c); ///< Record a frame.
+    std::vector<ScreenCost> GetCosts() const; ///< Get the cost of each screen.
+    bool Check(const std::vector<ScreenCost>& budgets, FILE* report) const; ///< Compare costs with budgets.
+
+    static bool LoadBudgets(const char* path, std::vector<ScreenCost>& v); ///< Read a budget file.
+    static bool SaveBudgets(const char* path, const std::vector<ScreenCost>& v); ///< Write a budget file.
+    static std::vector<ScreenCost> MakeBudgets(const std::vector<ScreenCost>& costs,
+      double headroom); ///< Make budgets from costs.
+}; //CFrameGate
+
+#endif //__L4RC_GAME_FRAMEGATE_H__
@@ -1,17 +1,118 @@
 /// \file Game.cpp
 /// \brief Code for the game class CGame.
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
 #include <fstream>
+#include "Balance.h"
 #include "Game.h"
+#include "MemoryUsage.h"
+#include "Platform.h"
+#include "Profiler.h"
+#include "SeedCatalog.h"
+#include "Snapshot.h"
 
 #include "GameDefines.h"
 #include "SpriteRenderer.h"
 #include "ComponentIncludes.h"
-#include "WindowDesc.h"
-#include "Windows.h"
 #include "Window.h"
 
-#include "shellapi.h"
+static const char* g_pSaveFile = "save.bin"; ///< Run snapshot file.
+static const char* g_pSeedCatalog = "seeds.cat"; ///< Named run seeds.
+static const char* g_pBalanceFile = "balance.txt"; ///< Tuned balance.
+static const char* g_pFrameBudgetFile = "framebudget.txt"; ///< Frame cost budgets.
+static const char* g_pFrameGateFile = "framegate.txt"; ///< Frame cost gate report.
+static const char* g_pTelemetryFile = "telemetry.bin"; ///< Gameplay telemetry log.
+static const char* g_pSettingsFile = "Media/XML/gamesettings.xml"; ///< Game settings.
+
+/// Folder watched for a changed balance while the game runs, see
+/// `CGame::HotReload()`.
+
+static const char* g_pBalanceFolder = ".";
+
+/// Folders watched for changed settings, images and sounds while the game
+/// runs, where the platform can read them again, see `CanReloadAssets()`.
+
+static const char* g_pAssetFolder[] = {"Media/XML", "Media/Images", "Media/Sounds"};
+
+/// Screens measured by the frame cost gate, in order, see `CGame::GateSetup()`.
+
+static const char* g_pGateScreen[] = {
+  "menu", "intro", "map", "battle1", "battle2", "battle3", "battle4",
+  "battle5", "battle6", "battle500", "newcard", "nerd", "win", "lose"
+}; //g_pGateScreen
+
+static const size_t g_nGateScreens = sizeof(g_pGateScreen)/sizeof(g_pGateScreen[0]); ///< Number of gate screens.
+
+/// \brief A sprite and the game states that draw it.
+
+struct SpriteAsset{
+  eSprite m_eSprite; ///< Sprite type.
+  const char* m_pName; ///< Sprite tag in `gamesettings.xml`.
+  uint32_t m_nStates; ///< Bit mask of the game states that draw it.
+}; //SpriteAsset
+
+static const uint32_t g_nMenuAssets = 1u << GameState::Menu; ///< Menu screen.
+static const uint32_t g_nIntroAssets = 1u << GameState::Intro; ///< Intro screen.
+static const uint32_t g_nMapAssets = 1u << GameState::Map; ///< Map screen.
+static const uint32_t g_nBattleAssets = 1u << GameState::Battle; ///< Battle screen.
+static const uint32_t g_nNewCardAssets = 1u << GameState::NewCard; ///< Card upgrade screen.
+static const uint32_t g_nNerdAssets = 1u << GameState::Nerd; ///< Special card level screen.
+static const uint32_t g_nGameOverAssets = 1u << GameState::GameOver; ///< Win and lose screens.
+
+/// The sprites, with the states that draw them. Spritesheets come before
+/// the sprites cut from them.
+
+static const SpriteAsset g_pSpriteAsset[] = {
+  {eSprite::MenuBackground, "menuBackground", g_nMenuAssets},
+  {eSprite::PlayButton, "playButton", g_nMenuAssets},
+  {eSprite::IntroBackground, "introBackground", g_nIntroAssets},
+  {eSprite::MapBackground, "mapBackground", g_nMapAssets},
+  {eSprite::Node, "node", g_nMapAssets},
+  {eSprite::Line, "line", g_nMapAssets},
+  {eSprite::DoorClosed, "doorClosed", g_nMapAssets},
+  {eSprite::DoorOpen, "doorOpen", g_nMapAssets},
+  {eSprite::Checkmark, "checkmark", g_nMapAssets},
+  {eSprite::Nerd, "nerd", g_nMapAssets},
+  {eSprite::PlayerSpritesheet, "PlayerSpritesheet", g_nBattleAssets},
+  {eSprite::EnemySpritesheet, "EnemySpritesheet", g_nBattleAssets},
+  {eSprite::EnemyRunning, "EnemyRunning", g_nBattleAssets},
+  {eSprite::Player, "player", g_nBattleAssets},
+  {eSprite::PlayerRunning, "PlayerRunning", g_nBattleAssets},
+  {eSprite::Enemy, "enemy", g_nBattleAssets},
+  {eSprite::Background, "background", g_nBattleAssets},
+  {eSprite::BookSpritesheet, "BookSpritesheet", g_nBattleAssets},
+  {eSprite::BookTurning, "BookTurning", g_nBattleAssets},
+  {eSprite::Paper, "paper", g_nBattleAssets},
+  {eSprite::Boss, "boss", g_nBattleAssets},
+  {eSprite::Laptop, "laptop", g_nBattleAssets},
+  {eSprite::Calendar, "calendar", g_nBattleAssets},
+  {eSprite::Card, "card", g_nBattleAssets | g_nNewCardAssets},
+  {eSprite::CardDamage, "cardDamage", g_nBattleAssets | g_nNewCardAssets},
+  {eSprite::CardHealth, "cardHealth", g_nBattleAssets | g_nNewCardAssets},
+  {eSprite::CardShield, "cardShield", g_nBattleAssets | g_nNewCardAssets},
+  {eSprite::CardBackground, "cardBackground", g_nNewCardAssets},
+  {eSprite::NerdBackground, "nerdBackground", g_nNerdAssets},
+  {eSprite::WinBackground, "winBackground", g_nGameOverAssets},
+  {eSprite::LoseBackground, "loseBackground", g_nGameOverAssets},
+  {eSprite::PlayAgainButton, "playAgainButton", g_nGameOverAssets},
+}; //g_pSpriteAsset
+
+/// The state most likely to come next after each state, indexed by
+/// `GameState`, whose assets are loaded ahead of time. The special card
+/// level and the end of the run are rare enough to be loaded when reached.
+
+static const uint32_t g_pPrefetch[] = {
+  g_nBattleAssets, //Map
+  g_nNewCardAssets, //Battle
+  g_nMenuAssets, //GameOver
+  g_nIntroAssets, //Menu
+  g_nMapAssets, //NewCard
+  g_nMapAssets, //Intro
+  g_nMapAssets, //Nerd
+}; //g_pPrefetch
 
 /// Delete the object manager. The renderer needs to be deleted before this
 /// destructor runs so it will be done elsewhere.
@@ -20,105 +121,241 @@ CGame::~CGame(){
   delete m_pObjectManager;
 } //destructor
 
-/// Create the renderer and the object manager, load images and sounds, and
-/// begin the game.
+/// Create the renderer and the object manager, start loading images and
+/// sounds, and begin the game. The menu is shown as soon as its own images
+/// are in, see `LoadAssets()`, except for the soak test and the frame cost
+/// gate, which load everything first and never unload any of it. The soak
+/// test also records its draws without drawing their pixels, see
+/// `SetRaster()`. A tuned balance in `balance.txt` replaces the defaults. Normal play is recorded in the telemetry log, and
+/// the files the game reads are watched for changes, see `HotReload()`.
 
 void CGame::Initialize(){
   m_pRenderer = new LSpriteRenderer(eSpriteMode::Batched2D); 
   m_pRenderer->Initialize(eSprite::Size); 
   LoadImages(); //load images from xml file list
 
+  m_cHandLayout = CHandLayout(CHandLayout::Preset(eLayout::Hand));
+  m_cDrawLayout = CHandLayout(CHandLayout::Preset(eLayout::DrawPreview));
+  m_cUpgradeLayout = CHandLayout(CHandLayout::Preset(eLayout::Upgrade));
+
   m_pObjectManager = new CObjectManager; //set up the object manager 
   LoadSounds(); //load the sounds for this game
 
+  assetThreads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+  m_cAssets.Start(assetThreads);
+
+  if(soakRuns > 0 || gating){
+    assetBudget = SIZE_MAX;
+    m_pRenderer->BeginResourceUpload();
+    m_cAssets.Wait(~0u);
+    m_pRenderer->EndResourceUpload();
+  } //if
+
+  if(soakRuns > 0) //the soak test does not look at the pixels
+    SetRaster(m_pRenderer, false);
+
+  Balance balance;
+
+  if(LoadBalance(g_pBalanceFile, balance)) //tuned balance, if any
+    SetBalance(balance);
+
+  if(soakRuns == 0 && !gating && !m_cTelemetry.Open(g_pTelemetryFile))
+    fprintf(stderr, "cannot write %s\n", g_pTelemetryFile);
+
+  if(soakRuns == 0 && !gating){
+    m_cWatcher.Watch(g_pBalanceFolder);
+
+    if(CanReloadAssets())
+      for(const char* folder: g_pAssetFolder)
+        m_cWatcher.Watch(folder);
+  } //if
+
   BeginGame();
+
+  if(soakRuns == 0 && !seededRun) //pick up the run left at the last exit, if any
+    LoadRun(g_pSaveFile);
 } //Initialize
 
-/// Load the specific images needed for this game. This is where `eSprite`
-/// values from `GameDefines.h` get tied to the names of sprite tags in
-/// `gamesettings.xml`. Those sprite tags contain the name of the corresponding
-/// image file. If the image tag or the image file are missing, then the game
-/// should abort from deeper in the Engine code leaving you with an error
-/// message in a dialog box.
+/// Queue the images needed for this game. This is where `eSprite` values
+/// from `GameDefines.h` get tied to the names of sprite tags in
+/// `gamesettings.xml`. Those sprite tags contain the name of the
+/// corresponding image file. Images are decoded on the asset loader's
+/// threads and loaded into the renderer on the main thread, see
+/// `LoadAssets()`.
 
 void CGame::LoadImages(){  
-  m_pRenderer->BeginResourceUpload();
-
-  m_pRenderer->Load(eSprite::PlayerSpritesheet, "PlayerSpritesheet");
-  m_pRenderer->Load(eSprite::EnemySpritesheet, "EnemySpritesheet");
-  m_pRenderer->Load(eSprite::EnemyRunning, "EnemyRunning");
-  m_pRenderer->Load(eSprite::Player, "player");
-  m_pRenderer->Load(eSprite::PlayerRunning, "PlayerRunning");
-  m_pRenderer->Load(eSprite::Enemy, "enemy");
-  m_pRenderer->Load(eSprite::Card, "card");
-  m_pRenderer->Load(eSprite::Background, "background");
-  m_pRenderer->Load(eSprite::Node, "node");
-  m_pRenderer->Load(eSprite::Line, "line");
-  m_pRenderer->Load(eSprite::DoorClosed, "doorClosed");
-  m_pRenderer->Load(eSprite::DoorOpen, "doorOpen");
-  m_pRenderer->Load(eSprite::MapBackground, "mapBackground");
-  m_pRenderer->Load(eSprite::Checkmark, "checkmark");
-  m_pRenderer->Load(eSprite::WinBackground, "winBackground");
-  m_pRenderer->Load(eSprite::LoseBackground, "loseBackground");
-  m_pRenderer->Load(eSprite::BookSpritesheet, "BookSpritesheet");
-  m_pRenderer->Load(eSprite::BookTurning, "BookTurning");
-  m_pRenderer->Load(eSprite::Paper, "paper");
-  m_pRenderer->Load(eSprite::Boss, "boss");
-  m_pRenderer->Load(eSprite::Nerd, "nerd");
-  m_pRenderer->Load(eSprite::MenuBackground, "menuBackground");
-  m_pRenderer->Load(eSprite::PlayButton, "playButton");
-  m_pRenderer->Load(eSprite::CardBackground, "cardBackground");
-  m_pRenderer->Load(eSprite::Laptop, "laptop");
-  m_pRenderer->Load(eSprite::IntroBackground, "introBackground");
-  m_pRenderer->Load(eSprite::PlayAgainButton, "playAgainButton");
-  m_pRenderer->Load(eSprite::Calendar, "calendar");
-  m_pRenderer->Load(eSprite::CardDamage, "cardDamage");
-  m_pRenderer->Load(eSprite::CardHealth, "cardHealth");
-  m_pRenderer->Load(eSprite::CardShield, "cardShield");
-  m_pRenderer->Load(eSprite::NerdBackground, "nerdBackground");
-
-  m_pRenderer->EndResourceUpload();
+  PROFILE_ZONE("LoadImages");
+
+  for(const SpriteAsset& a: g_pSpriteAsset)
+    m_cAssets.Add(a.m_nStates,
+      [this, a](){PrepareSprite(m_pRenderer, a.m_pName);},
+      [this, a](){m_pRenderer->Load(a.m_eSprite, a.m_pName);},
+      [this, a](){UnloadSprite(m_pRenderer, a.m_eSprite);});
 } //LoadImages
 
-/// Initialize the audio player and load game sounds.
+/// Initialize the audio player and queue the game sounds. They are only
+/// heard in battle, so they load with the battle screen.
 
 void CGame::LoadSounds(){
+  PROFILE_ZONE("LoadSounds");
+
+  static const std::pair<eSound, const char*> sound[] = {
+    {eSound::StudyTime, "StudyTime"},
+    {eSound::EndlessHomework, "EndlessHomework"},
+    {eSound::Lame, "Lame"},
+    {eSound::PlayerDamage, "PlayerDamage"},
+    {eSound::EnemyDamage, "EnemyDamage"},
+    {eSound::Auto, "auto"},
+    {eSound::PowerNap, "PowerNap"},
+    {eSound::Time, "Time"},
+  }; //sound
+
   m_pAudio->Initialize(eSound::Size);
-  m_pAudio->Load(eSound::StudyTime, "StudyTime");
-  m_pAudio->Load(eSound::EndlessHomework, "EndlessHomework");
-  m_pAudio->Load(eSound::Lame, "Lame");
-  m_pAudio->Load(eSound::PlayerDamage, "PlayerDamage");
-  m_pAudio->Load(eSound::EnemyDamage, "EnemyDamage");
-  m_pAudio->Load(eSound::Auto, "auto");
-  m_pAudio->Load(eSound::PowerNap, "PowerNap");
-  m_pAudio->Load(eSound::Time, "Time");
+
+  for(const auto& s: sound)
+    m_cAssets.Add(g_nBattleAssets, nullptr,
+      [this, s](){m_pAudio->Load(s.first, s.second);},
+      [this, s](){UnloadSound(m_pAudio, s.first);});
 } //LoadSounds
 
-/// Release all of the DirectX12 objects by deleting the renderer.
+/// Keep the assets of the current state loaded, and those of the state
+/// likely to come next loading in the background, the current state's
+/// first. If the current state has just been reached and some of its own
+/// assets are not loaded yet, wait for those, and only those. The renderer
+/// is only asked to batch an upload when there is something to upload. Then,
+/// while assets take more memory than the budget, unload those of the states
+/// used least recently. Only the headless platform can unload them. On
+/// Windows `GetAssetBytes()` is 0, so nothing is ever unloaded there.
+
+void CGame::LoadAssets(){
+  PROFILE_ZONE("LoadAssets");
+
+  const uint32_t needed = 1u << state;
+  const uint32_t wanted = needed | g_pPrefetch[state];
+
+  if((int)state != assetState){ //put the new state first, then the ones after it
+    for(size_t g=0; g<CAssetLoader::MaxGroups; g++)
+      if(g_pPrefetch[state] >> g & 1)
+        m_cAssets.Prioritize(g);
+
+    m_cAssets.Prioritize(state);
+    assetState = state;
+  } //if
+
+  m_cAssets.Touch(wanted);
+  m_cAssets.Request(wanted);
+
+  const bool ready = m_cAssets.IsReady(needed);
+
+  if(!ready || m_cAssets.HasWork()){
+    m_pRenderer->BeginResourceUpload();
+
+    if(ready)m_cAssets.Update(assetMilliseconds);
+    else m_cAssets.Wait(needed);
+
+    m_pRenderer->EndResourceUpload();
+  } //if
+
+  while(GetAssetBytes(m_pRenderer, m_pAudio) > assetBudget && m_cAssets.Evict(wanted));
+} //LoadAssets
+
+/// Read again the files that changed since the last frame. The settings
+/// may change any sprite or sound, so the loaded ones are looked up in them
+/// again, with the asset loader stopped while they are, since its threads
+/// look sprites up too. A changed image or sound is read again if it is
+/// loaded, and otherwise will be when it is next loaded. A changed balance
+/// applies to whatever is made or upgraded from then on. Objects refer to
+/// sprites and sounds by type, so they carry on with the new ones as they
+/// are. Only the balance is watched on Windows, where the settings, images
+/// and sounds cannot be read again, see `CanReloadAssets()`.
+
+void CGame::HotReload(){
+  std::vector<std::string> changed;
+  if(m_cWatcher.Poll(changed) == 0)return;
+
+  PROFILE_ZONE("HotReload");
+
+  for(const std::string& path: changed){
+    const char* p = path.c_str();
+
+    if(path == g_pSettingsFile){
+      m_cAssets.Stop();
+      const int n = ReloadSettingsFile(m_pRenderer, m_pAudio);
+      m_cAssets.Start(assetThreads);
+
+      if(n >= 0)
+        fprintf(stderr, "reloaded %s, %d sprites and sounds changed\n", p, n);
+    } //if
+
+    else if(path == g_pBalanceFile){
+      Balance balance;
+
+      if(LoadBalance(p, balance)){
+        SetBalance(balance);
+        fprintf(stderr, "reloaded %s\n", p);
+      } //if
+
+      else fprintf(stderr, "cannot read %s\n", p);
+    } //else if
+
+    else if(ReloadImage(m_pRenderer, p) || ReloadSound(m_pAudio, p) > 0)
+      fprintf(stderr, "reloaded %s\n", p);
+  } //for
+} //HotReload
+
+/// Save the run if it is at a point where it can be resumed, or throw the
+/// save away if the run is over, then close the telemetry log, stop the
+/// asset loader and release all of the DirectX12 objects by deleting the
+/// renderer.
 
 void CGame::Release(){
+  if(soakRuns == 0 && !gating){
+    if(CanSaveRun())SaveRun(g_pSaveFile);
+    else if(gameOver || state == GameState::Menu)remove(g_pSaveFile);
+  } //if
+
+  m_cTelemetry.Close();
+  m_cWatcher.Close();
+  m_cAssets.Stop(); //its threads may be using the renderer
   delete m_pRenderer;
   m_pRenderer = nullptr; //for safety
 } //Release
 
-/// Ask the object manager to create the game objects.
+/// Ask the object manager to create the game objects. The map is generated
+/// from the run seed itself, as the seed search tool does, so a catalog run
+/// gets the map it was picked for. The enemies and the draws are seeded from
+/// it too, so everyone playing it sees the same run.
 
 void CGame::CreateObjects(){
-  rng = new LRandom();
+  const uint64_t seed = seededRun? runSeed: (uint64_t)time(0);
+  m_cMapRng.Seed(seed);
+  m_cEnemyRng.Seed(seed + 1);
   
-  player = (Player*)m_pObjectManager->create(eSprite::Player, Vector2(125, 430));
+  player = m_pObjectManager->CreatePlayer(Vector2(125, 430));
+
+  if(seededRun)
+    player.GetPiles().Seed(seed + 2);
+
+  startSeed = seed;
 } //CreateObjects
 
 /// Call this function to start a new game. This should be re-entrant so that
 /// you can restart a new game without having to shut down and restart the
 /// program. All we need to do is delete any old objects out of the object
 /// manager and create some new ones.
+/// \param pMap Map to play on, or `nullptr` to generate a new one.
 
-void CGame::BeginGame(){  
+void CGame::BeginGame(const MapDesc* pMap){  
   m_pObjectManager->ClearEnemies();
   m_pObjectManager->ClearNodes();
   m_pObjectManager->clear(); //clear old objects
+  m_cEncounter.Clear();
+  m_bBattle = false;
   CreateObjects(); //create new objects 
+
+  m_cHandLayout.Arrange(handSize);
+  m_cUpgradeLayout.Arrange(player.GetDeck().size());
+  nextHand();
   replaceCards();
 
   gameOver = false;
@@ -127,303 +364,68 @@ void CGame::BeginGame(){
 
   layers.clear();
   levelAdjacencyLists.clear();
-  currentlyUnlockedNodes.clear();
 
-  //Generate levels
-  const int numLayers = 5;
-  int currID = 0;
-  for (int i = 0; i < numLayers; i++)
+  //Generate levels, unless given a map small enough to track progress on.
+  //Generated maps always are
+  if (pMap && progress.Build(*pMap))
+      m_sMap = *pMap;
+  else
+  {
+      CMapGenerator::Generate(m_cMapRng, m_sMap);
+      progress.Build(m_sMap);
+      m_cTelemetry.Record(eTelemetry::RunStart, (int)(startSeed & 0xFFFF), (int)(startSeed >> 16 & 0xFFFF),
+          (int)(startSeed >> 32 & 0xFFFF), (int)(startSeed >> 48), player.GetHealth());
+  }
+
+  for (const auto& mapLayer : m_sMap.m_vLayers)
   {
       std::vector<Node> layer;
 
-      int levelsInLayer = rng->randn(1, 4);
-      if (i == 0 || i == numLayers - 1)
-         levelsInLayer = 1;
-      else
-      {
-          if (levelsInLayer == 1)
-              levelsInLayer += rng->randn(0, 1);
-      }
-      
-      for (int j = 0; j < levelsInLayer; j++)
+      for (const MapNode& mapNode : mapLayer)
       {
           Node newNode;
-          newNode.id = currID;
-          newNode.layer = i;
-          currID++;
-
-          //Position the node within map
-          int base = 300;
-          if (levelsInLayer < 4)
-              base += 400 / (levelsInLayer + 1);
-
-          int divisor = levelsInLayer;
-          if (levelsInLayer == 4)
-              divisor--;
-
-          int multiplier = levelsInLayer * 100;
-          if (levelsInLayer == 2)
-          {
-              multiplier *= 2;
-              divisor++;
-          }
-
-          newNode.position = Vector2(base + (multiplier / divisor) * j, 125 * i + 150);
-
-          //Determine number of enemies in level
-          newNode.numEnemies = rng->randn(1, i + 1);
-
-          if (i == 0 || i == numLayers - 1)
-              newNode.numEnemies = 1;
+          newNode.id = mapNode.m_nId;
+          newNode.layer = mapNode.m_nLayer;
+          newNode.position = Vector2((float)mapNode.x, (float)mapNode.y);
+          newNode.numEnemies = mapNode.m_nEnemies;
+          newNode.special = mapNode.m_bSpecial;
 
           layer.push_back(newNode);
 
-          auto nodeObj = (NodeObject*)m_pObjectManager->create(eSprite::Node, newNode.position);
-          nodeObj->numEnemies = newNode.numEnemies;
+          m_pObjectManager->CreateNode(newNode.position).SetEnemies(newNode.numEnemies);
       }
 
       layers.push_back(layer);
   }
 
-  //Set and unlock first level
-  layers[0][0].unlocked = true;
+  //Start on the first level
   currLevel = 0;
   currLayer = 0;
-  m_pObjectManager->UnlockLevel(0);
-  currentlyUnlockedNodes.push_back(&layers[0][0]);
-
-  //Generate adjacency lists
 
-  std::vector<AdjacencyListEntry> firstLevelAdjacencyList;
+  //Point the adjacency lists at the levels, which are in layer order
+  std::vector<Node*> nodes;
 
-  //Connect first level to all levels in next layer
-  for (int i = 0; i < layers[1].size(); i++)
-  {
-      AdjacencyListEntry entry;
-      entry.from = &layers[0][0];
-      entry.to = &layers[1][i];
-      firstLevelAdjacencyList.push_back(entry);
-  }
-  levelAdjacencyLists.push_back(firstLevelAdjacencyList);
+  for (auto& layer : layers)
+      for (auto& node : layer)
+          nodes.push_back(&node);
 
-  //Connect inner layers
-  for (int i = 1; i < numLayers - 2; i++)
+  for (const auto& mapList : m_sMap.m_vAdjacency)
   {
-      int currLayerSize = layers[i].size();
-      int nextLayerSize = layers[i + 1].size();
-
-      //If same size, connect like to like
-      if (currLayerSize == nextLayerSize)
-      {
-          for (int j = 0; j < currLayerSize; j++)
-          {
-              std::vector<AdjacencyListEntry> levelAdjacencyList;
-              AdjacencyListEntry entry;
-              entry.from = &layers[i][j];
-              entry.to = &layers[i + 1][j];
-
-              levelAdjacencyList.push_back(entry);
-              levelAdjacencyLists.push_back(levelAdjacencyList);
-          }
-      }
-      else if (currLayerSize == 1)
-      {
-          std::vector<AdjacencyListEntry> levelAdjacencyList;
-
-          for (int j = 0; j < nextLayerSize; j++)
-          {
-              AdjacencyListEntry entry;
-              entry.from = &layers[i][0];
-              entry.to = &layers[i + 1][j];
-              levelAdjacencyList.push_back(entry);
-          }
+      std::vector<AdjacencyListEntry> levelAdjacencyList;
 
-          levelAdjacencyLists.push_back(levelAdjacencyList);
-      }
-      else if (nextLayerSize == 1)
-      {
-          for (int j = 0; j < currLayerSize; j++)
-          {
-              std::vector<AdjacencyListEntry> levelAdjacencyList;
-              AdjacencyListEntry entry;
-              entry.from = &layers[i][j];
-              entry.to = &layers[i + 1][0];
-
-              levelAdjacencyList.push_back(entry);
-              levelAdjacencyLists.push_back(levelAdjacencyList);
-          }
-      }
-      else if (currLayerSize > nextLayerSize)
-      {
-          if (currLayerSize == 4)
-          {
-              if (nextLayerSize == 3)
-              {
-                  for (int j = 0; j < nextLayerSize; j++)
-                  {
-                      std::vector<AdjacencyListEntry> levelAdjacencyList;
-                      AdjacencyListEntry entry;
-                      entry.from = &layers[i][j];
-                      entry.to = &layers[i + 1][j];
-
-                      levelAdjacencyList.push_back(entry);
-                      levelAdjacencyLists.push_back(levelAdjacencyList);
-                  }
-
-                  std::vector<AdjacencyListEntry> levelAdjacencyList;
-                  AdjacencyListEntry entry;
-                  entry.from = &layers[i][currLayerSize - 1];
-                  entry.to = &layers[i + 1][nextLayerSize - 1];
-
-                  levelAdjacencyList.push_back(entry);
-                  levelAdjacencyLists.push_back(levelAdjacencyList);
-              }
-              else if (nextLayerSize == 2)
-              {
-                  for (int j = 0; j < nextLayerSize; j++)
-                  {
-                      std::vector<AdjacencyListEntry> levelAdjacencyList1;
-                      AdjacencyListEntry entry1;
-                      entry1.from = &layers[i][2*j];
-                      entry1.to = &layers[i + 1][(j+1)/2];
-                      levelAdjacencyList1.push_back(entry1);
-
-                      std::vector<AdjacencyListEntry> levelAdjacencyList2;
-                      AdjacencyListEntry entry2;
-                      entry2.from = &layers[i][2*j + 1];
-                      entry2.to = &layers[i + 1][(2*j+1)/2];
-                      levelAdjacencyList2.push_back(entry2);
-
-                      levelAdjacencyLists.push_back(levelAdjacencyList1);
-                      levelAdjacencyLists.push_back(levelAdjacencyList2);
-                  }
-              }
-          }
-          else if (currLayerSize == 3) 
-          {
-              //Since case of 1 is handled separately and currLayerSize == 3,
-              //that means nextLayerSize == 2
-
-              for (int j = 0; j < nextLayerSize; j++)
-              {
-                  std::vector<AdjacencyListEntry> levelAdjacencyList;
-                  AdjacencyListEntry entry;
-                  entry.from = &layers[i][j];
-                  entry.to = &layers[i + 1][j];
-
-                  levelAdjacencyList.push_back(entry);
-                  levelAdjacencyLists.push_back(levelAdjacencyList);
-              }
-
-              std::vector<AdjacencyListEntry> levelAdjacencyList;
-              AdjacencyListEntry entry;
-              entry.from = &layers[i][currLayerSize - 1];
-              entry.to = &layers[i + 1][nextLayerSize - 1];
-
-              levelAdjacencyList.push_back(entry);
-              levelAdjacencyLists.push_back(levelAdjacencyList);
-          }
-      }
-      else if (nextLayerSize > currLayerSize)
+      for (const MapEdge& edge : mapList)
       {
-          if (currLayerSize == 2)
-          {
-              if (nextLayerSize == 3)
-              {
-                  for (int j = 0; j < currLayerSize; j++)
-                  {
-                      std::vector<AdjacencyListEntry> levelAdjacencyList;
-                      AdjacencyListEntry entry;
-                      entry.from = &layers[i][j];
-                      entry.to = &layers[i + 1][j];
-
-                      levelAdjacencyList.push_back(entry);
-                      levelAdjacencyLists.push_back(levelAdjacencyList);
-                  }
-
-                  AdjacencyListEntry entry;
-                  entry.from = &layers[i][currLayerSize - 1];
-                  entry.to = &layers[i + 1][nextLayerSize - 1];
-
-                  levelAdjacencyLists[levelAdjacencyLists.size() - 1].push_back(entry);
-              }
-              else if (nextLayerSize == 4)
-              {
-                  for (int j = 0; j < currLayerSize; j++)
-                  {
-                      std::vector<AdjacencyListEntry> levelAdjacencyList;
-                      AdjacencyListEntry entry1;
-                      entry1.from = &layers[i][j];
-                      entry1.to = &layers[i + 1][j*2];
-
-                      AdjacencyListEntry entry2;
-                      entry2.from = &layers[i][j];
-                      entry2.to = &layers[i + 1][j*2 + 1];
-
-                      levelAdjacencyList.push_back(entry1);
-                      levelAdjacencyList.push_back(entry2);
-                      levelAdjacencyLists.push_back(levelAdjacencyList);
-                  }
-              }
-          }
-          else if (currLayerSize == 3)
-          {
-              //nextLayerSize must be 4
-
-              for (int j = 0; j < currLayerSize; j++)
-              {
-                  std::vector<AdjacencyListEntry> levelAdjacencyList;
-                  AdjacencyListEntry entry;
-                  entry.from = &layers[i][j];
-                  entry.to = &layers[i + 1][j];
-
-                  levelAdjacencyList.push_back(entry);
-                  levelAdjacencyLists.push_back(levelAdjacencyList);
-              }
-
-              AdjacencyListEntry entry;
-              entry.from = &layers[i][currLayerSize - 1];
-              entry.to = &layers[i + 1][nextLayerSize - 1];
-              levelAdjacencyLists[levelAdjacencyLists.size() - 1].push_back(entry);
-          }
+          AdjacencyListEntry entry;
+          entry.from = nodes[edge.m_nFrom];
+          entry.to = nodes[edge.m_nTo];
+          levelAdjacencyList.push_back(entry);
       }
 
+      levelAdjacencyLists.push_back(levelAdjacencyList);
   }
 
-  //Connect everything in second to last layer to last level
-  for (int i = 0; i < layers[numLayers - 2].size(); i++)
-  {
-      std::vector<AdjacencyListEntry> adjacencyList;
-      AdjacencyListEntry entry;
-      entry.from = &layers[numLayers - 2][i];
-      entry.to = &layers[numLayers - 1][0];
-
-      adjacencyList.push_back(entry);
-      levelAdjacencyLists.push_back(adjacencyList);
-  }
-
-  //Place a randomized special card node
-  int specialLayer = rng->randn(2, layers.size() - 2);
-  int specialNode = rng->randn(0, layers[specialLayer].size() - 1);
-
-  int specialID = layers[specialLayer][specialNode].id;
-  
-  levelAdjacencyLists[specialID][0].from->special = true;
-
-  m_pObjectManager->GetNodes().at(specialID)->SetSpecial();
-  
-  for (auto adjacencyList : levelAdjacencyLists)
-  {
-      for (auto entry : adjacencyList)
-      {
-          if (entry.to->id == specialID)
-          {
-              entry.from->numEnemies = max(entry.from->numEnemies, 4);
-              m_pObjectManager->GetNodes().at(entry.from->id)->numEnemies = entry.from->numEnemies;
-          }
-      }
-  }
-
+  m_pObjectManager->GetNodes().at(m_sMap.m_nSpecial).SetSpecial();
+  ShowProgress();
 } //BeginGame
 
 /// Poll the keyboard state and respond to the key presses that happened since
@@ -432,18 +434,30 @@ void CGame::BeginGame(){
 void CGame::KeyboardHandler(){
   m_pKeyboard->GetState(); //get current keyboard state 
   
-  if(m_pKeyboard->TriggerDown(VK_F1)) //help
-    ShellExecute(0, 0, "https://larc.unt.edu/code/blank/", 0, 0, SW_SHOW);
+  if(TriggerDown(VK_F1)) //help
+    OpenUrl("https://larc.unt.edu/code/blank/");
   
-  if(m_pKeyboard->TriggerDown(VK_F2)) //toggle frame rate 
+  if(TriggerDown(VK_F2)) //toggle frame rate and profiler overlay
     m_bDrawFrameRate = !m_bDrawFrameRate;
 
-  if (m_pKeyboard->TriggerDown(VK_BACK)) //restart game
+  if(TriggerDown(VK_F4)) //dump profiler samples
+    CProfiler::WriteTrace("trace.json");
+
+  if(TriggerDown(VK_F3)) //toggle fast combat from the next enemy turn
+    fastCombat = !fastCombat;
+
+  if(TriggerDown(VK_F5) && CanSaveRun()) //save the run
+    SaveRun(g_pSaveFile);
+
+  if(TriggerDown(VK_F9)) //go back to the saved run
+    LoadRun(g_pSaveFile);
+
+  if (TriggerDown(VK_BACK)) //restart game
       BeginGame(); //restart game
 
   if (gameOver)
   {
-      if (m_pKeyboard->TriggerDown(VK_LBUTTON))
+      if (TriggerDown(VK_LBUTTON))
       {
           const Vector2 buttonCenter = Vector2(m_nWinWidth / 2, m_nWinHeight / 2 + 75);
           const float buttonWidth = m_pRenderer->GetWidth(eSprite::PlayAgainButton);
@@ -467,68 +481,30 @@ void CGame::KeyboardHandler(){
   if (state == GameState::Battle)
   {
       //God mode
-      if (m_pKeyboard->TriggerDown('G'))
+      if (TriggerDown('G'))
       {
           //Need to clear current enemies
           for (auto enemy : m_pObjectManager->GetEnemies())
           {
-              enemy->Kill();
+              enemy.Kill();
           }
           m_pObjectManager->ClearEnemies();
 
           //Then do normal end of level stuff
-
-          //Check if player has won
-          if (currLayer == layers.size() - 1)
-          {
-              gameOver = true;
-              state = GameState::GameOver;
+          if (FinishLevel())
               return;
-          }
-
-          //Lock levels that are no longer accessible
-          for (auto node : currentlyUnlockedNodes)
-          {
-              m_pObjectManager->LockLevel(node->id);
-              node->unlocked = false;
-          }
-          currentlyUnlockedNodes.clear();
-
-          //Unlock levels adjacent to this one
-          for (auto entry : levelAdjacencyLists[currLevel])
-          {
-              entry.to->unlocked = true;
-              state = GameState::NewCard;
-
-              if (!entry.to->special)
-                  m_pObjectManager->UnlockLevel(entry.to->id);
-
-              currentlyUnlockedNodes.push_back(entry.to);
-          }
-
-          m_pObjectManager->CompleteLevel(levelAdjacencyLists[currLevel][0].from->id);  //Mark current level as completed
 
           removeCards();        //Remove remaining unused cards
-          clearUsed();          //Clear the vector tracking used cards
-          player->Reset();
+          player.Reset();
 
-          for (auto card : player->GetDeck())
+          for (auto card : player.GetDeck())
           {
-              card->Reset();
+              card.Reset();
           }
 
           enemyUpdateIndex = -1;
 
-          //Shuffle the cards 10 times
-          if (shuffleTracker == 1) {
-              for (int i = 0; i < 10; i++) {
-                  player->shuffleCards();
-              }
-              shuffleTracker = 0;
-          }
-          else {
-              shuffleTracker++;
-          }
+          nextHand();
           replaceCards(); //Replace with 5 new cards
           cardNum = -10; //Reset cardNum for selection
 
@@ -537,158 +513,102 @@ void CGame::KeyboardHandler(){
 
       if (enemyUpdateIndex == -1)
       {
-          if (player->GetState() == PlayerState::WaitingForInput)
+          if (player.GetState() == PlayerState::WaitingForInput)
           {
               if (cardNum == -10)
               {
                   chooseCard();//Find which card was chosen
               }
-              else if (cardNum >= 0 && cardNum <= 4)
+              else if (cardNum >= 0)
               {
-                  if (m_pKeyboard->TriggerDown(VK_LBUTTON))
+                  if (TriggerDown(VK_LBUTTON))
                   {
-                      ChooseTarget(m_pObjectManager->GetEnemies().size());
+                      ChooseTarget();
                   }
               }
           }
-          else if (player->GetState() == PlayerState::Attacking && player->FinishedAttacking())
+          else if (player.GetState() == PlayerState::Attacking && player.FinishedAttacking())
           {
-              //Where 0 is below is how the enemy taking damage is decided 
-              if (player->GetDeck().at(cardNum)->dealDamage() > 0)
+              if (m_bBattle)
               {
-                  auto enemy = m_pObjectManager->GetEnemies()[choseEnemy];
-                  if (enemy->TakeDamage(player->useCard(cardNum)))
-                      m_pObjectManager->RemoveEnemy(choseEnemy);
+                  PlayCard(); //the battle state works out what the card does
               }
               else
               {
-                  player->useCard(cardNum);
+                  const int damage = player.useCard(cardNum);
+
+                  if (damage > 0 && numEnemies > (int)BattleState::MaxEnemies)
+                      DamageAllEnemies(damage); //large encounters take area damage
+                  else if (damage > 0)
+                      DamageEnemy(choseEnemy, damage);
               }
 
               if (m_pObjectManager->GetEnemies().size() == 0)
               {
-                  //Check if player has won
-                  if (currLayer == layers.size() - 1)
-                  {
-                      gameOver = true;
-                      state = GameState::GameOver;
+                  if (FinishLevel())
                       return;
-                  }
-
-                  //Lock levels that are no longer accessible
-                  for (auto node : currentlyUnlockedNodes)
-                  {
-                      m_pObjectManager->LockLevel(node->id);
-                      node->unlocked = false;
-                  }
-                  currentlyUnlockedNodes.clear();
-
-                  //Unlock levels adjacent to this one
-                  for (auto entry : levelAdjacencyLists[currLevel])
-                  {
-                      
-                      entry.to->unlocked = true;
-                      state = GameState::NewCard;
-
-                      if (!entry.to->special)
-                        m_pObjectManager->UnlockLevel(entry.to->id);
-
-                      currentlyUnlockedNodes.push_back(entry.to);
-                  }
-
-                  m_pObjectManager->CompleteLevel(levelAdjacencyLists[currLevel][0].from->id);  //Mark current level as completed
 
                   removeCards();        //Remove remaining unused cards
-                  clearUsed();          //Clear the vector tracking used cards
-                  player->SetBack();    //Reset the player position and state
-                  player->GetDeck().at(cardNum)->SetUsed();
-                  //Shuffle the cards 10 times
-                  if (shuffleTracker == 1) {
-                      for (int i = 0; i < 10; i++) {
-                          player->shuffleCards();
-                      }
-                      shuffleTracker = 0;
-                  }
-                  else {
-                      shuffleTracker++;
-                  }
+                  player.SetBack();    //Reset the player position and state
+                  player.GetDeck().at(cardNum).SetUsed();
+                  nextHand();
                   replaceCards(); //Replace with 5 new cards
                   cardNum = -10; //Reset cardNum for selection
 
                   return;
               }
 
-              player->ReturnToPosition();
+              player.ReturnToPosition();
           }
-          else if (player->GetState() == PlayerState::Returned && turnNum == 3)
+          else if (player.GetState() == PlayerState::Returned && turnNum == 3)
           {
               removeCards();        //Remove remaining unused cards
-              clearUsed();          //Clear the vector tracking used cards
-              player->SetBack();    //Reset the player position and state
-              player->GetDeck().at(cardNum)->Unselect();
-              player->GetDeck().at(cardNum)->Unhover();
-              //Shuffle the cards 10 times
-              if (shuffleTracker == 1) {
-                  for (int i = 0; i < 10; i++) {
-                      player->shuffleCards();
-                  }
-                  shuffleTracker = 0;
-              }
-              else {
-                  shuffleTracker++;
-              }
+              player.SetBack();    //Reset the player position and state
+              player.GetDeck().at(cardNum).Unselect();
+              player.GetDeck().at(cardNum).Unhover();
+              nextHand();
               replaceCards();       //Replace with 5 new cards
+              PlanEnemyTurn();      //Decide what every enemy will do this turn
               enemyUpdateIndex++;   //Update enemy index to make enemy attack
+              fastEnemyTurn = fastCombat || numEnemies > (int)BattleState::MaxEnemies;
+
+              if (fastEnemyTurn)
+                  StartFastEnemyTurn();
               cardNum = -10;        //Reset cardNum for selection
               turnNum = 0;          //Reset turnNum to 0 so the player can play 3 more cards next turn
           }
-          else if (player->GetState() == PlayerState::Returned)
+          else if (player.GetState() == PlayerState::Returned)
           {
-              player->SetBack();
-              player->GetDeck().at(cardNum)->SetUsed();
+              player.SetBack();
+              player.GetDeck().at(cardNum).SetUsed();
               cardNum = -10;
               //enemyUpdateIndex++;
           }
       }
+      else if (fastEnemyTurn)
+      {
+          FastEnemyTurn();
+      }
       else
       {
           auto enemy = m_pObjectManager->GetEnemies()[enemyUpdateIndex];
 
-          if (enemy->GetState() == EnemyState::InPosition)
-              enemy->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-          else if (enemy->GetState() == EnemyState::PlayingCard && enemy->FinishedAttacking())
+          if (enemy.GetState() == EnemyState::InPosition)
+              enemy.PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
+          else if (enemy.GetState() == EnemyState::PlayingCard && enemy.FinishedAttacking())
           {
-              //Take action based on the enemy card's type
-
-              auto enemyCard = enemy->GetCard();
-              if (enemyCard.type == EnemyCardType::Attack)
-              {
-                  player->TakeDamage(enemyCard.value);
-
-                  if (player->IsDead())
-                  {
-                      gameOver = true;
-                      state = GameState::GameOver;
-                      return;
-                  }
-              }
-              else if (enemyCard.type == EnemyCardType::Heal)
-              {
-                  enemy->Heal(enemyCard.value);
-              }
+              if (ResolveEnemyCard(enemyUpdateIndex))
+                  return;
 
-              enemy->ReturnToPosition();
+              enemy.ReturnToPosition();
           }
-          else if (enemy->GetState() == EnemyState::Returned)
+          else if (enemy.GetState() == EnemyState::Returned)
           {
-              enemy->SetBack();
+              enemy.SetBack();
               enemyUpdateIndex++;
 
-              if (enemyUpdateIndex == m_pObjectManager->GetEnemies().size())
-              {
-                  player->ResetShield();
-                  enemyUpdateIndex = -1;
-              }
+              if (enemyUpdateIndex == (int)m_pObjectManager->GetEnemies().size())
+                  EndEnemyTurn();
           }
       }
 
@@ -697,7 +617,29 @@ void CGame::KeyboardHandler(){
   {
       cardNum = -10;
       turnNum = 0;
-      if (m_pKeyboard->TriggerDown(VK_LBUTTON))
+
+      //Benchmark encounter, fought in place of the first unlocked level
+      if (TriggerDown('B'))
+      {
+          for (auto& layer : layers)
+          {
+              for (auto& node : layer)
+              {
+                  if (!progress.IsUnlocked(node.id) || node.special)
+                      continue;
+
+                  state = GameState::Battle;
+                  numEnemies = (int)CEncounter::BenchmarkSize;
+                  LoadEnemies(numEnemies);
+                  currLevel = node.id;
+                  currLayer = node.layer;
+                  m_cTelemetry.SetLevel(currLevel);
+                  return;
+              }
+          }
+      }
+
+      if (TriggerDown(VK_LBUTTON))
       {
           findMouse();
           Vector2 mousePos = Vector2(mPoint.x, m_nWinHeight - mPoint.y);
@@ -706,11 +648,8 @@ void CGame::KeyboardHandler(){
           {
               for (auto node : layer)
               {
-                  if (node.unlocked)
+                  if (progress.IsUnlocked(node.id))
                   {
-                      float dist = Vector2::DistanceSquared(mousePos, node.position);
-                      const float radSquared = pow(19, 2);
-
                       const float width = 1430 * 0.05f;
                       const float height = 1604 * 0.05f;
 
@@ -720,48 +659,26 @@ void CGame::KeyboardHandler(){
                       if (mousePos.x >= topLeft.x && mousePos.x <= bottomRight.x &&
                           mousePos.y >= topLeft.y && mousePos.y <= bottomRight.y)
                       {
+                          m_cTelemetry.SetLevel(node.id);
+                          m_cTelemetry.Record(eTelemetry::NodeChosen, node.layer, node.numEnemies, node.special);
+
                           if (node.special)
                           {
                               currLevel = node.id;
                               currLayer = node.layer;
 
-                              //Lock levels that are no longer accessible
-                              for (auto node : currentlyUnlockedNodes)
-                              {
-                                  if (!node->special)
-                                  {
-                                      m_pObjectManager->LockLevel(node->id);
-                                  }
-                                  node->unlocked = false;
-                              }
-                              currentlyUnlockedNodes.clear();
-
-                              //Unlock levels adjacent to this one
-                              for (auto entry : levelAdjacencyLists[currLevel])
-                              {
-                                  entry.to->unlocked = true;
-                                  state = GameState::Nerd;
-
-                                  m_pObjectManager->UnlockLevel(entry.to->id);
-
-                                  currentlyUnlockedNodes.push_back(entry.to);
-                              }
-
-                              m_pObjectManager->CompleteLevel(levelAdjacencyLists[currLevel][0].from->id);  //Mark current level as completed
-
+                              //Move on to the levels after this one
+                              progress.Complete(currLevel);
+                              ShowProgress();
+                              state = GameState::Nerd;
                           }
                           else
                           {
                               state = GameState::Battle;
-                              LoadEnemies(node.numEnemies);
                               numEnemies = node.numEnemies;
                               currLevel = node.id;
                               currLayer = node.layer;
-
-                              if (currLayer == layers.size() - 1)
-                              {
-                                  m_pObjectManager->GetEnemies().at(0)->SetBoss();
-                              }
+                              LoadEnemies(numEnemies, currLayer == (int)layers.size() - 1);
                           }
                       }
                   }
@@ -771,7 +688,7 @@ void CGame::KeyboardHandler(){
   }
   else if (state == GameState::Menu)
   {
-      if (m_pKeyboard->TriggerDown(VK_LBUTTON))
+      if (TriggerDown(VK_LBUTTON))
       {
           Vector2 buttonCenter = Vector2(m_nWinWidth / 2, m_nWinHeight / 2 + 100);
           float buttonWidth = m_pRenderer->GetWidth(eSprite::PlayButton);
@@ -794,9 +711,12 @@ void CGame::KeyboardHandler(){
   {
       if (cardUpgraded == false) {
           removeCards();
-          for (int i = 0; i < player->GetDeck().size(); i++) {
-              player->GetDeck().at(i)->AddCardMove(i);
+          m_cUpgradeLayout.Arrange(player.GetDeck().size());
+          for (int i = 0; i < (int)player.GetDeck().size(); i++) {
+              const CardSlot slot = m_cUpgradeLayout.GetSlot(i);
+              player.GetDeck().at(i).Show(Vector2(slot.x, slot.y));
           }
+          hoverCard = -1;
           cardUpgraded = true;
 
       }
@@ -804,21 +724,23 @@ void CGame::KeyboardHandler(){
  }
   else if (state == GameState::Intro)
   {
-    if (m_pKeyboard->TriggerDown(VK_RETURN))
+    if (TriggerDown(VK_RETURN))
     {
         state = GameState::Map;
     }
   }
   else if (state == GameState::Nerd)
   {
-      if (m_pKeyboard->TriggerDown(VK_LBUTTON))
+      if (TriggerDown(VK_LBUTTON))
       {
           //Upgrade cards
-          for (auto card : player->GetDeck())
+          for (auto card : player.GetDeck())
           {
-              card->UpgradeAllCards();
+              card.UpgradeAllCards();
           }
 
+          m_cTelemetry.Record(eTelemetry::Upgrade, -1);
+
           state = GameState::Map;
       }
   }
@@ -835,11 +757,32 @@ void CGame::DrawFrameRateText(){
   m_pRenderer->DrawScreenText(s.c_str(), pos); //draw to screen
 } //DrawFrameRateText
 
+/// Draw the profiler overlay below the frame rate: the median and 99th
+/// percentile frame times, then the smoothed time spent in each zone,
+/// indented to show nesting.
+
+void CGame::DrawProfileText(){
+  char s[128];
+  Vector2 pos(m_nWinWidth - 320.0f, 60.0f);
+
+  snprintf(s, sizeof(s), "p50 %.2f ms  p99 %.2f ms",
+    CProfiler::GetPercentile(50.0f), CProfiler::GetPercentile(99.0f));
+  m_pRenderer->DrawScreenText(s, pos);
+
+  for(const ProfileZoneStat& z: CProfiler::GetZones()){
+    if(!z.m_bSeen || z.m_nDepth == 0)continue;
+
+    pos.y += 20.0f;
+    snprintf(s, sizeof(s), "%*s%s %.2f ms", 2*z.m_nDepth, "", z.m_pName, z.m_fAvgMs);
+    m_pRenderer->DrawScreenText(s, pos);
+  } //for
+} //DrawProfileText
+
 void CGame::DrawGameOverText() {
     Vector2 pos(m_nWinWidth / 2.0f - 260.0f, m_nWinHeight / 2.0f - 180.0f);
     std::string text = "You finished school!  Con-grad-ulations!";
 
-    if (player->IsDead())
+    if (player.IsDead())
     {
         text = "You failed school!  Oh no!";
         pos.x += 75;
@@ -849,18 +792,51 @@ void CGame::DrawGameOverText() {
     m_pRenderer->DrawScreenText(text.c_str(), pos, Colors::White); //draw to screen
 } //DrawFrameRateText
 
+/// Draw the draw pile as a stack of face-down cards to the left of the hand,
+/// with the number of cards left in it on top. At most ten cards are stacked
+/// so that a large deck costs no more to draw than a small one.
+
+void CGame::DrawPilePreview(){
+  const size_t n = player.GetPiles().GetDrawCount();
+  const size_t shown = std::min<size_t>(n, 10);
+
+  if(shown != m_cDrawLayout.GetCount())
+    m_cDrawLayout.Arrange(shown);
+
+  CardSlot slot = m_cDrawLayout.GetSlot(0);
+
+  for(size_t i=0; i<shown; i++){
+    slot = m_cDrawLayout.GetSlot(i);
+    m_pRenderer->Draw(eSprite::Card, Vector2(slot.x, slot.y));
+  } //for
+
+  const std::string s = std::to_string(n);
+  const Vector2 pos(slot.x - 13, m_nWinHeight - slot.y - 30);
+  m_pRenderer->DrawScreenText(s.c_str(), pos, Colors::Black);
+} //DrawPilePreview
+
 /// Ask the object manager to draw the game objects. The renderer is notified
 /// of the start and end of the frame so that it can let Direct3D do its
 /// pipelining jiggery-pokery.
 
 void CGame::RenderFrame(){
+  PROFILE_ZONE("RenderFrame");
+
   m_pRenderer->BeginFrame(); //required before rendering
   
-  if(m_bDrawFrameRate)DrawFrameRateText(); //draw frame rate, if required
+  if(m_bDrawFrameRate){ //draw frame rate and profiler overlay, if required
+    DrawFrameRateText();
+    DrawProfileText();
+  } //if
+
+  if(soakRun < soakRuns){ //soak test progress
+    const std::string s = "Soak test " + std::to_string(soakRun) + "/" + std::to_string(soakRuns);
+    m_pRenderer->DrawScreenText(s.c_str(), Vector2(25.0f, 30.0f));
+  } //if
 
   if (gameOver)
   {
-      if (currLayer == layers.size() - 1)
+      if (currLayer == (int)layers.size() - 1)
         m_pRenderer->Draw(eSprite::WinBackground, Vector2(m_nWinWidth / 2, m_nWinHeight / 2));
       else
         m_pRenderer->Draw(eSprite::LoseBackground, Vector2(m_nWinWidth / 2, m_nWinHeight / 2));
@@ -884,6 +860,7 @@ void CGame::RenderFrame(){
   else if (state == GameState::Battle)
   {
       m_pRenderer->Draw(eSprite::Background, Vector2(m_nWinWidth / 2, m_nWinHeight / 2));
+      DrawPilePreview();
 
       //Draw number of cards left to play in this turn
       std::string s2 = "3/3";
@@ -900,6 +877,9 @@ void CGame::RenderFrame(){
           s2 = "0/3";
       }
       m_pRenderer->DrawScreenText(s2.c_str(), Vector2(125, 635), Colors::Black); 
+
+      if (fastCombat)
+          m_pRenderer->DrawScreenText("Fast combat", Vector2(25, 30), Colors::White);
   }
   else if (state == GameState::Menu)
   {
@@ -919,32 +899,59 @@ void CGame::RenderFrame(){
       m_pRenderer->Draw(eSprite::NerdBackground, Vector2(m_nWinWidth / 2, m_nWinHeight / 2));
   }
 
-  m_pObjectManager->draw(); //draw objects
+  {
+    PROFILE_ZONE("ObjectManager::draw");
+    m_pObjectManager->draw(); //draw objects
+  }
 
+  PROFILE_ZONE("EndFrame");
   m_pRenderer->EndFrame(); //required after rendering
 } //RenderFrame
 
 /// This function will be called regularly to process and render a frame
-/// of animation, which involves the following. Handle keyboard input.
-/// Notify the  audio player at the start of each frame so that it can prevent
-/// multiple copies of a sound from starting on the same frame.  
-/// Move the game objects. Render a frame of animation.
+/// of animation. The frame cost gate, if it was asked for, wraps the frame.
 
 void CGame::ProcessFrame(){
-  KeyboardHandler(); //handle keyboard input
+  if(gating && gateScreen < g_nGateScreens)GateStep();
+  else PlayFrame();
+} //ProcessFrame
+
+/// Play a frame of animation, which involves the following. Handle keyboard
+/// input. Notify the  audio player at the start of each frame so that it can
+/// prevent multiple copies of a sound from starting on the same frame.
+/// Move the game objects. Render a frame of animation.
+
+void CGame::PlayFrame(){
+  CProfiler::BeginFrame();
+  m_cTelemetry.SetFrame(frameNumber++);
+
+  if(soakRun < soakRuns)
+    SoakStep(); //the soak test's input in place of the player's
+
+  {
+    PROFILE_ZONE("KeyboardHandler");
+    KeyboardHandler(); //handle keyboard input
+  }
+
+  HotReload(); //before loading, so that nothing stale is loaded
+  LoadAssets(); //after input, which may have changed the state
   m_pAudio->BeginFrame(); //notify audio player that frame has begun
 
   m_pTimer->Tick([&](){ //all time-dependent function calls should go here
+    PROFILE_ZONE("ObjectManager::move");
     m_pObjectManager->move(); //move all objects
   });
 
   RenderFrame(); //render a frame of animation
-} //ProcessFrame
+  CProfiler::EndFrame();
+} //PlayFrame
 
 //Helper function to find the mouse position inside the game window
 void CGame::findMouse() {
-    GetCursorPos(&mPoint);
-    ScreenToClient(m_Hwnd, &mPoint);
+    if (soakRun < soakRuns)
+        mPoint = soakMouse; //the soak test's mouse
+    else
+        GetMousePosition(m_Hwnd, mPoint);
     /*  ///Uncomment below to output mouse position of the last click to a file: test.txt
     std::ofstream of;
     of.open("test.txt");
@@ -953,704 +960,956 @@ void CGame::findMouse() {
     */
 }
 
-void CGame::clearUsed() {
-    for (int i = 0; i < usedCards.size(); i++)
-        usedCards.at(i) = 0;
-}
-
 void CGame::markUsed(int index) {
-    usedCards.at(index) = 99;
+    player.GetPiles().Play(index);
 }
 
 bool CGame::IsMarked(int index) {
-    if (usedCards.at(index) == 99) {
-        return true;
-    }
-    else {
-        return false;
-    }
+    return player.GetPiles().IsPlayed(index);
 }
 
+//Deal the current hand into the slots computed by the hand layout
 void CGame::replaceCards() {
-    if (shuffleTracker == 0) {
-        for (int i = 0; i < 5; i++) {
-            player->GetDeck().at(i)->ReplaceCard();
-            player->GetDeck().at(i)->RepositionCard(i);
-        }
-    }
-    else {
-        for (int i = 5; i < 10; i++) {
-            player->GetDeck().at(i)->ReplaceCard();
-            player->GetDeck().at(i)->RepositionCard(i);
-        }
+    const CDeck& piles = player.GetPiles();
+    for (size_t i = 0; i < piles.GetHandCount(); i++) {
+        const CardSlot slot = m_cHandLayout.GetSlot(i);
+        player.GetDeck().at(piles.GetHandCard(i)).Show(Vector2(slot.x, slot.y));
     }
+    hoverCard = -1;
 }
 
+//Hide the current hand; played cards are already hidden
 void CGame::removeCards() {
-    if (shuffleTracker == 0) {
-        for (int i = 0; i < 5; i++) {
-            if (!IsMarked(i))
-                player->GetDeck().at(i)->RemoveCard(i);
-        }
-    }
-    else {
-        for (int i = 5; i < 10; i++) {
-            if (!IsMarked(i))
-                player->GetDeck().at(i)->RemoveCard(i);
-        }
+    const CDeck& piles = player.GetPiles();
+    for (size_t i = 0; i < piles.GetHandCount(); i++)
+        player.GetDeck().at(piles.GetHandCard(i)).Hide();
+}
+
+//Discard the hand and draw a new one. The draw pile shuffles as it is drawn
+//and refills from the discard pile when it runs out. In a battle the battle
+//state deals, and the piles show its hand
+void CGame::nextHand() {
+    if (m_bBattle) {
+        m_sBattle.Deal();
+        ShowBattle();
+        return;
     }
+
+    player.GetPiles().DiscardHand();
+    player.GetPiles().Draw(handSize);
+}
+
+//Raise the card under the mouse, lowering the previous one. Only does work
+//when the mouse moves onto a different card.
+void CGame::hoverOver(int index) {
+    if (index == hoverCard)
+        return;
+
+    if (hoverCard >= 0)
+        player.GetDeck().at(hoverCard).Unhover();
+    if (index >= 0)
+        player.GetDeck().at(index).Hover();
+
+    hoverCard = index;
 }
 
 void CGame::chooseCard() {
+    PROFILE_ZONE("chooseCard");
+
     findMouse(); //Find mouse position when button is clicked
+    const Vector2 mousePos = Vector2(mPoint.x, m_nWinHeight - mPoint.y);
+
     if (state == GameState::Battle) {
-        if (mPoint.x > 314.0f && mPoint.x < 381.0f && mPoint.y < 700.0f && mPoint.y > 581.0f) {
-            if (shuffleTracker == 0) {
-                player->GetDeck().at(0)->Hover();
-            }
-            else {
-                player->GetDeck().at(5)->Hover();
+        const CDeck& piles = player.GetPiles();
+        const int slot = m_cHandLayout.HitTest(mousePos.x, mousePos.y);
+
+        int index = -1;
+        if (slot >= 0 && slot < (int)piles.GetHandCount())
+            index = (int)piles.GetHandCard(slot);
+        if (index >= 0 && IsMarked(index))
+            index = -1;
+
+        hoverOver(index);
+
+        if (index >= 0 && TriggerDown(VK_LBUTTON))
+        {
+            cardNum = index;
+            player.GetDeck().at(cardNum).Select();
+            player.SetCard(cardNum);
+
+            if (player.GetDeck().at(cardNum).dealDamage() > 0)
+            {
+                player.SetUnavailable();
             }
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
+            else
             {
-                if (shuffleTracker == 0) {
-                    cardNum = 0;
+                for (auto enemy : m_pObjectManager->GetEnemies())
+                {
+                    enemy.SetUnavailable();
                 }
-                else {
-                    cardNum = 5;
-                }
-                player->GetDeck().at(cardNum)->Select();
-                player->SetCard(cardNum);
-
-                if (player->GetDeck().at(cardNum)->dealDamage() > 0)
-                {
-                    player->SetUnavailable();
-                }
-                else
-                {
-                    for (auto enemy : m_pObjectManager->GetEnemies())
-                    {
-                        enemy->SetUnavailable();
-                    }
-                }
-
-                if (shuffleTracker == 1)
-                    cardNum = 0;
             }
         }
-        else
+    } else if (state == GameState::NewCard) {
+        const int index = m_cUpgradeLayout.HitTest(mousePos.x, mousePos.y);
+
+        hoverOver(index);
+
+        if (index >= 0 && TriggerDown(VK_LBUTTON))
         {
-            if (shuffleTracker == 0) {
-                player->GetDeck().at(0)->Unhover();
-            }
-            else {
-                player->GetDeck().at(5)->Unhover();
+            cardNum = index;
+            Card card = player.GetDeck().at(cardNum);
+            card.UpgradeCard();
+            m_cTelemetry.Record(eTelemetry::Upgrade, cardNum, card.dealDamage(),
+                card.giveShield(), card.giveHealth());
+            player.SetCard(cardNum);
+            cardUpgraded = false;
+            for (auto card : player.GetDeck()) {
+                card.Hide();
             }
+            replaceCards();
+            state = GameState::Map;
         }
+    }
+}
 
-        //Check if mouse was clicked on 2nd card
-        if (mPoint.x > 394.0f && mPoint.x < 461.0f && mPoint.y < 700.0f && mPoint.y > 581.0f) {
-            if (shuffleTracker == 0) {
-                player->GetDeck().at(1)->Hover();
-            }
-            else {
-                player->GetDeck().at(6)->Hover();
-            }
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-            {
-                if (shuffleTracker == 0) {
-                    cardNum = 1;
-                }
-                else {
-                    cardNum = 6;
-                }
-                player->GetDeck().at(cardNum)->Select();
-                player->SetCard(cardNum);
+void CGame::ChooseTarget() {
+    PROFILE_ZONE("ChooseTarget");
 
-                if (player->GetDeck().at(cardNum)->dealDamage() > 0)
-                {
-                    player->SetUnavailable();
-                }
-                else
-                {
-                    for (auto enemy : m_pObjectManager->GetEnemies())
-                    {
-                        enemy->SetUnavailable();
-                    }
-                }
+    findMouse(); //Find mouse position when button is clicked
+    Vector2 mousePos = Vector2(mPoint.x, m_nWinHeight - mPoint.y);
 
-                if (shuffleTracker == 1)
-                    cardNum = 1;
-            }
-        }
-        else
-        {
-            if (shuffleTracker == 0) {
-                player->GetDeck().at(1)->Unhover();
-            }
-            else {
-                player->GetDeck().at(6)->Unhover();
-            }
+    //If the selected card deals damage, select an enemy
+    if (player.GetDeck().at(cardNum).dealDamage() > 0)
+    {
+        const int target = m_pObjectManager->PickEnemy(mousePos);
+
+        if (target >= 0 && !IsMarked(cardNum)) {
+            Card card = player.GetDeck().at(cardNum);
+            m_cTelemetry.Record(eTelemetry::CardPlayed, cardNum, card.dealDamage(),
+                card.giveShield(), card.giveHealth(), target);
+
+            choseEnemy = target;
+            turnNum++;
+            player.GetDeck().at(cardNum).Hide();
+            markUsed(cardNum);
+            player.PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
+            player.SetNormal();
         }
+        else {
+            player.GetDeck().at(cardNum).Unselect();
+            cardNum = -10;
 
-        //Check if mouse was clicked on 3rd card
-        if (mPoint.x > 474.0f && mPoint.x < 541.0f && mPoint.y < 700.0f && mPoint.y > 581.0f) {
-            if (shuffleTracker == 0) {
-                player->GetDeck().at(2)->Hover();
-            }
-            else {
-                player->GetDeck().at(7)->Hover();
-            }
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
+            player.SetNormal();
+        }
+    }
+    else //Otherwise, select the player
+    {
+        if (TriggerDown(VK_LBUTTON))
+        {
+            if(mPoint.x > 79.0f && mPoint.x < 174.0f && mPoint.y < 410.0f && mPoint.y > 267.0f /* && !IsMarked(cardNum) */ )
             {
-                if (shuffleTracker == 0) {
-                    cardNum = 2;
-                }
-                else {
-                    cardNum = 7;
-                }
-                player->GetDeck().at(cardNum)->Select();
-                player->SetCard(cardNum);
+                Card card = player.GetDeck().at(cardNum);
+                m_cTelemetry.Record(eTelemetry::CardPlayed, cardNum, card.dealDamage(),
+                    card.giveShield(), card.giveHealth(), -1);
 
-                if (player->GetDeck().at(cardNum)->dealDamage() > 0)
-                {
-                    player->SetUnavailable();
-                }
-                else
+                turnNum++;
+                player.GetDeck().at(cardNum).Hide();
+                markUsed(cardNum);
+                player.PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));   
+
+                for (auto enemy : m_pObjectManager->GetEnemies())
                 {
-                    for (auto enemy : m_pObjectManager->GetEnemies())
-                    {
-                        enemy->SetUnavailable();
-                    }
+                    enemy.SetNormal();
                 }
-
-                if (shuffleTracker == 1)
-                    cardNum = 2;
-            }
-        }
-        else
-        {
-            if (shuffleTracker == 0) {
-                player->GetDeck().at(2)->Unhover();
-            }
-            else {
-                player->GetDeck().at(7)->Unhover();
             }
-        }
-
-        //Check if mouse was clicked on 4th card
-        if (mPoint.x > 554.0f && mPoint.x < 621.0f && mPoint.y < 700.0f && mPoint.y > 581.0f) {
-            if (shuffleTracker == 0) {
-                player->GetDeck().at(3)->Hover();
-            }
-            else {
-                player->GetDeck().at(8)->Hover();
-            }
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
+            else
             {
-                if (shuffleTracker == 0) {
-                    cardNum = 3;
-                }
-                else {
-                    cardNum = 8;
-                }
-                player->GetDeck().at(cardNum)->Select();
-                player->SetCard(cardNum);
+                player.GetDeck().at(cardNum).Unselect();
+                cardNum = -10;
 
-                if (player->GetDeck().at(cardNum)->dealDamage() > 0)
-                {
-                    player->SetUnavailable();
-                }
-                else
+                for (auto enemy : m_pObjectManager->GetEnemies())
                 {
-                    for (auto enemy : m_pObjectManager->GetEnemies())
-                    {
-                        enemy->SetUnavailable();
-                    }
+                    enemy.SetNormal();
                 }
-
-                if (shuffleTracker == 1)
-                    cardNum = 3;
-            }
-        }
-        else
-        {
-            if (shuffleTracker == 0) {
-                player->GetDeck().at(3)->Unhover();
-            }
-            else {
-                player->GetDeck().at(8)->Unhover();
             }
         }
+    }
+}
 
-        //Check if mouse was clicked on 5th card
-        if (mPoint.x > 634.0f && mPoint.x < 706.0f && mPoint.y < 700.0f && mPoint.y > 581.0f) {
-            if (shuffleTracker == 0) {
-                player->GetDeck().at(4)->Hover();
-            }
-            else {
-                player->GetDeck().at(9)->Hover();
-            }
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-            {
-                if (shuffleTracker == 0) {
-                    cardNum = 4;
-                }
-                else {
-                    cardNum = 9;
-                }
-                player->GetDeck().at(cardNum)->Select();
-                player->SetCard(cardNum);
+//The player's card has landed, so play it on the battle state, at the
+//chosen enemy if it deals damage, and show what it did
+void CGame::PlayCard()
+{
+    const CDeck& piles = player.GetPiles();
+    BattleAction action;
+    action.m_nTarget = (uint8_t)choseEnemy;
 
-                if (player->GetDeck().at(cardNum)->dealDamage() > 0)
-                {
-                    player->SetUnavailable();
-                }
-                else
-                {
-                    for (auto enemy : m_pObjectManager->GetEnemies())
-                    {
-                        enemy->SetUnavailable();
-                    }
-                }
+    for (size_t i = 0; i < piles.GetHandCount(); i++)
+        if ((int)piles.GetHandCard(i) == cardNum)
+            action.m_nSlot = (uint8_t)i;
 
-                if (shuffleTracker == 1)
-                    cardNum = 4;
-            }
-        }
-        else
+    const size_t count = m_sBattle.m_nEnemies;
+    const int damage = m_sBattle.m_pCard[cardNum].m_nDamage;
+
+    if (!m_sBattle.Play(action))
+        return;
+
+    if (damage > 0)
+    {
+        auto enemy = m_pObjectManager->GetEnemies()[choseEnemy];
+        const bool killed = m_sBattle.m_nEnemies < count;
+        const int health = killed ? 0 : m_sBattle.m_pEnemy[choseEnemy].m_nHealth;
+
+        enemy.Hit(health);
+        m_cTelemetry.Record(eTelemetry::DamageDealt, choseEnemy, damage, health, killed);
+
+        if (killed)
+            m_pObjectManager->RemoveEnemy(choseEnemy);
+    }
+
+    ShowBattle();
+}
+//Ask each enemy's policy what it will play this turn, all in one pass at the
+//start of the enemy turn, and show the results to the player as intents
+void CGame::PlanEnemyTurn()
+{
+    const std::vector<Enemy>& enemies = m_pObjectManager->GetEnemies();
+    const size_t n = enemies.size();
+
+    if (m_cEncounter.GetCount() > 0) //large encounters plan from their own arrays
+    {
+        const std::vector<EnemyCard>& intents =
+            m_cEncounter.PlanTurn(player.GetHealth(), player.GetShield(), m_cEnemyRng);
+
+        for (size_t i = 0; i < n; i++)
+            enemies[i].SetIntent(intents[i]);
+
+        return;
+    }
+
+    m_vEnemyIntents.resize(n);
+    m_sBattle.PlanEnemyTurn(m_vEnemyIntents.data());
+    m_cEnemyRng.SetState(m_sBattle.m_nEnemyRng);
+
+    for (size_t i = 0; i < n; i++)
+        enemies[i].SetIntent(m_vEnemyIntents[i]);
+}
+
+//Start every enemy playing its card in place, each a little after the one
+//before it. The gap shrinks for large encounters so that the whole enemy turn
+//never takes longer than fastMaxSpread + fastPlayTime seconds
+void CGame::StartFastEnemyTurn()
+{
+    const std::vector<Enemy>& enemies = m_pObjectManager->GetEnemies();
+    const size_t n = enemies.size();
+
+    const float step = n > 1 ? std::min(fastStagger, fastMaxSpread / (n - 1)) : 0.0f;
+    const size_t soundStride = n / fastMaxSounds + 1;
+
+    for (size_t i = 0; i < n; i++)
+        enemies[i].PlayCardInPlace(i * step, fastPlayTime, i % soundStride == 0);
+}
+
+//Resolve the cards of enemies that have finished playing them. Enemies are
+//resolved strictly in order, so the outcome is the same as in a normal turn
+void CGame::FastEnemyTurn()
+{
+    const std::vector<Enemy>& enemies = m_pObjectManager->GetEnemies();
+
+    while (enemyUpdateIndex < (int)enemies.size() && enemies[enemyUpdateIndex].FinishedAttacking())
+    {
+        auto enemy = enemies[enemyUpdateIndex];
+
+        if (ResolveEnemyCard(enemyUpdateIndex))
+            return;
+
+        enemy.SetBack();
+        enemyUpdateIndex++;
+    }
+
+    if (enemyUpdateIndex == (int)enemies.size())
+    {
+        EndEnemyTurn();
+        fastEnemyTurn = false;
+    }
+}
+
+//Take action based on the enemy card's type: hit the player, or heal the
+//enemy, and record what it did. Returns true if the player died
+bool CGame::ResolveEnemyCard(int index)
+{
+    auto enemy = m_pObjectManager->GetEnemies()[index];
+    auto enemyCard = enemy.GetCard();
+
+    if (enemyCard.type == EnemyCardType::Attack)
+    {
+        const int health = player.GetHealth();
+        const int shield = player.GetShield();
+
+        if (m_bBattle)
         {
-            if (shuffleTracker == 0) {
-                player->GetDeck().at(4)->Unhover();
-            }
-            else {
-                player->GetDeck().at(9)->Unhover();
-            }
-        }
-    } else if (state == GameState::NewCard) {
-        if (mPoint.x > 112.0f && mPoint.x < 186.0f && mPoint.y < 494.0f && mPoint.y > 370.0f) {
-            player->GetDeck().at(0)->Hover();
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-            {
-                cardNum = 0;
-                player->GetDeck().at(cardNum)->UpgradeCard();
-                player->SetCard(cardNum);
-                cardUpgraded = false;
-                for (int i = 0; i < player->GetDeck().size(); i++) {
-                    player->GetDeck().at(i)->AddCardRemove(i);
-                }
-                replaceCards();
-                state = GameState::Map;
-            }
+            m_sBattle.PlayEnemyCard(index, enemyCard);
+            player.Hit(m_sBattle.m_nHealth, m_sBattle.m_nShield);
         }
         else
-        {
-            player->GetDeck().at(0)->Unhover();
-        }
+            player.TakeDamage(enemyCard.value);
 
-        //Check if mouse was clicked on 2nd card
-        if (mPoint.x > 192.0f && mPoint.x < 266.0f && mPoint.y < 494.0f && mPoint.y > 370.0f) {
-            player->GetDeck().at(1)->Hover();
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-            {
-                cardNum = 1;
-                player->GetDeck().at(cardNum)->UpgradeCard();
-                player->SetCard(cardNum);
-                cardUpgraded = false;
-                for (int i = 0; i < player->GetDeck().size(); i++) {
-                    player->GetDeck().at(i)->AddCardRemove(i);
-                }
-                replaceCards();
-                state = GameState::Map;
-            }
-        }
-        else
-        {
-            player->GetDeck().at(1)->Unhover();
-        }
+        m_cTelemetry.Record(eTelemetry::DamageTaken, index, enemyCard.value,
+            health - player.GetHealth(), std::max(0, std::min(shield, enemyCard.value)),
+            player.GetHealth());
 
-        //Check if mouse was clicked on 3rd card
-        if (mPoint.x > 272.0f && mPoint.x < 346.0f && mPoint.y < 494.0f && mPoint.y > 370.0f) {
-            player->GetDeck().at(2)->Hover();
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-            {
-                cardNum = 2;
-                player->GetDeck().at(cardNum)->UpgradeCard();
-                player->SetCard(cardNum);
-                cardUpgraded = false;
-                for (int i = 0; i < player->GetDeck().size(); i++) {
-                    player->GetDeck().at(i)->AddCardRemove(i);
-                }
-                replaceCards();
-                state = GameState::Map;
-            }
-        }
-        else
+        if (player.IsDead())
         {
-            player->GetDeck().at(2)->Unhover();
+            m_cTelemetry.Record(eTelemetry::Death, index);
+            gameOver = true;
+            state = GameState::GameOver;
+            return true;
         }
-
-        //Check if mouse was clicked on 4th card
-        if (mPoint.x > 352.0f && mPoint.x < 426.0f && mPoint.y < 494.0f && mPoint.y > 370.0f) {
-            player->GetDeck().at(3)->Hover();
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-            {
-                cardNum = 3;
-                player->GetDeck().at(cardNum)->UpgradeCard();
-                player->SetCard(cardNum);
-                cardUpgraded = false;
-                for (int i = 0; i < player->GetDeck().size(); i++) {
-                    player->GetDeck().at(i)->AddCardRemove(i);
-                }
-                replaceCards();
-                state = GameState::Map;
-            }
-        }
-        else
+    }
+    else if (enemyCard.type == EnemyCardType::Heal)
+    {
+        if (m_bBattle)
         {
-            player->GetDeck().at(3)->Unhover();
-        }
-
-        //Check if mouse was clicked on 5th card
-        if (mPoint.x > 432.0f && mPoint.x < 506.0f && mPoint.y < 494.0f && mPoint.y > 370.0f) {
-            player->GetDeck().at(4)->Hover();
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-            {
-                cardNum = 4;
-                player->GetDeck().at(cardNum)->UpgradeCard();
-                player->SetCard(cardNum);
-                cardUpgraded = false;
-                for (int i = 0; i < player->GetDeck().size(); i++) {
-                    player->GetDeck().at(i)->AddCardRemove(i);
-                }
-                replaceCards();
-                state = GameState::Map;
-            }
+            m_sBattle.PlayEnemyCard(index, enemyCard);
+            enemy.SetHealth(m_sBattle.m_pEnemy[index].m_nHealth);
         }
         else
         {
-            player->GetDeck().at(4)->Unhover();
+            enemy.Heal(enemyCard.value);
+            m_cEncounter.SetHealth(index, enemy.GetHealth());
         }
 
-        if (mPoint.x > 512.0f && mPoint.x < 586.0f && mPoint.y < 494.0f && mPoint.y > 370.0f) {
-            player->GetDeck().at(5)->Hover();
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-            {
-                cardNum = 5;
-                player->GetDeck().at(cardNum)->UpgradeCard();
-                player->SetCard(cardNum);
-                cardUpgraded = false;
-                for (int i = 0; i < player->GetDeck().size(); i++) {
-                    player->GetDeck().at(i)->AddCardRemove(i);
-                }
-                replaceCards();
-                state = GameState::Map;
-            }
-        }
-        else
-        {
-            player->GetDeck().at(5)->Unhover();
-        }
+        m_cTelemetry.Record(eTelemetry::EnemyHealed, index, enemyCard.value, enemy.GetHealth());
+    }
 
-        if (mPoint.x > 592.0f && mPoint.x < 666.0f && mPoint.y < 494.0f && mPoint.y > 370.0f) {
-            player->GetDeck().at(6)->Hover();
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-            {
-                cardNum = 6;
-                player->GetDeck().at(cardNum)->UpgradeCard();
-                player->SetCard(cardNum);
-                cardUpgraded = false;
-                for (int i = 0; i < player->GetDeck().size(); i++) {
-                    player->GetDeck().at(i)->AddCardRemove(i);
-                }
-                replaceCards();
-                state = GameState::Map;
-            }
-        }
+    return false;
+}
+
+//Every enemy has played its card. The player's shield wears off
+void CGame::EndEnemyTurn()
+{
+    if (m_bBattle)
+    {
+        m_sBattle.EndEnemyTurn();
+        ShowBattle();
+    }
+    else
+        player.ResetShield();
+
+    enemyUpdateIndex = -1;
+}
+
+//Ask for a soak test. It starts on the next frame and replaces normal play
+//until it is done, then the game exits. Whatever the number of runs,
+//soakFullRuns of them are played in full, spread evenly, and the first four
+//of those are the warm-up
+void CGame::StartSoak(size_t runs)
+{
+    soakRuns = runs;
+    soakRun = 0;
+    soakBaseline = 0;
+    soakFullEvery = std::max<size_t>(1, runs / soakFullRuns);
+    soakWarmup = std::min(4 * soakFullEvery, runs / 2);
+}
+
+//Play a named run from the seed catalog instead of a random one. Call
+//before Initialize. Returns false, and leaves the game as it was, if there
+//is no catalog or the name is not in it
+bool CGame::UseCatalogRun(const char* name)
+{
+    CSeedCatalog catalog;
+
+    if (!catalog.Open(g_pSeedCatalog) || !catalog.Find(name, runSeed))
+        return false;
+
+    seededRun = true;
+    return true;
+}
+
+//Test for a key or mouse button going down since the last frame. In a soak
+//test the soak test's input is read instead of the keyboard
+bool CGame::TriggerDown(WPARAM key)
+{
+    if (soakRun < soakRuns)
+        return key == soakKey;
+
+    return m_pKeyboard->TriggerDown(key);
+}
+
+//Give a soak test left click at a position in the world, y up
+void CGame::SoakClick(const Vector2& pos)
+{
+    soakKey = VK_LBUTTON;
+    soakMouse.x = (LONG)pos.x;
+    soakMouse.y = (LONG)(m_nWinHeight - pos.y);
+}
+
+//Choose the soak test's input for this frame, as a player would give it:
+//click through the menus, pick the first open level on the map, and in a
+//battle play the first card in the hand on the first enemy or the player.
+//Most runs are quick ones, restarted with Backspace as soon as the first
+//battle has been dealt, which covers starting a run, making the map and
+//loading a battle in a few frames. Every soakFullEvery-th run is played in
+//full instead, and those take turns being one of four kinds:
+//  0. Every level is fought, until game over.
+//  1. The same in fast combat, with a deck of soakDeck cards, too many for a
+//     battle state, so that battles are fought on the encounter instead.
+//  2. Every level is won with G, up to the win screen.
+//  3. Fast combat, restarted with Backspace once a card has been played.
+void CGame::SoakInput()
+{
+    const bool full = soakRun % soakFullEvery == 0;
+    const size_t kind = soakRun / soakFullEvery % 4;
+    soakKey = 0;
+
+    if (gameOver)
+    {
+        SoakClick(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f + 75)); //play again
+        soakRun++;
+    }
+    else if (state == GameState::Menu)
+    {
+        if (full && fastCombat != (kind % 2 == 1))
+            soakKey = VK_F3;
         else
+            SoakClick(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f + 100)); //play
+    }
+    else if (state == GameState::Intro)
+    {
+        if (full && kind == 1)
+            while (player.GetDeck().size() < soakDeck)
+                player.AddCard(m_pObjectManager->CreateCard(Vector2(350, -390)), 4, 0, 0);
+
+        soakKey = VK_RETURN;
+    }
+    else if (state == GameState::Nerd)
+        SoakClick(m_vWinCenter);
+    else if (state == GameState::NewCard && cardUpgraded)
+    {
+        const CardSlot slot = m_cUpgradeLayout.GetSlot(0);
+        SoakClick(Vector2(slot.x, slot.y));
+    }
+    else if (state == GameState::Map)
+    {
+        for (auto& layer : layers)
+            for (auto& node : layer)
+                if (soakKey == 0 && progress.IsUnlocked(node.id))
+                    SoakClick(node.position);
+    }
+    else if (state == GameState::Battle && enemyUpdateIndex == -1 &&
+        player.GetState() == PlayerState::WaitingForInput)
+    {
+        if (!full || (kind == 3 && turnNum > 0))
         {
-            player->GetDeck().at(6)->Unhover();
+            soakKey = VK_BACK; //restart
+            soakRun++;
         }
-
-        if (mPoint.x > 672.0f && mPoint.x < 746.0f && mPoint.y < 494.0f && mPoint.y > 370.0f) {
-            player->GetDeck().at(7)->Hover();
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-            {
-                cardNum = 7;
-                player->GetDeck().at(cardNum)->UpgradeCard();
-                player->SetCard(cardNum);
-                cardUpgraded = false;
-                for (int i = 0; i < player->GetDeck().size(); i++) {
-                    player->GetDeck().at(i)->AddCardRemove(i);
-                }
-                replaceCards();
-                state = GameState::Map;
-            }
+        else if (kind == 2)
+            soakKey = 'G'; //win the level
+        else if (cardNum >= 0)
+        {
+            if (player.GetDeck().at(cardNum).dealDamage() > 0)
+                SoakClick(m_pObjectManager->GetEnemies().at(0).GetPos());
+            else
+                SoakClick(player.GetPos());
         }
         else
         {
-            player->GetDeck().at(7)->Unhover();
-        }
+            const CDeck& piles = player.GetPiles();
 
-        if (mPoint.x > 752.0f && mPoint.x < 826.0f && mPoint.y < 494.0f && mPoint.y > 370.0f) {
-            player->GetDeck().at(8)->Hover();
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
+            for (size_t i = 0; i < piles.GetHandCount(); i++)
             {
-                cardNum = 8;
-                player->GetDeck().at(cardNum)->UpgradeCard();
-                player->SetCard(cardNum);
-                cardUpgraded = false;
-                for (int i = 0; i < player->GetDeck().size(); i++) {
-                    player->GetDeck().at(i)->AddCardRemove(i);
+                if (!IsMarked((int)piles.GetHandCard(i)))
+                {
+                    const CardSlot slot = m_cHandLayout.GetSlot(i);
+                    SoakClick(Vector2(slot.x, slot.y));
+                    break;
                 }
-                replaceCards();
-                state = GameState::Map;
             }
         }
+    }
+}
+
+//Play a frame of the soak test, which plays whole runs through the same
+//input handling, animation and drawing as the game, with its input chosen
+//by SoakInput. Memory use is recorded once the warm-up runs are done, to let
+//the allocator and caches settle, and when all of the runs are done it must
+//not have grown by more than soakGrowth bytes per run since, plus soakSlack
+//for the allocator's noise. The result goes to soak.txt and the exit code is
+//nonzero on failure
+void CGame::SoakStep()
+{
+    PROFILE_ZONE("SoakStep");
+
+    SoakInput();
+
+    if (soakBaseline == 0 && soakRun >= soakWarmup)
+        soakBaseline = GetResidentBytes();
+
+    if (soakRun < soakRuns)
+        return;
+
+    const size_t used = GetResidentBytes();
+    const size_t runs = soakRuns - soakWarmup;
+    const size_t growth = used > soakBaseline ? used - soakBaseline : 0;
+    const bool passed = growth <= soakSlack + soakGrowth * runs;
+
+    std::ofstream output("soak.txt");
+    output << "runs " << soakRuns << "\n";
+    output << "full runs every " << soakFullEvery << "\n";
+    output << "warm-up runs " << soakWarmup << "\n";
+    output << "baseline bytes " << soakBaseline << "\n";
+    output << "final bytes " << used << "\n";
+    output << "growth per run " << (runs > 0 ? growth / runs : 0) << "\n";
+    output << (passed ? "passed" : "FAILED") << "\n";
+    output.close();
+
+    BeginGame();
+    RequestQuit(passed ? 0 : 1);
+}
+
+//Set the most memory that images and sounds may take before those of the
+//states used least recently are unloaded. The assets of the current state
+//and the state likely to come next are always kept, even over budget. Call
+//before Initialize
+void CGame::SetAssetBudget(size_t bytes)
+{
+    assetBudget = bytes;
+}
+
+//Ask for the frame cost gate. It starts on the next frame and replaces
+//normal play until every screen has been measured, then the game exits. The
+//run is seeded so that the gate always sees the same map and enemies. With
+//update set, new budgets are written instead of the old ones being checked
+void CGame::StartGate(bool update)
+{
+    gating = true;
+    gateUpdate = update;
+    gateScreen = 0;
+    gateFrame = 0;
+    runSeed = gateSeed;
+    seededRun = true;
+}
+
+//Put the game on one of the gate's screens, as the game itself would get
+//there from a fresh run. Battles are fought in the first level with the
+//number of enemies in the screen name, which is more than a map level ever
+//has for the larger ones
+void CGame::GateSetup(size_t screen)
+{
+    const std::string name = g_pGateScreen[screen];
+    BeginGame();
+
+    if (name == "intro")
+        state = GameState::Intro;
+
+    else if (name == "map")
+        state = GameState::Map;
+
+    else if (name.compare(0, 6, "battle") == 0)
+    {
+        state = GameState::Battle;
+        numEnemies = atoi(name.c_str() + 6);
+        LoadEnemies(numEnemies);
+        currLevel = 0;
+        currLayer = 0;
+        cardNum = -10;
+        turnNum = 0;
+    }
+
+    else if (name == "newcard")
+    {
+        state = GameState::NewCard;
+        cardUpgraded = false;
+    }
+
+    else if (name == "nerd")
+        state = GameState::Nerd;
+
+    else if (name == "win" || name == "lose")
+    {
+        gameOver = true;
+        state = GameState::GameOver;
+        currLayer = name == "win" ? (int)layers.size() - 1 : 0;
+    }
+}
+
+//Play and measure a frame of the frame cost gate. Each screen is given
+//gateWarmup frames to load and settle, then the next gateFrames frames are
+//timed and counted. When every screen is done the costs are checked against
+//the budgets, with the result in the report file and a nonzero exit code on
+//failure, or written as the new budgets with 100% headroom on frame time
+void CGame::GateStep()
+{
+    if (gateFrame == 0)
+        GateSetup(gateScreen);
+
+    using clock = std::chrono::steady_clock;
+    const size_t allocations = GetAllocationCount();
+    const clock::time_point t0 = clock::now();
+
+    PlayFrame();
+
+    FrameCost cost;
+    cost.m_fMilliseconds = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    cost.m_nAllocations = GetAllocationCount() - allocations;
+    GetRenderStats(m_pRenderer, cost);
+
+    if (gateFrame >= gateWarmup)
+        m_cFrameGate.Add(g_pGateScreen[gateScreen], cost);
+
+    if (++gateFrame < gateWarmup + gateFrames)
+        return;
+
+    gateFrame = 0;
+
+    if (++gateScreen < g_nGateScreens)
+        return;
+
+    bool passed = false;
+
+    if (gateUpdate)
+        passed = CFrameGate::SaveBudgets(g_pFrameBudgetFile,
+            CFrameGate::MakeBudgets(m_cFrameGate.GetCosts(), 1.0));
+
+    else if (FILE* report = fopen(g_pFrameGateFile, "w"))
+    {
+        std::vector<ScreenCost> budgets;
+
+        if (CFrameGate::LoadBudgets(g_pFrameBudgetFile, budgets))
+            passed = m_cFrameGate.Check(budgets, report);
         else
+            fprintf(report, "cannot read %s\n", g_pFrameBudgetFile);
+
+        fprintf(report, "%s\n", passed ? "passed" : "FAILED");
+        fclose(report);
+    }
+
+    BeginGame();
+    RequestQuit(passed ? 0 : 1);
+}
+
+//Move on from the current level after its battle is won. If it was the boss
+//the run is over, otherwise the levels after it are unlocked and the player
+//gets to upgrade a card. Returns true if the run is over
+bool CGame::FinishLevel()
+{
+    m_bBattle = false; //the piles carry the deck on to the next battle
+    const bool boss = currLayer == (int)layers.size() - 1;
+    m_cTelemetry.Record(eTelemetry::LevelComplete, player.GetHealth(), boss);
+
+    if (boss)
+    {
+        gameOver = true;
+        state = GameState::GameOver;
+        return true;
+    }
+
+    progress.Complete(currLevel);
+    ShowProgress();
+    state = GameState::NewCard;
+    return false;
+}
+
+//Make the level sprites on the map show the progress: open doors for the
+//unlocked levels, closed doors for the rest and a check mark on complete
+//ones. The special level keeps its own sprite. Progress only ever grows
+//within a run, so check marks are never taken away
+void CGame::ShowProgress()
+{
+    for (int i = 0; i < progress.GetLevelCount(); i++)
+    {
+        if (!progress.IsSpecial(i))
         {
-            player->GetDeck().at(8)->Unhover();
+            if (progress.IsUnlocked(i))
+                m_pObjectManager->UnlockLevel(i);
+            else
+                m_pObjectManager->LockLevel(i);
         }
 
-        if (mPoint.x > 832.0f && mPoint.x < 906.0f && mPoint.y < 494.0f && mPoint.y > 370.0f) {
-            player->GetDeck().at(9)->Hover();
-            if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-            {
-                cardNum = 9;
-                player->GetDeck().at(cardNum)->UpgradeCard();
-                player->SetCard(cardNum);
-                cardUpgraded = false;
-                for (int i = 0; i < player->GetDeck().size(); i++) {
-                    player->GetDeck().at(i)->AddCardRemove(i);
-                }
-                replaceCards();
-                state = GameState::Map;
-            }
-        }
-        else
+        if (progress.IsComplete(i))
+            m_pObjectManager->CompleteLevel(i);
+    }
+}
+
+//The run can only be saved on the map or in a battle while waiting for the
+//player to choose a card, so that no animation is ever half done on resume
+bool CGame::CanSaveRun()
+{
+    if (gameOver || soakRun < soakRuns || gating)
+        return false;
+
+    if (state == GameState::Map)
+        return true;
+
+    return state == GameState::Battle && enemyUpdateIndex == -1 && cardNum == -10 &&
+        player.GetState() == PlayerState::WaitingForInput &&
+        !m_pObjectManager->GetEnemies().empty();
+}
+
+//Write the run to a snapshot: the map and which levels are unlocked and
+//complete, the deck and its piles, the player, the random number generators
+//and, in a battle, the enemies
+bool CGame::SaveRun(const char* path)
+{
+    RunSnapshot s;
+    SnapHeader& h = s.m_sHeader;
+
+    s.SetMap(m_sMap);
+
+    for (int i = 0; i < progress.GetLevelCount(); i++)
+    {
+        if (progress.IsUnlocked(i))
+            s.m_vNodes[i].m_nFlags |= SnapNode::Unlocked;
+        if (progress.IsComplete(i))
+            s.m_vNodes[i].m_nFlags |= SnapNode::Complete;
+    }
+
+    for (auto card : player.GetDeck())
+    {
+        SnapCard c;
+        c.m_nDamage = (int8_t)card.dealDamage();
+        c.m_nShield = (int8_t)card.giveShield();
+        c.m_nHealth = (int8_t)card.giveHealth();
+        s.m_vCards.push_back(c);
+    }
+
+    DeckState piles;
+    player.GetPiles().GetState(piles);
+    s.SetPiles(piles);
+
+    h.m_nMapRng = m_cMapRng.GetState();
+    h.m_nEnemyRng = m_cEnemyRng.GetState();
+    h.m_nHealth = (int16_t)player.GetHealth();
+    h.m_nShield = (int16_t)player.GetShield();
+    h.m_nLevel = (uint8_t)currLevel;
+    h.m_nLayer = (uint8_t)currLayer;
+
+    if (state == GameState::Battle)
+    {
+        h.m_nBattle = 1;
+        h.m_nTurn = (uint8_t)turnNum;
+
+        for (auto enemy : m_pObjectManager->GetEnemies())
         {
-            player->GetDeck().at(9)->Unhover();
+            SnapEnemy e;
+            e.m_nHealth = (int16_t)enemy.GetHealth();
+            e.m_nAttack = (uint8_t)enemy.GetView().m_eAttack;
+            s.m_vEnemies.push_back(e);
         }
     }
+
+    return SaveSnapshot(path, s);
 }
 
-void CGame::ChooseTarget(int numEnemies) {
-    findMouse(); //Find mouse position when button is clicked
-    Vector2 mousePos = Vector2(mPoint.x, m_nWinHeight - mPoint.y);
+//Start again from a snapshot. The game is begun afresh on the saved map and
+//then everything the snapshot holds is put back. A snapshot that cannot be
+//read, or whose deck does not match the player's, leaves the game as it was
+bool CGame::LoadRun(const char* path)
+{
+    RunSnapshot s;
+
+    if (!LoadSnapshot(path, s) || s.m_vCards.size() != player.GetDeck().size())
+        return false;
+
+    const SnapHeader& h = s.m_sHeader;
+    MapDesc map;
+    s.GetMap(map);
+    BeginGame(&map);
+
+    //Put back which levels are unlocked and complete
+    MapProgress saved;
 
-    if (shuffleTracker == 1) {
-        cardNum = cardNum + 5;
+    for (int i = 0; i < progress.GetLevelCount(); i++)
+    {
+        if (s.m_vNodes[i].m_nFlags & SnapNode::Unlocked)
+            saved.m_nUnlocked |= 1ULL << i;
+        if (s.m_vNodes[i].m_nFlags & SnapNode::Complete)
+            saved.m_nComplete |= 1ULL << i;
     }
 
-    //If the selected card deals damage, select an enemy
-    if (player->GetDeck().at(cardNum)->dealDamage() > 0)
+    progress.SetProgress(saved);
+    ShowProgress();
+
+    for (size_t i = 0; i < s.m_vCards.size(); i++)
     {
-        switch (numEnemies) {
-        case 1:
-            if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 463.0f && mPoint.y > 305.0f && !IsMarked(cardNum)) {
-                choseEnemy = 0;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else {
-                player->GetDeck().at(cardNum)->Unselect();
-                cardNum = -10;
+        const SnapCard& c = s.m_vCards[i];
+        player.GetDeck().at(i).createCard(c.m_nDamage, c.m_nShield, c.m_nHealth);
+    }
 
-                player->SetNormal();
-            }
-            break;
-        case 2:
-            if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 351.0f && mPoint.y > 191.0f && !IsMarked(cardNum)) {
-                choseEnemy = 0;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 575.0f && mPoint.y > 415.0f && !IsMarked(cardNum)) {
-                choseEnemy = 1;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else {
-                player->GetDeck().at(cardNum)->Unselect();
-                cardNum = -10;
+    removeCards();
+    DeckState piles;
+    s.GetPiles(piles);
+    player.GetPiles().SetState(piles);
 
-                player->SetNormal();
-            }
-            break;
-        case 3:
-            if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 239.0f && mPoint.y > 76.0f && !IsMarked(cardNum)) {
-                choseEnemy = 0;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 463.0f && mPoint.y > 303.0f && !IsMarked(cardNum)) {
-                choseEnemy = 1;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 688.0f && mPoint.y > 527.0f && !IsMarked(cardNum)) {
-                choseEnemy = 2;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else {
-                player->GetDeck().at(cardNum)->Unselect();
-                cardNum = -10;
+    m_cMapRng.SetState(h.m_nMapRng);
+    m_cEnemyRng.SetState(h.m_nEnemyRng);
+    player.SetHealth(h.m_nHealth);
+    player.SetShield(h.m_nShield);
+    currLevel = h.m_nLevel;
+    currLayer = h.m_nLayer;
+    state = GameState::Map;
 
-                player->SetNormal();
-            }
-            break;
-        case 4:
-            if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 239.0f && mPoint.y > 76.0f && !IsMarked(cardNum)) {
-                choseEnemy = 0;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 463.0f && mPoint.y > 303.0f && !IsMarked(cardNum)) {
-                choseEnemy = 1;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 688.0f && mPoint.y > 527.0f && !IsMarked(cardNum)) {
-                choseEnemy = 2;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else if (mPoint.x > 706.0f && mPoint.x < 798.0f && mPoint.y < 462.0f && mPoint.y > 302.0f && !IsMarked(cardNum)) {
-                choseEnemy = 3;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else {
-                player->GetDeck().at(cardNum)->Unselect();
-                cardNum = -10;
+    if (h.m_nBattle)
+    {
+        state = GameState::Battle;
+        numEnemies = (int)s.m_vEnemies.size();
+        LoadEnemies(numEnemies);
 
-                player->SetNormal();
-            }
-            break;
-        case 5:
-            if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 239.0f && mPoint.y > 76.0f && !IsMarked(cardNum)) {
-                choseEnemy = 0;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-            }
-            else if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 463.0f && mPoint.y > 303.0f && !IsMarked(cardNum)) {
-                choseEnemy = 1;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else if (mPoint.x > 855.0f && mPoint.x < 943.0f && mPoint.y < 688.0f && mPoint.y > 527.0f && !IsMarked(cardNum)) {
-                choseEnemy = 2;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else if (mPoint.x > 706.0f && mPoint.x < 798.0f && mPoint.y < 351.0f && mPoint.y > 189.0f && !IsMarked(cardNum)) {
-                choseEnemy = 3;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else if (mPoint.x > 706.0f && mPoint.x < 798.0f && mPoint.y < 577.0f && mPoint.y > 415.0f && !IsMarked(cardNum)) {
-                choseEnemy = 4;
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));
-                player->SetNormal();
-            }
-            else {
-                player->GetDeck().at(cardNum)->Unselect();
-                cardNum = -10;
+        for (size_t i = 0; i < s.m_vEnemies.size(); i++)
+        {
+            auto enemy = m_pObjectManager->GetEnemies()[i];
 
-                player->SetNormal();
-            }
-            break;
-        default:
-            break;
+            if ((EnemyAttack)s.m_vEnemies[i].m_nAttack == EnemyAttack::Lame)
+                enemy.SetBoss();
+            enemy.SetHealth(s.m_vEnemies[i].m_nHealth);
         }
+
+        turnNum = h.m_nTurn;
+        StartBattle(); //again, with the saved enemies
     }
-    else //Otherwise, select the player
+
+    //Deal the saved hand, hiding the cards already played from it
+    replaceCards();
+
+    const CDeck& hand = player.GetPiles();
+    for (size_t i = 0; i < hand.GetHandCount(); i++)
+        if (hand.IsPlayed(hand.GetHandCard(i)))
+            player.GetDeck().at(hand.GetHandCard(i)).Hide();
+
+    m_cTelemetry.SetLevel(currLevel);
+    m_cTelemetry.Record(eTelemetry::RunResume, player.GetHealth());
+    return true;
+}
+
+//Create the enemies of a battle, the first of them the boss if there is one,
+//and start the battle
+void CGame::LoadEnemies(int numEnemies, bool boss)
+{
+    for (int i = 0; i < numEnemies; i++)
     {
-        if (m_pKeyboard->TriggerDown(VK_LBUTTON))
-        {
-            float playerWidth = m_pRenderer->GetWidth(eSprite::Player);
-            float playerHeight = m_pRenderer->GetHeight(eSprite::Player);
+        m_pObjectManager->CreateEnemy(Vector2(125, 430));
+    }
 
-            Vector2 bottomRight = Vector2(player->m_vPos.x + playerWidth / 2, player->m_vPos.y + playerHeight / 2);
-            Vector2 topLeft = Vector2(player->m_vPos.x - playerWidth / 2, player->m_vPos.y - playerHeight / 2);
+    m_pObjectManager->PositionEnemies();
 
-            if(mPoint.x > 79.0f && mPoint.x < 174.0f && mPoint.y < 410.0f && mPoint.y > 267.0f /* && !IsMarked(cardNum) */ )
-            //if (mousePos.x >= topLeft.x && mousePos.x <= bottomRight.x &&
-            //    mousePos.y >= topLeft.y && mousePos.y <= bottomRight.y)
-            {
-                turnNum++;
-                player->GetDeck().at(cardNum)->RemoveCard(cardNum);
-                markUsed(cardNum);
-                player->PlayCard(Vector2(m_nWinWidth / 2.0f, m_nWinHeight / 2.0f));   
+    if (boss)
+        m_pObjectManager->GetEnemies().at(0).SetBoss();
 
-                for (auto enemy : m_pObjectManager->GetEnemies())
-                {
-                    enemy->SetNormal();
-                }
-            }
-            else
-            {
-                player->GetDeck().at(cardNum)->Unselect();
-                cardNum = -10;
+    StartBattle();
+}
 
-                for (auto enemy : m_pObjectManager->GetEnemies())
-                {
-                    enemy->SetNormal();
-                }
-            }
+//Put the battle that has just been set up into the battle state: the
+//player's health, shield, cards and piles, the enemies and the enemy random
+//number generator. From here on the battle is fought on the battle state,
+//and the player and enemies only show it. A battle with more enemies or
+//cards than a battle state holds, such as the benchmark encounter, is kept
+//as a CEncounter instead, which works out the enemies' damage and intents
+void CGame::StartBattle()
+{
+    const std::vector<Enemy>& enemies = m_pObjectManager->GetEnemies();
+    const std::vector<Card>& deck = player.GetDeck();
+    const CDeck& piles = player.GetPiles();
+    DeckState saved;
+    piles.GetState(saved);
+
+    BattleState& s = m_sBattle;
+    s = BattleState();
+
+    m_bBattle = enemies.size() <= BattleState::MaxEnemies &&
+        deck.size() <= BattleState::MaxCards && s.SetPiles(saved);
+
+    if (!m_bBattle)
+    {
+        m_cEncounter.Create(enemies.size(), 0);
+
+        for (size_t i = 0; i < enemies.size(); i++)
+        {
+            m_cEncounter.SetHealth(i, enemies[i].GetHealth());
+            m_cEncounter.SetAttack(i, enemies[i].GetView().m_eAttack);
         }
+
+        return;
+    }
+
+    m_cEncounter.Clear();
+    s.m_nEnemyRng = m_cEnemyRng.GetState();
+    s.m_nHealth = (int16_t)player.GetHealth();
+    s.m_nShield = (int16_t)player.GetShield();
+
+    for (size_t i = 0; i < deck.size(); i++)
+    {
+        s.m_pCard[i].m_nDamage = (int8_t)deck[i].dealDamage();
+        s.m_pCard[i].m_nShield = (int8_t)deck[i].giveShield();
+        s.m_pCard[i].m_nHealth = (int8_t)deck[i].giveHealth();
+    }
+
+    for (size_t i = 0; i < piles.GetHandCount(); i++)
+        if (piles.IsPlayed(piles.GetHandCard(i)))
+            s.m_nPlayed++;
+
+    s.m_nEnemies = (uint8_t)enemies.size();
+
+    for (size_t i = 0; i < enemies.size(); i++)
+    {
+        s.m_pEnemy[i].m_nHealth = (int16_t)enemies[i].GetHealth();
+        s.m_pEnemy[i].m_nAttack = (uint8_t)enemies[i].GetView().m_eAttack;
     }
 }
 
-void CGame::LoadEnemies(int numEnemies)
+//Make the player and enemies show the battle state: health, shield and the
+//card piles. Enemies that the state has removed must already have been
+//removed from the object manager
+void CGame::ShowBattle()
 {
-    for (int i = 0; i < numEnemies; i++)
+    player.SetHealth(m_sBattle.m_nHealth);
+    player.SetShield(m_sBattle.m_nShield);
+
+    DeckState piles;
+    m_sBattle.GetPiles(piles);
+    player.GetPiles().SetState(piles);
+
+    const std::vector<Enemy>& enemies = m_pObjectManager->GetEnemies();
+
+    for (size_t i = 0; i < enemies.size() && i < m_sBattle.m_nEnemies; i++)
+        enemies[i].SetHealth(m_sBattle.m_pEnemy[i].m_nHealth);
+
+    m_cEnemyRng.SetState(m_sBattle.m_nEnemyRng);
+}
+
+//Hit the chosen enemy of a battle fought on the encounter, and remove it
+//from both the encounter and the object manager if it dies
+void CGame::DamageEnemy(int index, int damage)
+{
+    auto enemy = m_pObjectManager->GetEnemies()[index];
+    const bool killed = m_cEncounter.Damage(index, damage) > 0;
+    const int health = m_cEncounter.GetHealth(index);
+
+    enemy.Hit(health);
+    m_cTelemetry.Record(eTelemetry::DamageDealt, index, damage, health, killed);
+
+    if (killed)
     {
-        m_pObjectManager->create(eSprite::Enemy, Vector2(125, 430));
+        m_cEncounter.RemoveDead();
+        m_pObjectManager->RemoveEnemy(index);
     }
 }
+
+//Hit every enemy of a large encounter at once. The health arithmetic is one
+//vectorized pass over the encounter, then each enemy shows its hit and the
+//dead are removed from both in one pass each
+void CGame::DamageAllEnemies(int damage)
+{
+    m_cEncounter.DamageAll(damage);
+    const std::vector<Enemy>& enemies = m_pObjectManager->GetEnemies();
+
+    for (size_t i = 0; i < enemies.size(); i++)
+    {
+        const int health = m_cEncounter.GetHealth(i);
+        const bool killed = enemies[i].Hit(health);
+        m_cTelemetry.Record(eTelemetry::DamageDealt, (int)i, damage, health, killed);
+    }
+
+    m_cEncounter.RemoveDead();
+    m_pObjectManager->RemoveDeadEnemies();
+}
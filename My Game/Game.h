@@ -8,11 +8,20 @@
 #include "Common.h"
 #include "ObjectManager.h"
 #include "Settings.h"
-#include "Random.h"
+#include "Rng.h"
+#include "AssetLoader.h"
+#include "BattleState.h"
 #include "Player.h"
 #include "Card.h"
+#include "Encounter.h"
+#include "FileWatcher.h"
+#include "FrameGate.h"
+#include "HandLayout.h"
+#include "MapGenerator.h"
+#include "MapProgress.h"
 #include "Node.h"
 #include "AdjacencyListEntry.h"
+#include "Telemetry.h"
 
 /// \brief The game class.
 ///
@@ -30,12 +39,64 @@ class CGame:
 
   private:
     bool m_bDrawFrameRate = false; ///< Draw the frame rate.
+    CAssetLoader m_cAssets; ///< Loads images and sounds in the background.
+    const double assetMilliseconds = 4.0; ///< Time per frame spent committing assets.
+    size_t assetBudget = 48 << 20; ///< Most memory for assets before unused ones are unloaded.
+    int assetState = -1; ///< State whose assets were put first, -1 for none.
+    size_t assetThreads = 0; ///< Number of asset loader threads.
+    CFileWatcher m_cWatcher; ///< Watches the files that can be read again for changes.
     bool gameOver = false;
     bool cardUpgraded = false;
     std::vector<std::vector<Node>> layers;
     std::vector<std::vector<AdjacencyListEntry>> levelAdjacencyLists;
-    std::vector<Node*> currentlyUnlockedNodes;
-    std::vector<int> usedCards{ 0,0,0,0,0,0,0,0,0,0 };
+    CMapProgress progress; ///< Which levels are unlocked, complete and reachable.
+    CTelemetry m_cTelemetry; ///< Records what happens in each run.
+    uint32_t frameNumber = 0; ///< Frames played, for telemetry.
+
+    CHandLayout m_cHandLayout; ///< Layout of the hand on the battle screen.
+    CHandLayout m_cDrawLayout; ///< Layout of the draw pile preview.
+    CHandLayout m_cUpgradeLayout; ///< Layout of the deck on the upgrade screen.
+    const int handSize = 5; ///< Number of cards dealt per hand.
+    int hoverCard = -1; ///< Deck index of the card under the mouse.
+
+    CRng m_cEnemyRng; ///< Random number generator for enemy decisions.
+    CRng m_cMapRng; ///< Random number generator for the map.
+    MapDesc m_sMap; ///< The current map.
+    uint64_t runSeed = 0; ///< Seed of the catalog run, if any.
+    uint64_t startSeed = 0; ///< Seed the current run was started from.
+    bool seededRun = false; ///< Play the catalog run instead of a random one.
+    std::vector<EnemyCard> m_vEnemyIntents; ///< Planned enemy cards.
+    BattleState m_sBattle; ///< The battle being fought, which the player and enemies show.
+    bool m_bBattle = false; ///< A battle is being fought on m_sBattle.
+    CEncounter m_cEncounter; ///< Enemies of a battle too large for a battle state, empty otherwise.
+
+    bool fastCombat = false; ///< Play enemy turns on one shared timeline.
+    bool fastEnemyTurn = false; ///< The current enemy turn is a fast one.
+    const float fastPlayTime = 1.0f; ///< Time each enemy plays its card for in fast combat.
+    const float fastStagger = 0.25f; ///< Delay between enemies starting in fast combat.
+    const float fastMaxSpread = 1.5f; ///< Latest any enemy starts in fast combat.
+    const size_t fastMaxSounds = 8; ///< Most enemies heard per fast enemy turn.
+
+    size_t soakRuns = 0; ///< Number of soak test runs to play.
+    size_t soakRun = 0; ///< Number of soak test runs played.
+    size_t soakBaseline = 0; ///< Memory use once the soak test has warmed up.
+    size_t soakFullEvery = 1; ///< The soak test plays every this many runs in full.
+    size_t soakWarmup = 0; ///< Soak test runs played before the baseline is taken.
+    WPARAM soakKey = 0; ///< Key or mouse button the soak test presses this frame, 0 for none.
+    POINT soakMouse = {0, 0}; ///< Mouse position the soak test gives, in window coordinates.
+    const size_t soakFullRuns = 20; ///< Soak test runs played in full, the rest are quick.
+    const size_t soakGrowth = 32; ///< Most memory growth allowed per soak test run after the warm-up.
+    const size_t soakSlack = 256 << 10; ///< Memory growth allowed for allocator noise in a soak test.
+    const size_t soakDeck = 20; ///< Deck size for the soak test's large deck runs.
+
+    bool gating = false; ///< Play the frame cost gate instead of the game.
+    bool gateUpdate = false; ///< Write new budgets instead of checking them.
+    size_t gateScreen = 0; ///< Screen the frame cost gate is on.
+    size_t gateFrame = 0; ///< Frames drawn on that screen.
+    const size_t gateWarmup = 20; ///< Frames drawn on a screen before it is measured.
+    const size_t gateFrames = 100; ///< Frames measured on each screen.
+    const uint64_t gateSeed = 1; ///< Run seed for the frame cost gate.
+    CFrameGate m_cFrameGate; ///< Frame costs measured by the gate.
 
     POINT mPoint;
 
@@ -43,32 +104,63 @@ class CGame:
     int currLevel;
     int currLayer;
     int tempInt = 0;
-    int numEnemies, choseEnemy = 0, turnNum = 0, shuffleTracker = 0;
+    int numEnemies, choseEnemy = 0, turnNum = 0;
     
     void LoadImages(); ///< Load images.
     void LoadSounds(); ///< Load sounds.
-    void BeginGame(); ///< Begin playing the game.
+    void LoadAssets(); ///< Load the current state's assets.
+    void HotReload(); ///< Read changed settings, images, sounds and balance again.
+    void BeginGame(const MapDesc* pMap=nullptr); ///< Begin playing the game.
     void CreateObjects(); ///< Create game objects.
     void KeyboardHandler(); ///< The keyboard handler.
     void RenderFrame(); ///< Render an animation frame.
     void DrawFrameRateText(); ///< Draw frame rate text to screen.
+    void DrawProfileText(); ///< Draw profiler overlay to screen.
     void DrawGameOverText();
-    void LoadEnemies(int numEnemies);
+    void LoadEnemies(int numEnemies, bool boss=false);
+    void StartBattle();
+    void ShowBattle();
     void findMouse();
     void chooseCard();
     void markUsed(int);
     bool IsMarked(int);
     void replaceCards();
     void removeCards();
+    void nextHand();
+    void hoverOver(int);
     void drawCards();
-    void clearUsed();
-    void ChooseTarget(int numEnemies);
+    void DrawPilePreview();
+    void ChooseTarget();
+    void PlayCard();
+    void DamageEnemy(int index, int damage);
+    void DamageAllEnemies(int damage);
+    void PlanEnemyTurn();
+    void StartFastEnemyTurn();
+    void FastEnemyTurn();
+    bool ResolveEnemyCard(int index);
+    void EndEnemyTurn();
+    bool TriggerDown(WPARAM key);
+    void SoakClick(const Vector2& pos);
+    void SoakInput();
+    void SoakStep();
+    void GateSetup(size_t screen);
+    void GateStep();
+    void PlayFrame(); ///< Play an animation frame.
+    bool FinishLevel();
+    void ShowProgress();
+    bool CanSaveRun();
+    bool SaveRun(const char* path);
+    bool LoadRun(const char* path);
 
   public:
     ~CGame(); ///< Destructor.
 
     void Initialize(); ///< Initialize the game.
     void ProcessFrame(); ///< Process an animation frame.
+    void StartSoak(size_t runs=10000); ///< Play a soak test instead of the game.
+    void StartGate(bool update); ///< Play the frame cost gate instead of the game.
+    void SetAssetBudget(size_t bytes); ///< Set the memory budget for assets.
+    bool UseCatalogRun(const char* name); ///< Play a named run from the seed catalog.
     void Release(); ///< Release the renderer.
 
 }; //CGame
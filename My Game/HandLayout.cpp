@@ -0,0 +1,141 @@
+/// \file HandLayout.cpp
+/// \brief Code for the card layout class CHandLayout.
+
+#include <algorithm>
+#include <cmath>
+
+#include "HandLayout.h"
+
+/// Create an empty layout with default parameters.
+
+CHandLayout::CHandLayout(){
+} //default constructor
+
+/// Create an empty layout.
+/// \param d Layout descriptor.
+
+CHandLayout::CHandLayout(const LayoutDesc& d):
+  m_sDesc(d){
+} //constructor
+
+/// Get the layout descriptor for one of the places the game shows cards.
+/// The hand sits along the bottom of the battle screen, the draw preview is
+/// a tightly stacked pile to the left of the hand, and the upgrade screen
+/// shows the whole deck in rows of ten across the middle of the screen.
+/// \param t Layout kind.
+/// \return Layout descriptor for that kind.
+
+LayoutDesc CHandLayout::Preset(eLayout t){
+  LayoutDesc d;
+
+  switch(t){
+    case eLayout::Hand:
+      d.m_fCenterX = 510.0f;
+      d.m_fTopY = 125.0f;
+      d.m_fMaxRowWidth = 700.0f;
+      d.m_nMaxPerRow = 64;
+    break;
+
+    case eLayout::DrawPreview:
+      d.m_fCenterX = 230.0f;
+      d.m_fTopY = 125.0f;
+      d.m_fGap = 3.0f - d.m_fCardWidth; //stacked, 3 pixels apart
+      d.m_fMaxRowWidth = 120.0f;
+      d.m_nMaxPerRow = 64;
+    break;
+
+    case eLayout::Upgrade:
+      d.m_fCenterX = 510.0f;
+      d.m_fTopY = 335.0f;
+      d.m_fMaxRowWidth = 1000.0f;
+      d.m_nMaxPerRow = 10;
+    break;
+  } //switch
+
+  return d;
+} //Preset
+
+/// Compute the row structure and slot spacing for a given number of cards.
+/// If a full row would be wider than the maximum row width, the cards in it
+/// are overlapped just enough to make it fit.
+/// \param n Number of cards.
+
+void CHandLayout::Arrange(size_t n){
+  m_nCount = n;
+  m_nPerRow = std::max<size_t>(1, std::min(n, m_sDesc.m_nMaxPerRow));
+  m_nRows = (n + m_nPerRow - 1)/m_nPerRow;
+
+  m_fPitch = m_sDesc.m_fCardWidth + m_sDesc.m_fGap;
+  m_fRowPitch = m_sDesc.m_fCardHeight + m_sDesc.m_fRowGap;
+
+  if(m_nPerRow > 1){
+    const float w = (m_nPerRow - 1)*m_fPitch + m_sDesc.m_fCardWidth;
+
+    if(w > m_sDesc.m_fMaxRowWidth)
+      m_fPitch = std::max(1.0f,
+        (m_sDesc.m_fMaxRowWidth - m_sDesc.m_fCardWidth)/(m_nPerRow - 1));
+  } //if
+} //Arrange
+
+/// Get the number of slots in a row. Every row is full except possibly the
+/// last one.
+/// \param row Row index.
+/// \return Number of slots in that row.
+
+size_t CHandLayout::RowCount(size_t row) const{
+  const size_t first = row*m_nPerRow;
+  return first < m_nCount? std::min(m_nPerRow, m_nCount - first): 0;
+} //RowCount
+
+/// Get the horizontal position of the first slot in a row, which is chosen
+/// so that the row is centered.
+/// \param row Row index.
+/// \return Horizontal position of the first slot center.
+
+float CHandLayout::RowLeft(size_t row) const{
+  return m_sDesc.m_fCenterX - 0.5f*((float)RowCount(row) - 1.0f)*m_fPitch;
+} //RowLeft
+
+/// Get the position of a slot.
+/// \param i Slot index.
+/// \return Center of the slot.
+
+CardSlot CHandLayout::GetSlot(size_t i) const{
+  const size_t row = i/m_nPerRow;
+  const size_t col = i%m_nPerRow;
+
+  CardSlot s;
+  s.x = RowLeft(row) + col*m_fPitch;
+  s.y = m_sDesc.m_fTopY - row*m_fRowPitch;
+  return s;
+} //GetSlot
+
+/// Find the slot under a point by computing its row and column directly
+/// rather than testing every slot. Where cards overlap, the point goes to
+/// the slot whose center is closest.
+/// \param x Horizontal position in world space.
+/// \param y Vertical position in world space.
+/// \return Slot index, or -1 if the point is not on a card.
+
+int CHandLayout::HitTest(float x, float y) const{
+  if(m_nCount == 0)return -1;
+
+  const float halfw = 0.5f*m_sDesc.m_fCardWidth;
+  const float halfh = 0.5f*m_sDesc.m_fCardHeight;
+
+  const float r = std::floor((m_sDesc.m_fTopY + halfh - y)/m_fRowPitch);
+  if(r < 0.0f || r >= (float)m_nRows)return -1;
+
+  const size_t row = (size_t)r;
+  const float cy = m_sDesc.m_fTopY - row*m_fRowPitch;
+  if(std::fabs(y - cy) > halfh)return -1;
+
+  const float left = RowLeft(row);
+  const float c = std::floor((x - left)/m_fPitch + 0.5f);
+  const float last = (float)(RowCount(row) - 1);
+  const size_t col = (size_t)std::min(std::max(c, 0.0f), last);
+
+  if(std::fabs(x - (left + col*m_fPitch)) > halfw)return -1;
+
+  return (int)(row*m_nPerRow + col);
+} //HitTest
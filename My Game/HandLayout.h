@@ -0,0 +1,74 @@
+/// \file HandLayout.h
+/// \brief Interface for the card layout class CHandLayout.
+
+#ifndef __L4RC_GAME_HANDLAYOUT_H__
+#define __L4RC_GAME_HANDLAYOUT_H__
+
+#include <cstddef>
+
+/// \brief Card layout kinds.
+///
+/// The places where the game lays out a row of cards. Each one has a preset
+/// layout descriptor, see `CHandLayout::Preset()`.
+
+enum class eLayout{
+  Hand, DrawPreview, Upgrade
+}; //eLayout
+
+/// \brief The center of a card slot in world space (y up).
+
+struct CardSlot{
+  float x = 0.0f; ///< Horizontal position.
+  float y = 0.0f; ///< Vertical position.
+}; //CardSlot
+
+/// \brief Card layout descriptor.
+///
+/// The parameters from which slot positions are computed. Rows are centered
+/// on `m_fCenterX` and grow downwards from `m_fTopY`.
+
+struct LayoutDesc{
+  float m_fCenterX = 0.0f; ///< Horizontal center of every row.
+  float m_fTopY = 0.0f; ///< Vertical center of the first row.
+  float m_fCardWidth = 75.0f; ///< Card sprite width.
+  float m_fCardHeight = 125.0f; ///< Card sprite height.
+  float m_fGap = 5.0f; ///< Horizontal gap between neighbouring cards.
+  float m_fRowGap = 5.0f; ///< Vertical gap between rows.
+  float m_fMaxRowWidth = 1000.0f; ///< Wider rows are overlapped to fit.
+  size_t m_nMaxPerRow = 10; ///< Cards past this many wrap onto a new row.
+}; //LayoutDesc
+
+/// \brief The card layout.
+///
+/// Computes the slot positions for a given number of cards from a layout
+/// descriptor. All of the work is done in `Arrange()`, which is called only
+/// when the card count changes, so that `GetSlot()` and `HitTest()` are
+/// constant time no matter how large the deck gets.
+
+class CHandLayout{
+  private:
+    LayoutDesc m_sDesc; ///< Layout parameters.
+    size_t m_nCount = 0; ///< Number of slots.
+    size_t m_nPerRow = 1; ///< Number of slots in a full row.
+    size_t m_nRows = 0; ///< Number of rows.
+    float m_fPitch = 0.0f; ///< Horizontal distance between slot centers.
+    float m_fRowPitch = 0.0f; ///< Vertical distance between row centers.
+
+    size_t RowCount(size_t row) const; ///< Number of slots in a row.
+    float RowLeft(size_t row) const; ///< Center of first slot in a row.
+
+  public:
+    CHandLayout(); ///< Default constructor.
+    CHandLayout(const LayoutDesc&); ///< Constructor.
+
+    static LayoutDesc Preset(eLayout); ///< Layout descriptor for the game.
+
+    void Arrange(size_t n); ///< Compute the layout for n cards.
+    CardSlot GetSlot(size_t i) const; ///< Get position of slot i.
+    int HitTest(float x, float y) const; ///< Get slot under a point.
+
+    size_t GetCount() const { return m_nCount; } ///< Get number of slots.
+    const LayoutDesc& GetDesc() const { return m_sDesc; } ///< Get parameters.
+}; //CHandLayout
+
+#endif //__L4RC_GAME_HANDLAYOUT_H__
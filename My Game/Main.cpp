@@ -1,6 +1,12 @@
 /// \file Main.cpp 
 /// \brief Every program has to have a main.
 
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+
 #include "Game.h"
 #include "Window.h"
 
@@ -13,12 +19,18 @@
 static LWindow g_cWindow; ///< The window class.
 static CGame g_cGame; ///< The game class.
 
+#ifdef _WIN32
+
 /// \brief The main entry point for this application.  
 ///
 /// The main entry point for this application. 
 /// \param hInstance Handle to the current instance of this application.
 /// \param hPrevInstance Unused.
-/// \param lpCmdLine Unused.
+/// \param lpCmdLine Command line. `-soak` plays a soak test instead of the game,
+///   of 10000 runs unless followed by the number of runs.
+///   `-run name` plays the named run from the seed catalog. `-gate` measures
+///   the cost of every screen against the frame budgets and `-gate-update`
+///   writes new budgets.
 /// \param nCmdShow Nonzero if window is to be shown.
 /// \return 0 If this application terminates correctly, otherwise an error code.
 
@@ -26,7 +38,6 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
   _In_ LPWSTR lpCmdLine, _In_ int nCmdShow)
 {
   UNREFERENCED_PARAMETER(hPrevInstance);
-  UNREFERENCED_PARAMETER(lpCmdLine);
   UNREFERENCED_PARAMETER(nCmdShow);
   
   #ifdef USE_DEBUG_CONSOLE
@@ -35,9 +46,89 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     const bool console = false;
   #endif //USE_DEBUG_CONSOLE
 
+  if(const wchar_t* p = wcsstr(lpCmdLine, L"-soak")){ //leak test, see CGame::SoakStep
+    const size_t runs = wcstoul(p + 5, nullptr, 10);
+    if(runs > 0)g_cGame.StartSoak(runs);
+    else g_cGame.StartSoak();
+  } //if
+
+  if(wcsstr(lpCmdLine, L"-gate-update") != nullptr) //see CGame::GateStep
+    g_cGame.StartGate(true);
+  else if(wcsstr(lpCmdLine, L"-gate") != nullptr)
+    g_cGame.StartGate(false);
+
+  if(const wchar_t* p = wcsstr(lpCmdLine, L"-run ")){ //named run, see CSeedCatalog
+    char name[64] = {};
+    p += 5;
+
+    for(size_t i=0; i<sizeof(name) - 1 && p[i] > L' ' && p[i] < 128; i++)
+      name[i] = (char)p[i];
+
+    g_cGame.UseCatalogRun(name);
+  } //if
+
   auto init    = [&](){g_cGame.Initialize();};
   auto process = [&](){g_cGame.ProcessFrame();};
   auto release = [&](){g_cGame.Release();};
 
   return g_cWindow.WinMain(hInstance, console, init, process, release);
 } //wWinMain
+
+#else //headless platform, see LWindow
+
+/// \brief The main entry point for this application without a window.
+///
+/// Runs the game on the headless platform with input from a script.
+/// \param argc Number of arguments.
+/// \param argv Arguments. `-soak` plays a soak test instead of the game, of
+///   10000 runs unless followed by the number of runs, `-run name` plays the named run from the seed catalog, `-gate` measures
+///   the cost of every screen against the frame budgets, `-gate-update`
+///   writes new budgets, `-assets mb` sets the memory budget for images and
+///   sounds, `-audio file` writes the mixed sound to a WAV file,
+///   `-script file` reads input from a script and
+///   `-frames n` stops after n frames, 0 for when the game quits. The
+///   default is a minute of game time, or until the soak test or the gate
+///   ends.
+/// \return 0 If this application terminates correctly, otherwise an error code.
+
+int main(int argc, char* argv[]){
+  LHeadlessDesc desc;
+  bool soak = false;
+  size_t soakRuns = 0;
+  bool gate = false;
+  bool frames = false;
+
+  for(int i=1; i<argc; i++){
+    const char* a = argv[i];
+    const bool more = i + 1 < argc;
+
+    if(strcmp(a, "-soak") == 0){
+      soak = true;
+      if(more && isdigit((unsigned char)argv[i + 1][0]))soakRuns = strtoul(argv[++i], nullptr, 0);
+    } //if
+    else if(strcmp(a, "-gate") == 0){g_cGame.StartGate(false); gate = true;}
+    else if(strcmp(a, "-gate-update") == 0){g_cGame.StartGate(true); gate = true;}
+    else if(strcmp(a, "-run") == 0 && more)g_cGame.UseCatalogRun(argv[++i]);
+    else if(strcmp(a, "-assets") == 0 && more)g_cGame.SetAssetBudget(strtoul(argv[++i], nullptr, 0) << 20);
+    else if(strcmp(a, "-audio") == 0 && more)desc.m_strAudio = argv[++i];
+    else if(strcmp(a, "-script") == 0 && more)desc.m_strScript = argv[++i];
+    else if(strcmp(a, "-frames") == 0 && more){desc.m_nFrames = strtoul(argv[++i], nullptr, 0); frames = true;}
+
+    else{
+      fprintf(stderr, "usage: %s [-soak [runs]] [-gate] [-gate-update] [-assets mb] [-audio file] [-run name] [-script file] [-frames n]\n", argv[0]);
+      return 2;
+    } //else
+  } //for
+
+  if(soak && soakRuns > 0)g_cGame.StartSoak(soakRuns);
+  else if(soak)g_cGame.StartSoak();
+  if(!frames)desc.m_nFrames = soak || gate? 0: 3600;
+
+  auto init    = [&](){g_cGame.Initialize();};
+  auto process = [&](){g_cGame.ProcessFrame();};
+  auto release = [&](){g_cGame.Release();};
+
+  return g_cWindow.Run(desc, init, process, release);
+} //main
+
+#endif //_WIN32
@@ -0,0 +1,239 @@
+/// \file MapGenerator.cpp
+/// \brief Code for the map generator CMapGenerator.
+
+#include <algorithm>
+
+#include "Balance.h"
+#include "MapGenerator.h"
+
+/// Get a level by number. Levels are numbered in layer order, so this walks
+/// the layers rather than searching them.
+/// \param id Level number.
+/// \return Reference to the level.
+
+MapNode& MapDesc::GetNode(int id){
+  size_t i = 0;
+
+  while(id >= (int)m_vLayers[i].size()){
+    id -= (int)m_vLayers[i].size();
+    ++i;
+  } //while
+
+  return m_vLayers[i][id];
+} //GetNode
+
+/// Add a path from a level in one layer to a level in another.
+/// \param map The map.
+/// \param list Adjacency list to add the path to.
+/// \param i Layer of the level the path starts at.
+/// \param j Index of that level in its layer.
+/// \param k Layer of the level the path leads to.
+/// \param l Index of that level in its layer.
+
+void CMapGenerator::Link(MapDesc& map, std::vector<MapEdge>& list,
+  int i, int j, int k, int l)
+{
+  MapEdge e;
+  e.m_nFrom = map.m_vLayers[i][j].m_nId;
+  e.m_nTo = map.m_vLayers[k][l].m_nId;
+  list.push_back(e);
+} //Link
+
+/// Make every random choice for a map, in the same order as the map
+/// generator always has, so that a given generator state still gives the
+/// same map. The first and last layers have a single level and the layers in
+/// between have up to four. The special card level goes in one of the upper
+/// middle layers. Nothing is allocated, so this is cheap enough to run on
+/// millions of seeds.
+/// \param rng Random number generator.
+/// \param layout [out] The random choices.
+
+void CMapGenerator::DrawLayout(CRng& rng, MapLayout& layout){
+  for(int i=0; i<NumLayers; i++){
+    int n = rng.randn(1, 4);
+
+    if(i == 0 || i == NumLayers - 1)
+      n = 1;
+    else if(n == 1)
+      n += rng.randn(0, 1);
+
+    layout.m_pWidth[i] = n;
+
+    for(int j=0; j<n; j++){
+      layout.m_pEnemies[i][j] = rng.randn(1, i + 1);
+
+      if(i == 0 || i == NumLayers - 1)
+        layout.m_pEnemies[i][j] = 1;
+    } //for
+  } //for
+
+  layout.m_nSpecialLayer = rng.randn(2, NumLayers - 2);
+  layout.m_nSpecialIndex = rng.randn(0, layout.m_pWidth[layout.m_nSpecialLayer] - 1);
+} //DrawLayout
+
+/// Build a map from its random choices. Every level in one layer is linked
+/// to at least one level in the next, with the links chosen so that paths do
+/// not cross, and the levels leading to the special card level get at least
+/// `Balance::m_nGuardEnemies` enemies.
+/// \param layout The random choices.
+/// \param map [out] The map.
+
+void CMapGenerator::Build(const MapLayout& layout, MapDesc& map){
+  map.m_vLayers.clear();
+  map.m_vAdjacency.clear();
+
+  //generate levels
+
+  int id = 0;
+
+  for(int i=0; i<NumLayers; i++){
+    std::vector<MapNode> layer;
+    const int n = layout.m_pWidth[i];
+
+    //position the levels within the map
+
+    int base = 300;
+    if(n < 4)
+      base += 400/(n + 1);
+
+    int divisor = n;
+    if(n == 4)
+      divisor--;
+
+    int multiplier = n*100;
+
+    if(n == 2){
+      multiplier *= 2;
+      divisor++;
+    } //if
+
+    for(int j=0; j<n; j++){
+      MapNode node;
+      node.m_nId = id++;
+      node.m_nLayer = i;
+      node.x = base + (multiplier/divisor)*j;
+      node.y = 125*i + 150;
+      node.m_nEnemies = layout.m_pEnemies[i][j];
+      layer.push_back(node);
+    } //for
+
+    map.m_vLayers.push_back(layer);
+  } //for
+
+  std::vector<std::vector<MapEdge>>& adj = map.m_vAdjacency;
+
+  //connect first level to all levels in next layer
+
+  adj.push_back(std::vector<MapEdge>());
+
+  for(int j=0; j<(int)map.m_vLayers[1].size(); j++)
+    Link(map, adj.back(), 0, 0, 1, j);
+
+  //connect inner layers
+
+  for(int i=1; i<NumLayers - 2; i++){
+    const int n = (int)map.m_vLayers[i].size();
+    const int m = (int)map.m_vLayers[i + 1].size();
+
+    if(n == m) //same size, connect like to like
+      for(int j=0; j<n; j++){
+        adj.push_back(std::vector<MapEdge>());
+        Link(map, adj.back(), i, j, i + 1, j);
+      } //for
+
+    else if(n == 1){ //fan out
+      adj.push_back(std::vector<MapEdge>());
+
+      for(int j=0; j<m; j++)
+        Link(map, adj.back(), i, 0, i + 1, j);
+    } //else if
+
+    else if(m == 1) //fan in
+      for(int j=0; j<n; j++){
+        adj.push_back(std::vector<MapEdge>());
+        Link(map, adj.back(), i, j, i + 1, 0);
+      } //for
+
+    else if(n == 4 && m == 3){
+      for(int j=0; j<m; j++){
+        adj.push_back(std::vector<MapEdge>());
+        Link(map, adj.back(), i, j, i + 1, j);
+      } //for
+
+      adj.push_back(std::vector<MapEdge>());
+      Link(map, adj.back(), i, n - 1, i + 1, m - 1);
+    } //else if
+
+    else if(n == 4 && m == 2)
+      for(int j=0; j<m; j++){
+        adj.push_back(std::vector<MapEdge>());
+        Link(map, adj.back(), i, 2*j, i + 1, (j + 1)/2);
+        adj.push_back(std::vector<MapEdge>());
+        Link(map, adj.back(), i, 2*j + 1, i + 1, (2*j + 1)/2);
+      } //for
+
+    else if(n == 3 && m == 2){
+      for(int j=0; j<m; j++){
+        adj.push_back(std::vector<MapEdge>());
+        Link(map, adj.back(), i, j, i + 1, j);
+      } //for
+
+      adj.push_back(std::vector<MapEdge>());
+      Link(map, adj.back(), i, n - 1, i + 1, m - 1);
+    } //else if
+
+    else if(n == 2 && m == 3){
+      for(int j=0; j<n; j++){
+        adj.push_back(std::vector<MapEdge>());
+        Link(map, adj.back(), i, j, i + 1, j);
+      } //for
+
+      Link(map, adj.back(), i, n - 1, i + 1, m - 1);
+    } //else if
+
+    else if(n == 2 && m == 4)
+      for(int j=0; j<n; j++){
+        adj.push_back(std::vector<MapEdge>());
+        Link(map, adj.back(), i, j, i + 1, 2*j);
+        Link(map, adj.back(), i, j, i + 1, 2*j + 1);
+      } //for
+
+    else if(n == 3 && m == 4){
+      for(int j=0; j<n; j++){
+        adj.push_back(std::vector<MapEdge>());
+        Link(map, adj.back(), i, j, i + 1, j);
+      } //for
+
+      Link(map, adj.back(), i, n - 1, i + 1, m - 1);
+    } //else if
+  } //for
+
+  //connect everything in second to last layer to last level
+
+  for(int j=0; j<(int)map.m_vLayers[NumLayers - 2].size(); j++){
+    adj.push_back(std::vector<MapEdge>());
+    Link(map, adj.back(), NumLayers - 2, j, NumLayers - 1, 0);
+  } //for
+
+  //place the special card level
+
+  map.m_nSpecial = map.m_vLayers[layout.m_nSpecialLayer][layout.m_nSpecialIndex].m_nId;
+  map.GetNode(map.m_nSpecial).m_bSpecial = true;
+
+  for(const std::vector<MapEdge>& list: adj)
+    for(const MapEdge& e: list)
+      if(e.m_nTo == map.m_nSpecial){
+        MapNode& from = map.GetNode(e.m_nFrom);
+        from.m_nEnemies = std::max(from.m_nEnemies, GetBalance().m_nGuardEnemies);
+      } //if
+} //Build
+
+/// Generate a map.
+/// \param rng Random number generator.
+/// \param map [out] The map.
+
+void CMapGenerator::Generate(CRng& rng, MapDesc& map){
+  MapLayout layout;
+  DrawLayout(rng, layout);
+  Build(layout, map);
+} //Generate
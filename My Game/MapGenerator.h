@@ -0,0 +1,82 @@
+/// \file MapGenerator.h
+/// \brief Interface for the map generator CMapGenerator.
+
+#ifndef __L4RC_GAME_MAPGENERATOR_H__
+#define __L4RC_GAME_MAPGENERATOR_H__
+
+#include <vector>
+
+#include "Rng.h"
+
+/// \brief A level on the map as the rules see it.
+
+struct MapNode{
+  int m_nId = 0; ///< Level number, in layer order.
+  int m_nLayer = 0; ///< Layer, from 0 at the bottom.
+  int x = 0; ///< Horizontal position on the map screen.
+  int y = 0; ///< Vertical position on the map screen.
+  int m_nEnemies = 1; ///< Number of enemies in the level.
+  bool m_bSpecial = false; ///< True for the special card level.
+}; //MapNode
+
+/// \brief A path from one level to a level in the next layer.
+
+struct MapEdge{
+  int m_nFrom = 0; ///< Level the path starts at.
+  int m_nTo = 0; ///< Level the path leads to.
+}; //MapEdge
+
+/// \brief A generated map.
+///
+/// The levels, layer by layer, and the paths out of each level. The paths
+/// out of level n are in `m_vAdjacency[n]`. The last level has none.
+
+struct MapDesc{
+  std::vector<std::vector<MapNode>> m_vLayers; ///< Levels by layer.
+  std::vector<std::vector<MapEdge>> m_vAdjacency; ///< Paths by level.
+  int m_nSpecial = 0; ///< The special card level.
+
+  MapNode& GetNode(int id); ///< Get a level by number.
+}; //MapDesc
+
+struct MapLayout;
+
+/// \brief The map generator.
+///
+/// Generates the map for a new game: the levels in each layer, where they
+/// are drawn, how many enemies they have, the paths between them, and which
+/// level holds the special card. Has no engine dependencies, so the same map
+/// comes out of the same generator state in the game, the benchmarks and any
+/// other tool.
+
+class CMapGenerator{
+  public:
+    static const int NumLayers = 5; ///< Number of layers.
+
+  private:
+    static void Link(MapDesc& map, std::vector<MapEdge>& list,
+      int i, int j, int k, int l); ///< Add a path to a list.
+
+  public:
+    static void DrawLayout(CRng& rng, MapLayout& layout); ///< Make the random choices.
+    static void Build(const MapLayout& layout, MapDesc& map); ///< Build a map from a layout.
+    static void Generate(CRng& rng, MapDesc& map); ///< Generate a map.
+}; //CMapGenerator
+
+/// \brief Everything random about a map.
+///
+/// The number of levels in each layer, their enemy counts before the levels
+/// leading to the special card level are toughened up, and where the special
+/// card level is. The rest of a map follows from these, so they are enough
+/// to test a map for most properties without building it.
+
+struct MapLayout{
+  static const int MaxWidth = 4; ///< Most levels in a layer.
+
+  int m_pWidth[CMapGenerator::NumLayers]; ///< Number of levels in each layer.
+  int m_pEnemies[CMapGenerator::NumLayers][MaxWidth]; ///< Enemies in each level, by layer.
+  int m_nSpecialLayer = 0; ///< Layer of the special card level.
+  int m_nSpecialIndex = 0; ///< Index of the special card level in its layer.
+}; //MapLayout
+
+#endif //__L4RC_GAME_MAPGENERATOR_H__
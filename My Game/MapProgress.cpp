@@ -0,0 +1,89 @@
+/// \file MapProgress.cpp
+/// \brief Code for the map progression tracker CMapProgress.
+
+#include "MapProgress.h"
+
+static_assert(CMapGenerator::NumLayers*MapLayout::MaxWidth <= CMapProgress::MaxLevels,
+  "generated maps must fit in a level set");
+
+/// Start on a new map with only the first level unlocked. Paths must lead
+/// from a level to a higher-numbered one, which is how `CMapGenerator` lays
+/// them out, so that reachability can be worked out in one backwards pass.
+/// \param map The map.
+/// \return false if the map has more than `MaxLevels` levels.
+
+bool CMapProgress::Build(const MapDesc& map){
+  m_nLevels = 0;
+
+  for(const std::vector<MapNode>& layer: map.m_vLayers)
+    m_nLevels += (int)layer.size();
+
+  if(m_nLevels > MaxLevels)return false;
+
+  m_nSpecial = m_nBoss = m_nReachesBoss = 0;
+
+  for(int i=0; i<m_nLevels; i++)
+    m_pNext[i] = 0;
+
+  for(const std::vector<MapEdge>& list: map.m_vAdjacency)
+    for(const MapEdge& e: list)
+      m_pNext[e.m_nFrom] |= 1ULL << e.m_nTo;
+
+  for(const std::vector<MapNode>& layer: map.m_vLayers)
+    for(const MapNode& node: layer)
+      if(node.m_bSpecial)
+        m_nSpecial |= 1ULL << node.m_nId;
+
+  if(!map.m_vLayers.empty())
+    for(const MapNode& node: map.m_vLayers.back())
+      m_nBoss |= 1ULL << node.m_nId;
+
+  for(int i=m_nLevels - 1; i>=0; i--){
+    LevelSet reach = 1ULL << i;
+
+    for(int j=i + 1; j<m_nLevels; j++)
+      if(m_pNext[i] >> j & 1)
+        reach |= m_pReach[j];
+
+    m_pReach[i] = reach;
+
+    if(reach & m_nBoss)
+      m_nReachesBoss |= 1ULL << i;
+  } //for
+
+  m_sProgress.m_nUnlocked = m_nLevels > 0? 1: 0;
+  m_sProgress.m_nComplete = 0;
+  return true;
+} //Build
+
+/// Move on from a level, whether by winning its battle or by visiting the
+/// special card level. It is marked complete and the levels one path on
+/// from it become the only unlocked ones.
+/// \param level Level number.
+
+void CMapProgress::Complete(int level){
+  m_sProgress.m_nComplete |= 1ULL << level;
+  m_sProgress.m_nUnlocked = m_pNext[level];
+} //Complete
+
+/// Get the levels that can still be reached from the unlocked ones,
+/// including the unlocked levels themselves.
+/// \return Set of levels.
+
+LevelSet CMapProgress::GetReachable() const{
+  LevelSet reach = 0;
+
+  for(int i=0; i<m_nLevels; i++)
+    if(IsUnlocked(i))
+      reach |= m_pReach[i];
+
+  return reach;
+} //GetReachable
+
+/// Get the levels that can still be reached and that have a path on to the
+/// boss level.
+/// \return Set of levels.
+
+LevelSet CMapProgress::GetCanReachBoss() const{
+  return GetReachable() & m_nReachesBoss;
+} //GetCanReachBoss
@@ -0,0 +1,64 @@
+/// \file MapProgress.h
+/// \brief Interface for the map progression tracker CMapProgress.
+
+#ifndef __L4RC_GAME_MAPPROGRESS_H__
+#define __L4RC_GAME_MAPPROGRESS_H__
+
+#include <cstdint>
+
+#include "MapGenerator.h"
+
+typedef uint64_t LevelSet; ///< A set of levels, bit n for level number n.
+
+/// \brief How far through the map a run is.
+///
+/// Small enough to copy for a checkpoint or for every simulated run.
+
+struct MapProgress{
+  LevelSet m_nUnlocked = 0; ///< Levels that can be entered.
+  LevelSet m_nComplete = 0; ///< Levels that have been beaten.
+}; //MapProgress
+
+/// \brief The map progression tracker.
+///
+/// Keeps the unlocked, complete, special and reachable levels as bitsets.
+/// The paths out of each level, and every level that can be reached from
+/// it, are worked out once per map, so that moving on from a level or
+/// asking which levels can still reach the boss is a few word operations
+/// however the map is laid out.
+
+class CMapProgress{
+  public:
+    static const int MaxLevels = 64; ///< Most levels in a map.
+
+  private:
+    int m_nLevels = 0; ///< Number of levels.
+    LevelSet m_pNext[MaxLevels]; ///< Levels one path on from each level.
+    LevelSet m_pReach[MaxLevels]; ///< Levels reachable from each level, itself included.
+    LevelSet m_nSpecial = 0; ///< Special card levels.
+    LevelSet m_nBoss = 0; ///< Levels in the last layer.
+    LevelSet m_nReachesBoss = 0; ///< Levels with a path to the last layer.
+    MapProgress m_sProgress; ///< Unlocked and complete levels.
+
+  public:
+    bool Build(const MapDesc&); ///< Start on a new map.
+    void Complete(int level); ///< Move on from a level.
+
+    const MapProgress& GetProgress() const { return m_sProgress; } ///< Get progress.
+    void SetProgress(const MapProgress& p){ m_sProgress = p; } ///< Set progress.
+
+    int GetLevelCount() const { return m_nLevels; } ///< Get number of levels.
+    LevelSet GetUnlocked() const { return m_sProgress.m_nUnlocked; } ///< Get unlocked levels.
+    LevelSet GetComplete() const { return m_sProgress.m_nComplete; } ///< Get complete levels.
+    LevelSet GetSpecial() const { return m_nSpecial; } ///< Get special levels.
+    LevelSet GetNext(int level) const { return m_pNext[level]; } ///< Get levels one path on.
+    LevelSet GetReachable() const; ///< Get levels that can still be reached.
+    LevelSet GetCanReachBoss() const; ///< Get reachable levels with a path to the boss.
+
+    bool IsUnlocked(int level) const { return (GetUnlocked() >> level & 1) != 0; } ///< Test for unlocked.
+    bool IsComplete(int level) const { return (GetComplete() >> level & 1) != 0; } ///< Test for complete.
+    bool IsSpecial(int level) const { return (m_nSpecial >> level & 1) != 0; } ///< Test for special.
+    bool CanReach(int from, int to) const { return (m_pReach[from] >> to & 1) != 0; } ///< Test for a path.
+}; //CMapProgress
+
+#endif //__L4RC_GAME_MAPPROGRESS_H__
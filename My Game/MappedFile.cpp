@@ -0,0 +1,133 @@
+/// \file MappedFile.cpp
+/// \brief Code for the read-only memory mapped file CMappedFile, and for
+/// writing whole files safely.
+
+#include <cstdio>
+#include <string>
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+  #include <io.h>
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+/// Unmap the file, if one is mapped.
+
+CMappedFile::~CMappedFile(){
+  Close();
+} //destructor
+
+/// Map a file, unmapping any file that was mapped before. Empty files cannot
+/// be mapped.
+/// \param path File name.
+/// \return true if the file was mapped.
+
+bool CMappedFile::Open(const char* path){
+  Close();
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if(file == INVALID_HANDLE_VALUE)return false;
+  m_hFile = file;
+
+  LARGE_INTEGER size;
+
+  if(!GetFileSizeEx(file, &size) || size.QuadPart == 0){
+    Close();
+    return false;
+  } //if
+
+  m_hMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+  if(m_hMapping == nullptr){
+    Close();
+    return false;
+  } //if
+
+  m_pData = (const uint8_t*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+  m_nSize = (size_t)size.QuadPart;
+#else
+  const int fd = open(path, O_RDONLY);
+  if(fd < 0)return false;
+
+  struct stat st;
+
+  if(fstat(fd, &st) != 0 || st.st_size == 0){
+    close(fd);
+    return false;
+  } //if
+
+  void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); //the mapping keeps the file open
+
+  if(p != MAP_FAILED){
+    m_pData = (const uint8_t*)p;
+    m_nSize = (size_t)st.st_size;
+  } //if
+#endif
+
+  if(m_pData == nullptr){
+    Close();
+    return false;
+  } //if
+
+  return true;
+} //Open
+
+/// Unmap the file.
+
+void CMappedFile::Close(){
+#ifdef _WIN32
+  if(m_pData)UnmapViewOfFile(m_pData);
+  if(m_hMapping)CloseHandle(m_hMapping);
+  if(m_hFile)CloseHandle(m_hFile);
+  m_hMapping = m_hFile = nullptr;
+#else
+  if(m_pData)munmap((void*)m_pData, m_nSize);
+#endif
+
+  m_pData = nullptr;
+  m_nSize = 0;
+} //Close
+
+/// Write a whole file. It is written to a temporary file that is flushed to
+/// disk and then renamed over the old file, so a crash or power cut leaves
+/// either the old file or the new one, never half of each.
+/// \param path File name.
+/// \param data File contents.
+/// \param size File size in bytes.
+/// \return true if the file was written.
+
+bool WriteFileAtomic(const char* path, const void* data, size_t size){
+  const std::string temp = std::string(path) + ".tmp";
+  FILE* output = fopen(temp.c_str(), "wb");
+  if(output == nullptr)return false;
+
+  bool ok = fwrite(data, 1, size, output) == size;
+  ok = fflush(output) == 0 && ok;
+
+#ifdef _WIN32
+  ok = _commit(_fileno(output)) == 0 && ok;
+#else
+  ok = fsync(fileno(output)) == 0 && ok;
+#endif
+
+  ok = fclose(output) == 0 && ok;
+
+#ifdef _WIN32
+  ok = ok && MoveFileExA(temp.c_str(), path,
+    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  ok = ok && rename(temp.c_str(), path) == 0;
+#endif
+
+  if(!ok)remove(temp.c_str());
+  return ok;
+} //WriteFileAtomic
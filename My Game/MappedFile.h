@@ -0,0 +1,43 @@
+/// \file MappedFile.h
+/// \brief Interface for the read-only memory mapped file CMappedFile, and
+/// for writing whole files safely.
+
+#ifndef __L4RC_GAME_MAPPEDFILE_H__
+#define __L4RC_GAME_MAPPEDFILE_H__
+
+#include <cstddef>
+#include <cstdint>
+
+/// \brief A read-only memory mapped file.
+///
+/// Maps a whole file into memory so that it can be read in place without
+/// copying it through a buffer. The mapping is released when the object is
+/// destroyed.
+
+class CMappedFile{
+  private:
+    const uint8_t* m_pData = nullptr; ///< Start of the mapped file.
+    size_t m_nSize = 0; ///< File size in bytes.
+
+#ifdef _WIN32
+    void* m_hFile = nullptr; ///< File handle.
+    void* m_hMapping = nullptr; ///< File mapping handle.
+#endif
+
+  public:
+    CMappedFile(){} ///< Default constructor.
+    ~CMappedFile(); ///< Destructor.
+
+    CMappedFile(const CMappedFile&) = delete; ///< No copying.
+    CMappedFile& operator=(const CMappedFile&) = delete; ///< No copying.
+
+    bool Open(const char* path); ///< Map a file.
+    void Close(); ///< Unmap the file.
+
+    const uint8_t* GetData() const { return m_pData; } ///< Get file contents.
+    size_t GetSize() const { return m_nSize; } ///< Get file size.
+}; //CMappedFile
+
+bool WriteFileAtomic(const char* path, const void* data, size_t size); ///< Replace a file safely.
+
+#endif //__L4RC_GAME_MAPPEDFILE_H__
@@ -0,0 +1,12 @@
+/// \file MemoryUsage.h
+/// \brief Interface for process memory queries.
+
+#ifndef __L4RC_GAME_MEMORYUSAGE_H__
+#define __L4RC_GAME_MEMORYUSAGE_H__
+
+#include <cstddef>
+
+size_t GetResidentBytes(); ///< Get memory used by this process.
+size_t GetAllocationCount(); ///< Get number of heap allocations so far.
+
+#endif //__L4RC_GAME_MEMORYUSAGE_H__
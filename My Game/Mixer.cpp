@@ -0,0 +1,406 @@
+/// \file Mixer.cpp
+/// \brief Code for the software audio mixer CMixer.
+///
+/// Each inner loop does four output samples at a time with SSE, then the
+/// rest one at a time. Without SSE the loops that do one at a time do them
+/// all.
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+#endif
+
+#include "Mixer.h"
+
+static const uint64_t One = 1ULL << 32; ///< One frame, in 32.32 fixed point.
+static const float FracScale = 1.0f/16777216.0f; ///< Turns the top 24 bits of a position's fraction into a float.
+
+/// Add a mono sound to a mono output, at its own rate.
+/// \param out [in, out] Output samples.
+/// \param s Sound samples, from the first to mix.
+/// \param n Number of samples.
+/// \param gain Gain.
+
+static void MixMono(float* out, const float* s, size_t n, float gain){
+  size_t i = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128 g = _mm_set1_ps(gain);
+
+  for(; i + 4<=n; i+=4)
+    _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i),
+      _mm_mul_ps(_mm_loadu_ps(s + i), g)));
+#endif
+
+  for(; i<n; i++)
+    out[i] += s[i]*gain;
+} //MixMono
+
+/// Add a stereo sound to a stereo output, at its own rate.
+/// \param out [in, out] Output frames.
+/// \param s Sound samples, from the first to mix.
+/// \param n Number of frames.
+/// \param gain Gain.
+
+static void MixStereo(float* out, const float* s, size_t n, float gain){
+  size_t i = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128 g = _mm_set1_ps(gain);
+
+  for(; i + 4<=2*n; i+=4)
+    _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i),
+      _mm_mul_ps(_mm_loadu_ps(s + i), g)));
+#endif
+
+  for(; i<2*n; i++)
+    out[i] += s[i]*gain;
+} //MixStereo
+
+/// Add a mono sound to a mono output, resampled by linear interpolation.
+/// \param out [in, out] Output samples.
+/// \param s Sound samples, with a silent one on the end.
+/// \param pos Position of the first frame to mix, 32.32 fixed point.
+/// \param step Position step per output frame, 32.32 fixed point.
+/// \param n Number of frames.
+/// \param gain Gain.
+
+static void MixMonoResampled(float* out, const float* s, uint64_t pos, uint64_t step,
+  size_t n, float gain)
+{
+  size_t i = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128 g = _mm_set1_ps(gain);
+  const __m128 scale = _mm_set1_ps(FracScale);
+  const __m128i step4 = _mm_set1_epi32((int)(uint32_t)(4*step));
+  __m128i frac = _mm_setr_epi32((int)(uint32_t)pos, (int)(uint32_t)(pos + step),
+    (int)(uint32_t)(pos + 2*step), (int)(uint32_t)(pos + 3*step)); //low halves, which wrap as the positions do
+
+  for(; i + 4<=n; i+=4, pos+=4*step){
+    const __m64* s0 = (const __m64*)(s + (pos >> 32)); //each frame and the next
+    const __m64* s1 = (const __m64*)(s + ((pos + step) >> 32));
+    const __m64* s2 = (const __m64*)(s + ((pos + 2*step) >> 32));
+    const __m64* s3 = (const __m64*)(s + ((pos + 3*step) >> 32));
+
+    const __m128 p01 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), s0), s1);
+    const __m128 p23 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), s2), s3);
+    const __m128 a = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 b = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 f = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(frac, 8)), scale);
+    frac = _mm_add_epi32(frac, step4);
+
+    const __m128 x = _mm_mul_ps(_mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), f)), g);
+    _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), x));
+  } //for
+#endif
+
+  for(; i<n; i++, pos+=step){
+    const float* p = s + (pos >> 32);
+    const float f = ((uint32_t)pos >> 8)*FracScale;
+    out[i] += (p[0] + (p[1] - p[0])*f)*gain;
+  } //for
+} //MixMonoResampled
+
+/// Add a stereo sound to a stereo output, resampled by linear interpolation.
+/// \param out [in, out] Output frames.
+/// \param s Sound samples, with a silent frame on the end.
+/// \param pos Position of the first frame to mix, 32.32 fixed point.
+/// \param step Position step per output frame, 32.32 fixed point.
+/// \param n Number of frames.
+/// \param gain Gain.
+
+static void MixStereoResampled(float* out, const float* s, uint64_t pos, uint64_t step,
+  size_t n, float gain)
+{
+  size_t i = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128 g = _mm_set1_ps(gain);
+  const __m128 scale = _mm_set1_ps(FracScale);
+  const __m128i step2 = _mm_set1_epi32((int)(uint32_t)(2*step));
+  const int f0 = (int)(uint32_t)pos, f1 = (int)(uint32_t)(pos + step);
+  __m128i frac = _mm_setr_epi32(f0, f0, f1, f1); //low halves, which wrap as the positions do
+
+  for(; i + 2<=n; i+=2, pos+=2*step){
+    const __m64* s0 = (const __m64*)(s + 2*(pos >> 32));
+    const __m64* s1 = (const __m64*)(s + 2*((pos + step) >> 32));
+
+    const __m128 a = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), s0), s1);
+    const __m128 b = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), s0 + 1), s1 + 1);
+    const __m128 f = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(frac, 8)), scale);
+    frac = _mm_add_epi32(frac, step2);
+
+    const __m128 x = _mm_mul_ps(_mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), f)), g);
+    _mm_storeu_ps(out + 2*i, _mm_add_ps(_mm_loadu_ps(out + 2*i), x));
+  } //for
+#endif
+
+  for(; i<n; i++, pos+=step){
+    const float* p = s + 2*(pos >> 32);
+    const float f = ((uint32_t)pos >> 8)*FracScale;
+    out[2*i] += (p[0] + (p[2] - p[0])*f)*gain;
+    out[2*i + 1] += (p[1] + (p[3] - p[1])*f)*gain;
+  } //for
+} //MixStereoResampled
+
+/// Add the mono output to both channels of the stereo output, and clamp
+/// the samples to [-1, 1].
+/// \param out [in, out] Stereo output frames.
+/// \param mono Mono output samples.
+/// \param n Number of frames.
+
+static void Finish(float* out, const float* mono, size_t n){
+  size_t i = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+
+  for(; i + 4<=n; i+=4){
+    const __m128 x = _mm_loadu_ps(mono + i);
+    float* o = out + 2*i;
+    const __m128 y0 = _mm_add_ps(_mm_loadu_ps(o), _mm_unpacklo_ps(x, x));
+    const __m128 y1 = _mm_add_ps(_mm_loadu_ps(o + 4), _mm_unpackhi_ps(x, x));
+    _mm_storeu_ps(o, _mm_min_ps(_mm_max_ps(y0, lo), hi));
+    _mm_storeu_ps(o + 4, _mm_min_ps(_mm_max_ps(y1, lo), hi));
+  } //for
+#endif
+
+  for(; i<n; i++){
+    out[2*i] = std::min(std::max(out[2*i] + mono[i], -1.0f), 1.0f);
+    out[2*i + 1] = std::min(std::max(out[2*i + 1] + mono[i], -1.0f), 1.0f);
+  } //for
+} //Finish
+
+/// \param voices Number of voices, which is the most sounds that can play
+///   at once.
+/// \param rate Output sample rate in Hz.
+
+CMixer::CMixer(size_t voices, int rate):
+  m_nRate(rate), m_vVoices(std::max<size_t>(voices, 1)){
+} //constructor
+
+/// Load a sound, replacing any loaded under the same index. Voices playing
+/// the sound it replaces are stopped.
+/// \param i Sound index.
+/// \param s The sound, mono or stereo.
+
+void CMixer::SetSound(size_t i, const WavSound& s){
+  if(s.m_nChannels != 1 && s.m_nChannels != 2)return;
+  ClearSound(i);
+
+  if(i >= m_vSounds.size())
+    m_vSounds.resize(i + 1);
+
+  Sound& d = m_vSounds[i];
+  d.m_nChannels = s.m_nChannels;
+  d.m_nRate = s.m_nRate;
+  d.m_nFrames = s.GetFrames();
+  d.m_vSamples.assign(s.m_vSamples.begin(), s.m_vSamples.begin() + d.m_nFrames*d.m_nChannels);
+  d.m_vSamples.resize(d.m_vSamples.size() + d.m_nChannels, 0.0f); //interpolation reads one past the end
+} //SetSound
+
+/// Load a compressed sound, replacing any loaded under the same index.
+/// Voices playing the sound it replaces are stopped.
+/// \param i Sound index.
+/// \param s The sound, mono or stereo.
+
+void CMixer::SetSound(size_t i, const AdpcmSound& s){
+  if(s.m_nChannels != 1 && s.m_nChannels != 2)return;
+  ClearSound(i);
+
+  if(i >= m_vSounds.size())
+    m_vSounds.resize(i + 1);
+
+  Sound& d = m_vSounds[i];
+  d.m_nChannels = s.m_nChannels;
+  d.m_nRate = s.m_nRate;
+  d.m_nFrames = s.m_nFrames;
+  d.m_cAdpcm = s;
+} //SetSound
+
+/// Unload a sound, stopping any voices playing it.
+/// \param i Sound index.
+
+void CMixer::ClearSound(size_t i){
+  if(i >= m_vSounds.size())return;
+
+  Stop(i);
+  m_vSounds[i] = Sound();
+} //ClearSound
+
+/// Play a sound. If every voice is busy, the lowest priority voice is
+/// stolen, unless it is of higher priority than this sound, in which case
+/// this sound is dropped.
+/// \param i Sound index.
+/// \param d How to play it.
+/// \return true if the sound is playing, or will be at its start time.
+
+bool CMixer::Play(size_t i, const VoiceDesc& d){
+  if(i >= m_vSounds.size() || m_vSounds[i].m_nFrames == 0 || d.m_fPitch <= 0.0f)
+    return false;
+
+  Voice* v = nullptr;
+
+  for(Voice& u: m_vVoices)
+    if(!u.m_bActive){
+      v = &u;
+      break;
+    } //if
+
+  if(v == nullptr){ //steal the lowest priority voice, the oldest of those
+    v = &m_vVoices[0];
+
+    for(Voice& u: m_vVoices)
+      if(u.m_nPriority < v->m_nPriority ||
+        (u.m_nPriority == v->m_nPriority && u.m_nSerial < v->m_nSerial))
+        v = &u;
+
+    if(v->m_nPriority > d.m_nPriority){
+      m_nDropped++;
+      return false;
+    } //if
+
+    m_nStolen++;
+  } //if
+
+  const Sound& s = m_vSounds[i];
+  const double step = (double)d.m_fPitch*s.m_nRate/m_nRate*One;
+
+  v->m_bActive = true;
+  v->m_nSound = i;
+  v->m_nPos = 0;
+  v->m_nStep = std::max<uint64_t>((uint64_t)(step + 0.5), 1);
+  v->m_fGain = d.m_fGain;
+  v->m_nPriority = d.m_nPriority;
+  v->m_nStart = std::max(d.m_nStart, m_nTime);
+  v->m_nSerial = m_nSerial++;
+  v->m_cDecoder = AdpcmDecoder();
+
+  return true;
+} //Play
+
+/// Stop every voice that is playing a sound, or waiting to.
+/// \param i Sound index.
+
+void CMixer::Stop(size_t i){
+  for(Voice& v: m_vVoices)
+    if(v.m_bActive && v.m_nSound == i)
+      v.m_bActive = false;
+} //Stop
+
+/// Decode the frames of a compressed sound that a voice needs for its next
+/// output frames, from the one that its position is in to the one after
+/// the last that it reaches, which interpolation reads. The last two frames
+/// decoded are kept from one time to the next, since a voice that plays
+/// slower than recorded can start its next output frames in either.
+/// \param v Voice.
+/// \param s The voice's sound, compressed.
+/// \param frames Number of output frames, at least one.
+/// \param pos [out] The voice's position, from the first frame decoded.
+/// \return Frames, with silence after the sound's last.
+
+const float* CMixer::Decode(Voice& v, const Sound& s, size_t frames, uint64_t& pos){
+  const size_t channels = (size_t)s.m_nChannels;
+  AdpcmDecoder& d = v.m_cDecoder;
+
+  const size_t last = (size_t)((v.m_nPos + (frames - 1)*v.m_nStep) >> 32) + 1;
+  const size_t kept = std::min<size_t>(d.m_nFrame, 2);
+  const size_t base = d.m_nFrame - kept;
+  const size_t total = std::max(last + 1, d.m_nFrame) - base;
+
+  if(m_vScratch.size() < total*channels)
+    m_vScratch.resize(total*channels);
+
+  float* out = m_vScratch.data();
+  std::copy(v.m_pTail + (2 - kept)*channels, v.m_pTail + 2*channels, out);
+
+  const size_t n = kept + DecodeAdpcm(s.m_cAdpcm, d, out + kept*channels, total - kept);
+  std::fill(out + n*channels, out + total*channels, 0.0f); //past the end
+
+  const size_t tail = std::min<size_t>(d.m_nFrame, 2);
+  std::copy(out + (d.m_nFrame - tail - base)*channels, out + (d.m_nFrame - base)*channels,
+    v.m_pTail + (2 - tail)*channels);
+
+  pos = v.m_nPos - ((uint64_t)base << 32);
+  return out;
+} //Decode
+
+/// Add a voice to the output, and free it if its sound ends.
+/// \param v Voice.
+/// \param mono [in, out] Mono output samples, from where the voice starts.
+/// \param stereo [in, out] Stereo output frames, from where the voice starts.
+/// \param frames Number of output frames.
+
+void CMixer::MixVoice(Voice& v, float* mono, float* stereo, size_t frames){
+  const Sound& s = m_vSounds[v.m_nSound];
+  const uint64_t end = (uint64_t)s.m_nFrames << 32;
+  const size_t n = (size_t)std::min<uint64_t>(frames, (end - v.m_nPos + v.m_nStep - 1)/v.m_nStep);
+
+  uint64_t pos = v.m_nPos;
+  const float* samples = s.m_cAdpcm.m_vData.empty()? s.m_vSamples.data(): Decode(v, s, n, pos);
+
+  if(v.m_nStep == One){ //no resampling
+    const size_t first = (size_t)(pos >> 32);
+
+    if(s.m_nChannels == 1)MixMono(mono, samples + first, n, v.m_fGain);
+    else MixStereo(stereo, samples + 2*first, n, v.m_fGain);
+  } //if
+
+  else if(s.m_nChannels == 1)MixMonoResampled(mono, samples, pos, v.m_nStep, n, v.m_fGain);
+  else MixStereoResampled(stereo, samples, pos, v.m_nStep, n, v.m_fGain);
+
+  v.m_nPos += v.m_nStep*n;
+
+  if(v.m_nPos >= end)
+    v.m_bActive = false;
+} //MixVoice
+
+/// Mix the next frames of output. Voices that start part way through are
+/// mixed from their start frame on.
+/// \param out [out] Output frames, left then right, in [-1, 1].
+/// \param frames Number of frames.
+
+void CMixer::Mix(float* out, size_t frames){
+  if(m_vMono.size() < frames)
+    m_vMono.resize(frames);
+
+  float* mono = m_vMono.data();
+  memset(mono, 0, frames*sizeof(float));
+  memset(out, 0, 2*frames*sizeof(float));
+
+  for(Voice& v: m_vVoices)
+    if(v.m_bActive && v.m_nStart < m_nTime + frames){
+      const size_t offset = (size_t)(std::max(v.m_nStart, m_nTime) - m_nTime);
+      MixVoice(v, mono + offset, out + 2*offset, frames - offset);
+    } //if
+
+  Finish(out, mono, frames);
+  m_nTime += frames;
+} //Mix
+
+/// Get the number of voices in use, including those waiting to start.
+/// \return Number of voices.
+
+size_t CMixer::GetActiveCount() const{
+  size_t n = 0;
+
+  for(const Voice& v: m_vVoices)
+    n += v.m_bActive;
+
+  return n;
+} //GetActiveCount
+
+/// Get the memory that the loaded sounds take.
+/// \return Memory in bytes.
+
+size_t CMixer::GetBytes() const{
+  size_t n = 0;
+
+  for(const Sound& s: m_vSounds)
+    n += s.m_vSamples.size()*sizeof(float) + s.m_cAdpcm.m_vData.size();
+
+  return n;
+} //GetBytes
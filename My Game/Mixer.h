@@ -0,0 +1,103 @@
+/// \file Mixer.h
+/// \brief Interface for the software audio mixer CMixer.
+
+#ifndef __L4RC_GAME_MIXER_H__
+#define __L4RC_GAME_MIXER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Adpcm.h"
+#include "Wav.h"
+
+/// \brief How to play a sound.
+
+struct VoiceDesc{
+  float m_fGain = 1.0f; ///< Volume, 1 for as recorded.
+  float m_fPitch = 1.0f; ///< Playback speed, 1 for as recorded.
+  int m_nPriority = 0; ///< Voices of higher priority are kept when voices run out.
+  uint64_t m_nStart = 0; ///< Output frame to start on. One already mixed means at once.
+}; //VoiceDesc
+
+/// \brief The software audio mixer.
+///
+/// Mixes any number of sounds playing at once, up to a fixed number of
+/// voices, into a stereo output buffer of float samples, with SSE where
+/// there is SSE. Every voice has its own gain and pitch, and starts on an
+/// exact output frame, so that sounds can be lined up with the game's
+/// timeline rather than with whenever the next buffer happens to be mixed.
+/// A voice that plays at other than its sound's sample rate is resampled
+/// by linear interpolation. Mono voices are mixed into a mono buffer that
+/// goes to both channels at the end, since both channels would get the
+/// same samples anyway.
+///
+/// A sound can be loaded compressed with ADPCM, in which case each voice
+/// that plays it decodes just the frames it needs for each block of output,
+/// carrying on from where it left off, into scratch memory that all voices
+/// share.
+///
+/// When a sound is played with every voice busy, the voice of lowest
+/// priority is stolen for it, the oldest if there is a tie. If that voice
+/// is of higher priority than the new sound, the new sound is dropped
+/// instead. A stolen voice stops dead.
+
+class CMixer{
+  private:
+    /// \brief A sound that can be played.
+
+    struct Sound{
+      std::vector<float> m_vSamples; ///< Samples, with a silent frame on the end, or none if compressed.
+      AdpcmSound m_cAdpcm; ///< Compressed samples, or none if not compressed.
+      size_t m_nFrames = 0; ///< Number of frames, not counting the silent one.
+      int m_nChannels = 0; ///< Number of channels, 1 or 2, or 0 for none loaded.
+      int m_nRate = 0; ///< Sample rate in Hz.
+    }; //Sound
+
+    /// \brief A voice, which plays one sound.
+
+    struct Voice{
+      bool m_bActive = false; ///< Whether the voice is in use.
+      size_t m_nSound = 0; ///< Sound index.
+      uint64_t m_nPos = 0; ///< Position in the sound in frames, 32.32 fixed point.
+      uint64_t m_nStep = 0; ///< Position step per output frame, 32.32 fixed point.
+      float m_fGain = 1.0f; ///< Gain.
+      int m_nPriority = 0; ///< Priority.
+      uint64_t m_nStart = 0; ///< Output frame to start on.
+      uint64_t m_nSerial = 0; ///< Order of playing, oldest first.
+      AdpcmDecoder m_cDecoder; ///< Where decoding is up to, if the sound is compressed.
+      float m_pTail[4] = {}; ///< Last two frames decoded, if the sound is compressed.
+    }; //Voice
+
+    int m_nRate = 0; ///< Output sample rate in Hz.
+    std::vector<Sound> m_vSounds; ///< Sounds.
+    std::vector<Voice> m_vVoices; ///< Voices.
+    uint64_t m_nTime = 0; ///< Number of output frames mixed.
+    uint64_t m_nSerial = 0; ///< Number of sounds played.
+    size_t m_nStolen = 0; ///< Number of voices stolen.
+    size_t m_nDropped = 0; ///< Number of sounds dropped.
+    std::vector<float> m_vMono; ///< Mono voices, mixed before going to both channels.
+    std::vector<float> m_vScratch; ///< Frames decoded from a compressed sound.
+
+    const float* Decode(Voice& v, const Sound& s, size_t frames, uint64_t& pos); ///< Decode a voice's next frames.
+    void MixVoice(Voice& v, float* mono, float* stereo, size_t frames); ///< Mix a voice.
+
+  public:
+    CMixer(size_t voices, int rate); ///< Constructor.
+
+    void SetSound(size_t i, const WavSound& s); ///< Load a sound.
+    void SetSound(size_t i, const AdpcmSound& s); ///< Load a compressed sound.
+    void ClearSound(size_t i); ///< Unload a sound.
+    bool Play(size_t i, const VoiceDesc& d); ///< Play a sound.
+    void Stop(size_t i); ///< Stop every voice playing a sound.
+    void Mix(float* out, size_t frames); ///< Mix the next frames.
+
+    int GetRate() const { return m_nRate; } ///< Get output sample rate.
+    uint64_t GetTime() const { return m_nTime; } ///< Get number of frames mixed.
+    size_t GetActiveCount() const; ///< Get number of voices in use.
+    size_t GetStolenCount() const { return m_nStolen; } ///< Get number of voices stolen.
+    size_t GetDroppedCount() const { return m_nDropped; } ///< Get number of sounds dropped.
+    size_t GetBytes() const; ///< Get memory used by sounds.
+}; //CMixer
+
+#endif //__L4RC_GAME_MIXER_H__
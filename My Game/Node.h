@@ -12,7 +12,6 @@ class Node : CCommon
 		int id;
 		int layer;
 		Vector2 position;
-		bool unlocked = false;
 		int numEnemies;
 		bool special = false;
 };
@@ -1,42 +1,25 @@
-#pragma once
-
 #include "NodeObject.h"
+#include "ObjectManager.h"
 
-void NodeObject::draw()
+void NodeObject::SetSpecial() const
 {
-	if (state == GameState::Map)
-	{
-		CObject::draw();
-
-		if (m_nSpriteIndex != (UINT)eSprite::Nerd)
-		{
-			std::string s = std::to_string(numEnemies);
-			m_pRenderer->DrawScreenText(s.c_str(), Vector2(m_vPos.x - 13, LSettings::m_nWinHeight - m_vPos.y - 35), Colors::White); //draw to screen
-		}
-		
-		if (complete)
-		{
-			LSpriteDesc2D checkmarkDesc;
-			checkmarkDesc.m_nSpriteIndex = (UINT)eSprite::Checkmark;
-			checkmarkDesc.m_vPos = m_vPos + Vector2(0, -15);
-			checkmarkDesc.m_fXScale = 0.05f;
-			checkmarkDesc.m_fYScale = 0.05f;
+	m_pObjectManager->Get<Sprite>(entity).m_nIndex = (UINT)eSprite::Nerd;
+	m_pObjectManager->Get<Transform>(entity).m_fXScale = 0.6f;
+	m_pObjectManager->Get<Transform>(entity).m_fYScale = 0.6f;
+}
 
-			m_pRenderer->Draw(&checkmarkDesc);
-		}
-	}
+void NodeObject::SetEnemies(int n) const
+{
+	m_pObjectManager->Get<NodeInfo>(entity).m_nEnemies = n;
 }
 
-NodeObject::NodeObject(const Vector2& p) : CObject(eSprite::DoorClosed, p) 
+void NodeObject::SetComplete(bool complete) const
 {
-	//m_f4Tint = Vector4(0.75, 0.25, 0.0, 1.0);
-	m_fXScale = 0.05f;
-	m_fYScale = 0.05f;
+	m_pObjectManager->Get<NodeInfo>(entity).m_bComplete = complete;
 }
 
-void NodeObject::SetSpecial()
+//Show the door open or closed
+void NodeObject::SetOpen(bool open) const
 {
-	m_nSpriteIndex = (UINT)eSprite::Nerd;
-	m_fXScale = 0.6f;
-	m_fYScale = 0.6f;
+	m_pObjectManager->Get<Sprite>(entity).m_nIndex = (UINT)(open ? eSprite::DoorOpen : eSprite::DoorClosed);
 }
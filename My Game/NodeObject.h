@@ -1,15 +1,23 @@
 #pragma once
 
-#include "Object.h"
+#include "GameDefines.h"
 #include "Common.h"
+#include "Ecs.h"
 
-class NodeObject : public CObject, CCommon, LSettings
+//A level on the map is an entity with a transform, a sprite and node info.
+//This is a handle to it
+class NodeObject : CCommon
 {
 	public:
-		NodeObject(const Vector2& p);
-		void draw();
-		bool complete = false;
-		int numEnemies = 0;
+		NodeObject() {}
+		explicit NodeObject(Entity e) : entity(e) {}
+		Entity GetEntity() const { return entity; }
 
-		void SetSpecial();
-};
\ No newline at end of file
+		void SetSpecial() const;
+		void SetEnemies(int n) const;
+		void SetComplete(bool complete) const;
+		void SetOpen(bool open) const;
+
+	private:
+		Entity entity;
+};
@@ -1,108 +1,547 @@
 /// \file ObjectManager.cpp
 /// \brief Code for the the object manager class CObjectManager.
 
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
 #include "ObjectManager.h"
 #include "ComponentIncludes.h"
-#include "Player.h"
-#include "Enemy.h"
-#include "NodeObject.h"
+#include "Balance.h"
+#include "Profiler.h"
+
+static const float g_fNear = 15.0f; ///< Square of the distance from a target that counts as there.
 
-/// Create an object and put a pointer to it at the back of the object list
-/// `m_stdObjectList`, which it inherits from `LBaseObjectManager`.
+/// Create an entity with a transform and a sprite, which every entity has.
+/// The two are added together, so that their arrays stay in step.
 /// \param t Sprite type.
 /// \param pos Initial position.
-/// \return Pointer to the object created.
-
-CObject* CObjectManager::create(eSprite t, const Vector2& pos){
-    CObject* pObj = nullptr;
-
-    switch (t) { //create object of type t
-    case eSprite::Player:  
-        {
-            Player* temp = new Player(pos, m_nWinHeight);
-
-            for (int i = 0; i < temp->GetDeck().size(); i++)
-            {
-                m_stdObjectList.push_back(temp->GetDeck().at(i));
-            }
-            pObj = temp;
-        }
-        break;
-    case eSprite::Enemy:  
-        pObj = new Enemy(pos, m_nWinHeight); 
-        enemies.push_back((Enemy*)pObj);
-        PositionEnemies();
-        break;
-    case eSprite::Card:
-        pObj = new Card(pos);
-        break;
-    case eSprite::Node:
-        pObj = new NodeObject(pos);
-        nodes.push_back((NodeObject*)pObj);
-        break;
-    default: pObj = new CObject(t, pos);
+/// \param states Game states to draw it in.
+/// \return The entity.
+
+Entity CObjectManager::CreateEntity(eSprite t, const Vector2& pos, UINT states){
+  const Entity e = m_cEntities.Create();
+
+  Transform& transform = GetComponents<Transform>().Add(e);
+  transform.m_vPos = pos;
+
+  Sprite& sprite = GetComponents<Sprite>().Add(e);
+  sprite.m_nIndex = (UINT)t;
+  sprite.m_nStates = states;
+
+  return e;
+} //CreateEntity
+
+/// Create the player, and before it the cards in its deck, which are given
+/// the starting hands. The draws are seeded from the clock.
+/// \param pos Initial position.
+/// \return The player.
+
+Player CObjectManager::CreatePlayer(const Vector2& pos){
+  std::vector<Card> deck;
+
+  for(int i=0; i<10; i++)
+    deck.push_back(CreateCard(Vector2(350, -390)));
+
+  const Entity e = CreateEntity(eSprite::Player, pos, StateBit(GameState::Battle));
+
+  Transform& transform = Get<Transform>(e);
+  transform.m_fXScale = transform.m_fYScale = 0.2f;
+
+  GetComponents<Health>().Add(e).m_nValue = GetBalance().m_nPlayerHealth;
+  GetComponents<Shield>().Add(e);
+  GetComponents<Animation>().Add(e).m_fLastTime = m_pTimer->GetTime();
+  GetComponents<Flash>().Add(e);
+
+  Actor& actor = GetComponents<Actor>().Add(e);
+  actor.m_bCount = true; //pages of the book
+  actor.m_nIdleSprite = (UINT)eSprite::Player;
+  actor.m_nRunSprite = (UINT)eSprite::PlayerRunning;
+
+  PlayerInfo& info = GetComponents<PlayerInfo>().Add(e);
+  info.m_vDeck = deck;
+  info.m_cPiles.Create(deck.size());
+  info.m_cPiles.Seed((uint64_t)time(0));
+
+  Player player(e);
+  player.CreateStartDeck();
+  return player;
+} //CreatePlayer
+
+/// Create a card, hidden until it is dealt.
+/// \param pos Initial position.
+/// \return The card.
+
+Card CObjectManager::CreateCard(const Vector2& pos){
+  const Entity e = CreateEntity(eSprite::Card, pos,
+    StateBit(GameState::Battle) | StateBit(GameState::NewCard));
+
+  Sprite& sprite = Get<Sprite>(e);
+  sprite.m_f4Tint = Vector4(0.05f, 0.7f, 0.05f, 1.0f);
+  sprite.m_bHidden = true;
+
+  GetComponents<CardInfo>().Add(e);
+  return Card(e);
+} //CreateCard
+
+/// Create an enemy and put it at the back of the enemy list.
+/// \param pos Initial position.
+/// \return The enemy.
+
+Enemy CObjectManager::CreateEnemy(const Vector2& pos){
+  const Entity e = CreateEntity(eSprite::Enemy, pos, StateBit(GameState::Battle));
+
+  GetComponents<Health>().Add(e).m_nValue = GetBalance().m_nEnemyHealth;
+  GetComponents<Animation>().Add(e).m_fLastTime = m_pTimer->GetTime();
+  GetComponents<Flash>().Add(e);
+  GetComponents<EnemyInfo>().Add(e);
+
+  Actor& actor = GetComponents<Actor>().Add(e);
+  actor.m_nIdleSprite = (UINT)eSprite::Enemy;
+  actor.m_nRunSprite = (UINT)eSprite::EnemyRunning;
+
+  enemies.push_back(Enemy(e));
+  return enemies.back();
+} //CreateEnemy
+
+/// Create a map node, a closed door, and put it at the back of the node list.
+/// \param pos Position.
+/// \return The node.
+
+NodeObject CObjectManager::CreateNode(const Vector2& pos){
+  const Entity e = CreateEntity(eSprite::DoorClosed, pos, StateBit(GameState::Map));
+
+  Transform& transform = Get<Transform>(e);
+  transform.m_fXScale = transform.m_fYScale = 0.05f;
+
+  GetComponents<NodeInfo>().Add(e);
+
+  nodes.push_back(NodeObject(e));
+  return nodes.back();
+} //CreateNode
+
+/// Call a function on every component array.
+/// \param fn Function that takes a reference to a component array.
+
+template<class f> void CObjectManager::ForEachArray(f fn){
+  fn(GetComponents<Transform>());
+  fn(GetComponents<Sprite>());
+  fn(GetComponents<Health>());
+  fn(GetComponents<Shield>());
+  fn(GetComponents<CardInfo>());
+  fn(GetComponents<NodeInfo>());
+  fn(GetComponents<Animation>());
+  fn(GetComponents<Actor>());
+  fn(GetComponents<Flash>());
+  fn(GetComponents<EnemyInfo>());
+  fn(GetComponents<PlayerInfo>());
+} //ForEachArray
+
+/// Destroy an entity. Its components are kept until the end of the next
+/// move, so that game code can still look at an enemy it has just killed.
+/// \param e Entity.
+
+void CObjectManager::Destroy(Entity e){
+  m_cEntities.Destroy(e);
+  m_bCull = true;
+} //Destroy
+
+/// Remove the components of the entities destroyed since the last cull, one
+/// pass over each array.
+
+void CObjectManager::Cull(){
+  if(!m_bCull)return;
+
+  const CEntityPool& pool = m_cEntities;
+
+  ForEachArray([&](auto& a){
+    a.RemoveIf([&](Entity e){ return !pool.IsAlive(e); });
+  });
+
+  m_bCull = false;
+} //Cull
+
+/// Destroy every entity and remove every component.
+
+void CObjectManager::clear(){
+  m_cEntities.Clear();
+  ForEachArray([](auto& a){ a.Clear(); });
+  enemies.clear();
+  nodes.clear();
+  m_bCull = false;
+} //clear
+
+/// Run the systems that move things, then remove the destroyed entities.
+/// Animations tick first, so that an actor reaching its target this frame
+/// finishes the frame of running it was on.
+
+void CObjectManager::move(){
+  const float t = m_pTimer->GetFrameTime();
+
+  Animate();
+  MoveActors(t);
+  FadeFlashes(t);
+  Cull();
+} //move
+
+/// Animation system. An animation that is due ticks once, either moving its
+/// sprite on a frame or adding one to its count.
+
+void CObjectManager::Animate(){
+  const float now = m_pTimer->GetTime();
+  CComponentArray<Animation>& animations = GetComponents<Animation>();
+
+  for(size_t i=0; i<animations.Size(); i++){
+    Animation& a = animations[i];
+
+    if(a.m_eMode == eAnimate::None || now < a.m_fLastTime + a.m_fInterval)
+      continue;
+
+    a.m_fLastTime = now;
+
+    if(a.m_eMode == eAnimate::Count)
+      a.m_nCount++;
+
+    else{
+      Sprite& s = Get<Sprite>(animations.GetEntity(i));
+      s.m_nFrame = (s.m_nFrame + 1)%m_pRenderer->GetNumFrames(s.m_nIndex);
+    } //else
+  } //for
+} //Animate
+
+/// Actor system. Actors move to their targets, wait, and time how long they
+/// have been acting. On getting to the center, or when done waiting, an
+/// actor starts acting and plays its sound. On getting home it stops
+/// running.
+/// \param t Frame time in seconds.
+
+void CObjectManager::MoveActors(float t){
+  CComponentArray<Actor>& actors = GetComponents<Actor>();
+
+  for(size_t i=0; i<actors.Size(); i++){
+    Actor& a = actors[i];
+    const Entity e = actors.GetEntity(i);
+    bool act = false;
+
+    switch(a.m_eState){
+      case eAct::Moving:
+      case eAct::Returning: {
+        Vector2& pos = Get<Transform>(e).m_vPos;
+        Vector2 direction = a.m_vTarget - pos;
+        direction.Normalize();
+        pos += direction*a.m_fSpeed*t;
+
+        if((pos - a.m_vTarget).LengthSquared() >= g_fNear)
+          break;
+
+        if(a.m_eState == eAct::Moving)
+          act = true;
+
+        else{
+          a.m_eState = eAct::Returned;
+          Get<Animation>(e).m_eMode = eAnimate::None;
+
+          Sprite& sprite = Get<Sprite>(e);
+
+          if(sprite.m_nIndex == a.m_nRunSprite){
+            sprite.m_nIndex = a.m_nIdleSprite;
+            sprite.m_nFrame = 0;
+          } //if
+        } //else
+      } //case
+      break;
+
+      case eAct::Waiting:
+        a.m_fTime -= t;
+        act = a.m_fTime <= 0.0f;
+      break;
+
+      case eAct::Acting:
+        a.m_fTime += t;
+      break;
+
+      default: break;
     } //switch
 
-    m_stdObjectList.push_back(pObj); //push pointer onto object list
-    return pObj; //return pointer to created object
-} //create
+    if(act){
+      a.m_eState = eAct::Acting;
+      a.m_fTime = 0.0f;
 
-//Position enemies into rows in a visually-pleasing way
-//Currently supports a max of 6 enemies, 2 rows of 3
-void CObjectManager::PositionEnemies()
-{
-    const float enemyWidth = 100;
-    const float backRowX = 900.0f;
-    const float frontRowX = backRowX - enemyWidth - 50;
+      Animation& animation = Get<Animation>(e);
+      animation.m_eMode = a.m_bCount? eAnimate::Count: eAnimate::None;
+      animation.m_nCount = 0;
 
-    int numEnemies = enemies.size();
+      if(a.m_eSound != eSound::Size)
+        m_pAudio->play(a.m_eSound);
+    } //if
+  } //for
+} //MoveActors
 
-    if (numEnemies > MaxEnemiesPerRow)
-    {
-        int numFrontRow = numEnemies - MaxEnemiesPerRow;
+/// Damage flash system. The tint goes back to normal when the flash is over.
+/// \param t Frame time in seconds.
 
-        std::vector<Enemy*> backRow;
-        for (int i = 0; i < MaxEnemiesPerRow; i++)
-        {
-            backRow.push_back(enemies.at(i));
-        }
+void CObjectManager::FadeFlashes(float t){
+  CComponentArray<Flash>& flashes = GetComponents<Flash>();
 
-        SetEquallySpaced(backRow, backRowX);
+  for(size_t i=0; i<flashes.Size(); i++){
+    Flash& f = flashes[i];
 
-        std::vector<Enemy*> frontRow;
-        for (int i = 0; i < numFrontRow; i++)
-        {
-            frontRow.push_back(enemies.at(i + MaxEnemiesPerRow));
-        }
+    if(f.m_fTime <= 0.0f)continue;
+    f.m_fTime -= t;
 
-        SetEquallySpaced(frontRow, frontRowX);
-    }
-    else
-    {
-        SetEquallySpaced(enemies, backRowX);
-    }
-}
+    if(f.m_fTime <= 0.0f)
+      Get<Sprite>(flashes.GetEntity(i)).m_f4Tint = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
+  } //for
+} //FadeFlashes
 
-//Set a row of enemies to be equally spaced and centered
-void CObjectManager::SetEquallySpaced(std::vector<Enemy*> enemies, float x)
-{
-    const float diffY = -75;
-    const int enemyHeight = 150;
+/// Draw everything for the current game state: every sprite first, in the
+/// order their entities were created, then the text and card effects on top.
+
+void CObjectManager::draw(){
+  DrawSprites();
+
+  if(state == GameState::Battle || state == GameState::NewCard)
+    DrawCards();
+
+  if(state == GameState::Map)
+    DrawNodes();
+
+  if(state == GameState::Battle){
+    DrawPlayers();
+    DrawEnemies();
+  } //if
+} //draw
+
+/// Sprite system. Walks the transforms and sprites side by side, drawing
+/// the sprites that are shown in the current game state.
+
+void CObjectManager::DrawSprites(){
+  PROFILE_ZONE("DrawSprites");
+
+  CComponentArray<Transform>& transforms = GetComponents<Transform>();
+  CComponentArray<Sprite>& sprites = GetComponents<Sprite>();
+  const UINT bit = StateBit(state);
+  LSpriteDesc2D desc;
+
+  for(size_t i=0; i<sprites.Size(); i++){
+    const Sprite& s = sprites[i];
+    if(s.m_bHidden || !(s.m_nStates & bit))continue;
+
+    const Transform& x = transforms[i];
+    assert(transforms.GetEntity(i) == sprites.GetEntity(i));
+
+    desc.m_nSpriteIndex = s.m_nIndex;
+    desc.m_nCurrentFrame = s.m_nFrame;
+    desc.m_vPos = x.m_vPos;
+    desc.m_fXScale = x.m_fXScale;
+    desc.m_fYScale = x.m_fYScale;
+    desc.m_fAlpha = s.m_fAlpha;
+    desc.m_f4Tint = s.m_f4Tint;
+
+    m_pRenderer->Draw(&desc);
+  } //for
+} //DrawSprites
+
+/// Draw the number on each card that is shown.
+
+void CObjectManager::DrawCards(){
+  PROFILE_ZONE("DrawCards");
+
+  CComponentArray<CardInfo>& cards = GetComponents<CardInfo>();
+
+  for(size_t i=0; i<cards.Size(); i++){
+    const Entity e = cards.GetEntity(i);
+    if(Get<Sprite>(e).m_bHidden)continue;
+
+    const CardInfo& c = cards[i];
+    const int n = c.m_nDamage? c.m_nDamage: c.m_nShield? c.m_nShield: c.m_nHealth;
+    if(n == 0)continue;
+
+    const Vector2& pos = Get<Transform>(e).m_vPos;
+    const std::string s = std::to_string(n);
+    m_pRenderer->DrawScreenText(s.c_str(), Vector2(pos.x - 13, m_nWinHeight - pos.y - 30), Colors::Black);
+  } //for
+} //DrawCards
+
+/// Draw the number of enemies on each level on the map, except the special
+/// one, and check off the levels that are complete.
+
+void CObjectManager::DrawNodes(){
+  PROFILE_ZONE("DrawNodes");
+
+  CComponentArray<NodeInfo>& infos = GetComponents<NodeInfo>();
+
+  for(size_t i=0; i<infos.Size(); i++){
+    const Entity e = infos.GetEntity(i);
+    const Vector2& pos = Get<Transform>(e).m_vPos;
+
+    if(Get<Sprite>(e).m_nIndex != (UINT)eSprite::Nerd){
+      const std::string s = std::to_string(infos[i].m_nEnemies);
+      m_pRenderer->DrawScreenText(s.c_str(), Vector2(pos.x - 13, m_nWinHeight - pos.y - 35), Colors::White);
+    } //if
+
+    if(infos[i].m_bComplete){
+      LSpriteDesc2D desc;
+      desc.m_nSpriteIndex = (UINT)eSprite::Checkmark;
+      desc.m_vPos = pos + Vector2(0, -15);
+      desc.m_fXScale = desc.m_fYScale = 0.05f;
+      m_pRenderer->Draw(&desc);
+    } //if
+  } //for
+} //DrawNodes
+
+/// Draw the player's health and shield, and while the player is playing a
+/// card, its effect: a book turning its pages for damage, floating Zs for
+/// health and calendars flying out for shield.
+
+void CObjectManager::DrawPlayers(){
+  PROFILE_ZONE("DrawPlayers");
+
+  CComponentArray<PlayerInfo>& infos = GetComponents<PlayerInfo>();
+
+  for(size_t i=0; i<infos.Size(); i++){
+    const Entity e = infos.GetEntity(i);
+    const Vector2& pos = Get<Transform>(e).m_vPos;
+
+    const std::string health = std::to_string(Get<Health>(e).m_nValue);
+    m_pRenderer->DrawScreenText(health.c_str(), Vector2(pos.x - 25, m_nWinHeight - pos.y - 125), Colors::White);
+
+    const std::string shield = std::to_string(Get<Shield>(e).m_nValue);
+    m_pRenderer->DrawScreenText(shield.c_str(), Vector2(pos.x - 25, m_nWinHeight - pos.y - 155), Colors::Blue);
+
+    const Actor& a = Get<Actor>(e);
+    if(a.m_eState != eAct::Acting)continue;
 
-    int numEnemies = enemies.size();
-    //Below is how enemies are spaced
-    float totalDist = numEnemies * enemyHeight + (numEnemies - 1) * abs(diffY);
-    float startY = m_nWinHeight - (m_nWinHeight - totalDist) / 2 - enemyHeight / 2;
+    const Card card = infos[i].m_vDeck.at(infos[i].m_nCard);
+    const float time = a.m_fTime;
 
-    Vector2 currPosition = Vector2(x, startY);
+    if(card.dealDamage() > 0){
+      LSpriteDesc2D desc;
+      desc.m_nSpriteIndex = (UINT)eSprite::BookTurning;
+      desc.m_vPos = pos + Vector2(0, 175);
+      desc.m_fXScale = desc.m_fYScale = 3.0f;
+      desc.m_nCurrentFrame = (UINT)Get<Animation>(e).m_nCount;
+      m_pRenderer->Draw(&desc);
+    } //if
 
-    for (int i = 0; i < numEnemies; i++)
+    else if(card.giveHealth() > 0){
+      const float y = pos.y - time*25;
+
+      m_pRenderer->DrawScreenText("Z", Vector2(pos.x, y - 150), Colors::DarkBlue);
+      m_pRenderer->DrawScreenText("Z", Vector2(pos.x + 90, y - 125), Colors::DarkBlue);
+      m_pRenderer->DrawScreenText("Z", Vector2(pos.x - 90, y - 125), Colors::DarkBlue);
+    } //else if
+
+    else if(card.giveShield() > 0){
+      const float speed = 30.0f;
+      const float diagonal = speed*cosf(XM_PI/4);
+
+      LSpriteDesc2D desc;
+      desc.m_nSpriteIndex = (UINT)eSprite::Calendar;
+      desc.m_fXScale = desc.m_fYScale = 2.0f;
+
+      desc.m_vPos = pos + Vector2(0, 150 + time*speed);
+      m_pRenderer->Draw(&desc);
+
+      desc.m_vPos = pos + Vector2(90 + time*diagonal, 125 + time*diagonal);
+      m_pRenderer->Draw(&desc);
+
+      desc.m_vPos = pos + Vector2(-90 - time*diagonal, 125 + time*diagonal);
+      m_pRenderer->Draw(&desc);
+    } //else if
+  } //for
+} //DrawPlayers
+
+/// Draw each enemy's health and intent, and the effect of the card it is
+/// playing: homework papers circling it, a shout of "LAME!!!" from the boss,
+/// or a laptop rising for a heal. Text is by far the most expensive thing
+/// to draw, so it is left off enemies that have been shrunk to fit a large
+/// formation unless they are taking their turn.
+
+void CObjectManager::DrawEnemies(){
+  PROFILE_ZONE("DrawEnemies");
+
+  CComponentArray<EnemyInfo>& infos = GetComponents<EnemyInfo>();
+
+  for(size_t i=0; i<infos.Size(); i++){
+    const EnemyInfo& info = infos[i];
+    const Entity e = infos.GetEntity(i);
+    const Vector2& pos = Get<Transform>(e).m_vPos;
+    const Actor& a = Get<Actor>(e);
+    const float scale = info.m_fFormationScale;
+
+    const bool showText = scale >= 0.5f ||
+      (a.m_eState != eAct::Idle && a.m_eState != eAct::Waiting);
+
+    if(showText){
+      PROFILE_ZONE("Enemy text");
+
+      const std::string s = std::to_string(Get<Health>(e).m_nValue);
+      m_pRenderer->DrawScreenText(s.c_str(), Vector2(pos.x - 25, m_nWinHeight - pos.y - 125*scale), Colors::White);
+
+      if(info.m_bIntent && a.m_eState != eAct::Acting){
+        const bool heal = info.m_sCard.type == EnemyCardType::Heal;
+        const std::string intent = (heal? "+": "-") + std::to_string(info.m_sCard.value);
+        m_pRenderer->DrawScreenText(intent.c_str(), Vector2(pos.x - 25, m_nWinHeight - pos.y - 155*scale),
+          heal? Colors::LightGreen: Colors::Red);
+      } //if
+    } //if
+
+    if(a.m_eState != eAct::Acting)continue;
+
+    const float time = a.m_fTime;
+
+    if(info.m_sCard.type == EnemyCardType::Heal){
+      LSpriteDesc2D desc;
+      desc.m_nSpriteIndex = (UINT)eSprite::Laptop;
+      desc.m_fXScale = desc.m_fYScale = 0.18f;
+      desc.m_vPos = pos + Vector2(0, 120 + 60*time);
+      m_pRenderer->Draw(&desc);
+    } //if
+
+    else if(info.m_eAttack == EnemyAttack::EndlessHomework){
+      const UINT sprite = Get<Sprite>(e).m_nIndex;
+      const float w = m_pRenderer->GetWidth(sprite);
+      const float h = m_pRenderer->GetHeight(sprite);
+
+      LSpriteDesc2D desc;
+      desc.m_nSpriteIndex = (UINT)eSprite::Paper;
+      desc.m_fXScale = desc.m_fYScale = 0.35f;
+
+      for(int j=0; j<4; j++){ //a quarter turn apart
+        const float angle = time + j*XM_PIDIV2;
+        desc.m_vPos = pos + Vector2(w*cosf(angle), h*sinf(angle));
+        m_pRenderer->Draw(&desc);
+      } //for
+    } //else if
+
+    else if(info.m_eAttack == EnemyAttack::Lame){
+      const Vector2 p(pos.x - 100*time, m_nWinHeight - pos.y - 80);
+      m_pRenderer->DrawScreenText("LAME!!!", p, Colors::White);
+    } //else if
+  } //for
+} //DrawEnemies
+
+//Position enemies in a formation of columns, shrinking them to fit when there
+//are more than fit at full size
+void CObjectManager::PositionEnemies()
+{
+    formation.Arrange(enemies.size());
+
+    for (size_t i = 0; i < enemies.size(); i++)
     {
-        enemies.at(i)->SetPosition(currPosition);
-        currPosition += Vector2(0, diffY - enemyHeight);
+        const EnemySlot slot = formation.GetSlot(i);
+        enemies[i].SetPosition(Vector2(slot.x, slot.y));
+        enemies[i].SetFormationScale(formation.GetScale());
     }
 }
 
+//Find the enemy under a point in world space, or -1 if there is none
+int CObjectManager::PickEnemy(const Vector2& pos)
+{
+    return formation.Pick(pos.x, pos.y);
+}
+
 void CObjectManager::ClearEnemies()
 {
     enemies.clear();
@@ -114,20 +553,29 @@ void CObjectManager::RemoveEnemy(int index)
     PositionEnemies();
 }
 
+//Remove every enemy that has been killed, keeping the rest in turn order,
+//and lay out the survivors once
+void CObjectManager::RemoveDeadEnemies()
+{
+    const CEntityPool& pool = m_cEntities;
+
+    enemies.erase(std::remove_if(enemies.begin(), enemies.end(),
+        [&](const Enemy& e) { return !pool.IsAlive(e.GetEntity()); }), enemies.end());
+
+    PositionEnemies();
+}
+
 void CObjectManager::UnlockLevel(int id)
 {
-    //nodes[id]->m_f4Tint = Vector4(0.05, 0.85, 0.0, 1.0);
-    nodes[id]->m_nSpriteIndex = (UINT)eSprite::DoorOpen;
+    nodes[id].SetOpen(true);
 }
 
 void CObjectManager::CompleteLevel(int id)
 {
-    //nodes[id]->m_f4Tint = Vector4(0.05, 0.05, 0.85, 1.0);
-    nodes[id]->complete = true;
+    nodes[id].SetComplete(true);
 }
 
 void CObjectManager::LockLevel(int id)
 {
-    //nodes[id]->m_f4Tint = Vector4(0.75, 0.25, 0.0, 1.0);
-    nodes[id]->m_nSpriteIndex = (UINT)eSprite::DoorClosed;
+    nodes[id].SetOpen(false);
 }
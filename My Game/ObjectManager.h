@@ -4,39 +4,111 @@
 #ifndef __L4RC_GAME_OBJECTMANAGER_H__
 #define __L4RC_GAME_OBJECTMANAGER_H__
 
-#include "BaseObjectManager.h"
-#include "Object.h"
+#include <tuple>
+
+#include "Component.h"
 #include "Common.h"
+#include "Components.h"
+#include "Ecs.h"
 #include "Enemy.h"
+#include "Formation.h"
 #include "NodeObject.h"
+#include "Player.h"
+#include "SpriteDesc.h"
+#include "SpriteRenderer.h"
 
 /// \brief The object manager.
 ///
-/// A collection of all of the game objects.
+/// Owns every game entity and its components, one dense array per kind of
+/// component, and runs the systems that move and draw them. Each system
+/// walks the arrays it needs from front to back, so the hot loops touch
+/// memory in order and have no virtual calls, and a new kind of entity is a
+/// new mix of components rather than a new class. The player, enemy, card
+/// and node classes are handles that game code uses to change one entity.
+/// The enemy and node lists are in the order the game numbers them.
 
-class CObjectManager: 
-  public LBaseObjectManager<CObject>,
+class CObjectManager:
+  public LComponent,
   public CCommon{
+  private:
+    CEntityPool m_cEntities; ///< Entities.
+
+    std::tuple<
+      CComponentArray<Transform>,
+      CComponentArray<Sprite>,
+      CComponentArray<Health>,
+      CComponentArray<Shield>,
+      CComponentArray<CardInfo>,
+      CComponentArray<NodeInfo>,
+      CComponentArray<Animation>,
+      CComponentArray<Actor>,
+      CComponentArray<Flash>,
+      CComponentArray<EnemyInfo>,
+      CComponentArray<PlayerInfo>
+    > m_tComponents; ///< Component arrays.
+
+    bool m_bCull = false; ///< Some entity has been destroyed since the last cull.
+
+    Entity CreateEntity(eSprite t, const Vector2& pos, UINT states); ///< Create an entity with a transform and sprite.
+    template<class f> void ForEachArray(f fn); ///< Call a function on every component array.
+    void Cull(); ///< Remove the components of destroyed entities.
+
+    void Animate(); ///< Animation system.
+    void MoveActors(float t); ///< Actor system.
+    void FadeFlashes(float t); ///< Damage flash system.
+
+    void DrawSprites(); ///< Sprite system.
+    void DrawCards(); ///< Card text.
+    void DrawNodes(); ///< Node text and checkmarks.
+    void DrawPlayers(); ///< Player text and card effects.
+    void DrawEnemies(); ///< Enemy text, intents and card effects.
+
+    std::vector<Enemy> enemies;
+    CFormation formation;
+
+    std::vector<NodeObject> nodes;
+
   public:
-    CObject* create(eSprite, const Vector2&); ///< Create new object.
-    std::vector<Enemy*> GetEnemies() { return enemies;  }
+    Player CreatePlayer(const Vector2& pos); ///< Create the player and cards.
+    Card CreateCard(const Vector2& pos); ///< Create a card.
+    Enemy CreateEnemy(const Vector2& pos); ///< Create an enemy.
+    NodeObject CreateNode(const Vector2& pos); ///< Create a map node.
+    void Destroy(Entity e); ///< Destroy an entity.
+
+    /// Get the array of components of one type.
+    /// \tparam t Component type.
+    /// \return Reference to the component array.
+
+    template<class t> CComponentArray<t>& GetComponents(){
+      return std::get<CComponentArray<t>>(m_tComponents);
+    } //GetComponents
+
+    /// Get the component of an entity, which must have one.
+    /// \tparam t Component type.
+    /// \param e Entity.
+    /// \return Reference to the component.
+
+    template<class t> t& Get(Entity e){
+      return GetComponents<t>().Get(e);
+    } //Get
+
+    void move(); ///< Move everything.
+    void draw(); ///< Draw everything.
+    void clear(); ///< Destroy everything.
+
+    const std::vector<Enemy>& GetEnemies() { return enemies;  }
     void ClearEnemies();
     void ClearNodes() { nodes.clear(); }
+    size_t GetCount() { return GetComponents<Sprite>().Size(); }
     void RemoveEnemy(int index);
+    void RemoveDeadEnemies();
+    void PositionEnemies();
+    int PickEnemy(const Vector2& pos);
 
     void UnlockLevel(int id);
     void CompleteLevel(int id);
     void LockLevel(int id);
-    std::vector<NodeObject*> GetNodes() { return nodes; }
-
-    private:
-        std::vector<Enemy*> enemies;
-        const int MaxEnemiesPerRow = 3;
-
-        std::vector<NodeObject*> nodes;
-
-        void PositionEnemies();
-        void SetEquallySpaced(std::vector<Enemy*> enemies, float x);
+    const std::vector<NodeObject>& GetNodes() { return nodes; }
 }; //CObjectManager
 
 #endif //__L4RC_GAME_OBJECTMANAGER_H__
@@ -0,0 +1,221 @@
+/// \file Platform.cpp
+/// \brief Code for the operating system services the game uses directly.
+///
+/// On Windows these are Win32 calls. Elsewhere the game runs on the headless
+/// platform, whose window supplies scripted mouse input.
+
+#include "Platform.h"
+#include "FrameGate.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+  #include <shellapi.h>
+#else
+  #include <cstdio>
+  #include "Sound.h"
+  #include "SpriteRenderer.h"
+  #include "Window.h"
+#endif
+
+/// Get the mouse position relative to the top left of a window's client
+/// area.
+/// \param hwnd Window handle.
+/// \param p [out] Mouse position in pixels.
+
+void GetMousePosition(HWND hwnd, POINT& p){
+#ifdef _WIN32
+  GetCursorPos(&p);
+  ScreenToClient(hwnd, &p);
+#else
+  (void)hwnd;
+  LWindow::GetCursor(p);
+#endif
+} //GetMousePosition
+
+/// Open a web page in the default browser. The headless platform has no
+/// browser, so it prints the address instead.
+/// \param url Web address.
+
+void OpenUrl(const char* url){
+#ifdef _WIN32
+  ShellExecuteA(0, 0, url, 0, 0, SW_SHOW);
+#else
+  printf("%s\n", url);
+#endif
+} //OpenUrl
+
+/// End the game once the current frame is done.
+/// \param code Exit code.
+
+void RequestQuit(int code){
+#ifdef _WIN32
+  PostQuitMessage(code);
+#else
+  LWindow::Quit(code);
+#endif
+} //RequestQuit
+
+/// Get the number of draws, texture switches and text draws in the last
+/// frame. Only the headless renderer counts them, so on Windows they are
+/// left at zero.
+/// \param p Renderer.
+/// \param c [in, out] Frame cost, whose counts are filled in.
+
+void GetRenderStats(const LSpriteRenderer* p, FrameCost& c){
+#ifdef _WIN32
+  (void)p;
+  (void)c;
+#else
+  c.m_nDraws = p->GetDrawCount();
+  c.m_nTextureSwitches = p->GetTextureSwitchCount();
+  c.m_nTextDraws = p->GetTextDrawCount();
+#endif
+} //GetRenderStats
+
+/// Choose whether frames are drawn to pixels or their draws are only
+/// recorded and counted, which is all a test that does not look at the
+/// pixels needs. The headless renderer draws on the CPU, which is most of
+/// the cost of a frame. The LARC renderer draws on the GPU, so on Windows
+/// this does nothing.
+/// \param p Renderer.
+/// \param raster true to draw pixels.
+
+void SetRaster(LSpriteRenderer* p, bool raster){
+#ifdef _WIN32
+  (void)p;
+  (void)raster;
+#else
+  p->SetRaster(raster);
+#endif
+} //SetRaster
+
+/// Decode a sprite's image so that loading it later is quick. This may be
+/// called on any thread. The headless renderer decodes the image here. The
+/// LARC renderer decodes and uploads in one step on the main thread, so on
+/// Windows this does nothing.
+/// \param p Renderer.
+/// \param name Sprite name in the settings file.
+
+void PrepareSprite(LSpriteRenderer* p, const char* name){
+#ifdef _WIN32
+  (void)p;
+  (void)name;
+#else
+  p->Prepare(name);
+#endif
+} //PrepareSprite
+
+/// Unload a sprite, freeing its image unless another sprite uses it. The
+/// LARC renderer keeps every image it loads, so on Windows this does
+/// nothing.
+/// \param p Renderer.
+/// \param t Sprite type.
+
+void UnloadSprite(LSpriteRenderer* p, eSprite t){
+#ifdef _WIN32
+  (void)p;
+  (void)t;
+#else
+  p->Unload(t);
+#endif
+} //UnloadSprite
+
+/// Unload a sound. The LARC sound player keeps every sound it loads, so on
+/// Windows this does nothing.
+/// \param p Sound player.
+/// \param t Sound type.
+
+void UnloadSound(LSound* p, eSound t){
+#ifdef _WIN32
+  (void)p;
+  (void)t;
+#else
+  p->Unload(t);
+#endif
+} //UnloadSound
+
+/// Get the memory used by the images and sounds that are loaded. Neither
+/// the LARC renderer nor its sound player can say, and they cannot unload
+/// anything anyway, so on Windows this is 0, which keeps the game from
+/// trying to.
+/// \param p Renderer.
+/// \param s Sound player.
+/// \return Memory in bytes.
+
+size_t GetAssetBytes(const LSpriteRenderer* p, const LSound* s){
+#ifdef _WIN32
+  (void)p;
+  (void)s;
+  return 0;
+#else
+  return p->GetTextureBytes() + s->GetBytes();
+#endif
+} //GetAssetBytes
+
+/// Test whether the settings file, images and sounds can be read again while
+/// the game runs. The LARC renderer and sound player read the settings
+/// once and cannot replace a texture or a sound, so on Windows they cannot,
+/// and the game does not watch them for changes there.
+/// \return true if they can be read again.
+
+bool CanReloadAssets(){
+#ifdef _WIN32
+  return false;
+#else
+  return true;
+#endif
+} //CanReloadAssets
+
+/// Read the settings file again after it has changed, and apply it to the
+/// loaded sprites and sounds. Nothing else may be looking up settings
+/// meanwhile. The LARC renderer and sound player read the settings once,
+/// so on Windows this does nothing.
+/// \param p Renderer.
+/// \param s Sound player.
+/// \return Number of sprites and sounds that changed, or -1 if the settings
+///   were not read.
+
+int ReloadSettingsFile(LSpriteRenderer* p, LSound* s){
+#ifdef _WIN32
+  (void)p;
+  (void)s;
+  return -1;
+#else
+  if(!LSettings::ReloadSettings())return -1;
+  return (int)(p->RefreshSprites() + s->RefreshSounds());
+#endif
+} //ReloadSettingsFile
+
+/// Read an image file again after it has changed, replacing the texture of
+/// the sprites that use it if any are loaded. The LARC renderer cannot
+/// replace a texture, so on Windows this does nothing.
+/// \param p Renderer.
+/// \param path Image file name.
+/// \return true if a loaded texture was replaced.
+
+bool ReloadImage(LSpriteRenderer* p, const char* path){
+#ifdef _WIN32
+  (void)p;
+  (void)path;
+  return false;
+#else
+  return p->ReloadImage(path);
+#endif
+} //ReloadImage
+
+/// Read a sound file again after it has changed, for the loaded sounds that
+/// were read from it. The LARC sound player cannot replace a sound, so on
+/// Windows this does nothing.
+/// \param p Sound player.
+/// \param path Sound file name.
+/// \return Number of sounds read again.
+
+size_t ReloadSound(LSound* p, const char* path){
+#ifdef _WIN32
+  (void)p;
+  (void)path;
+  return 0;
+#else
+  return p->ReloadFile(path);
+#endif
+} //ReloadSound
@@ -0,0 +1,28 @@
+/// \file Platform.h
+/// \brief Interface for the few operating system services the game uses
+/// directly, rather than through the engine.
+
+#ifndef __L4RC_GAME_PLATFORM_H__
+#define __L4RC_GAME_PLATFORM_H__
+
+#include "Defines.h"
+
+class LSpriteRenderer;
+class LSound;
+struct FrameCost;
+
+void GetMousePosition(HWND hwnd, POINT& p); ///< Get the mouse position in a window.
+void OpenUrl(const char* url); ///< Open a web page.
+void RequestQuit(int code); ///< End the game.
+void GetRenderStats(const LSpriteRenderer* p, FrameCost& c); ///< Get the last frame's draw counts.
+void SetRaster(LSpriteRenderer* p, bool raster); ///< Draw frames to pixels or only count their draws.
+void PrepareSprite(LSpriteRenderer* p, const char* name); ///< Decode a sprite's image ahead of loading it.
+void UnloadSprite(LSpriteRenderer* p, eSprite t); ///< Unload a sprite.
+void UnloadSound(LSound* p, eSound t); ///< Unload a sound.
+size_t GetAssetBytes(const LSpriteRenderer* p, const LSound* s); ///< Get memory used by loaded images and sounds.
+bool CanReloadAssets(); ///< Test whether settings, images and sounds can be read again.
+int ReloadSettingsFile(LSpriteRenderer* p, LSound* s); ///< Read the settings file again.
+bool ReloadImage(LSpriteRenderer* p, const char* path); ///< Read an image file again.
+size_t ReloadSound(LSound* p, const char* path); ///< Read a sound file again.
+
+#endif //__L4RC_GAME_PLATFORM_H__
@@ -1,288 +1,209 @@
 #include "Player.h"
 #include "ComponentIncludes.h"
-#include "Helpers.h"
-#include <iostream>
+#include "ObjectManager.h"
 
-Player::Player(const Vector2& p, float height) : CObject(eSprite::Player, p)
+template<class t> t& Player::Get() const
 {
-	health = 15;
-	m_fXScale = .2;
-	m_fYScale = .2;
-	this->height = height;
-	state = PlayerState::WaitingForInput;
-	createCards();
-	CreateStartDeck();
-	shuffleCards();
-
-	currCardIndex = -10;
-	attackingTime = 0;
-
-	animationTimer = new LEventTimer(0.1f);
-
-	bookIndex = 0;
-	damageTimer = new LEventTimer(0.3f);
+	return m_pObjectManager->Get<t>(entity);
 }
 
-void Player::TakeDamage(int amount)
+//Take damage from an enemy in a large encounter. Battles that fit in a battle
+//state work the damage out there instead and call Hit
+void Player::TakeDamage(int amount) const
 {
+	int health = Get<Health>().m_nValue;
+	int shield = Get<Shield>().m_nValue;
+
 	if (shield > 0) {
 		shield -= amount;
 		if (shield < 0)
 			health = std::max(0, health - abs(shield));
-		ResetShield();
+		shield = 0;
 	}
 	else {
 		health = std::max(0, health - amount);
 	}
-	m_f4Tint = Vector4(0.9f, 0.4f, 0.4f, 1.0f);
-	damageTimer = new LEventTimer(0.3f);
+	Hit(health, shield);
+}
+
+//Take a hit whose damage has already been worked out, leaving the given
+//health and shield
+void Player::Hit(int health, int shield) const
+{
+	Get<Health>().m_nValue = health;
+	Get<Shield>().m_nValue = shield;
+	Get<Sprite>().m_f4Tint = Vector4(0.9f, 0.4f, 0.4f, 1.0f);
+	Get<Flash>().m_fTime = 0.3f;
 	m_pAudio->play(eSound::PlayerDamage);
 }
 
-int Player::useCard(int cardNum)
+int Player::useCard(int cardNum) const
 {
-	if (deck[cardNum]->giveShield() > 0)
-		shield += deck[cardNum]->giveShield();
+	Card card = GetDeck().at(cardNum);
+
+	if (card.giveShield() > 0)
+		Get<Shield>().m_nValue += card.giveShield();
 
-	if (deck[cardNum]->giveHealth() > 0)
-		health += deck[cardNum]->giveHealth();
+	if (card.giveHealth() > 0)
+		Get<Health>().m_nValue += card.giveHealth();
 	
-	return deck.at(cardNum)->dealDamage();
+	return card.dealDamage();
 }
 
-void Player::createCards() {
-	for (int i = 0; i < 10; i++) {
-		deck.push_back(new Card(Vector2(350, -390)));
-	}
-}
+void Player::CreateStartDeck() const {
+	const std::vector<Card>& deck = GetDeck();
 
-void Player::CreateStartDeck() {
 	//First num in createCard = Dmg, 2nd num = Shield, 3rd num = health
-	deck[0]->createCard(4, 0, 0);
-	deck[1]->createCard(4, 0, 0);
-	deck[2]->createCard(4, 0, 0);
-	deck[3]->createCard(4, 0, 0);
-	deck[4]->createCard(4, 0, 0);
-	deck[5]->createCard(0, 2, 0);
-	deck[6]->createCard(0, 2, 0);
-	deck[7]->createCard(0, 2, 0);
-	deck[8]->createCard(0, 2, 0);
-	deck[9]->createCard(0, 0, 1);
-}
-
-int myrandom(int i) { return rand() % i; }
+	deck[0].createCard(4, 0, 0);
+	deck[1].createCard(4, 0, 0);
+	deck[2].createCard(4, 0, 0);
+	deck[3].createCard(4, 0, 0);
+	deck[4].createCard(4, 0, 0);
+	deck[5].createCard(0, 2, 0);
+	deck[6].createCard(0, 2, 0);
+	deck[7].createCard(0, 2, 0);
+	deck[8].createCard(0, 2, 0);
+	deck[9].createCard(0, 0, 1);
+}
+
+//Add a card to the deck. It goes into the discard pile, so it is drawn after
+//the next reshuffle. Does nothing if the piles are full
+void Player::AddCard(const Card& card, int damage, int shield, int health) const
+{
+	PlayerInfo& info = Get<PlayerInfo>();
 
-void Player::shuffleCards() {
-	srand(unsigned(time(0)));
+	if (info.m_cPiles.Add() >= CCardRing::Capacity)
+		return;
 
-	std::random_shuffle(deck.begin(), deck.end());// , myrandom);
+	card.createCard(damage, shield, health);
+	info.m_vDeck.push_back(card);
 }
 
-void Player::PlayCard(const Vector2& center)
+//The sound is picked now, from the card being played, and played when the
+//player gets to the center
+void Player::PlayCard(const Vector2& center) const
 {
-	state = PlayerState::MovingTowardsCenter;
-	target = center;
-	oldPosition = m_vPos;
-	m_nSpriteIndex = (UINT)eSprite::PlayerRunning;
+	Actor& actor = Get<Actor>();
+	actor.m_eState = eAct::Moving;
+	actor.m_vTarget = center;
+	actor.m_vHome = Get<Transform>().m_vPos;
+	actor.m_eSound = eSound::Size;
+
+	Card card = GetDeck().at(Get<PlayerInfo>().m_nCard);
+	if (card.dealDamage() > 0)
+		actor.m_eSound = eSound::StudyTime;
+	else if (card.giveHealth() > 0)
+		actor.m_eSound = eSound::PowerNap;
+	else if (card.giveShield() > 0)
+		actor.m_eSound = eSound::Time;
+
+	Get<Sprite>().m_nIndex = actor.m_nRunSprite;
+	Get<Animation>().m_eMode = eAnimate::Loop;
 }
 
-void Player::ReturnToPosition()
+void Player::ReturnToPosition() const
 {
-	state = PlayerState::Returning;
-	target = oldPosition;
+	Actor& actor = Get<Actor>();
+	actor.m_eState = eAct::Returning;
+	actor.m_vTarget = actor.m_vHome;
+	Get<Animation>().m_eMode = eAnimate::Loop;
 }
 
-void Player::draw()
+PlayerState Player::GetState() const
 {
-	if (CCommon::state == GameState::Battle)
+	switch (Get<Actor>().m_eState)
 	{
-		CObject::draw();
-
-		const std::string s = this->getHeadText();
-		m_pRenderer->DrawScreenText(s.c_str(), Vector2(m_vPos.x - 25, height - m_vPos.y - 125), Colors::White); //draw to screen
-
-		const std::string s2 = this->getShieldText();
-		m_pRenderer->DrawScreenText(s2.c_str(), Vector2(m_vPos.x - 25, height - m_vPos.y - 155), Colors::Blue); //draw to screen
-
-		if (state == PlayerState::Attacking)
-		{
-			auto currCard = deck.at(currCardIndex);
-			if (currCard->dealDamage() > 0)
-			{
-				LSpriteDesc2D bookDesc;
-				bookDesc.m_nSpriteIndex = (UINT)eSprite::BookTurning;
-				bookDesc.m_vPos = m_vPos + Vector2(0, 175);
-				bookDesc.m_fXScale = 3.0f;
-				bookDesc.m_fYScale = 3.0f;
-				bookDesc.m_nCurrentFrame = bookIndex;
-
-				m_pRenderer->Draw(&bookDesc);
-			}
-			else if (currCard->giveHealth() > 0)
-			{
-				float yBase = m_vPos.y - attackingTime * 25;
-
-				Vector2 basePos1 = Vector2(m_vPos.x, yBase - 150);
-				Vector2 basePos2 = Vector2(m_vPos.x + 90, yBase - 125);
-				Vector2 basePos3 = Vector2(m_vPos.x - 90, yBase - 125);
-
-				std::cout << basePos1.x << ", " << basePos1.y << std::endl;
-
-				const std::string text = "Z";
-				m_pRenderer->DrawScreenText(text.c_str(), basePos1, Colors::DarkBlue);
-				m_pRenderer->DrawScreenText(text.c_str(), basePos2, Colors::DarkBlue);
-				m_pRenderer->DrawScreenText(text.c_str(), basePos3, Colors::DarkBlue);
-			}
-			else if (currCard->giveShield() > 0)
-			{
-				Vector2 basePos1 = Vector2(m_vPos.x, m_vPos.y + 150);
-				Vector2 basePos2 = Vector2(m_vPos.x + 90, m_vPos.y + 125);
-				Vector2 basePos3 = Vector2(m_vPos.x - 90, m_vPos.y + 125);
-
-				float speed = 30.0f;
-
-				LSpriteDesc2D desc1;
-				desc1.m_nSpriteIndex = (UINT)eSprite::Calendar;
-				desc1.m_vPos = basePos1 + Vector2(0, attackingTime * speed);
-				desc1.m_fXScale = 2.0f;
-				desc1.m_fYScale = 2.0f;
-
-				float dirSpeed = speed * cosf(3.141592 / 4);
-
-				LSpriteDesc2D desc2;
-				desc2.m_nSpriteIndex = (UINT)eSprite::Calendar;
-				desc2.m_vPos = basePos2 + Vector2(attackingTime * dirSpeed, attackingTime * dirSpeed);
-				desc2.m_fXScale = 2.0f;
-				desc2.m_fYScale = 2.0f;
-
-				LSpriteDesc2D desc3;
-				desc3.m_nSpriteIndex = (UINT)eSprite::Calendar;
-				desc3.m_vPos = basePos3 + Vector2(attackingTime * -dirSpeed, attackingTime * dirSpeed);
-				desc3.m_fXScale = 2.0f;
-				desc3.m_fYScale = 2.0f;
-
-				m_pRenderer->Draw(&desc1);
-				m_pRenderer->Draw(&desc2);
-				m_pRenderer->Draw(&desc3);
-			}
-		}
+		case eAct::Moving: return PlayerState::MovingTowardsCenter;
+		case eAct::Acting: return PlayerState::Attacking;
+		case eAct::Returning: return PlayerState::Returning;
+		case eAct::Returned: return PlayerState::Returned;
+		default: return PlayerState::WaitingForInput;
 	}
 }
 
-void Player::move()
+void Player::SetBack() const
 {
-	const float t = m_pTimer->GetFrameTime();
+	Get<Actor>().m_eState = eAct::Idle;
+	Get<Animation>().m_eMode = eAnimate::None;
+	Get<Transform>().m_vPos = Get<Actor>().m_vHome;
+}
 
-	Vector2 direction;
+//The book has turned its last page
+bool Player::FinishedAttacking() const
+{
+	const size_t numBookFrames = m_pRenderer->GetNumFrames(eSprite::BookTurning);
 
-	switch (state)
-	{
-		case PlayerState::MovingTowardsCenter:
-			UpdateFrame();
-			direction = (target - m_vPos);
-			direction.Normalize();
-			m_vPos += direction * speed * t;
-
-			if ((m_vPos - target).LengthSquared() < diff)
-			{
-				state = PlayerState::Attacking;
-				bookIndex = 0;
-				attackingTime = 0;
-
-				auto currCard = deck.at(currCardIndex);
-				if (currCard->dealDamage() > 0)
-				{
-					m_pAudio->play(eSound::StudyTime);
-				}
-				else if (currCard->giveHealth() > 0)
-				{
-					m_pAudio->play(eSound::PowerNap);
-				}
-				else if (currCard->giveShield() > 0)
-				{
-					m_pAudio->play(eSound::Time);
-				}
-			}
-			break;
-		case PlayerState::Attacking:
-			UpdateBook();
-			attackingTime += t;
-			break;
-		case PlayerState::Returning:
-			UpdateFrame();
-			direction = (target - m_vPos);
-			direction.Normalize();
-			m_vPos += direction * speed * t;
-
-			if ((m_vPos - target).LengthSquared() < diff)
-			{
-				state = PlayerState::Returned;
-				m_nSpriteIndex = (UINT)eSprite::Player;
-				m_nCurrentFrame = 0;
-			}
-			break;
-	}
+	return Get<Animation>().m_nCount == (int)numBookFrames;
+}
 
-	if (damageTimer->Triggered())
-		m_f4Tint = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
+void Player::SetCard(int card) const
+{
+	Get<PlayerInfo>().m_nCard = card;
 }
 
-void Player::UpdateFrame()
+void Player::SetUnavailable() const
 {
-	const size_t numFrames = m_pRenderer->GetNumFrames(m_nSpriteIndex);
+	Get<Sprite>().m_fAlpha = 0.5f;
+}
 
-	if (animationTimer->Triggered())
-	{
-		m_nCurrentFrame++;
-		m_nCurrentFrame %= numFrames;
-	}
+void Player::SetNormal() const
+{
+	Get<Sprite>().m_fAlpha = 1.0f;
 }
 
-void Player::UpdateBook()
+void Player::Reset() const
 {
-	const size_t numBookFrames = m_pRenderer->GetNumFrames((UINT)eSprite::BookTurning);
+	Get<Transform>().m_vPos = Vector2(125, 430);   //Manually reset player to right position no matter when god mode activated
+	Get<Actor>().m_eState = eAct::Idle;
+	Get<Actor>().m_fTime = 0;
+	Get<Animation>().m_eMode = eAnimate::None;
+	Get<Animation>().m_nCount = 0;
+	Get<PlayerInfo>().m_nCard = -10;
+	Get<Sprite>().m_nIndex = (UINT)eSprite::Player;
+	Get<Sprite>().m_nFrame = 0;
+}
 
-	if (animationTimer->Triggered())
-	{
-		bookIndex++;
-	}
+void Player::ResetShield() const
+{
+	Get<Shield>().m_nValue = 0;
 }
 
-void Player::SetBack()
+bool Player::IsDead() const
 {
-	state = PlayerState::WaitingForInput;
-	m_vPos = oldPosition;
+	return Get<Health>().m_nValue == 0;
 }
 
-bool Player::FinishedAttacking()
+int Player::GetHealth() const
 {
-	const size_t numBookFrames = m_pRenderer->GetNumFrames(eSprite::BookTurning);
+	return Get<Health>().m_nValue;
+}
 
-	return bookIndex == numBookFrames;
+int Player::GetShield() const
+{
+	return Get<Shield>().m_nValue;
+}
+
+void Player::SetHealth(int h) const
+{
+	Get<Health>().m_nValue = h;
 }
 
-void Player::SetCard(int card)
+void Player::SetShield(int s) const
 {
-	currCardIndex = card;
+	Get<Shield>().m_nValue = s;
 }
 
-void Player::SetUnavailable()
+const Vector2& Player::GetPos() const
 {
-	m_fAlpha = 0.5f;
+	return Get<Transform>().m_vPos;
 }
 
-void Player::SetNormal()
+const std::vector<Card>& Player::GetDeck() const
 {
-	m_fAlpha = 1.0f;
+	return Get<PlayerInfo>().m_vDeck;
 }
 
-void Player::Reset()
+CDeck& Player::GetPiles() const
 {
-	m_vPos = Vector2(125, 430);   //Manually reset player to right position no matter when god mode activated
-	state = PlayerState::WaitingForInput;
-	bookIndex = 0;
-	currCardIndex = -10;
-	attackingTime = 0;
-	m_nSpriteIndex = (UINT)eSprite::Player;
-	m_nCurrentFrame = 0;
+	return Get<PlayerInfo>().m_cPiles;
 }
@@ -1,60 +1,53 @@
 #pragma once
 
 #include "Card.h"
-#include "Object.h"
-#include "Random.h"
-#include "EventTimer.h"
+#include "Deck.h"
+#include "Common.h"
+#include "Component.h"
+#include "Ecs.h"
 
 enum class PlayerState { WaitingForInput, MovingTowardsCenter, Attacking, Returning, Returned };
 
-class Player : public CObject, CCommon
+//The player is an entity with a transform, a sprite, health, a shield, an
+//animation, an actor, a damage flash and player info, which holds the cards.
+//This is a handle to it, so it is cheap to copy, and the object manager's
+//systems move and draw it
+class Player : public LComponent, CCommon
 {
 	public:
-		Player(const Vector2& p, float height);
-
-		void TakeDamage(int);
-		int useCard(int);
-		void ResetShield() { shield = 0; }
-		void createCards();
-		void CreateStartDeck();
-		void shuffleCards();
-
-		bool IsDead() { return health == 0; }
-		void draw();
-		void move();
-		void PlayCard(const Vector2& center);
-		void ReturnToPosition();
-		PlayerState GetState() { return state; }
-		void SetBack();
-		std::vector<Card*> GetDeck() { return deck; }
-
-		bool FinishedAttacking();
-		void SetCard(int card);
-
-		void SetUnavailable();
-		void SetNormal();
-		void Reset();
+		Player() {}
+		explicit Player(Entity e) : entity(e) {}
+		Entity GetEntity() const { return entity; }
+
+		void TakeDamage(int) const;
+		void Hit(int health, int shield) const;
+		int useCard(int) const;
+		void ResetShield() const;
+		void CreateStartDeck() const;
+		void AddCard(const Card& card, int damage, int shield, int health) const;
+
+		bool IsDead() const;
+		int GetHealth() const;
+		int GetShield() const;
+		void SetHealth(int h) const;
+		void SetShield(int s) const;
+		const Vector2& GetPos() const;
+		void PlayCard(const Vector2& center) const;
+		void ReturnToPosition() const;
+		PlayerState GetState() const;
+		void SetBack() const;
+		const std::vector<Card>& GetDeck() const;
+		CDeck& GetPiles() const;
+
+		bool FinishedAttacking() const;
+		void SetCard(int card) const;
+
+		void SetUnavailable() const;
+		void SetNormal() const;
+		void Reset() const;
 
 	private:
-		int health;
-		int shield = 0;
-
-		PlayerState state;
-		Vector2 target;
-		Vector2 oldPosition;
-		const float speed = 460.0f;
-		const float diff = 15.0f;
-		float height;
-		LEventTimer* animationTimer = nullptr;
-		int bookIndex;
-		LEventTimer* damageTimer = nullptr;
-		int currCardIndex;
-		float attackingTime;
-
-		std::vector<Card*> deck;
-
-		std::string getHeadText() { return std::to_string(health);  }
-		std::string getShieldText() { return std::to_string(shield); }
-		void UpdateFrame();
-		void UpdateBook();
-};
\ No newline at end of file
+		Entity entity;
+
+		template<class t> t& Get() const;
+};
@@ -0,0 +1,227 @@
+/// \file Profiler.cpp
+/// \brief Code for the frame profiler CProfiler.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "Profiler.h"
+
+std::mutex CProfiler::m_mRings;
+std::vector<std::unique_ptr<CProfileRing>> CProfiler::m_vRings;
+thread_local CProfileRing* CProfiler::m_pRing = nullptr;
+
+uint64_t CProfiler::m_nEpoch = CProfiler::Now();
+uint64_t CProfiler::m_nRead = 0;
+float CProfiler::m_pFrameMs[FrameHistory];
+size_t CProfiler::m_nFrames = 0;
+std::vector<ProfileZoneStat> CProfiler::m_vZones;
+
+static const char* const g_pFrameZone = "Frame"; ///< Name of the frame zone.
+
+/// Open a zone by remembering its start time. Zones nested deeper than
+/// `MaxDepth` are not recorded.
+/// \param t Start time.
+
+void CProfileRing::Begin(uint64_t t){
+  if(m_nDepth < MaxDepth)
+    m_pStart[m_nDepth] = t;
+
+  ++m_nDepth;
+} //Begin
+
+/// Close the innermost open zone and publish its sample. The slot's stamp
+/// is cleared before the sample is written, and the release fence keeps the
+/// writes from moving above it, so that a reader never takes a half-written
+/// slot for a whole one.
+/// \param name Zone name.
+/// \param t End time.
+
+void CProfileRing::End(const char* name, uint64_t t){
+  --m_nDepth;
+  if(m_nDepth >= MaxDepth)return;
+
+  const uint64_t head = m_nHead.load(std::memory_order_relaxed);
+  Slot& s = m_pSlot[head%Capacity];
+
+  s.m_nStamp.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  s.m_pName.store(name, std::memory_order_relaxed);
+  s.m_nStart.store(m_pStart[m_nDepth], std::memory_order_relaxed);
+  s.m_nEnd.store(t, std::memory_order_relaxed);
+  s.m_nDepth.store(m_nDepth, std::memory_order_relaxed);
+
+  s.m_nStamp.store(head + 1, std::memory_order_release);
+  m_nHead.store(head + 1, std::memory_order_release);
+} //End
+
+/// Copy a sample out of the ring. Safe from any thread. The slot's stamp is
+/// read before and after the copy, and the copy is kept only if both times
+/// it says the slot holds sample `i`, so that a sample the owner thread has
+/// overwritten, or is overwriting, is dropped rather than read torn.
+/// \param i Sample number, less than the head.
+/// \param s [out] Sample.
+/// \return true if the sample was still in the ring and was copied whole.
+
+bool CProfileRing::Read(uint64_t i, ProfileSample& s) const{
+  const Slot& slot = m_pSlot[i%Capacity];
+  if(slot.m_nStamp.load(std::memory_order_acquire) != i + 1)return false;
+
+  s.m_pName = slot.m_pName.load(std::memory_order_relaxed);
+  s.m_nStart = slot.m_nStart.load(std::memory_order_relaxed);
+  s.m_nEnd = slot.m_nEnd.load(std::memory_order_relaxed);
+  s.m_nDepth = slot.m_nDepth.load(std::memory_order_relaxed);
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.m_nStamp.load(std::memory_order_relaxed) == i + 1;
+} //Read
+
+/// Get the time from a monotonic clock.
+/// \return Time in nanoseconds.
+
+uint64_t CProfiler::Now(){
+  using namespace std::chrono;
+  return (uint64_t)duration_cast<nanoseconds>(
+    steady_clock::now().time_since_epoch()).count();
+} //Now
+
+/// Get the ring for the calling thread, creating and registering it the
+/// first time. This is the only time a thread takes the lock.
+/// \return Pointer to this thread's ring.
+
+CProfileRing* CProfiler::GetRing(){
+  if(m_pRing == nullptr){
+    std::lock_guard<std::mutex> lock(m_mRings);
+    m_vRings.emplace_back(new CProfileRing((uint32_t)m_vRings.size()));
+    m_pRing = m_vRings.back().get();
+  } //if
+
+  return m_pRing;
+} //GetRing
+
+/// Open a zone on the calling thread.
+
+void CProfiler::Begin(){
+  GetRing()->Begin(Now());
+} //Begin
+
+/// Close the innermost zone on the calling thread.
+/// \param name Zone name, a string literal.
+
+void CProfiler::End(const char* name){
+  GetRing()->End(name, Now());
+} //End
+
+/// Start a frame. Must be called on the main thread.
+
+void CProfiler::BeginFrame(){
+  Begin();
+} //BeginFrame
+
+/// End a frame. The frame is itself a zone. Samples the main thread recorded
+/// since the last frame are added up per zone, and the zones are put into
+/// the order in which they started so that the overlay reads as a tree.
+
+void CProfiler::EndFrame(){
+  End(g_pFrameZone);
+
+  const CProfileRing& ring = *GetRing();
+  const uint64_t head = ring.GetHead();
+  const uint64_t first = std::max(m_nRead, head > CProfileRing::Capacity?
+    head - CProfileRing::Capacity: 0);
+
+  for(ProfileZoneStat& z: m_vZones){
+    z.m_fLastMs = 0.0f;
+    z.m_bSeen = false;
+  } //for
+
+  for(uint64_t i=first; i<head; i++){
+    ProfileSample s;
+    ring.Read(i, s); //our own ring, so never overwritten under us
+    const float ms = (s.m_nEnd - s.m_nStart)/1000000.0f;
+
+    auto it = std::find_if(m_vZones.begin(), m_vZones.end(),
+      [&](const ProfileZoneStat& z){
+        return z.m_pName == s.m_pName && z.m_nDepth == s.m_nDepth;});
+
+    if(it == m_vZones.end()){
+      m_vZones.push_back(ProfileZoneStat());
+      it = m_vZones.end() - 1;
+      it->m_pName = s.m_pName;
+      it->m_nDepth = s.m_nDepth;
+    } //if
+
+    if(!it->m_bSeen || s.m_nStart < it->m_nFirstStart)
+      it->m_nFirstStart = s.m_nStart;
+
+    it->m_fLastMs += ms;
+    it->m_bSeen = true;
+
+    if(s.m_pName == g_pFrameZone)
+      m_pFrameMs[m_nFrames++%FrameHistory] = ms;
+  } //for
+
+  m_nRead = head;
+
+  for(ProfileZoneStat& z: m_vZones)
+    z.m_fAvgMs = 0.9f*z.m_fAvgMs + 0.1f*z.m_fLastMs;
+
+  std::stable_sort(m_vZones.begin(), m_vZones.end(),
+    [](const ProfileZoneStat& a, const ProfileZoneStat& b){
+      return a.m_nFirstStart < b.m_nFirstStart;});
+} //EndFrame
+
+/// Get a percentile of the recent frame times.
+/// \param p Percentile, between 0 and 100.
+/// \return Frame time in milliseconds, or 0 if no frame has ended.
+
+float CProfiler::GetPercentile(float p){
+  const size_t n = m_nFrames < FrameHistory? m_nFrames: FrameHistory;
+  if(n == 0)return 0.0f;
+
+  float ms[FrameHistory];
+  std::copy(m_pFrameMs, m_pFrameMs + n, ms);
+
+  const size_t k = std::min(n - 1, (size_t)(p/100.0f*n));
+  std::nth_element(ms, ms + k, ms + n);
+  return ms[k];
+} //GetPercentile
+
+/// Write every sample still held by every thread's ring as complete events
+/// in the Chrome trace event format. Other threads carry on recording while
+/// this runs, and samples they overwrite before they are copied are left
+/// out.
+/// \param path File name.
+/// \return true if the file was written.
+
+bool CProfiler::WriteTrace(const char* path){
+  FILE* output = fopen(path, "wb");
+  if(output == nullptr)return false;
+
+  fprintf(output, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool first = true;
+
+  std::lock_guard<std::mutex> lock(m_mRings);
+
+  for(const std::unique_ptr<CProfileRing>& ring: m_vRings){
+    const uint64_t head = ring->GetHead();
+    const uint64_t start = head > CProfileRing::Capacity?
+      head - CProfileRing::Capacity: 0;
+
+    for(uint64_t i=start; i<head; i++){
+      ProfileSample s;
+      if(!ring->Read(i, s))continue; //overwritten by the owner thread
+
+      fprintf(output, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+        "\"ts\":%.3f,\"dur\":%.3f}", first? "": ",\n", s.m_pName,
+        ring->GetThread(), (s.m_nStart - m_nEpoch)/1000.0,
+        (s.m_nEnd - s.m_nStart)/1000.0);
+
+      first = false;
+    } //for
+  } //for
+
+  fprintf(output, "\n]}\n");
+  return fclose(output) == 0;
+} //WriteTrace
@@ -0,0 +1,144 @@
+/// \file Profiler.h
+/// \brief Interface for the frame profiler CProfiler.
+
+#ifndef __L4RC_GAME_PROFILER_H__
+#define __L4RC_GAME_PROFILER_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// \brief A timed zone.
+///
+/// One execution of a profiled block of code. Zone names must be string
+/// literals, since only the pointer is stored.
+
+struct ProfileSample{
+  const char* m_pName = nullptr; ///< Zone name.
+  uint64_t m_nStart = 0; ///< Start time in nanoseconds.
+  uint64_t m_nEnd = 0; ///< End time in nanoseconds.
+  uint32_t m_nDepth = 0; ///< Nesting depth, 0 for outermost.
+}; //ProfileSample
+
+/// \brief A ring buffer of samples.
+///
+/// Each thread that enters a zone gets its own ring, so the owning thread
+/// never takes a lock to record a sample. It fills in the slot and then
+/// publishes it by advancing the head with a release store. Once the ring is
+/// full the oldest samples are overwritten, so a thread reading another's
+/// ring may find a slot being written under it. Each slot is therefore a
+/// seqlock: its stamp is cleared before the sample is written and set to one
+/// more than the sample number after, and a reader that copies a slot keeps
+/// the copy only if the stamp was the one it expected both before and after.
+
+class CProfileRing{
+  public:
+    static const size_t Capacity = 1 << 14; ///< Number of samples kept.
+    static const size_t MaxDepth = 32; ///< Deepest nesting of zones.
+
+  private:
+    /// \brief A sample slot, with every field atomic so that a reader racing
+    /// the writer reads stale or torn values but is not undefined behavior.
+
+    struct Slot{
+      std::atomic<uint64_t> m_nStamp{0}; ///< Sample number plus one, 0 while being written.
+      std::atomic<const char*> m_pName{nullptr}; ///< Zone name.
+      std::atomic<uint64_t> m_nStart{0}; ///< Start time in nanoseconds.
+      std::atomic<uint64_t> m_nEnd{0}; ///< End time in nanoseconds.
+      std::atomic<uint32_t> m_nDepth{0}; ///< Nesting depth.
+    }; //Slot
+
+    Slot m_pSlot[Capacity]; ///< Samples.
+    std::atomic<uint64_t> m_nHead{0}; ///< Number of samples ever written.
+    uint64_t m_pStart[MaxDepth]; ///< Start times of open zones.
+    uint32_t m_nDepth = 0; ///< Number of open zones.
+    uint32_t m_nThread = 0; ///< Thread number.
+
+  public:
+    explicit CProfileRing(uint32_t thread): m_nThread(thread){} ///< Constructor.
+
+    void Begin(uint64_t t); ///< Open a zone.
+    void End(const char* name, uint64_t t); ///< Close a zone.
+    bool Read(uint64_t i, ProfileSample& s) const; ///< Copy a sample.
+
+    uint64_t GetHead() const { return m_nHead.load(std::memory_order_acquire); } ///< Get number of samples written.
+    uint32_t GetThread() const { return m_nThread; } ///< Get thread number.
+}; //CProfileRing
+
+/// \brief Running statistics for a zone.
+
+struct ProfileZoneStat{
+  const char* m_pName = nullptr; ///< Zone name.
+  uint32_t m_nDepth = 0; ///< Nesting depth.
+  uint64_t m_nFirstStart = 0; ///< Start of its first sample in the last frame.
+  float m_fLastMs = 0.0f; ///< Time spent in the last frame.
+  float m_fAvgMs = 0.0f; ///< Smoothed time per frame.
+  bool m_bSeen = false; ///< Seen in the last frame.
+}; //ProfileZoneStat
+
+/// \brief The frame profiler.
+///
+/// Hierarchical zone timing. Wrap a block in `PROFILE_ZONE("name")` to time
+/// it. The main thread brackets each frame with `BeginFrame()` and
+/// `EndFrame()`, which gathers its samples into per-zone statistics and a
+/// history of frame times for the overlay. `WriteTrace()` writes every
+/// sample still held by any thread as a Chrome trace, which can be opened in
+/// `chrome://tracing` or Perfetto. Like `CCommon`, everything is static so
+/// that any code can open a zone without being handed a profiler.
+
+class CProfiler{
+  public:
+    static const size_t FrameHistory = 256; ///< Number of frame times kept.
+
+  private:
+    static std::mutex m_mRings; ///< Guards the list of rings.
+    static std::vector<std::unique_ptr<CProfileRing>> m_vRings; ///< Every thread's ring.
+    static thread_local CProfileRing* m_pRing; ///< This thread's ring.
+
+    static uint64_t m_nEpoch; ///< Time of the first sample.
+    static uint64_t m_nRead; ///< Main thread samples already gathered.
+    static float m_pFrameMs[FrameHistory]; ///< Recent frame times.
+    static size_t m_nFrames; ///< Number of frames ever ended.
+    static std::vector<ProfileZoneStat> m_vZones; ///< Zone statistics.
+
+    static CProfileRing* GetRing(); ///< Get this thread's ring.
+
+  public:
+    static uint64_t Now(); ///< Get the time in nanoseconds.
+    static void Begin(); ///< Open a zone.
+    static void End(const char* name); ///< Close a zone.
+
+    static void BeginFrame(); ///< Start a frame.
+    static void EndFrame(); ///< End a frame and gather its samples.
+
+    static float GetPercentile(float p); ///< Get a frame time percentile.
+    static const std::vector<ProfileZoneStat>& GetZones(){ return m_vZones; } ///< Get zone statistics.
+    static bool WriteTrace(const char* path); ///< Write a Chrome trace.
+}; //CProfiler
+
+/// \brief A scoped zone.
+///
+/// Opens a zone when constructed and closes it when destroyed.
+
+class CProfileZone{
+  private:
+    const char* m_pName; ///< Zone name.
+
+  public:
+    explicit CProfileZone(const char* name): m_pName(name){ CProfiler::Begin(); } ///< Constructor.
+    ~CProfileZone(){ CProfiler::End(m_pName); } ///< Destructor.
+}; //CProfileZone
+
+#define PROFILE_CONCAT2(a, b) a##b ///< Paste tokens.
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b) ///< Paste tokens after expanding them.
+
+#ifdef L4RC_NO_PROFILE
+  #define PROFILE_ZONE(name) ///< Profiling compiled out.
+#else
+  #define PROFILE_ZONE(name) CProfileZone PROFILE_CONCAT(_zone, __LINE__)(name) ///< Time the rest of this scope.
+#endif
+
+#endif //__L4RC_GAME_PROFILER_H__
@@ -0,0 +1,66 @@
+/// \file Rng.h
+/// \brief Interface for the pseudo-random number generator CRng.
+
+#ifndef __L4RC_GAME_RNG_H__
+#define __L4RC_GAME_RNG_H__
+
+#include <cstdint>
+
+/// \brief Pseudo-random number generator.
+///
+/// A small xorshift64* generator for the game rules. Unlike `LRandom` it
+/// does not depend on the engine and its whole state is a single 64-bit word,
+/// so that rules code can run headless and a run can be replayed, saved or
+/// cloned just by copying the state.
+
+class CRng{
+  private:
+    uint64_t m_nState = 0x9E3779B97F4A7C15ULL; ///< Generator state, never zero.
+
+  public:
+    CRng(){} ///< Default constructor.
+    explicit CRng(uint64_t seed){ Seed(seed); } ///< Constructor.
+
+    /// Seed the generator. The seed is scrambled with a splitmix64 step so
+    /// that nearby seeds give unrelated sequences.
+    /// \param seed Seed value.
+
+    void Seed(uint64_t seed){
+      uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+      z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+      m_nState = (z ^ (z >> 31)) | 1;
+    } //Seed
+
+    /// Get the next 32 random bits.
+    /// \return Random unsigned integer.
+
+    uint32_t next(){
+      m_nState ^= m_nState >> 12;
+      m_nState ^= m_nState << 25;
+      m_nState ^= m_nState >> 27;
+      return (uint32_t)((m_nState*0x2545F4914F6CDD1DULL) >> 32);
+    } //next
+
+    /// Get a random integer in a range, like `LRandom::randn()`.
+    /// \param i Lower bound, inclusive.
+    /// \param j Upper bound, inclusive.
+    /// \return Random integer in [i, j].
+
+    int randn(int i, int j){
+      const uint64_t range = (uint64_t)((int64_t)j - i + 1);
+      return i + (int)(((uint64_t)next()*range) >> 32);
+    } //randn
+
+    /// Get a random floating point number in [0, 1).
+    /// \return Random float.
+
+    float randf(){
+      return (next() >> 8)*(1.0f/16777216.0f);
+    } //randf
+
+    uint64_t GetState() const { return m_nState; } ///< Get generator state.
+    void SetState(uint64_t s){ m_nState = s? s: 1; } ///< Set generator state.
+}; //CRng
+
+#endif //__L4RC_GAME_RNG_H__
@@ -0,0 +1,116 @@
+/// \file SeedCatalog.cpp
+/// \brief Code for the catalog of named map seeds CSeedCatalog.
+
+#include <algorithm>
+#include <cstring>
+
+#include "SeedCatalog.h"
+
+static_assert(sizeof(SeedCatalogHeader) == 16, "seed catalog header layout");
+static_assert(sizeof(SeedEntry) == 32, "seed catalog entry layout");
+
+/// Order entries by name.
+/// \param a An entry.
+/// \param b Another entry.
+/// \return true if a comes before b.
+
+static bool NameLess(const SeedEntry& a, const SeedEntry& b){
+  return strncmp(a.m_pName, b.m_pName, SeedEntry::NameSize) < 0;
+} //NameLess
+
+/// Map a catalog file and check its header.
+/// \param path File name.
+/// \return true if the catalog was opened.
+
+bool CSeedCatalog::Open(const char* path){
+  m_pEntry = nullptr;
+  m_nCount = 0;
+
+  if(!m_cFile.Open(path) || m_cFile.GetSize() < sizeof(SeedCatalogHeader))
+    return false;
+
+  SeedCatalogHeader h;
+  memcpy(&h, m_cFile.GetData(), sizeof(h));
+
+  if(h.m_nMagic != Magic || h.m_nVersion != Version ||
+    h.m_nHeaderSize != sizeof(SeedCatalogHeader) ||
+    m_cFile.GetSize() != sizeof(SeedCatalogHeader) + h.m_nCount*sizeof(SeedEntry)){
+    m_cFile.Close();
+    return false;
+  } //if
+
+  m_pEntry = (const SeedEntry*)(m_cFile.GetData() + sizeof(SeedCatalogHeader));
+  m_nCount = h.m_nCount;
+  return true;
+} //Open
+
+/// Look up a seed by name.
+/// \param name Name.
+/// \param seed [out] The seed, if the name was found.
+/// \return true if the name was found.
+
+bool CSeedCatalog::Find(const char* name, uint64_t& seed) const{
+  SeedEntry key;
+  if(!MakeEntry(name, 0, key))return false;
+
+  const SeedEntry* end = m_pEntry + m_nCount;
+  const SeedEntry* p = std::lower_bound(m_pEntry, end, key, NameLess);
+
+  if(p == end || NameLess(key, *p))
+    return false;
+
+  seed = p->m_nSeed;
+  return true;
+} //Find
+
+/// Fill in an entry.
+/// \param name Name, shorter than `SeedEntry::NameSize`.
+/// \param seed Seed.
+/// \param e [out] The entry.
+/// \return false if the name is empty or too long.
+
+bool CSeedCatalog::MakeEntry(const char* name, uint64_t seed, SeedEntry& e){
+  const size_t n = strlen(name);
+  if(n == 0 || n >= SeedEntry::NameSize)return false;
+
+  memset(e.m_pName, 0, SeedEntry::NameSize);
+  memcpy(e.m_pName, name, n);
+  e.m_nSeed = seed;
+  return true;
+} //MakeEntry
+
+/// Add entries to a catalog file, creating it if it does not exist. An entry
+/// with the same name as an old one replaces it. The file is replaced
+/// atomically, so the game never sees a half-written catalog.
+/// \param path File name.
+/// \param v New entries.
+/// \return true if the catalog was written.
+
+bool CSeedCatalog::Add(const char* path, const std::vector<SeedEntry>& v){
+  std::vector<SeedEntry> entries(v);
+
+  { //old entries go after the new ones so that the new ones win
+    CSeedCatalog old;
+
+    if(old.Open(path))
+      entries.insert(entries.end(), old.m_pEntry, old.m_pEntry + old.m_nCount);
+  }
+
+  std::stable_sort(entries.begin(), entries.end(), NameLess);
+
+  entries.erase(std::unique(entries.begin(), entries.end(),
+    [](const SeedEntry& a, const SeedEntry& b){ return !NameLess(a, b) && !NameLess(b, a); }),
+    entries.end());
+
+  SeedCatalogHeader h;
+  h.m_nMagic = Magic;
+  h.m_nVersion = Version;
+  h.m_nHeaderSize = (uint16_t)sizeof(SeedCatalogHeader);
+  h.m_nCount = (uint32_t)entries.size();
+
+  std::vector<uint8_t> buffer((const uint8_t*)&h, (const uint8_t*)&h + sizeof(h));
+  const uint8_t* p = (const uint8_t*)entries.data();
+  buffer.insert(buffer.end(), p, p + entries.size()*sizeof(SeedEntry));
+
+  return WriteFileAtomic(path, buffer.data(), buffer.size());
+} //Add
@@ -0,0 +1,64 @@
+/// \file SeedCatalog.h
+/// \brief Interface for the catalog of named map seeds CSeedCatalog.
+
+#ifndef __L4RC_GAME_SEEDCATALOG_H__
+#define __L4RC_GAME_SEEDCATALOG_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MappedFile.h"
+
+/// \brief A named map seed.
+
+struct SeedEntry{
+  static const size_t NameSize = 24; ///< Name buffer size, including the terminator.
+
+  char m_pName[NameSize] = {}; ///< Name, zero padded.
+  uint64_t m_nSeed = 0; ///< Seed for the map generator.
+}; //SeedEntry
+
+/// \brief Seed catalog file header.
+///
+/// The file starts with this header, followed by the entries sorted by name.
+/// Every field is little-endian and naturally aligned, so the file can be
+/// searched in place from a memory mapping.
+
+struct SeedCatalogHeader{
+  uint32_t m_nMagic = 0; ///< Must be `CSeedCatalog::Magic`.
+  uint16_t m_nVersion = 0; ///< Format version.
+  uint16_t m_nHeaderSize = 0; ///< Size of this header.
+  uint32_t m_nCount = 0; ///< Number of entries.
+  uint32_t m_nReserved = 0; ///< Zero.
+}; //SeedCatalogHeader
+
+/// \brief The catalog of named map seeds.
+///
+/// Curated and daily runs are map seeds with properties that someone asked
+/// for, found offline by the seed search tool and given a name. The game
+/// looks a name up here to play that run. Lookups binary search the mapped
+/// file, so the catalog can hold millions of entries without being read in.
+
+class CSeedCatalog{
+  public:
+    static const uint32_t Magic = 0x54414353; ///< "SCAT" in file byte order.
+    static const uint16_t Version = 1; ///< Current format version.
+
+  private:
+    CMappedFile m_cFile; ///< The mapped catalog file.
+    const SeedEntry* m_pEntry = nullptr; ///< Entries, sorted by name.
+    size_t m_nCount = 0; ///< Number of entries.
+
+  public:
+    bool Open(const char* path); ///< Open a catalog.
+    bool Find(const char* name, uint64_t& seed) const; ///< Look up a seed by name.
+
+    size_t GetCount() const { return m_nCount; } ///< Get number of entries.
+    const SeedEntry& GetEntry(size_t i) const { return m_pEntry[i]; } ///< Get an entry.
+
+    static bool MakeEntry(const char* name, uint64_t seed, SeedEntry& e); ///< Fill in an entry.
+    static bool Add(const char* path, const std::vector<SeedEntry>& v); ///< Add entries to a catalog.
+}; //CSeedCatalog
+
+#endif //__L4RC_GAME_SEEDCATALOG_H__
@@ -0,0 +1,262 @@
+/// \file Snapshot.cpp
+/// \brief Code for run snapshots, which save and resume a run.
+
+#include <cstddef>
+#include <cstring>
+
+#include "Snapshot.h"
+#include "EnemyPolicy.h"
+#include "MapProgress.h"
+#include "MappedFile.h"
+
+static_assert(sizeof(SnapHeader) == 64, "snapshot header layout");
+static_assert(sizeof(SnapNode) == 8, "snapshot level layout");
+static_assert(sizeof(SnapEdge) == 2, "snapshot path layout");
+static_assert(sizeof(SnapCard) == 4, "snapshot card layout");
+static_assert(sizeof(SnapEnemy) == 4, "snapshot enemy layout");
+
+/// FNV-1a hash of a block of memory.
+/// \param p Pointer to the bytes.
+/// \param n Number of bytes.
+/// \param h Hash so far.
+/// \return Updated hash.
+
+static uint32_t Fnv1a(const uint8_t* p, size_t n, uint32_t h=2166136261u){
+  for(size_t i=0; i<n; i++)
+    h = (h ^ p[i])*16777619u;
+
+  return h;
+} //Fnv1a
+
+/// Get the checksum of a snapshot file, taking its checksum field as zero.
+/// \param p Pointer to the file contents.
+/// \param n File size, at least the size of the header.
+/// \return Checksum.
+
+static uint32_t Checksum(const uint8_t* p, size_t n){
+  SnapHeader h;
+  memcpy(&h, p, sizeof(h));
+  h.m_nChecksum = 0;
+
+  const uint32_t c = Fnv1a((const uint8_t*)&h, sizeof(h));
+  return Fnv1a(p + sizeof(h), n - sizeof(h), c);
+} //Checksum
+
+/// Get the size of the file for the counts in a header.
+/// \param h Header.
+/// \return File size in bytes.
+
+static size_t FileSize(const SnapHeader& h){
+  return sizeof(SnapHeader) + h.m_nNodes*sizeof(SnapNode) +
+    h.m_nEdges*sizeof(SnapEdge) + h.m_nCards*sizeof(SnapCard) +
+    h.m_nCards + h.m_nEnemies*sizeof(SnapEnemy);
+} //FileSize
+
+/// Store a map's levels and paths. Level flags other than `Special` are
+/// cleared, the caller sets them from the run's progress.
+/// \param map The map.
+
+void RunSnapshot::SetMap(const MapDesc& map){
+  m_vNodes.clear();
+  m_vEdges.clear();
+
+  for(const std::vector<MapNode>& layer: map.m_vLayers)
+    for(const MapNode& node: layer){
+      SnapNode n;
+      n.x = (int16_t)node.x;
+      n.y = (int16_t)node.y;
+      n.m_nLayer = (uint8_t)node.m_nLayer;
+      n.m_nEnemies = (uint8_t)node.m_nEnemies;
+      n.m_nFlags = node.m_bSpecial? SnapNode::Special: 0;
+      m_vNodes.push_back(n);
+    } //for
+
+  for(const std::vector<MapEdge>& list: map.m_vAdjacency)
+    for(const MapEdge& edge: list){
+      SnapEdge e;
+      e.m_nFrom = (uint8_t)edge.m_nFrom;
+      e.m_nTo = (uint8_t)edge.m_nTo;
+      m_vEdges.push_back(e);
+    } //for
+
+  m_sHeader.m_nSpecial = (uint8_t)map.m_nSpecial;
+} //SetMap
+
+/// Rebuild a map from the stored levels and paths.
+/// \param map [out] The map.
+
+void RunSnapshot::GetMap(MapDesc& map) const{
+  map.m_vLayers.clear();
+  map.m_vAdjacency.clear();
+
+  for(size_t i=0; i<m_vNodes.size(); i++){
+    const SnapNode& n = m_vNodes[i];
+
+    while(map.m_vLayers.size() <= n.m_nLayer)
+      map.m_vLayers.push_back(std::vector<MapNode>());
+
+    MapNode node;
+    node.m_nId = (int)i;
+    node.m_nLayer = n.m_nLayer;
+    node.x = n.x;
+    node.y = n.y;
+    node.m_nEnemies = n.m_nEnemies;
+    node.m_bSpecial = (n.m_nFlags & SnapNode::Special) != 0;
+    map.m_vLayers[n.m_nLayer].push_back(node);
+  } //for
+
+  for(const SnapEdge& e: m_vEdges){
+    while(map.m_vAdjacency.size() <= e.m_nFrom)
+      map.m_vAdjacency.push_back(std::vector<MapEdge>());
+
+    MapEdge edge;
+    edge.m_nFrom = e.m_nFrom;
+    edge.m_nTo = e.m_nTo;
+    map.m_vAdjacency[e.m_nFrom].push_back(edge);
+  } //for
+
+  map.m_nSpecial = m_sHeader.m_nSpecial;
+} //GetMap
+
+/// Store the card piles. The cards must already be stored, since the
+/// played and exhausts flags go into them.
+/// \param s Card piles.
+
+void RunSnapshot::SetPiles(const DeckState& s){
+  size_t n = 0;
+
+  for(size_t p=0; p<4; p++){
+    m_sHeader.m_pPile[p] = s.m_pCount[p];
+    n += s.m_pCount[p];
+  } //for
+
+  m_vOrder.assign(s.m_pOrder, s.m_pOrder + n);
+
+  for(size_t i=0; i<m_vCards.size() && i<s.m_nCards; i++)
+    m_vCards[i].m_nFlags = s.m_pFlags[i];
+
+  m_sHeader.m_nDeckRng = s.m_nRng;
+} //SetPiles
+
+/// Restore the card piles.
+/// \param s [out] Card piles.
+
+void RunSnapshot::GetPiles(DeckState& s) const{
+  s.m_nCards = (uint16_t)m_vCards.size();
+
+  for(size_t p=0; p<4; p++)
+    s.m_pCount[p] = m_sHeader.m_pPile[p];
+
+  memcpy(s.m_pOrder, m_vOrder.data(), m_vOrder.size());
+
+  for(size_t i=0; i<m_vCards.size(); i++)
+    s.m_pFlags[i] = m_vCards[i].m_nFlags;
+
+  s.m_nRng = m_sHeader.m_nDeckRng;
+} //GetPiles
+
+/// Append the contents of a vector to a buffer.
+/// \param buffer Buffer.
+/// \param v Vector.
+
+template<class t> static void Append(std::vector<uint8_t>& buffer, const std::vector<t>& v){
+  const uint8_t* p = (const uint8_t*)v.data();
+  buffer.insert(buffer.end(), p, p + v.size()*sizeof(t));
+} //Append
+
+/// Write a snapshot. The file is replaced atomically, so a crash or power
+/// cut leaves either the old snapshot or the new one, never half of each.
+/// \param path File name.
+/// \param s [in, out] Snapshot, whose header counts are filled in.
+/// \return true if the snapshot was written.
+
+bool SaveSnapshot(const char* path, RunSnapshot& s){
+  SnapHeader& h = s.m_sHeader;
+
+  if(s.m_vNodes.size() > 255 || s.m_vEdges.size() > 255 ||
+    s.m_vCards.size() > CCardRing::Capacity || s.m_vEnemies.size() > 65535 ||
+    s.m_vOrder.size() != s.m_vCards.size())
+    return false;
+
+  h.m_nMagic = RunSnapshot::Magic;
+  h.m_nVersion = RunSnapshot::Version;
+  h.m_nHeaderSize = (uint16_t)sizeof(SnapHeader);
+  h.m_nNodes = (uint8_t)s.m_vNodes.size();
+  h.m_nEdges = (uint8_t)s.m_vEdges.size();
+  h.m_nCards = (uint16_t)s.m_vCards.size();
+  h.m_nEnemies = (uint16_t)s.m_vEnemies.size();
+  h.m_nSize = (uint32_t)FileSize(h);
+  h.m_nChecksum = 0;
+
+  std::vector<uint8_t> buffer((const uint8_t*)&h, (const uint8_t*)&h + sizeof(h));
+  buffer.reserve(h.m_nSize);
+  Append(buffer, s.m_vNodes);
+  Append(buffer, s.m_vEdges);
+  Append(buffer, s.m_vCards);
+  Append(buffer, s.m_vOrder);
+  Append(buffer, s.m_vEnemies);
+
+  h.m_nChecksum = Checksum(buffer.data(), buffer.size());
+  memcpy(buffer.data() + offsetof(SnapHeader, m_nChecksum), &h.m_nChecksum, sizeof(uint32_t));
+
+  return WriteFileAtomic(path, buffer.data(), buffer.size());
+} //SaveSnapshot
+
+/// Copy an array out of a mapped snapshot.
+/// \param p [in, out] Read position, advanced past the array.
+/// \param n Number of elements.
+/// \param v [out] Vector to copy into.
+
+template<class t> static void Extract(const uint8_t*& p, size_t n, std::vector<t>& v){
+  v.resize(n);
+  if(n > 0)memcpy(v.data(), p, n*sizeof(t));
+  p += n*sizeof(t);
+} //Extract
+
+/// Read a snapshot. The file is memory mapped and checked for the right
+/// magic number, version, size and checksum before anything is copied out,
+/// so a damaged or foreign file is rejected as a whole. So is one whose
+/// counts or indices are out of range for the game, even if intact.
+/// \param path File name.
+/// \param s [out] Snapshot.
+/// \return true if the snapshot was read.
+
+bool LoadSnapshot(const char* path, RunSnapshot& s){
+  CMappedFile file;
+  if(!file.Open(path) || file.GetSize() < sizeof(SnapHeader))return false;
+
+  const uint8_t* p = file.GetData();
+  SnapHeader h;
+  memcpy(&h, p, sizeof(h));
+
+  if(h.m_nMagic != RunSnapshot::Magic || h.m_nVersion != RunSnapshot::Version ||
+    h.m_nHeaderSize != sizeof(SnapHeader) || h.m_nSize != file.GetSize() ||
+    FileSize(h) != file.GetSize() || h.m_nCards > CCardRing::Capacity ||
+    h.m_nNodes > CMapProgress::MaxLevels ||
+    h.m_pPile[0] + h.m_pPile[1] + h.m_pPile[2] + h.m_pPile[3] != h.m_nCards ||
+    Checksum(p, file.GetSize()) != h.m_nChecksum)
+    return false;
+
+  s.m_sHeader = h;
+  p += sizeof(SnapHeader);
+
+  Extract(p, h.m_nNodes, s.m_vNodes);
+  Extract(p, h.m_nEdges, s.m_vEdges);
+  Extract(p, h.m_nCards, s.m_vCards);
+  Extract(p, h.m_nCards, s.m_vOrder);
+  Extract(p, h.m_nEnemies, s.m_vEnemies);
+
+  for(const SnapEdge& e: s.m_vEdges)
+    if(e.m_nFrom >= h.m_nNodes || e.m_nTo >= h.m_nNodes)
+      return false;
+
+  for(uint8_t card: s.m_vOrder)
+    if(card >= h.m_nCards)
+      return false;
+
+  for(const SnapEnemy& e: s.m_vEnemies)
+    if(e.m_nAttack >= (uint8_t)EnemyAttack::Size)
+      return false;
+
+  return h.m_nSpecial < h.m_nNodes && h.m_nLevel < h.m_nNodes;
+} //LoadSnapshot
@@ -0,0 +1,114 @@
+/// \file Snapshot.h
+/// \brief Interface for run snapshots, which save and resume a run.
+
+#ifndef __L4RC_GAME_SNAPSHOT_H__
+#define __L4RC_GAME_SNAPSHOT_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "Deck.h"
+#include "MapGenerator.h"
+
+/// \brief Snapshot file header.
+///
+/// The file starts with this header, followed by the levels, the paths,
+/// the cards, the card pile order and the enemies, each packed tightly in
+/// that order with its count in the header. Every field is little-endian
+/// and naturally aligned, so the file can be read in place from a memory
+/// mapping. The checksum is FNV-1a over the whole file, with the checksum
+/// field taken as zero.
+
+struct SnapHeader{
+  uint32_t m_nMagic = 0; ///< Must be `Magic`.
+  uint16_t m_nVersion = 0; ///< Format version.
+  uint16_t m_nHeaderSize = 0; ///< Size of this header.
+  uint32_t m_nSize = 0; ///< Size of the whole file.
+  uint32_t m_nChecksum = 0; ///< Checksum of the whole file.
+  uint64_t m_nMapRng = 0; ///< Map random number generator state.
+  uint64_t m_nEnemyRng = 0; ///< Enemy random number generator state.
+  uint64_t m_nDeckRng = 0; ///< Card draw random number generator state.
+  int16_t m_nHealth = 0; ///< Player health.
+  int16_t m_nShield = 0; ///< Player shield.
+  uint8_t m_nBattle = 0; ///< 1 if in a battle, 0 if on the map.
+  uint8_t m_nTurn = 0; ///< Cards played this turn.
+  uint8_t m_nLevel = 0; ///< Current level.
+  uint8_t m_nLayer = 0; ///< Current layer.
+  uint8_t m_nNodes = 0; ///< Number of levels.
+  uint8_t m_nEdges = 0; ///< Number of paths.
+  uint8_t m_nSpecial = 0; ///< The special card level.
+  uint8_t m_nReserved = 0; ///< Zero.
+  uint16_t m_nCards = 0; ///< Number of cards.
+  uint16_t m_nEnemies = 0; ///< Number of enemies.
+  uint16_t m_pPile[4] = {0, 0, 0, 0}; ///< Draw, hand, discard and exhaust pile sizes.
+}; //SnapHeader
+
+/// \brief A level in a snapshot.
+
+struct SnapNode{
+  int16_t x = 0; ///< Horizontal position.
+  int16_t y = 0; ///< Vertical position.
+  uint8_t m_nLayer = 0; ///< Layer.
+  uint8_t m_nEnemies = 0; ///< Number of enemies.
+  uint8_t m_nFlags = 0; ///< `SnapNode` flag bits.
+  uint8_t m_nReserved = 0; ///< Zero.
+
+  static const uint8_t Unlocked = 1; ///< Can be entered from the map.
+  static const uint8_t Complete = 2; ///< Has been beaten.
+  static const uint8_t Special = 4; ///< Is the special card level.
+}; //SnapNode
+
+/// \brief A path in a snapshot.
+
+struct SnapEdge{
+  uint8_t m_nFrom = 0; ///< Level the path starts at.
+  uint8_t m_nTo = 0; ///< Level the path leads to.
+}; //SnapEdge
+
+/// \brief A card in a snapshot.
+
+struct SnapCard{
+  int8_t m_nDamage = 0; ///< Damage dealt.
+  int8_t m_nShield = 0; ///< Shield given.
+  int8_t m_nHealth = 0; ///< Health given.
+  uint8_t m_nFlags = 0; ///< Bit 0 for played this turn, bit 1 for exhausts.
+}; //SnapCard
+
+/// \brief An enemy in a snapshot.
+
+struct SnapEnemy{
+  int16_t m_nHealth = 0; ///< Health.
+  uint8_t m_nAttack = 0; ///< Enemy kind, an `EnemyAttack`.
+  uint8_t m_nReserved = 0; ///< Zero.
+}; //SnapEnemy
+
+/// \brief A run snapshot.
+///
+/// Everything needed to resume a run exactly where it was left: the map and
+/// how far through it the player is, the deck with its upgrades and piles,
+/// the player's health and shield, the random number generator states and,
+/// in a battle, the enemies and the number of cards already played this
+/// turn. The game and the headless battle simulator both read and write
+/// this one format.
+
+struct RunSnapshot{
+  static const uint32_t Magic = 0x4E525353; ///< "SSRN" in file byte order.
+  static const uint16_t Version = 1; ///< Current format version.
+
+  SnapHeader m_sHeader; ///< Header, counts are filled in on save.
+  std::vector<SnapNode> m_vNodes; ///< Levels, by level number.
+  std::vector<SnapEdge> m_vEdges; ///< Paths, grouped by starting level.
+  std::vector<SnapCard> m_vCards; ///< Cards, by deck index.
+  std::vector<uint8_t> m_vOrder; ///< Card indices, pile by pile.
+  std::vector<SnapEnemy> m_vEnemies; ///< Enemies, in turn order.
+
+  void SetMap(const MapDesc&); ///< Store a map.
+  void GetMap(MapDesc&) const; ///< Rebuild a map.
+  void SetPiles(const DeckState&); ///< Store the card piles.
+  void GetPiles(DeckState&) const; ///< Restore the card piles.
+}; //RunSnapshot
+
+bool SaveSnapshot(const char* path, RunSnapshot& s); ///< Write a snapshot atomically.
+bool LoadSnapshot(const char* path, RunSnapshot& s); ///< Read a snapshot.
+
+#endif //__L4RC_GAME_SNAPSHOT_H__
@@ -0,0 +1,90 @@
+/// \file SpscRing.h
+/// \brief Interface and code for the lock-free ring buffer CSpscRing.
+
+#ifndef __L4RC_GAME_SPSCRING_H__
+#define __L4RC_GAME_SPSCRING_H__
+
+#include <atomic>
+#include <cstddef>
+
+/// \brief A lock-free ring buffer for one producer thread and one consumer
+/// thread.
+///
+/// Neither side ever waits for the other. A push into a full ring and a pop
+/// from an empty one fail at once, and it is up to the caller what to do
+/// about it. The head is only written by the consumer and the tail only by
+/// the producer, each on a cache line of its own so that the two threads do
+/// not fight over it, and each side keeps a copy of the other's index so
+/// that it only has to read the shared one when the ring looks full or
+/// empty. The number of slots must be a power of two, and one slot is
+/// always left empty.
+/// \tparam t Item type, which must be cheap to copy.
+/// \tparam n Number of slots.
+
+template<class t, size_t n> class CSpscRing{
+  static_assert(n >= 2 && (n & (n - 1)) == 0, "ring size must be a power of two");
+
+  private:
+    static const size_t Mask = n - 1; ///< Slot index mask.
+    static const size_t LineSize = 64; ///< Cache line size.
+
+    alignas(LineSize) std::atomic<size_t> m_nHead{0}; ///< Next slot to pop, written by the consumer.
+    size_t m_nTailCache = 0; ///< Consumer's copy of the tail.
+
+    alignas(LineSize) std::atomic<size_t> m_nTail{0}; ///< Next slot to push, written by the producer.
+    size_t m_nHeadCache = 0; ///< Producer's copy of the head.
+
+    alignas(LineSize) t m_pSlot[n]; ///< Slots.
+
+  public:
+    /// Push an item, on the producer thread.
+    /// \param x Item.
+    /// \return true if it was pushed, false if the ring is full.
+
+    bool TryPush(const t& x){
+      const size_t tail = m_nTail.load(std::memory_order_relaxed);
+      const size_t next = (tail + 1) & Mask;
+
+      if(next == m_nHeadCache){ //looks full, see how far the consumer got
+        m_nHeadCache = m_nHead.load(std::memory_order_acquire);
+        if(next == m_nHeadCache)return false;
+      } //if
+
+      m_pSlot[tail] = x;
+      m_nTail.store(next, std::memory_order_release);
+      return true;
+    } //TryPush
+
+    /// Pop as many items as there are, up to a limit, on the consumer
+    /// thread.
+    /// \param out [out] Items.
+    /// \param most Most items to pop.
+    /// \return Number of items popped.
+
+    size_t TryPop(t* out, size_t most){
+      const size_t head = m_nHead.load(std::memory_order_relaxed);
+
+      if(head == m_nTailCache) //looks empty, see how far the producer got
+        m_nTailCache = m_nTail.load(std::memory_order_acquire);
+
+      const size_t count = (m_nTailCache - head) & Mask;
+      const size_t k = count < most? count: most;
+      if(k == 0)return 0;
+
+      for(size_t i=0; i<k; i++)
+        out[i] = m_pSlot[(head + i) & Mask];
+
+      m_nHead.store((head + k) & Mask, std::memory_order_release);
+      return k;
+    } //TryPop
+
+    /// Test whether the ring is empty. Exact on the consumer thread, a
+    /// guess anywhere else.
+    /// \return true if the ring is empty.
+
+    bool IsEmpty() const{
+      return m_nHead.load(std::memory_order_acquire) == m_nTail.load(std::memory_order_acquire);
+    } //IsEmpty
+}; //CSpscRing
+
+#endif //__L4RC_GAME_SPSCRING_H__
@@ -0,0 +1,130 @@
+/// \file Telemetry.cpp
+/// \brief Code for the gameplay telemetry stream CTelemetry.
+
+#include <chrono>
+
+#include "Telemetry.h"
+
+const int CTelemetry::FlushMilliseconds; ///< Definition, since `std::chrono::milliseconds` takes it by reference.
+
+/// Close the log, writing the records left.
+
+CTelemetry::~CTelemetry(){
+  Close();
+} //destructor
+
+/// Open a log and start the writer thread. Records are added to the end of
+/// the log. A log that is empty, or that was written in another format, is
+/// started over with a new header.
+/// \param path Log file name.
+/// \return true if the log was opened.
+
+bool CTelemetry::Open(const char* path){
+  Close();
+
+  TelemetryHeader h;
+  FILE* f = fopen(path, "rb");
+
+  const bool valid = f != nullptr && fread(&h, sizeof(h), 1, f) == 1 &&
+    h.m_nMagic == TelemetryHeader::Magic && h.m_nVersion == TelemetryHeader::Version &&
+    h.m_nHeaderSize == sizeof(h) && h.m_nRecordSize == sizeof(TelemetryRecord);
+
+  if(f)fclose(f);
+
+  m_pFile = fopen(path, valid? "ab": "wb");
+  if(m_pFile == nullptr)return false;
+
+  if(!valid){
+    h = TelemetryHeader();
+    h.m_nMagic = TelemetryHeader::Magic;
+    h.m_nVersion = TelemetryHeader::Version;
+    h.m_nHeaderSize = (uint16_t)sizeof(h);
+    h.m_nRecordSize = (uint16_t)sizeof(TelemetryRecord);
+    fwrite(&h, sizeof(h), 1, m_pFile);
+  } //if
+
+  m_bStop = false;
+  m_cWriter = std::thread(&CTelemetry::WriterLoop, this);
+  return true;
+} //Open
+
+/// Stop the writer thread, write the records left in the ring and a count
+/// of any that were dropped, then close the log.
+
+void CTelemetry::Close(){
+  if(m_pFile == nullptr)return;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bStop = true;
+  }
+
+  m_cvStop.notify_all();
+  m_cWriter.join();
+
+  while(Drain() > 0); //the writer thread is gone, so this thread is the consumer now
+
+  if(m_nDropped > 0){
+    TelemetryRecord r;
+    r.m_nFrame = m_nFrame;
+    r.m_nType = (uint8_t)eTelemetry::Dropped;
+    r.m_nLevel = m_nLevel;
+    r.m_pValue[0] = (int16_t)(m_nDropped & 0xFFFF);
+    r.m_pValue[1] = (int16_t)(m_nDropped >> 16);
+    fwrite(&r, sizeof(r), 1, m_pFile);
+    m_nDropped = 0;
+  } //if
+
+  fclose(m_pFile);
+  m_pFile = nullptr;
+} //Close
+
+/// Start a frame, on the game thread. Records made from now on are put on
+/// this frame. If any records were dropped, now that the writer thread has
+/// had a frame to catch up, say how many.
+/// \param frame Frame number.
+
+void CTelemetry::SetFrame(uint32_t frame){
+  m_nFrame = frame;
+
+  if(m_nDropped > 0){
+    const uint32_t n = m_nDropped;
+    m_nDropped = 0;
+    Record(eTelemetry::Dropped, (int)(n & 0xFFFF), (int)(n >> 16));
+
+    if(m_nDropped > 0) //still full, try again next frame
+      m_nDropped = n;
+  } //if
+} //SetFrame
+
+/// Write the records in the ring to the log, a batch at a time.
+/// \return Number of records written.
+
+size_t CTelemetry::Drain(){
+  TelemetryRecord batch[BatchSize];
+  size_t total = 0;
+
+  for(size_t n; (n = m_cRing.TryPop(batch, BatchSize)) > 0; total += n)
+    fwrite(batch, sizeof(TelemetryRecord), n, m_pFile);
+
+  return total;
+} //Drain
+
+/// Writer thread body. Poll the ring rather than be woken for each record,
+/// so that making a record never has to signal anything. Only `Close()`
+/// wakes the writer thread early. Flush the log whenever records were
+/// written, so that a crash loses no more than the records still in the ring.
+
+void CTelemetry::WriterLoop(){
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while(!m_bStop){
+    lock.unlock();
+
+    if(Drain() > 0)
+      fflush(m_pFile);
+
+    lock.lock();
+    m_cvStop.wait_for(lock, std::chrono::milliseconds(FlushMilliseconds), [this](){return m_bStop;});
+  } //while
+} //WriterLoop
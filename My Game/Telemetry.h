@@ -0,0 +1,132 @@
+/// \file Telemetry.h
+/// \brief Interface for the gameplay telemetry stream CTelemetry.
+
+#ifndef __L4RC_GAME_TELEMETRY_H__
+#define __L4RC_GAME_TELEMETRY_H__
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#include "SpscRing.h"
+
+/// \brief Telemetry record types. What the values of a record mean depends
+/// on its type, and values that are not listed are zero. An enemy is given
+/// by its index in the battle when the record was made.
+
+enum class eTelemetry: uint8_t{
+  RunStart, ///< A new run: the seed, 16 bits at a time from the low end, then the player's health.
+  RunResume, ///< A saved run picked up again, in place of the run started just before it: the player's health.
+  NodeChosen, ///< A level chosen on the map: its layer, number of enemies and 1 if it is the special card level.
+  CardPlayed, ///< A card played: its deck index, damage, shield and health, then the enemy or -1 for the player.
+  DamageDealt, ///< The player hit an enemy: the enemy, the damage, its health after and 1 if it died.
+  DamageTaken, ///< An enemy hit the player: the enemy, the damage, the health lost, the shield absorbed and the health after.
+  EnemyHealed, ///< An enemy healed: the enemy, the health gained and its health after.
+  LevelComplete, ///< A battle won: the player's health and 1 if it was the boss.
+  Death, ///< The player died: the enemy that did it.
+  Upgrade, ///< A card upgraded: its deck index or -1 for every card, then its damage, shield and health after.
+  Dropped, ///< Records lost because the ring was full: the number lost, 16 bits at a time from the low end.
+  Size ///< Number of record types.
+}; //eTelemetry
+
+/// \brief A telemetry record, as it is written to the log.
+
+struct TelemetryRecord{
+  uint32_t m_nFrame = 0; ///< Frame it was made on.
+  uint8_t m_nType = 0; ///< An `eTelemetry`.
+  uint8_t m_nLevel = 0; ///< Level being played.
+  int16_t m_pValue[5] = {}; ///< Values.
+}; //TelemetryRecord
+
+static_assert(sizeof(TelemetryRecord) == 16, "telemetry records must be packed");
+
+/// \brief Telemetry log header.
+///
+/// The log starts with this header, followed by nothing but records, one
+/// session after another, in the order they were made. Every field is
+/// little-endian.
+
+struct TelemetryHeader{
+  uint32_t m_nMagic = 0; ///< Must be `Magic`.
+  uint16_t m_nVersion = 0; ///< Format version.
+  uint16_t m_nHeaderSize = 0; ///< Size of this header.
+  uint16_t m_nRecordSize = 0; ///< Size of a record.
+  uint16_t m_nReserved = 0; ///< Zero.
+  uint32_t m_nReserved2 = 0; ///< Zero.
+
+  static const uint32_t Magic = 0x4D4C4554; ///< "TELM".
+  static const uint16_t Version = 1; ///< Current format version.
+}; //TelemetryHeader
+
+/// \brief The gameplay telemetry stream.
+///
+/// The game thread makes records with `Record()`, which only copies the
+/// record into a lock-free ring buffer, so that it costs a few nanoseconds
+/// and never waits for the disk. A writer thread takes records out of the
+/// ring in batches and appends them to the log. If the writer ever falls so
+/// far behind that the ring fills up, records are dropped rather than
+/// holding up the game, and a `eTelemetry::Dropped` record says how many.
+/// Until the log is opened, records are thrown away.
+
+class CTelemetry{
+  private:
+    static const size_t RingSize = 4096; ///< Records the ring holds.
+    static const size_t BatchSize = 256; ///< Most records written at a time.
+    static const int FlushMilliseconds = 50; ///< How often the writer thread looks for records.
+
+    CSpscRing<TelemetryRecord, RingSize> m_cRing; ///< Records on their way to the log.
+    FILE* m_pFile = nullptr; ///< The log.
+    std::thread m_cWriter; ///< Writer thread.
+    std::mutex m_mutex; ///< Guards the stop flag.
+    std::condition_variable m_cvStop; ///< Signals stop.
+    bool m_bStop = false; ///< Tell the writer thread to quit.
+
+    uint32_t m_nFrame = 0; ///< Current frame.
+    uint8_t m_nLevel = 0; ///< Current level.
+    uint32_t m_nDropped = 0; ///< Records dropped and not yet reported.
+
+    void WriterLoop(); ///< Writer thread body.
+    size_t Drain(); ///< Write the records in the ring.
+
+  public:
+    ~CTelemetry(); ///< Destructor.
+
+    bool Open(const char* path); ///< Start appending records to a log.
+    void Close(); ///< Write the records left and close the log.
+    bool IsOpen() const { return m_pFile != nullptr; } ///< Test whether the log is open.
+    uint32_t GetDropped() const { return m_nDropped; } ///< Get the number of records dropped and not yet reported.
+
+    void SetFrame(uint32_t frame); ///< Start a frame.
+    void SetLevel(int level){ m_nLevel = (uint8_t)level; } ///< Set the level to put on records.
+
+    void Record(eTelemetry t, int a=0, int b=0, int c=0, int d=0, int e=0); ///< Make a record.
+}; //CTelemetry
+
+/// Make a record, on the game thread. It is dropped if the ring is full.
+/// \param t Record type.
+/// \param a First value.
+/// \param b Second value.
+/// \param c Third value.
+/// \param d Fourth value.
+/// \param e Fifth value.
+
+inline void CTelemetry::Record(eTelemetry t, int a, int b, int c, int d, int e){
+  if(m_pFile == nullptr)return;
+
+  TelemetryRecord r;
+  r.m_nFrame = m_nFrame;
+  r.m_nType = (uint8_t)t;
+  r.m_nLevel = m_nLevel;
+  r.m_pValue[0] = (int16_t)a;
+  r.m_pValue[1] = (int16_t)b;
+  r.m_pValue[2] = (int16_t)c;
+  r.m_pValue[3] = (int16_t)d;
+  r.m_pValue[4] = (int16_t)e;
+
+  if(!m_cRing.TryPush(r))
+    m_nDropped++;
+} //Record
+
+#endif //__L4RC_GAME_TELEMETRY_H__
@@ -0,0 +1,91 @@
+/// \file Wav.cpp
+/// \brief Code for reading WAV files.
+///
+/// Only uncompressed PCM is read, 8 or 16 bits, mono or stereo, which is
+/// what the game's sounds are.
+
+#include <cstring>
+
+#include "MappedFile.h"
+#include "Wav.h"
+
+/// Read a little endian 16-bit number.
+/// \param p Bytes.
+/// \return The number.
+
+static uint16_t ReadLE16(const uint8_t* p){
+  return (uint16_t)(p[0] | p[1] << 8);
+} //ReadLE16
+
+/// Read a little endian 32-bit number.
+/// \param p Bytes.
+/// \return The number.
+
+static uint32_t ReadLE32(const uint8_t* p){
+  return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+} //ReadLE32
+
+/// Decode a WAV file in memory. Chunks other than the format and the data
+/// are skipped.
+/// \param data File contents.
+/// \param size File size in bytes.
+/// \param s [out] The sound.
+/// \return true if the sound was decoded.
+
+bool DecodeWav(const uint8_t* data, size_t size, WavSound& s){
+  if(size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0)
+    return false;
+
+  int format = 0, channels = 0, bits = 0;
+  uint32_t rate = 0;
+  const uint8_t* samples = nullptr;
+  size_t bytes = 0;
+
+  for(size_t pos=12; pos + 8 <= size;){
+    const uint8_t* p = data + pos + 8;
+    const size_t len = ReadLE32(data + pos + 4);
+    if(len > size - pos - 8)return false;
+
+    if(memcmp(data + pos, "fmt ", 4) == 0 && len >= 16){
+      format = ReadLE16(p);
+      channels = ReadLE16(p + 2);
+      rate = ReadLE32(p + 4);
+      bits = ReadLE16(p + 14);
+    } //if
+
+    else if(memcmp(data + pos, "data", 4) == 0){
+      samples = p;
+      bytes = len;
+    } //else if
+
+    pos += 8 + len + (len & 1); //chunks are padded to an even size
+  } //for
+
+  if(format != 1 || (channels != 1 && channels != 2) || (bits != 8 && bits != 16) ||
+    rate == 0 || samples == nullptr)
+    return false;
+
+  const size_t n = bytes/(bits/8)/channels*channels;
+  s.m_nChannels = channels;
+  s.m_nRate = (int)rate;
+  s.m_vSamples.resize(n);
+
+  if(bits == 16)
+    for(size_t i=0; i<n; i++)
+      s.m_vSamples[i] = (int16_t)ReadLE16(samples + 2*i)/32768.0f;
+
+  else for(size_t i=0; i<n; i++) //8-bit samples are unsigned
+    s.m_vSamples[i] = (samples[i] - 128)/128.0f;
+
+  return true;
+} //DecodeWav
+
+/// Read and decode a WAV file.
+/// \param path File name.
+/// \param s [out] The sound.
+/// \return true if the sound was read.
+
+bool LoadWav(const char* path, WavSound& s){
+  CMappedFile file;
+  return file.Open(path) && DecodeWav(file.GetData(), file.GetSize(), s);
+} //LoadWav
@@ -0,0 +1,27 @@
+/// \file Wav.h
+/// \brief Interface for reading WAV files.
+
+#ifndef __L4RC_GAME_WAV_H__
+#define __L4RC_GAME_WAV_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// \brief A sound in memory.
+///
+/// Samples are floats in [-1, 1], interleaved if there is more than one
+/// channel.
+
+struct WavSound{
+  int m_nChannels = 0; ///< Number of channels, 1 or 2.
+  int m_nRate = 0; ///< Sample rate in Hz.
+  std::vector<float> m_vSamples; ///< Samples.
+
+  size_t GetFrames() const { return m_nChannels? m_vSamples.size()/m_nChannels: 0; } ///< Get number of sample frames.
+}; //WavSound
+
+bool DecodeWav(const uint8_t* data, size_t size, WavSound& s); ///< Decode a WAV file in memory.
+bool LoadWav(const char* path, WavSound& s); ///< Read a WAV file.
+
+#endif //__L4RC_GAME_WAV_H__
@@ -0,0 +1,12 @@
+/// \file BaseObject.cpp
+/// \brief Code for the base object LBaseObject.
+
+#include "BaseObject.h"
+
+/// \param t Sprite type.
+/// \param p Initial position.
+
+LBaseObject::LBaseObject(eSprite t, const Vector2& p){
+  m_nSpriteIndex = (UINT)t;
+  m_vPos = p;
+} //constructor
@@ -0,0 +1,28 @@
+/// \file BaseObject.h
+/// \brief Interface for the base object LBaseObject.
+
+#ifndef __L4RC_PLATFORM_BASEOBJECT_H__
+#define __L4RC_PLATFORM_BASEOBJECT_H__
+
+#include "Component.h"
+#include "SpriteDesc.h"
+
+/// \brief The base object.
+///
+/// A sprite that an object manager moves, draws and deletes when dead.
+
+class LBaseObject:
+  public LComponent,
+  public LSpriteDesc2D
+{
+  template<class t> friend class LBaseObjectManager; ///< Deletes dead objects.
+
+  protected:
+    bool m_bDead = false; ///< Delete at the end of the frame.
+
+  public:
+    LBaseObject(eSprite t, const Vector2& p); ///< Constructor.
+    virtual ~LBaseObject(){} ///< Destructor.
+}; //LBaseObject
+
+#endif //__L4RC_PLATFORM_BASEOBJECT_H__
@@ -0,0 +1,61 @@
+/// \file BaseObjectManager.h
+/// \brief Interface for the base object manager LBaseObjectManager.
+
+#ifndef __L4RC_PLATFORM_BASEOBJECTMANAGER_H__
+#define __L4RC_PLATFORM_BASEOBJECTMANAGER_H__
+
+#include <list>
+
+#include "Component.h"
+
+/// \brief The base object manager.
+///
+/// Owns a list of objects, moves and draws them, and deletes the dead ones
+/// after each move.
+/// \tparam t Object type, derived from `LBaseObject`.
+
+template<class t> class LBaseObjectManager: public LComponent{
+  protected:
+    std::list<t*> m_stdObjectList; ///< Object list.
+
+    /// Delete the dead objects.
+
+    void CullDeadObjects(){
+      for(auto i=m_stdObjectList.begin(); i!=m_stdObjectList.end();)
+        if((*i)->m_bDead){
+          delete *i;
+          i = m_stdObjectList.erase(i);
+        } //if
+        else ++i;
+    } //CullDeadObjects
+
+  public:
+    ~LBaseObjectManager(){clear();} ///< Destructor.
+
+    /// Delete every object.
+
+    void clear(){
+      for(t* p: m_stdObjectList)
+        delete p;
+
+      m_stdObjectList.clear();
+    } //clear
+
+    /// Move every object, then delete the dead ones.
+
+    void move(){
+      for(t* p: m_stdObjectList)
+        p->move();
+
+      CullDeadObjects();
+    } //move
+
+    /// Draw every object in list order.
+
+    void draw(){
+      for(t* p: m_stdObjectList)
+        p->draw();
+    } //draw
+}; //LBaseObjectManager
+
+#endif //__L4RC_PLATFORM_BASEOBJECTMANAGER_H__
@@ -0,0 +1,8 @@
+/// \file Component.cpp
+/// \brief Code for the component base class LComponent.
+
+#include "Component.h"
+
+LTimer* LComponent::m_pTimer = nullptr;
+LKeyboard* LComponent::m_pKeyboard = nullptr;
+LSound* LComponent::m_pAudio = nullptr;
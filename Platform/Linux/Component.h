@@ -0,0 +1,29 @@
+/// \file Component.h
+/// \brief Interface for the component base class LComponent.
+
+#ifndef __L4RC_PLATFORM_COMPONENT_H__
+#define __L4RC_PLATFORM_COMPONENT_H__
+
+#include "Settings.h"
+#include "Window.h"
+
+class LTimer;
+class LKeyboard;
+class LSound;
+
+/// \brief The component base class.
+///
+/// Gives everything that derives from it access to the engine components.
+/// The window creates them before the game is initialized and deletes them
+/// after it is released.
+
+class LComponent: public LSettings{
+  friend class LWindow; ///< Creates and deletes the components.
+
+  protected:
+    static LTimer* m_pTimer; ///< Game timer.
+    static LKeyboard* m_pKeyboard; ///< Keyboard and mouse buttons.
+    static LSound* m_pAudio; ///< Sound player.
+}; //LComponent
+
+#endif //__L4RC_PLATFORM_COMPONENT_H__
@@ -0,0 +1,12 @@
+/// \file ComponentIncludes.h
+/// \brief Every engine component, for code that uses them.
+
+#ifndef __L4RC_PLATFORM_COMPONENTINCLUDES_H__
+#define __L4RC_PLATFORM_COMPONENTINCLUDES_H__
+
+#include "Component.h"
+#include "Keyboard.h"
+#include "Sound.h"
+#include "Timer.h"
+
+#endif //__L4RC_PLATFORM_COMPONENTINCLUDES_H__
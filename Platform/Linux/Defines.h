@@ -0,0 +1,75 @@
+/// \file Defines.h
+/// \brief Basic types and constants for the headless platform.
+///
+/// The game is written against the LARC engine, which is built on Windows
+/// and DirectX. This is the subset of the types and constants from those
+/// that the game uses, so that it builds unchanged on the headless platform.
+
+#ifndef __L4RC_PLATFORM_DEFINES_H__
+#define __L4RC_PLATFORM_DEFINES_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "SimpleMath.h"
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+typedef unsigned int UINT; ///< Unsigned integer.
+typedef uint8_t BYTE; ///< Byte.
+typedef int32_t LONG; ///< Windows long.
+typedef uintptr_t WPARAM; ///< Message parameter, used for key codes.
+typedef void* HWND; ///< Window handle.
+
+/// \brief A point in window coordinates.
+
+struct POINT{
+  LONG x = 0; ///< Distance from the left of the window.
+  LONG y = 0; ///< Distance from the top of the window.
+}; //POINT
+
+enum class eSprite: UINT; ///< Sprite types, defined by the game.
+enum class eSound: UINT; ///< Sound types, defined by the game.
+
+/// \brief Sprite renderer modes.
+
+enum class eSpriteMode{
+  Unbatched2D, Batched2D, Batched3D
+}; //eSpriteMode
+
+//Windows virtual key codes. Letter and digit keys are their upper case
+//ASCII codes.
+
+#define VK_LBUTTON 0x01 ///< Left mouse button.
+#define VK_RBUTTON 0x02 ///< Right mouse button.
+#define VK_BACK    0x08 ///< Backspace.
+#define VK_TAB     0x09 ///< Tab.
+#define VK_RETURN  0x0D ///< Enter.
+#define VK_SHIFT   0x10 ///< Shift.
+#define VK_ESCAPE  0x1B ///< Escape.
+#define VK_SPACE   0x20 ///< Space bar.
+#define VK_LEFT    0x25 ///< Left arrow.
+#define VK_UP      0x26 ///< Up arrow.
+#define VK_RIGHT   0x27 ///< Right arrow.
+#define VK_DOWN    0x28 ///< Down arrow.
+#define VK_F1      0x70 ///< F1.
+#define VK_F2      0x71 ///< F2.
+#define VK_F3      0x72 ///< F3.
+#define VK_F4      0x73 ///< F4.
+#define VK_F5      0x74 ///< F5.
+#define VK_F6      0x75 ///< F6.
+#define VK_F7      0x76 ///< F7.
+#define VK_F8      0x77 ///< F8.
+#define VK_F9      0x78 ///< F9.
+#define VK_F10     0x79 ///< F10.
+#define VK_F11     0x7A ///< F11.
+#define VK_F12     0x7B ///< F12.
+
+#endif //__L4RC_PLATFORM_DEFINES_H__
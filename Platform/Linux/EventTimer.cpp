@@ -0,0 +1,24 @@
+/// \file EventTimer.cpp
+/// \brief Code for the event timer LEventTimer.
+
+#include "EventTimer.h"
+#include "Timer.h"
+
+/// The first trigger is one interval after the timer is made.
+/// \param interval Time between triggers in seconds.
+
+LEventTimer::LEventTimer(float interval): m_fInterval(interval){
+  if(m_pTimer)m_fLastTime = m_pTimer->GetTime();
+} //constructor
+
+/// Test whether an interval has passed since the last trigger, and if so,
+/// start the next one.
+/// \return true if the timer triggered.
+
+bool LEventTimer::Triggered(){
+  const float t = m_pTimer->GetTime();
+  if(t < m_fLastTime + m_fInterval)return false;
+
+  m_fLastTime = t;
+  return true;
+} //Triggered
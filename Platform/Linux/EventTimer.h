@@ -0,0 +1,23 @@
+/// \file EventTimer.h
+/// \brief Interface for the event timer LEventTimer.
+
+#ifndef __L4RC_PLATFORM_EVENTTIMER_H__
+#define __L4RC_PLATFORM_EVENTTIMER_H__
+
+#include "Component.h"
+
+/// \brief An event timer.
+///
+/// Triggers at regular intervals of game time.
+
+class LEventTimer: public LComponent{
+  private:
+    float m_fInterval; ///< Time between triggers in seconds.
+    float m_fLastTime = 0.0f; ///< Time of the last trigger.
+
+  public:
+    LEventTimer(float interval); ///< Constructor.
+    bool Triggered(); ///< Test for a trigger.
+}; //LEventTimer
+
+#endif //__L4RC_PLATFORM_EVENTTIMER_H__
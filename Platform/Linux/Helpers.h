@@ -0,0 +1,19 @@
+/// \file Helpers.h
+/// \brief Helper functions.
+
+#ifndef __L4RC_PLATFORM_HELPERS_H__
+#define __L4RC_PLATFORM_HELPERS_H__
+
+#include "Defines.h"
+
+/// Clamp a value to a range.
+/// \param lo Smallest value.
+/// \param x Value.
+/// \param hi Largest value.
+/// \return The closest value to x in [lo, hi].
+
+template<class t> t clamp(t lo, t x, t hi){
+  return x < lo? lo: (hi < x? hi: x);
+} //clamp
+
+#endif //__L4RC_PLATFORM_HELPERS_H__
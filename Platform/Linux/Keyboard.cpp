@@ -0,0 +1,49 @@
+/// \file Keyboard.cpp
+/// \brief Code for the keyboard LKeyboard.
+
+#include "Keyboard.h"
+
+/// Take the key state for this frame.
+
+void LKeyboard::GetState(){
+  m_bOld = m_bNow;
+  m_bNow = m_bNext;
+} //GetState
+
+/// Test whether a key is down.
+/// \param k Virtual key code.
+/// \return true if the key is down.
+
+bool LKeyboard::Down(WPARAM k) const{
+  return k < 256 && m_bNow[k];
+} //Down
+
+/// Test whether a key went down this frame.
+/// \param k Virtual key code.
+/// \return true if the key went down.
+
+bool LKeyboard::TriggerDown(WPARAM k) const{
+  return k < 256 && m_bNow[k] && !m_bOld[k];
+} //TriggerDown
+
+/// Test whether a key went up this frame.
+/// \param k Virtual key code.
+/// \return true if the key went up.
+
+bool LKeyboard::TriggerUp(WPARAM k) const{
+  return k < 256 && !m_bNow[k] && m_bOld[k];
+} //TriggerUp
+
+/// Press a key.
+/// \param k Virtual key code.
+
+void LKeyboard::Press(WPARAM k){
+  if(k < 256)m_bNext[k] = true;
+} //Press
+
+/// Release a key.
+/// \param k Virtual key code.
+
+void LKeyboard::Release(WPARAM k){
+  if(k < 256)m_bNext[k] = false;
+} //Release
@@ -0,0 +1,34 @@
+/// \file Keyboard.h
+/// \brief Interface for the keyboard LKeyboard.
+
+#ifndef __L4RC_PLATFORM_KEYBOARD_H__
+#define __L4RC_PLATFORM_KEYBOARD_H__
+
+#include <bitset>
+
+#include "Defines.h"
+
+/// \brief The keyboard and mouse buttons.
+///
+/// Keys are Windows virtual key codes. On the headless platform keys are
+/// pressed and released by the input script, and the game sees the changes
+/// at its next call to `GetState()`.
+
+class LKeyboard{
+  private:
+    std::bitset<256> m_bNext; ///< Key state for the next frame.
+    std::bitset<256> m_bNow; ///< Key state this frame.
+    std::bitset<256> m_bOld; ///< Key state last frame.
+
+  public:
+    void GetState(); ///< Start a frame.
+
+    bool Down(WPARAM k) const; ///< Test for a key that is down.
+    bool TriggerDown(WPARAM k) const; ///< Test for a key that went down this frame.
+    bool TriggerUp(WPARAM k) const; ///< Test for a key that went up this frame.
+
+    void Press(WPARAM k); ///< Press a key.
+    void Release(WPARAM k); ///< Release a key.
+}; //LKeyboard
+
+#endif //__L4RC_PLATFORM_KEYBOARD_H__
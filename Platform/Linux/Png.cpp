@@ -0,0 +1,981 @@
+/// \file Png.cpp
+/// \brief Code for reading and writing PNG images.
+///
+/// The reader handles every non-interlaced PNG color type and bit depth,
+/// which covers the game's images. It has its own inflate, so the headless
+/// platform needs no libraries. Chunk checksums are not checked. The writer
+/// stores image data uncompressed, which is quick and good enough for
+/// screenshots.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+#endif
+
+#include "Png.h"
+
+static const size_t PipelineBytes = 1 << 20; ///< Smallest image, inflated, to inflate on a thread of its own.
+
+//////////////////////////////////////////////////////////////////////////////
+// Inflate
+
+/// \brief Reads a deflate stream a few bits at a time, least significant
+/// bit first.
+
+struct BitReader{
+  const uint8_t* m_pNext; ///< Next byte to load.
+  const uint8_t* m_pEnd; ///< End of the stream.
+  uint64_t m_nBits = 0; ///< Loaded bits.
+  int m_nCount = 0; ///< Number of loaded bits.
+  int m_nPadding = 0; ///< Number of zero bytes loaded past the end.
+
+  /// \param p Start of the stream.
+  /// \param end End of the stream.
+
+  BitReader(const uint8_t* p, const uint8_t* end): m_pNext(p), m_pEnd(end){}
+
+  /// Load whole bytes until there are more than 56 bits. Away from the end
+  /// of the stream they are loaded eight at a time on little endian hosts.
+  /// Past the end zero bytes are loaded, since a peek may look past the end.
+
+  void Refill(){
+  #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if(m_pEnd - m_pNext >= 8){
+      uint64_t x;
+      memcpy(&x, m_pNext, 8);
+      m_nBits |= x << m_nCount;
+      m_pNext += (63 - m_nCount) >> 3;
+      m_nCount |= 56;
+      return;
+    } //if
+  #endif
+
+    while(m_nCount <= 56){
+      if(m_pNext < m_pEnd)
+        m_nBits |= (uint64_t)*m_pNext++ << m_nCount;
+      else m_nPadding++;
+
+      m_nCount += 8;
+    } //while
+  } //Refill
+
+  /// Test whether bits past the end of the stream have been used.
+  /// \return true if the stream was overrun.
+
+  bool Overrun() const{
+    return m_nPadding*8 > m_nCount;
+  } //Overrun
+
+  /// Look at bits without using them.
+  /// \param n Number of bits, at most 56.
+  /// \return The bits.
+
+  uint32_t Peek(int n){
+    if(m_nCount < n)Refill();
+    return (uint32_t)(m_nBits & ((1ULL << n) - 1));
+  } //Peek
+
+  /// Use bits.
+  /// \param n Number of bits.
+
+  void Skip(int n){
+    m_nBits >>= n;
+    m_nCount -= n;
+  } //Skip
+
+  /// Read bits.
+  /// \param n Number of bits, at most 56.
+  /// \return The bits.
+
+  uint32_t Get(int n){
+    const uint32_t x = Peek(n);
+    Skip(n);
+    return x;
+  } //Get
+
+  /// Throw away bits up to the next byte boundary, and give back any whole
+  /// bytes that were loaded but not used.
+
+  void AlignToByte(){
+    Skip(m_nCount & 7);
+
+    while(m_nCount >= 8){ //padding was loaded last
+      if(m_nPadding > 0)m_nPadding--;
+      else m_pNext--;
+      m_nCount -= 8;
+    } //while
+
+    m_nBits = 0;
+    m_nCount = 0;
+  } //AlignToByte
+}; //BitReader
+
+/// \brief A canonical Huffman code for decoding.
+///
+/// Codes of up to `FastBits` bits are decoded with one table lookup, and
+/// longer ones a bit at a time.
+
+struct Huffman{
+  static const int FastBits = 10; ///< Bits decoded by table lookup.
+  static const int MaxBits = 15; ///< Longest code.
+
+  uint16_t m_pFast[1 << FastBits]; ///< Length times 512 plus symbol, 0 for a long code.
+  uint16_t m_pCount[MaxBits + 1]; ///< Number of codes of each length.
+  uint16_t m_pSymbol[288]; ///< Symbols in code order.
+
+  bool Build(const uint8_t* length, int n); ///< Make the code from code lengths.
+  int Decode(BitReader& r) const; ///< Read a symbol.
+}; //Huffman
+
+/// Make a canonical Huffman code from the code length of each symbol.
+/// \param length Code lengths, 0 for unused symbols.
+/// \param n Number of symbols.
+/// \return false if the lengths do not make a code.
+
+bool Huffman::Build(const uint8_t* length, int n){
+  memset(m_pCount, 0, sizeof(m_pCount));
+  memset(m_pFast, 0, sizeof(m_pFast));
+
+  for(int i=0; i<n; i++)
+    m_pCount[length[i]]++;
+
+  m_pCount[0] = 0;
+
+  uint16_t offset[MaxBits + 2] = {};
+  int left = 1;
+
+  for(int len=1; len<=MaxBits; len++){
+    left = (left << 1) - m_pCount[len];
+    if(left < 0)return false; //too many codes
+    offset[len + 1] = offset[len] + m_pCount[len];
+  } //for
+
+  for(int i=0; i<n; i++)
+    if(length[i])
+      m_pSymbol[offset[length[i]]++] = (uint16_t)i;
+
+  int code = 0, index = 0;
+
+  for(int len=1; len<=FastBits; len++){
+    for(int i=0; i<m_pCount[len]; i++, code++, index++){
+      int reversed = 0;
+
+      for(int b=0; b<len; b++)
+        reversed |= ((code >> b) & 1) << (len - 1 - b);
+
+      for(int j=reversed; j<(1 << FastBits); j+=1 << len)
+        m_pFast[j] = (uint16_t)(len << 9 | m_pSymbol[index]);
+    } //for
+
+    code <<= 1;
+  } //for
+
+  return true;
+} //Build
+
+/// Read a symbol.
+/// \param r Bit reader.
+/// \return The symbol, or -1 for a code that is not in the table.
+
+int Huffman::Decode(BitReader& r) const{
+  const uint16_t e = m_pFast[r.Peek(FastBits)];
+
+  if(e){
+    r.Skip(e >> 9);
+    return e & 511;
+  } //if
+
+  int code = 0, first = 0, index = 0;
+
+  for(int len=1; len<=MaxBits; len++){
+    code |= r.Get(1);
+    const int count = m_pCount[len];
+    if(code - count < first)return m_pSymbol[index + code - first];
+
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  } //for
+
+  return -1;
+} //Decode
+
+static const uint16_t g_pLengthBase[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258}; ///< Length code bases.
+
+static const uint8_t g_pLengthExtra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0}; ///< Length code extra bits.
+
+static const uint16_t g_pDistBase[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193,
+  12289, 16385, 24577}; ///< Distance code bases.
+
+static const uint8_t g_pDistExtra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13}; ///< Distance code extra bits.
+
+/// Read the code lengths of a dynamic block and make its codes.
+/// \param r Bit reader.
+/// \param lit [out] Literal and length code.
+/// \param dist [out] Distance code.
+/// \return true if the codes are good.
+
+static bool ReadDynamicCodes(BitReader& r, Huffman& lit, Huffman& dist){
+  static const uint8_t order[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+  const int nlit = r.Get(5) + 257;
+  const int ndist = r.Get(5) + 1;
+  const int nlen = r.Get(4) + 4;
+
+  uint8_t length[320] = {};
+
+  for(int i=0; i<nlen; i++)
+    length[order[i]] = (uint8_t)r.Get(3);
+
+  Huffman lengthCode;
+  if(!lengthCode.Build(length, 19))return false;
+
+  memset(length, 0, sizeof(length));
+
+  for(int i=0; i<nlit + ndist;){
+    const int sym = lengthCode.Decode(r);
+    if(sym < 0)return false;
+
+    if(sym < 16){
+      length[i++] = (uint8_t)sym;
+      continue;
+    } //if
+
+    int repeat = 0;
+    uint8_t value = 0;
+
+    if(sym == 16){
+      if(i == 0)return false;
+      value = length[i - 1];
+      repeat = 3 + r.Get(2);
+    } //if
+
+    else if(sym == 17)repeat = 3 + r.Get(3);
+    else repeat = 11 + r.Get(7);
+
+    if(i + repeat > nlit + ndist)return false;
+
+    while(repeat--)
+      length[i++] = value;
+  } //for
+
+  return lit.Build(length, nlit) && dist.Build(length + nlit, ndist);
+} //ReadDynamicCodes
+
+/// \brief How much of an image inflate has written so far, for a reader on
+/// another thread.
+
+struct InflateProgress{
+  std::mutex m_mutex; ///< Guards the rest.
+  std::condition_variable m_cv; ///< Signals more output, or the end.
+  size_t m_nBytes = 0; ///< Bytes written.
+  bool m_bDone = false; ///< Whether inflate has finished.
+
+  /// Tell the reader how many bytes are ready.
+  /// \param n Bytes written.
+  /// \param done Whether that is all there will be.
+
+  void Publish(size_t n, bool done){
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_nBytes = n;
+      m_bDone = done;
+    }
+
+    m_cv.notify_one();
+  } //Publish
+
+  /// Wait until some bytes are ready, or inflate has finished.
+  /// \param n Bytes wanted.
+  /// \return Bytes ready, less than n only if inflate finished short.
+
+  size_t Wait(size_t n){
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [&](){return m_nBytes >= n || m_bDone;});
+    return m_nBytes;
+  } //Wait
+}; //InflateProgress
+
+/// Decompress a zlib stream into a buffer of known size, which is all a
+/// PNG needs. Data past the end of the buffer is ignored.
+/// \param data Stream.
+/// \param size Stream size in bytes.
+/// \param out [out] Buffer for the decompressed data.
+/// \param capacity Buffer size in bytes.
+/// \param length [out] Number of bytes decompressed.
+/// \param progress Where to report each 64 KB written, or nullptr.
+/// \return true if the stream is good.
+
+static bool Inflate(const uint8_t* data, size_t size, uint8_t* out,
+  size_t capacity, size_t& length, InflateProgress* progress)
+{
+  length = 0;
+
+  if(size < 2 || (data[0] & 0x0F) != 8 || (data[0] << 8 | data[1]) % 31 != 0)
+    return false;
+
+  BitReader r(data + 2, data + size);
+  Huffman lit, dist;
+  uint8_t* o = out;
+  uint8_t* const end = out + capacity;
+  uint8_t* report = out + std::min<size_t>(capacity, 1 << 16);
+  bool last = false;
+
+  while(!last && o < end){
+    last = r.Get(1) == 1;
+    const uint32_t type = r.Get(2);
+
+    if(type == 0){ //stored
+      r.AlignToByte();
+      if(r.m_pEnd - r.m_pNext < 4)return false;
+
+      const uint32_t len = r.m_pNext[0] | r.m_pNext[1] << 8;
+      const uint32_t nlen = r.m_pNext[2] | r.m_pNext[3] << 8;
+      r.m_pNext += 4;
+
+      if((len ^ 0xFFFF) != nlen || (size_t)(r.m_pEnd - r.m_pNext) < len)return false;
+
+      const size_t n = std::min<size_t>(len, end - o);
+      memcpy(o, r.m_pNext, n);
+      o += n;
+      r.m_pNext += len;
+
+      if(progress)progress->Publish(o - out, false);
+    } //if
+
+    else{
+      if(type == 1){ //fixed codes
+        uint8_t length[320];
+        memset(length, 8, 144);
+        memset(length + 144, 9, 112);
+        memset(length + 256, 7, 24);
+        memset(length + 280, 8, 8);
+        memset(length + 288, 5, 30);
+
+        lit.Build(length, 288);
+        dist.Build(length + 288, 30);
+      } //if
+
+      else if(type == 2){
+        if(!ReadDynamicCodes(r, lit, dist))return false;
+      } //else if
+
+      else return false;
+
+      while(o < end){
+        const int sym = lit.Decode(r);
+        if(sym < 0 || r.Overrun())return false;
+
+        if(sym < 256)
+          *o++ = (uint8_t)sym;
+
+        else{
+          if(sym == 256)break;
+          if(sym > 285)return false;
+
+          size_t len = g_pLengthBase[sym - 257] + r.Get(g_pLengthExtra[sym - 257]);
+          const int d = dist.Decode(r);
+          if(d < 0 || d > 29)return false;
+
+          const size_t back = g_pDistBase[d] + r.Get(g_pDistExtra[d]);
+          if(back > (size_t)(o - out))return false;
+
+          len = std::min<size_t>(len, end - o);
+          const uint8_t* from = o - back;
+
+          if(back >= 8 && (size_t)(end - o) >= len + 8) //eight at a time, may run over by 7
+            for(size_t i=0; i<len; i+=8)
+              memcpy(o + i, from + i, 8);
+
+          else if(back == 1)memset(o, *from, len);
+
+          else for(size_t i=0; i<len; i++) //may overlap, so a byte at a time
+            o[i] = from[i];
+
+          o += len;
+        } //else
+
+        if(progress && o >= report){
+          progress->Publish(o - out, false);
+          report = o + std::min<size_t>(end - o, 1 << 16);
+        } //if
+      } //while
+    } //else
+  } //while
+
+  length = o - out;
+  return !r.Overrun();
+} //Inflate
+
+//////////////////////////////////////////////////////////////////////////////
+// PNG
+
+/// Read a big endian 32-bit number.
+/// \param p Bytes.
+/// \return The number.
+
+static uint32_t ReadBE32(const uint8_t* p){
+  return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+} //ReadBE32
+
+/// The Paeth predictor.
+/// \param a Left.
+/// \param b Above.
+/// \param c Above left.
+/// \return Whichever of a, b and c is closest to a + b - c.
+
+static uint8_t Paeth(int a, int b, int c){
+  const int p = a + b - c;
+  const int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+  if(pa <= pb && pa <= pc)return (uint8_t)a;
+  return (uint8_t)(pb <= pc? b: c);
+} //Paeth
+
+/// Undo the row filters, in place.
+/// \param data Rows, each a filter type byte followed by the row.
+/// \param stride Row size in bytes, not counting the filter type.
+/// \param rows Number of rows.
+/// \param bpp Bytes per pixel, rounded up.
+/// \return false if a filter type is not known.
+
+static bool Unfilter(uint8_t* data, size_t stride, int rows, int bpp){
+  std::vector<uint8_t> zero(stride, 0);
+  const uint8_t* prior = zero.data();
+
+  for(int y=0; y<rows; y++){
+    const uint8_t filter = data[y*(stride + 1)];
+    uint8_t* row = data + y*(stride + 1) + 1;
+
+    switch(filter){
+      case 0: break;
+
+      case 1:
+        for(size_t i=bpp; i<stride; i++)
+          row[i] += row[i - bpp];
+      break;
+
+      case 2:
+        for(size_t i=0; i<stride; i++)
+          row[i] += prior[i];
+      break;
+
+      case 3:
+        for(size_t i=0; i<stride; i++)
+          row[i] += (uint8_t)(((i >= (size_t)bpp? row[i - bpp]: 0) + prior[i]) >> 1);
+      break;
+
+      case 4:
+        for(size_t i=0; i<stride; i++)
+          row[i] += i >= (size_t)bpp?
+            Paeth(row[i - bpp], prior[i], prior[i - bpp]): Paeth(0, prior[i], 0);
+      break;
+
+      default: return false;
+    } //switch
+
+    prior = row;
+  } //for
+
+  return true;
+} //Unfilter
+
+/// Add four bytes to four bytes, each on its own, with no carry from one
+/// to the next.
+/// \param a Four bytes.
+/// \param b Four bytes.
+/// \return The four sums, modulo 256.
+
+static inline uint32_t AddBytes(uint32_t a, uint32_t b){
+  return ((a & 0x7F7F7F7F) + (b & 0x7F7F7F7F)) ^ ((a ^ b) & 0x80808080);
+} //AddBytes
+
+/// Average four bytes with four bytes, each on its own, rounding down.
+/// \param a Four bytes.
+/// \param b Four bytes.
+/// \return The four averages.
+
+static inline uint32_t AverageBytes(uint32_t a, uint32_t b){
+  return (a & b) + (((a ^ b) >> 1) & 0x7F7F7F7F);
+} //AverageBytes
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+/// The Paeth predictor of four channels at once, each widened to 16 bits.
+/// \param a Left.
+/// \param b Above.
+/// \param c Above left.
+/// \return The four predictions, widened.
+
+static inline __m128i PaethWide(__m128i a, __m128i b, __m128i c){
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i da = _mm_sub_epi16(b, c); //p - a
+  const __m128i db = _mm_sub_epi16(a, c); //p - b
+  const __m128i dc = _mm_add_epi16(da, db); //p - c
+
+  const __m128i pa = _mm_max_epi16(da, _mm_sub_epi16(zero, da));
+  const __m128i pb = _mm_max_epi16(db, _mm_sub_epi16(zero, db));
+  const __m128i pc = _mm_max_epi16(dc, _mm_sub_epi16(zero, dc));
+
+  const __m128i notA = _mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc));
+  const __m128i useC = _mm_cmpgt_epi16(pb, pc);
+  const __m128i bc = _mm_or_si128(_mm_and_si128(useC, c), _mm_andnot_si128(useC, b));
+  return _mm_or_si128(_mm_and_si128(notA, bc), _mm_andnot_si128(notA, a));
+} //PaethWide
+
+/// Widen four bytes to 16 bits each.
+/// \param x Four bytes.
+/// \return The bytes, widened.
+
+static inline __m128i Widen(uint32_t x){
+  return _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)x), _mm_setzero_si128());
+} //Widen
+
+#endif
+
+/// Read a pixel of an 8-bit RGB or RGBA row.
+/// \tparam bpp Bytes per pixel, 3 or 4.
+/// \param p Pixel.
+/// \return The pixel, red in the low byte, with alpha 0 if there is none.
+
+template<int bpp> static inline uint32_t ReadPixel(const uint8_t* p){
+  return p[0] | p[1] << 8 | p[2] << 16 | (bpp == 4? (uint32_t)p[3] << 24: 0);
+} //ReadPixel
+
+/// Undo the filter of a row of an 8-bit RGB or RGBA image, writing pixels
+/// straight into the image. Each pixel is worked on as one 32-bit word, so
+/// every filter does all four channels at once, with no carries between
+/// them, and Paeth does them in 16-bit lanes of an SSE2 register. RGB
+/// pixels are made opaque as they are written; their alpha bytes go through
+/// the filter arithmetic but never reach the other channels.
+/// \tparam bpp Bytes per pixel, 3 or 4.
+/// \param filter Filter type.
+/// \param src Filtered row, after the filter type byte.
+/// \param prior Pixels of the row above, all 0 for the top row.
+/// \param dest [out] Pixels of this row.
+/// \param w Width in pixels.
+/// \return false if the filter type is not known.
+
+template<int bpp> static bool UnfilterPixels(uint8_t filter, const uint8_t* src,
+  const uint32_t* prior, uint32_t* dest, int w)
+{
+  const uint32_t opaque = bpp == 3? 0xFF000000: 0;
+  uint32_t left = 0;
+
+  switch(filter){
+    case 0:
+      for(int x=0; x<w; x++)
+        dest[x] = ReadPixel<bpp>(src + bpp*x) | opaque;
+    break;
+
+    case 1:
+      for(int x=0; x<w; x++)
+        left = dest[x] = AddBytes(ReadPixel<bpp>(src + bpp*x), left) | opaque;
+    break;
+
+    case 2:
+    {
+      int x = 0;
+
+    #if defined(__SSE2__) || defined(_M_X64)
+      if(bpp == 4)
+        for(; x + 4<=w; x+=4){
+          const __m128i s = _mm_loadu_si128((const __m128i*)(src + 4*x));
+          const __m128i b = _mm_loadu_si128((const __m128i*)(prior + x));
+          _mm_storeu_si128((__m128i*)(dest + x), _mm_add_epi8(s, b));
+        } //for
+    #endif
+
+      for(; x<w; x++)
+        dest[x] = AddBytes(ReadPixel<bpp>(src + bpp*x), prior[x]) | opaque;
+    } //case
+    break;
+
+    case 3:
+      for(int x=0; x<w; x++)
+        left = dest[x] = AddBytes(ReadPixel<bpp>(src + bpp*x),
+          AverageBytes(left, prior[x])) | opaque;
+    break;
+
+    case 4:
+    {
+    #if defined(__SSE2__) || defined(_M_X64) //left pixel stays widened from one pixel to the next
+      const __m128i low = _mm_set1_epi16(0xFF);
+      __m128i a = _mm_setzero_si128(), c = a;
+
+      for(int x=0; x<w; x++){
+        const __m128i b = Widen(prior[x]);
+        a = _mm_and_si128(_mm_add_epi16(Widen(ReadPixel<bpp>(src + bpp*x)), PaethWide(a, b, c)), low);
+        dest[x] = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(a, a)) | opaque;
+        c = b;
+      } //for
+    #else
+      uint32_t aboveLeft = 0;
+
+      for(int x=0; x<w; x++){
+        const uint32_t above = prior[x];
+        uint32_t p = 0;
+
+        for(int shift=0; shift<32; shift+=8)
+          p |= (uint32_t)Paeth(left >> shift & 0xFF, above >> shift & 0xFF, aboveLeft >> shift & 0xFF) << shift;
+
+        left = dest[x] = AddBytes(ReadPixel<bpp>(src + bpp*x), p) | opaque;
+        aboveLeft = above;
+      } //for
+    #endif
+    } //case
+    break;
+
+    default: return false;
+  } //switch
+
+  return true;
+} //UnfilterPixels
+
+/// Turn an image's pixel rows, as they come out of inflate, into pixels:
+/// undo the row filters then convert every pixel to 8-bit RGBA. Any bit
+/// depth and color type will do.
+/// \param raw Rows, each a filter type byte followed by the row.
+/// \param stride Row size in bytes, not counting the filter type.
+/// \param type Color type.
+/// \param depth Bit depth.
+/// \param palette Palette.
+/// \param paletteSize Number of palette entries.
+/// \param key Transparent gray or RGB, or nullptr for none.
+/// \param img [in, out] Image, already sized.
+/// \return false if a filter type is not known.
+
+static bool ConvertRows(uint8_t* raw, size_t stride, int type, int depth,
+  const uint32_t* palette, int paletteSize, const uint16_t* key, LImage& img)
+{
+  static const int channels[7] = {1, 0, 3, 1, 2, 0, 4};
+  const int w = img.m_nWidth, h = img.m_nHeight;
+
+  if(!Unfilter(raw, stride, h, std::max(1, channels[type]*depth/8)))
+    return false;
+
+  const int maxValue = (1 << depth) - 1;
+
+  for(int y=0; y<h; y++){
+    const uint8_t* row = raw + y*(stride + 1) + 1;
+    uint32_t* dest = img.m_vPixels.data() + (size_t)y*w;
+
+    for(int x=0; x<w; x++){
+      uint16_t c[4] = {};
+
+      for(int i=0; i<channels[type]; i++){ //channel i of pixel x, at full depth
+        const size_t bit = ((size_t)x*channels[type] + i)*depth;
+
+        if(depth == 16)c[i] = (uint16_t)(row[bit/8] << 8 | row[bit/8 + 1]);
+        else if(depth == 8)c[i] = row[bit/8];
+        else c[i] = (row[bit/8] >> (8 - depth - bit%8)) & maxValue;
+      } //for
+
+      if(type == 3){
+        dest[x] = c[0] < paletteSize? palette[c[0]]: 0xFF000000;
+        continue;
+      } //if
+
+      auto byte = [&](uint16_t v){return (uint32_t)(depth == 16? v >> 8: v*255/maxValue);};
+      uint32_t r, g, b, a = 255;
+
+      if(type == 0 || type == 4){
+        r = g = b = byte(c[0]);
+        if(type == 4)a = byte(c[1]);
+        else if(key && c[0] == key[0])a = 0;
+      } //if
+
+      else{
+        r = byte(c[0]); g = byte(c[1]); b = byte(c[2]);
+        if(type == 6)a = byte(c[3]);
+        else if(key && c[0] == key[0] && c[1] == key[1] && c[2] == key[2])a = 0;
+      } //else
+
+      dest[x] = r | g << 8 | b << 16 | a << 24;
+    } //for
+  } //for
+
+  return true;
+} //ConvertRows
+
+/// Decode a PNG file in memory. Interlaced images are not supported.
+///
+/// 8-bit RGB and RGBA images, which are most of the game's, take a fast
+/// path that undoes the row filters straight into the image's pixels, a
+/// row at a time. For big ones, inflate runs on a thread of its own and
+/// rows are unfiltered as soon as it has written them. Inflate and the
+/// filters both depend on what came before, so that is as far as one image
+/// can be split; decoding several images at once is up to the caller.
+/// Other images are inflated whole, then unfiltered and converted.
+/// \param data File contents.
+/// \param size File size in bytes.
+/// \param img [out] The image.
+/// \return true if the image was decoded.
+
+bool DecodePng(const uint8_t* data, size_t size, LImage& img){
+  static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  if(size < 8 || memcmp(data, signature, 8) != 0)return false;
+
+  int w = 0, h = 0, depth = 0, type = -1, interlace = 0;
+  uint32_t palette[256];
+  int paletteSize = 0;
+  bool transparentKey = false;
+  uint16_t key[3] = {}; //transparent gray or RGB
+  std::vector<uint8_t> compressed;
+
+  for(size_t pos=8; pos + 12 <= size;){
+    const uint32_t len = ReadBE32(data + pos);
+    const uint8_t* type4 = data + pos + 4;
+    const uint8_t* p = data + pos + 8;
+    if(len > size - pos - 12)return false;
+
+    if(memcmp(type4, "IHDR", 4) == 0 && len >= 13){
+      w = (int)ReadBE32(p);
+      h = (int)ReadBE32(p + 4);
+      depth = p[8];
+      type = p[9];
+      interlace = p[12];
+    } //if
+
+    else if(memcmp(type4, "PLTE", 4) == 0){
+      paletteSize = (int)std::min<uint32_t>(len/3, 256);
+
+      for(int i=0; i<paletteSize; i++)
+        palette[i] = p[3*i] | p[3*i + 1] << 8 | p[3*i + 2] << 16 | 0xFFu << 24;
+    } //else if
+
+    else if(memcmp(type4, "tRNS", 4) == 0){
+      if(type == 3)
+        for(uint32_t i=0; i<len && i<(uint32_t)paletteSize; i++)
+          palette[i] = (palette[i] & 0x00FFFFFF) | (uint32_t)p[i] << 24;
+
+      else if(len >= 2){
+        transparentKey = true;
+        for(uint32_t i=0; i<3 && 2*i + 1<len; i++)
+          key[i] = (uint16_t)(p[2*i] << 8 | p[2*i + 1]);
+      } //else if
+    } //else if
+
+    else if(memcmp(type4, "IDAT", 4) == 0)
+      compressed.insert(compressed.end(), p, p + len);
+
+    else if(memcmp(type4, "IEND", 4) == 0)
+      break;
+
+    pos += 12 + len;
+  } //for
+
+  static const int channels[7] = {1, 0, 3, 1, 2, 0, 4};
+
+  if(w <= 0 || h <= 0 || w > 16384 || h > 16384 || interlace != 0 ||
+    type < 0 || type > 6 || channels[type] == 0 ||
+    (depth != 1 && depth != 2 && depth != 4 && depth != 8 && depth != 16))
+    return false;
+
+  const size_t stride = ((size_t)w*channels[type]*depth + 7)/8;
+  const size_t rawSize = (stride + 1)*h;
+  std::unique_ptr<uint8_t[]> raw(new uint8_t[rawSize]);
+
+  img.m_nWidth = w;
+  img.m_nHeight = h;
+  img.m_vPixels.resize((size_t)w*h);
+
+  const bool fast = depth == 8 && (type == 2 || type == 6);
+  const bool pipelined = fast && rawSize >= PipelineBytes &&
+    std::thread::hardware_concurrency() > 1;
+
+  InflateProgress progress;
+  std::thread inflater;
+  size_t length = 0;
+  bool inflated = false;
+
+  if(pipelined)
+    inflater = std::thread([&](){
+      inflated = Inflate(compressed.data(), compressed.size(), raw.get(), rawSize, length, &progress);
+      progress.Publish(inflated? length: 0, true);
+    });
+
+  else inflated = Inflate(compressed.data(), compressed.size(), raw.get(), rawSize, length, nullptr);
+
+  bool ok = false;
+
+  if(!fast)
+    ok = inflated && length == rawSize && ConvertRows(raw.get(), stride, type, depth,
+      palette, paletteSize, transparentKey? key: nullptr, img);
+
+  else{
+    const std::vector<uint32_t> zero(w, 0);
+    const uint32_t* prior = zero.data();
+    const uint32_t keyPixel = key[0] > 255 || key[1] > 255 || key[2] > 255? 0xFFFFFFFF:
+      key[0] | key[1] << 8 | key[2] << 16;
+    size_t ready = pipelined? 0: inflated? length: 0;
+
+    ok = true;
+
+    for(int y=0; y<h && ok; y++){
+      const size_t end = (y + 1)*(stride + 1);
+      if(ready < end && pipelined)ready = progress.Wait(end);
+
+      const uint8_t* row = raw.get() + y*(stride + 1);
+      uint32_t* dest = img.m_vPixels.data() + (size_t)y*w;
+
+      ok = ready >= end && (type == 6?
+        UnfilterPixels<4>(row[0], row + 1, prior, dest, w):
+        UnfilterPixels<3>(row[0], row + 1, prior, dest, w));
+
+      if(ok && type == 2 && transparentKey)
+        for(int x=0; x<w; x++)
+          if((dest[x] & 0x00FFFFFF) == keyPixel)
+            dest[x] = keyPixel;
+
+      prior = dest;
+    } //for
+
+    if(pipelined)inflater.join();
+    ok = ok && inflated;
+  } //else
+
+  if(!ok)img = LImage();
+  return ok;
+} //DecodePng
+
+/// Read and decode a PNG file.
+/// \param path File name.
+/// \param img [out] The image.
+/// \return true if the image was read.
+
+bool LoadPng(const char* path, LImage& img){
+  std::ifstream input(path, std::ios::binary | std::ios::ate);
+  if(!input)return false;
+
+  std::vector<uint8_t> data((size_t)input.tellg());
+  input.seekg(0);
+
+  return input.read((char*)data.data(), data.size()) &&
+    DecodePng(data.data(), data.size(), img);
+} //LoadPng
+
+/// Compute a CRC-32 as used in PNG chunks.
+/// \param crc CRC so far, 0 to start.
+/// \param p Bytes.
+/// \param n Number of bytes.
+/// \return The CRC.
+
+static uint32_t Crc32(uint32_t crc, const uint8_t* p, size_t n){
+  static uint32_t table[256];
+
+  if(table[1] == 0)
+    for(uint32_t i=0; i<256; i++){
+      uint32_t c = i;
+
+      for(int k=0; k<8; k++)
+        c = c & 1? 0xEDB88320 ^ (c >> 1): c >> 1;
+
+      table[i] = c;
+    } //for
+
+  crc = ~crc;
+
+  for(size_t i=0; i<n; i++)
+    crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+
+  return ~crc;
+} //Crc32
+
+/// Append a big endian 32-bit number.
+/// \param v [in, out] Bytes.
+/// \param x The number.
+
+static void PutBE32(std::vector<uint8_t>& v, uint32_t x){
+  v.push_back((uint8_t)(x >> 24));
+  v.push_back((uint8_t)(x >> 16));
+  v.push_back((uint8_t)(x >> 8));
+  v.push_back((uint8_t)x);
+} //PutBE32
+
+/// Append a chunk.
+/// \param v [in, out] File contents.
+/// \param type Chunk type.
+/// \param data Chunk data.
+
+static void PutChunk(std::vector<uint8_t>& v, const char* type, const std::vector<uint8_t>& data){
+  PutBE32(v, (uint32_t)data.size());
+  const size_t start = v.size();
+
+  v.insert(v.end(), type, type + 4);
+  v.insert(v.end(), data.begin(), data.end());
+  PutBE32(v, Crc32(0, v.data() + start, v.size() - start));
+} //PutChunk
+
+/// Write an image to a PNG file, RGBA with 8 bits per channel.
+/// \param path File name.
+/// \param pixels Pixels, red in the low byte, top row first.
+/// \param w Width in pixels.
+/// \param h Height in pixels.
+/// \return true if the file was written.
+
+bool SavePng(const char* path, const uint32_t* pixels, int w, int h){
+  std::vector<uint8_t> raw; //filter type 0 then RGBA, per row
+  raw.reserve((size_t)(4*w + 1)*h);
+
+  for(int y=0; y<h; y++){
+    raw.push_back(0);
+
+    for(int x=0; x<w; x++){
+      const uint32_t c = pixels[(size_t)y*w + x];
+      for(int i=0; i<4; i++)raw.push_back((uint8_t)(c >> 8*i));
+    } //for
+  } //for
+
+  std::vector<uint8_t> z = {0x78, 0x01}; //zlib stream of stored blocks
+  uint32_t s1 = 1, s2 = 0; //Adler-32
+
+  for(size_t pos=0; pos<raw.size() || pos == 0;){
+    const size_t n = std::min<size_t>(65535, raw.size() - pos);
+    const bool last = pos + n == raw.size();
+
+    z.push_back(last? 1: 0);
+    z.push_back((uint8_t)n); z.push_back((uint8_t)(n >> 8));
+    z.push_back((uint8_t)~n); z.push_back((uint8_t)(~n >> 8));
+    z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+
+    for(size_t i=pos; i<pos + n; i++){
+      s1 = (s1 + raw[i]) % 65521;
+      s2 = (s2 + s1) % 65521;
+    } //for
+
+    pos += n;
+    if(last)break;
+  } //for
+
+  PutBE32(z, s2 << 16 | s1);
+
+  std::vector<uint8_t> header;
+  PutBE32(header, (uint32_t)w);
+  PutBE32(header, (uint32_t)h);
+  header.insert(header.end(), {8, 6, 0, 0, 0});
+
+  std::vector<uint8_t> file = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  PutChunk(file, "IHDR", header);
+  PutChunk(file, "IDAT", z);
+  PutChunk(file, "IEND", {});
+
+  std::ofstream output(path, std::ios::binary);
+  return output.write((const char*)file.data(), file.size()) && output.flush();
+} //SavePng
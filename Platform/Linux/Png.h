@@ -0,0 +1,26 @@
+/// \file Png.h
+/// \brief Interface for reading and writing PNG images.
+
+#ifndef __L4RC_PLATFORM_PNG_H__
+#define __L4RC_PLATFORM_PNG_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// \brief An image in memory.
+///
+/// Pixels are 32 bits, red in the low byte and alpha in the high byte,
+/// with the top row first.
+
+struct LImage{
+  int m_nWidth = 0; ///< Width in pixels.
+  int m_nHeight = 0; ///< Height in pixels.
+  std::vector<uint32_t> m_vPixels; ///< Pixels.
+}; //LImage
+
+bool DecodePng(const uint8_t* data, size_t size, LImage& img); ///< Decode a PNG file in memory.
+bool LoadPng(const char* path, LImage& img); ///< Read a PNG file.
+bool SavePng(const char* path, const uint32_t* pixels, int w, int h); ///< Write a PNG file.
+
+#endif //__L4RC_PLATFORM_PNG_H__
@@ -0,0 +1,43 @@
+/// \file Random.h
+/// \brief Interface for the random number generator LRandom.
+
+#ifndef __L4RC_PLATFORM_RANDOM_H__
+#define __L4RC_PLATFORM_RANDOM_H__
+
+#include <cstdint>
+#include <ctime>
+
+/// \brief A random number generator.
+///
+/// A xorshift64* generator seeded from the clock.
+
+class LRandom{
+  private:
+    uint64_t m_nState; ///< Generator state, never zero.
+
+  public:
+    LRandom(): m_nState((uint64_t)time(nullptr)*0x9E3779B97F4A7C15ULL | 1){} ///< Constructor.
+
+    /// Get the next 64 random bits.
+
+    uint64_t Next(){
+      m_nState ^= m_nState >> 12;
+      m_nState ^= m_nState << 25;
+      m_nState ^= m_nState >> 27;
+      return m_nState*0x2545F4914F6CDD1DULL;
+    } //Next
+
+    /// Get a random integer in [i, j].
+
+    int randn(int i, int j){
+      return i + (int)(Next() % (uint64_t)(j - i + 1));
+    } //randn
+
+    /// Get a random float in [0, 1].
+
+    float randf(){
+      return (float)(Next() >> 40)/(float)(1 << 24);
+    } //randf
+}; //LRandom
+
+#endif //__L4RC_PLATFORM_RANDOM_H__
@@ -0,0 +1,236 @@
+/// \file Raster.cpp
+/// \brief Code for the sprite rasterizer's inner loop.
+///
+/// There is a portable version and an AVX2 version that does eight pixels
+/// at a time. The AVX2 version is compiled for AVX2 whatever the compiler
+/// flags and only used if the CPU has it. Both do the same arithmetic in
+/// the same order, so they draw the same pixels, give or take rounding.
+
+#include <algorithm>
+#include <cmath>
+
+#include "Raster.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+  #define RASTER_AVX2 ///< Build the AVX2 span function.
+#endif
+
+/// Test whether a span maps pixel centers to texel centers one to one, as
+/// an unscaled sprite at a whole pixel position does. Then there is nothing
+/// to filter.
+/// \param s Span.
+/// \return true if the span is aligned.
+
+static bool IsAligned(const LSpan& s){
+  const float u = s.m_fU - 0.5f, v = s.m_fV - 0.5f;
+  return s.m_fDu == 1.0f && s.m_fDv == 0.0f && u == floorf(u) && v == floorf(v);
+} //IsAligned
+
+/// Blend a texel over a pixel.
+/// \param s Span, for the color.
+/// \param t Texel.
+/// \param dest [in, out] Pixel.
+
+static inline void BlendTexel(const LSpan& s, uint32_t t, uint32_t& dest){
+  const float keep = 1.0f - (float)(t >> 24)*s.m_pColor[3]*(1.0f/255.0f);
+  uint32_t result = 0;
+
+  for(int k=0; k<4; k++){
+    const float x = (float)((t >> 8*k) & 0xFF)*s.m_pColor[k] + (float)((dest >> 8*k) & 0xFF)*keep;
+    result |= (uint32_t)std::min(nearbyintf(x), 255.0f) << 8*k;
+  } //for
+
+  dest = result;
+} //BlendTexel
+
+/// Draw a span a pixel at a time.
+/// \param s Span.
+/// \param dest First pixel.
+/// \param n Number of pixels.
+
+static void DrawSpanScalar(const LSpan& s, uint32_t* dest, int n){
+  if(IsAligned(s)){
+    const uint32_t* row = s.m_pTexels + (int)(s.m_fV - 0.5f)*s.m_nPitch + (int)(s.m_fU - 0.5f);
+
+    for(int i=0; i<n; i++)
+      BlendTexel(s, row[i], dest[i]);
+
+    return;
+  } //if
+
+  for(int i=0; i<n; i++){
+    const float u = s.m_fU + s.m_fDu*i - 0.5f;
+    const float v = s.m_fV + s.m_fDv*i - 0.5f;
+    const float fu = floorf(u), fv = floorf(v);
+    const float wu = u - fu, wv = v - fv;
+
+    const int u0 = std::min(std::max((int)fu, s.m_nMinU), s.m_nMaxU);
+    const int u1 = std::min(std::max((int)fu + 1, s.m_nMinU), s.m_nMaxU);
+    const int v0 = std::min(std::max((int)fv, s.m_nMinV), s.m_nMaxV);
+    const int v1 = std::min(std::max((int)fv + 1, s.m_nMinV), s.m_nMaxV);
+
+    const uint32_t t00 = s.m_pTexels[v0*s.m_nPitch + u0];
+    const uint32_t t01 = s.m_pTexels[v0*s.m_nPitch + u1];
+    const uint32_t t10 = s.m_pTexels[v1*s.m_nPitch + u0];
+    const uint32_t t11 = s.m_pTexels[v1*s.m_nPitch + u1];
+
+    float c[4];
+
+    for(int k=0; k<4; k++){
+      const float a = (float)((t00 >> 8*k) & 0xFF);
+      const float b = (float)((t01 >> 8*k) & 0xFF);
+      const float d = (float)((t10 >> 8*k) & 0xFF);
+      const float e = (float)((t11 >> 8*k) & 0xFF);
+      const float top = a + (b - a)*wu;
+      const float bottom = d + (e - d)*wu;
+      c[k] = (top + (bottom - top)*wv)*s.m_pColor[k];
+    } //for
+
+    const float keep = 1.0f - c[3]*(1.0f/255.0f);
+    uint32_t result = 0;
+
+    for(int k=0; k<4; k++){
+      const float x = c[k] + (float)((dest[i] >> 8*k) & 0xFF)*keep;
+      result |= (uint32_t)std::min(nearbyintf(x), 255.0f) << 8*k;
+    } //for
+
+    dest[i] = result;
+  } //for
+} //DrawSpanScalar
+
+#ifdef RASTER_AVX2
+
+/// Get one channel of eight pixels as floats.
+/// \param p Pixels.
+/// \param shift Channel shift, 0 for red to 24 for alpha.
+/// \return The channel.
+
+__attribute__((target("avx2,fma")))
+static inline __m256 Channel(__m256i p, int shift){
+  return _mm256_cvtepi32_ps(_mm256_and_si256(
+    _mm256_srli_epi32(p, shift), _mm256_set1_epi32(0xFF)));
+} //Channel
+
+/// Draw a span eight pixels at a time, with the last few done one at a time.
+/// \param s Span.
+/// \param dest First pixel.
+/// \param n Number of pixels.
+
+__attribute__((target("avx2,fma")))
+static void DrawSpanAvx2(const LSpan& s, uint32_t* dest, int n){
+  const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256 du = _mm256_set1_ps(s.m_fDu);
+  const __m256 dv = _mm256_set1_ps(s.m_fDv);
+  const __m256i minU = _mm256_set1_epi32(s.m_nMinU), maxU = _mm256_set1_epi32(s.m_nMaxU);
+  const __m256i minV = _mm256_set1_epi32(s.m_nMinV), maxV = _mm256_set1_epi32(s.m_nMaxV);
+  const __m256i pitch = _mm256_set1_epi32(s.m_nPitch);
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 max = _mm256_set1_ps(255.0f);
+  const __m256 oneF = _mm256_set1_ps(1.0f);
+  const __m256 inv255 = _mm256_set1_ps(1.0f/255.0f);
+  const int* texels = (const int*)s.m_pTexels;
+
+  __m256 color[4];
+
+  for(int k=0; k<4; k++)
+    color[k] = _mm256_set1_ps(s.m_pColor[k]);
+
+  int i = 0;
+
+  if(IsAligned(s)){ //no filtering, so contiguous loads instead of gathers
+    const uint32_t* row = s.m_pTexels + (int)(s.m_fV - 0.5f)*s.m_nPitch + (int)(s.m_fU - 0.5f);
+
+    for(; i + 8 <= n; i += 8){
+      const __m256i t = _mm256_loadu_si256((const __m256i*)(row + i));
+      const __m256i old = _mm256_loadu_si256((const __m256i*)(dest + i));
+      const __m256 keep = _mm256_fnmadd_ps(_mm256_mul_ps(Channel(t, 24), color[3]), inv255, oneF);
+      __m256i result = _mm256_setzero_si256();
+
+      for(int k=0; k<4; k++){
+        const __m256 c = _mm256_mul_ps(Channel(t, 8*k), color[k]);
+        const __m256 y = _mm256_min_ps(_mm256_fmadd_ps(Channel(old, 8*k), keep, c), max);
+        result = _mm256_or_si256(result, _mm256_slli_epi32(_mm256_cvtps_epi32(y), 8*k));
+      } //for
+
+      _mm256_storeu_si256((__m256i*)(dest + i), result);
+    } //for
+
+    for(; i<n; i++)
+      BlendTexel(s, row[i], dest[i]);
+
+    return;
+  } //if
+
+  for(; i + 8 <= n; i += 8){
+    const __m256 x = _mm256_add_ps(_mm256_set1_ps((float)i), lane);
+    const __m256 u = _mm256_sub_ps(_mm256_fmadd_ps(du, x, _mm256_set1_ps(s.m_fU)), half);
+    const __m256 v = _mm256_sub_ps(_mm256_fmadd_ps(dv, x, _mm256_set1_ps(s.m_fV)), half);
+    const __m256 fu = _mm256_floor_ps(u), fv = _mm256_floor_ps(v);
+    const __m256 wu = _mm256_sub_ps(u, fu), wv = _mm256_sub_ps(v, fv);
+
+    const __m256i iu = _mm256_cvttps_epi32(fu), iv = _mm256_cvttps_epi32(fv);
+    const __m256i u0 = _mm256_min_epi32(_mm256_max_epi32(iu, minU), maxU);
+    const __m256i u1 = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(iu, one), minU), maxU);
+    const __m256i r0 = _mm256_mullo_epi32(_mm256_min_epi32(_mm256_max_epi32(iv, minV), maxV), pitch);
+    const __m256i r1 = _mm256_mullo_epi32(
+      _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(iv, one), minV), maxV), pitch);
+
+    const __m256i t00 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(r0, u0), 4);
+    const __m256i t01 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(r0, u1), 4);
+    const __m256i t10 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(r1, u0), 4);
+    const __m256i t11 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(r1, u1), 4);
+
+    __m256 c[4];
+
+    for(int k=0; k<4; k++){
+      const __m256 a = Channel(t00, 8*k), b = Channel(t01, 8*k);
+      const __m256 d = Channel(t10, 8*k), e = Channel(t11, 8*k);
+      const __m256 top = _mm256_fmadd_ps(_mm256_sub_ps(b, a), wu, a);
+      const __m256 bottom = _mm256_fmadd_ps(_mm256_sub_ps(e, d), wu, d);
+      c[k] = _mm256_mul_ps(_mm256_fmadd_ps(_mm256_sub_ps(bottom, top), wv, top), color[k]);
+    } //for
+
+    const __m256i old = _mm256_loadu_si256((const __m256i*)(dest + i));
+    const __m256 keep = _mm256_fnmadd_ps(c[3], inv255, oneF);
+    __m256i result = _mm256_setzero_si256();
+
+    for(int k=0; k<4; k++){
+      const __m256 y = _mm256_min_ps(_mm256_fmadd_ps(Channel(old, 8*k), keep, c[k]), max);
+      result = _mm256_or_si256(result, _mm256_slli_epi32(_mm256_cvtps_epi32(y), 8*k));
+    } //for
+
+    _mm256_storeu_si256((__m256i*)(dest + i), result);
+  } //for
+
+  if(i < n){
+    LSpan rest = s;
+    rest.m_fU += s.m_fDu*i;
+    rest.m_fV += s.m_fDv*i;
+    DrawSpanScalar(rest, dest + i, n - i);
+  } //if
+} //DrawSpanAvx2
+
+#endif //RASTER_AVX2
+
+/// Get the fastest span function that this CPU can run.
+/// \return The span function.
+
+LSpanFunction GetSpanFunction(){
+#ifdef RASTER_AVX2
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return DrawSpanAvx2;
+#endif
+
+  return DrawSpanScalar;
+} //GetSpanFunction
+
+/// Get the span function that runs anywhere, for comparison.
+/// \return The span function.
+
+LSpanFunction GetScalarSpanFunction(){
+  return DrawSpanScalar;
+} //GetScalarSpanFunction
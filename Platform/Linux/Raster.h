@@ -0,0 +1,41 @@
+/// \file Raster.h
+/// \brief Interface for the sprite rasterizer's inner loop.
+
+#ifndef __L4RC_PLATFORM_RASTER_H__
+#define __L4RC_PLATFORM_RASTER_H__
+
+#include <cstdint>
+
+/// \brief One row of a sprite, to be drawn into one row of pixels.
+///
+/// Texels are premultiplied by alpha. Texture coordinates are in texels,
+/// with texel centers at half-integers, and are sampled bilinearly with
+/// texels clamped to the sprite's frame so that neighboring frames in a
+/// sheet do not bleed in. The color multiplies each sample, which is then
+/// blended over the destination.
+
+struct LSpan{
+  const uint32_t* m_pTexels; ///< Texture, red in the low byte.
+  int m_nPitch; ///< Texels per texture row.
+  int m_nMinU; ///< Leftmost texel of the frame.
+  int m_nMaxU; ///< Rightmost texel of the frame.
+  int m_nMinV; ///< Top texel of the frame.
+  int m_nMaxV; ///< Bottom texel of the frame.
+  float m_fU; ///< Texture u at the first pixel center.
+  float m_fV; ///< Texture v at the first pixel center.
+  float m_fDu; ///< Change in u per pixel.
+  float m_fDv; ///< Change in v per pixel.
+  float m_pColor[4]; ///< Red, green, blue and alpha multipliers, premultiplied.
+}; //LSpan
+
+/// Draw a span into a row of pixels.
+/// \param s Span.
+/// \param dest First pixel.
+/// \param n Number of pixels.
+
+typedef void (*LSpanFunction)(const LSpan& s, uint32_t* dest, int n);
+
+LSpanFunction GetSpanFunction(); ///< Get the fastest span function for this CPU.
+LSpanFunction GetScalarSpanFunction(); ///< Get the portable span function.
+
+#endif //__L4RC_PLATFORM_RASTER_H__
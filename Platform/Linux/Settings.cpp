@@ -0,0 +1,76 @@
+/// \file Settings.cpp
+/// \brief Code for the game settings LSettings.
+
+#include <cstdio>
+
+#include "Settings.h"
+
+int LSettings::m_nWinWidth = 1024;
+int LSettings::m_nWinHeight = 768;
+Vector2 LSettings::m_vWinCenter = Vector2(512.0f, 384.0f);
+LXmlElement* LSettings::m_pXmlSettings = nullptr;
+
+static const char* g_pSettingsFile = "Media/XML/gamesettings.xml"; ///< Settings file.
+
+/// Read the game settings file and the window size from it. Media paths in
+/// the file are relative to the directory that the game is run from.
+/// \return true if the file was read.
+
+bool LSettings::LoadSettings(){
+  ReleaseSettings();
+  m_pXmlSettings = new LXmlElement;
+
+  if(!m_pXmlSettings->Load(g_pSettingsFile)){
+    fprintf(stderr, "cannot read %s\n", g_pSettingsFile);
+    ReleaseSettings();
+    return false;
+  } //if
+
+  if(const LXmlElement* r = m_pXmlSettings->GetChild("renderer")){
+    m_nWinWidth = r->GetIntAttribute("width", m_nWinWidth);
+    m_nWinHeight = r->GetIntAttribute("height", m_nWinHeight);
+  } //if
+
+  m_vWinCenter = Vector2(m_nWinWidth/2.0f, m_nWinHeight/2.0f);
+  return true;
+} //LoadSettings
+
+/// Read the game settings file again after it has changed, keeping the
+/// settings as they were if the new file cannot be read, which it may not
+/// be while it is still being saved. The window keeps its size. Anything
+/// that looked up settings must look them up again, since the old ones are
+/// freed.
+/// \return true if the file was read.
+
+bool LSettings::ReloadSettings(){
+  LXmlElement* xml = new LXmlElement;
+
+  if(!xml->Load(g_pSettingsFile)){
+    fprintf(stderr, "cannot read %s\n", g_pSettingsFile);
+    delete xml;
+    return false;
+  } //if
+
+  delete m_pXmlSettings;
+  m_pXmlSettings = xml;
+  return true;
+} //ReloadSettings
+
+/// Free the settings file.
+
+void LSettings::ReleaseSettings(){
+  delete m_pXmlSettings;
+  m_pXmlSettings = nullptr;
+} //ReleaseSettings
+
+/// Join a media directory and file name from the settings file, which uses
+/// Windows path separators.
+/// \param dir Directory, or nullptr if the file name has one.
+/// \param file File name.
+/// \return The path.
+
+std::string LSettings::GetMediaPath(const char* dir, const char* file){
+  std::string s = dir? std::string(dir) + "/" + file: std::string(file);
+  std::replace(s.begin(), s.end(), '\\', '/');
+  return s;
+} //GetMediaPath
@@ -0,0 +1,31 @@
+/// \file Settings.h
+/// \brief Interface for the game settings LSettings.
+
+#ifndef __L4RC_PLATFORM_SETTINGS_H__
+#define __L4RC_PLATFORM_SETTINGS_H__
+
+#include <string>
+
+#include "Defines.h"
+#include "Xml.h"
+
+/// \brief The game settings.
+///
+/// Settings read from the game settings file, `Media/XML/gamesettings.xml`,
+/// shared by everything that derives from this class.
+
+class LSettings{
+  protected:
+    static int m_nWinWidth; ///< Window width in pixels.
+    static int m_nWinHeight; ///< Window height in pixels.
+    static Vector2 m_vWinCenter; ///< Window center.
+    static LXmlElement* m_pXmlSettings; ///< Settings file root element.
+
+  public:
+    static bool LoadSettings(); ///< Read the settings file.
+    static bool ReloadSettings(); ///< Read the settings file again.
+    static void ReleaseSettings(); ///< Free the settings file.
+    static std::string GetMediaPath(const char* dir, const char* file); ///< Make a media file path.
+}; //LSettings
+
+#endif //__L4RC_PLATFORM_SETTINGS_H__
@@ -0,0 +1,115 @@
+/// \file SimpleMath.h
+/// \brief The vectors and colors that the game uses from DirectXTK's
+/// SimpleMath, for the headless platform.
+
+#ifndef __L4RC_PLATFORM_SIMPLEMATH_H__
+#define __L4RC_PLATFORM_SIMPLEMATH_H__
+
+#include <cmath>
+
+namespace DirectX{
+  const float XM_PI = 3.141592654f; ///< Pi.
+  const float XM_2PI = 6.283185307f; ///< Two pi.
+  const float XM_PIDIV2 = 1.570796327f; ///< Pi over two.
+
+  /// \brief A color, red, green, blue and alpha in [0, 1].
+
+  struct XMVECTORF32{
+    float f[4]; ///< Components.
+  }; //XMVECTORF32
+
+  namespace Colors{
+    const XMVECTORF32 White = {{1.0f, 1.0f, 1.0f, 1.0f}}; ///< White.
+    const XMVECTORF32 Black = {{0.0f, 0.0f, 0.0f, 1.0f}}; ///< Black.
+    const XMVECTORF32 Red = {{1.0f, 0.0f, 0.0f, 1.0f}}; ///< Red.
+    const XMVECTORF32 Green = {{0.0f, 0.501960814f, 0.0f, 1.0f}}; ///< Green.
+    const XMVECTORF32 Blue = {{0.0f, 0.0f, 1.0f, 1.0f}}; ///< Blue.
+    const XMVECTORF32 DarkBlue = {{0.0f, 0.0f, 0.545098066f, 1.0f}}; ///< Dark blue.
+    const XMVECTORF32 LightGreen = {{0.564705908f, 0.933333397f, 0.564705908f, 1.0f}}; ///< Light green.
+    const XMVECTORF32 Yellow = {{1.0f, 1.0f, 0.0f, 1.0f}}; ///< Yellow.
+    const XMVECTORF32 Gray = {{0.501960814f, 0.501960814f, 0.501960814f, 1.0f}}; ///< Gray.
+  } //Colors
+
+  namespace SimpleMath{
+    /// \brief A 2D vector.
+
+    struct Vector2{
+      float x = 0.0f; ///< X coordinate.
+      float y = 0.0f; ///< Y coordinate.
+
+      Vector2(){} ///< Zero vector.
+      Vector2(float ix, float iy): x(ix), y(iy){} ///< Constructor.
+      explicit Vector2(float a): x(a), y(a){} ///< Both coordinates the same.
+
+      float Length() const { return sqrtf(x*x + y*y); } ///< Length.
+      float LengthSquared() const { return x*x + y*y; } ///< Length squared.
+      float Dot(const Vector2& v) const { return x*v.x + y*v.y; } ///< Dot product.
+
+      /// Scale to unit length. The zero vector is left alone.
+
+      void Normalize(){
+        const float len = Length();
+        if(len > 0.0f){x /= len; y /= len;}
+      } //Normalize
+
+      Vector2& operator+=(const Vector2& v){x += v.x; y += v.y; return *this;} ///< Add.
+      Vector2& operator-=(const Vector2& v){x -= v.x; y -= v.y; return *this;} ///< Subtract.
+      Vector2& operator*=(float s){x *= s; y *= s; return *this;} ///< Scale.
+      Vector2& operator/=(float s){x /= s; y /= s; return *this;} ///< Scale.
+      Vector2 operator-() const { return Vector2(-x, -y); } ///< Negate.
+
+      bool operator==(const Vector2& v) const { return x == v.x && y == v.y; } ///< Equal.
+      bool operator!=(const Vector2& v) const { return !(*this == v); } ///< Not equal.
+
+      /// Distance between two points.
+
+      static float Distance(const Vector2& a, const Vector2& b){
+        return (a - b).Length();
+      } //Distance
+
+      /// Distance between two points, squared.
+
+      static float DistanceSquared(const Vector2& a, const Vector2& b){
+        return (a - b).LengthSquared();
+      } //DistanceSquared
+
+      friend Vector2 operator+(Vector2 a, const Vector2& b){return a += b;} ///< Add.
+      friend Vector2 operator-(Vector2 a, const Vector2& b){return a -= b;} ///< Subtract.
+      friend Vector2 operator*(Vector2 a, float s){return a *= s;} ///< Scale.
+      friend Vector2 operator*(float s, Vector2 a){return a *= s;} ///< Scale.
+      friend Vector2 operator/(Vector2 a, float s){return a /= s;} ///< Scale.
+
+      /// Componentwise product.
+
+      friend Vector2 operator*(const Vector2& a, const Vector2& b){
+        return Vector2(a.x*b.x, a.y*b.y);
+      } //operator*
+    }; //Vector2
+
+    /// \brief A 3D vector.
+
+    struct Vector3{
+      float x = 0.0f; ///< X coordinate.
+      float y = 0.0f; ///< Y coordinate.
+      float z = 0.0f; ///< Z coordinate.
+
+      Vector3(){} ///< Zero vector.
+      Vector3(float ix, float iy, float iz): x(ix), y(iy), z(iz){} ///< Constructor.
+    }; //Vector3
+
+    /// \brief A 4D vector, also used for colors.
+
+    struct Vector4{
+      float x = 0.0f; ///< X coordinate, or red.
+      float y = 0.0f; ///< Y coordinate, or green.
+      float z = 0.0f; ///< Z coordinate, or blue.
+      float w = 0.0f; ///< W coordinate, or alpha.
+
+      Vector4(){} ///< Zero vector.
+      Vector4(float ix, float iy, float iz, float iw): x(ix), y(iy), z(iz), w(iw){} ///< Constructor.
+      Vector4(const XMVECTORF32& c): x(c.f[0]), y(c.f[1]), z(c.f[2]), w(c.f[3]){} ///< From a color.
+    }; //Vector4
+  } //SimpleMath
+} //DirectX
+
+#endif //__L4RC_PLATFORM_SIMPLEMATH_H__
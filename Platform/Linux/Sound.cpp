@@ -0,0 +1,189 @@
+/// \file Sound.cpp
+/// \brief Code for the sound player LSound.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Adpcm.h"
+#include "Sound.h"
+#include "Wav.h"
+
+/// Start with no sounds, playing to nowhere.
+
+LSound::LSound(): m_cMixer(Voices, Rate), m_pSink(new CNullSink),
+  m_vBlock(2*BlockFrames){
+} //constructor
+
+/// Choose where the mixed sound goes and how much game time a frame is.
+/// \param path WAV file to write, or empty for nowhere.
+/// \param frameTime Game time per frame in seconds.
+
+void LSound::SetOutput(const std::string& path, float frameTime){
+  m_fFrameTime = frameTime;
+  m_pSink.reset(new CNullSink);
+  if(path.empty())return;
+
+  CWavSink* wav = new CWavSink(path.c_str(), Rate);
+
+  if(wav->IsOpen())
+    m_pSink.reset(wav);
+
+  else{
+    fprintf(stderr, "cannot write %s\n", path.c_str());
+    delete wav;
+  } //else
+} //SetOutput
+
+/// Make room for the game's sounds.
+/// \param n Number of sounds.
+
+void LSound::Initialize(eSound n){
+  m_vDesc.assign((size_t)n, VoiceDesc());
+  m_vLastFrame.assign((size_t)n, 0);
+  m_vName.assign((size_t)n, std::string());
+  m_vPath.assign((size_t)n, std::string());
+} //Initialize
+
+/// Look a sound up in the settings file.
+/// \param name Sound name in the settings file.
+/// \param path [out] Path of the sound file.
+/// \return The sound's settings, or nullptr if there are none.
+
+const LXmlElement* LSound::FindSound(const char* name, std::string& path) const{
+  const LXmlElement* sounds = m_pXmlSettings? m_pXmlSettings->GetChild("sounds"): nullptr;
+  const LXmlElement* e = sounds? sounds->FindChild("sound", name): nullptr;
+  const char* file = e? e->GetAttribute("file"): nullptr;
+
+  path = file? GetMediaPath(sounds->GetAttribute("path"), file): std::string();
+  return file? e: nullptr;
+} //FindSound
+
+/// Look a sound up in the settings file, read its file and compress it.
+/// \param t Sound type.
+/// \param name Sound name in the settings file.
+
+void LSound::Load(eSound t, const char* name){
+  std::string path;
+  const LXmlElement* e = FindSound(name, path);
+
+  if(e == nullptr || (size_t)t >= m_vDesc.size()){
+    fprintf(stderr, "no sound %s in settings\n", name);
+    return;
+  } //if
+
+  const char* volume = e->GetAttribute("volume");
+  WavSound s;
+
+  if(!LoadWav(path.c_str(), s)){
+    fprintf(stderr, "cannot read %s\n", path.c_str());
+    return;
+  } //if
+
+  AdpcmSound a;
+  EncodeAdpcm(s, a);
+
+  VoiceDesc& d = m_vDesc[(size_t)t];
+  d.m_nPriority = e->GetIntAttribute("priority", 0);
+  d.m_fGain = volume? (float)atof(volume): 1.0f;
+  m_cMixer.SetSound((size_t)t, a);
+  m_vName[(size_t)t] = name;
+  m_vPath[(size_t)t] = path;
+} //Load
+
+/// Unload a sound. It is not heard until it is loaded again.
+/// \param t Sound type.
+
+void LSound::Unload(eSound t){
+  m_cMixer.ClearSound((size_t)t);
+
+  if((size_t)t < m_vName.size())
+    m_vName[(size_t)t].clear();
+} //Unload
+
+/// Read a sound file again after it has changed, for every loaded sound
+/// that was read from it. Voices playing those sounds are stopped. If the
+/// new file cannot be read, which it may not be while it is still being
+/// saved, the sounds are kept as they were.
+/// \param path Sound file name.
+/// \return Number of sounds read again.
+
+size_t LSound::ReloadFile(const std::string& path){
+  size_t n = 0;
+
+  for(size_t i=0; i<m_vName.size(); i++)
+    if(!m_vName[i].empty() && m_vPath[i] == path){
+      const std::string name = m_vName[i];
+      Load((eSound)i, name.c_str());
+      n++;
+    } //if
+
+  return n;
+} //ReloadFile
+
+/// Look every loaded sound up in the settings again, after they have been
+/// read again. A sound whose file has changed is loaded again, and one
+/// whose priority or volume has changed gets the new ones. A sound that is
+/// no longer in the settings is left as it was.
+/// \return Number of sounds that changed.
+
+size_t LSound::RefreshSounds(){
+  size_t changed = 0;
+
+  for(size_t i=0; i<m_vName.size(); i++){
+    if(m_vName[i].empty())continue;
+
+    std::string path;
+    const LXmlElement* e = FindSound(m_vName[i].c_str(), path);
+    if(e == nullptr)continue;
+
+    if(path != m_vPath[i]){
+      const std::string name = m_vName[i];
+      Load((eSound)i, name.c_str());
+      changed++;
+      continue;
+    } //if
+
+    const char* volume = e->GetAttribute("volume");
+    VoiceDesc& d = m_vDesc[i];
+    const int priority = e->GetIntAttribute("priority", 0);
+    const float gain = volume? (float)atof(volume): 1.0f;
+
+    changed += d.m_nPriority != priority || d.m_fGain != gain;
+    d.m_nPriority = priority;
+    d.m_fGain = gain;
+  } //for
+
+  return changed;
+} //RefreshSounds
+
+/// Start a frame, mixing the last one.
+
+void LSound::BeginFrame(){
+  m_nFrame++;
+
+  const uint64_t end = (uint64_t)llround(m_nFrame*m_fFrameTime*Rate);
+
+  while(m_cMixer.GetTime() < end){
+    const uint64_t left = end - m_cMixer.GetTime();
+    const size_t n = left < BlockFrames? (size_t)left: BlockFrames;
+    m_cMixer.Mix(m_vBlock.data(), n);
+    m_pSink->Write(m_vBlock.data(), n);
+  } //while
+} //BeginFrame
+
+/// Play a sound from the start of this frame, unless it was played already
+/// this frame.
+/// \param t Sound type.
+
+void LSound::play(eSound t){
+  const size_t i = (size_t)t;
+  if(i >= m_vDesc.size() || m_vLastFrame[i] == m_nFrame + 1)return;
+
+  VoiceDesc d = m_vDesc[i];
+  d.m_nStart = m_cMixer.GetTime();
+  if(!m_cMixer.Play(i, d))return;
+
+  m_vLastFrame[i] = m_nFrame + 1;
+  m_nPlays++;
+} //play
@@ -0,0 +1,66 @@
+/// \file Sound.h
+/// \brief Interface for the sound player LSound.
+
+#ifndef __L4RC_PLATFORM_SOUND_H__
+#define __L4RC_PLATFORM_SOUND_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AudioSink.h"
+#include "Mixer.h"
+#include "Settings.h"
+
+/// \brief The sound player.
+///
+/// Sounds are looked up in the game settings file and read from their WAV
+/// files when loaded, compressed with ADPCM to take a quarter of the memory
+/// of the 16-bit samples in the files, and played through the game's
+/// mixer, which decodes them as it goes. A sound's
+/// `priority` and `volume` attributes in the settings file say how to play
+/// it. Game time is turned into sample time a frame at a time: sounds played
+/// during a frame start on the frame's first sample, and the frame is mixed
+/// at the start of the next one. The mixed sound goes to a WAV file, or
+/// nowhere. A sound that is already playing this frame is not started
+/// again. Sound files and settings changed while the game runs can be read
+/// again, see `ReloadFile()` and `RefreshSounds()`.
+
+class LSound: public LSettings{
+  private:
+    static const int Rate = 44100; ///< Output sample rate in Hz.
+    static const size_t Voices = 32; ///< Number of mixer voices.
+    static const size_t BlockFrames = 512; ///< Most frames mixed at a time.
+
+    CMixer m_cMixer; ///< Mixer.
+    std::unique_ptr<CAudioSink> m_pSink; ///< Where the mixed sound goes.
+    std::vector<float> m_vBlock; ///< Mixed frames, left then right.
+    double m_fFrameTime = 1.0/60.0; ///< Game time per frame in seconds.
+
+    std::vector<VoiceDesc> m_vDesc; ///< How to play each sound.
+    std::vector<size_t> m_vLastFrame; ///< Frame each sound was last played in, plus one.
+    std::vector<std::string> m_vName; ///< Name of each sound in the settings file, empty if not loaded.
+    std::vector<std::string> m_vPath; ///< File each sound was read from.
+    size_t m_nFrame = 0; ///< Frame number.
+    size_t m_nPlays = 0; ///< Number of sounds played.
+
+    const LXmlElement* FindSound(const char* name, std::string& path) const; ///< Look up a sound.
+
+  public:
+    LSound(); ///< Constructor.
+
+    void SetOutput(const std::string& path, float frameTime); ///< Choose where the sound goes.
+    void Initialize(eSound n); ///< Make room for sounds.
+    void Load(eSound t, const char* name); ///< Load a sound.
+    void Unload(eSound t); ///< Unload a sound.
+    size_t ReloadFile(const std::string& path); ///< Read a sound file again.
+    size_t RefreshSounds(); ///< Look the loaded sounds up in the settings again.
+    void BeginFrame(); ///< Start a frame.
+
+    void play(eSound t); ///< Play a sound.
+
+    size_t GetPlayCount() const { return m_nPlays; } ///< Get number of sounds played.
+    size_t GetBytes() const { return m_cMixer.GetBytes(); } ///< Get memory used by loaded sounds.
+}; //LSound
+
+#endif //__L4RC_PLATFORM_SOUND_H__
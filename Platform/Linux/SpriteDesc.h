@@ -0,0 +1,25 @@
+/// \file SpriteDesc.h
+/// \brief Interface for the sprite descriptor LSpriteDesc2D.
+
+#ifndef __L4RC_PLATFORM_SPRITEDESC_H__
+#define __L4RC_PLATFORM_SPRITEDESC_H__
+
+#include "Defines.h"
+
+/// \brief A 2D sprite descriptor.
+///
+/// Everything the renderer needs to draw a sprite.
+
+class LSpriteDesc2D{
+  public:
+    UINT m_nSpriteIndex = 0; ///< Sprite index.
+    UINT m_nCurrentFrame = 0; ///< Animation frame.
+    Vector2 m_vPos; ///< Position of the center, y up.
+    float m_fRoll = 0.0f; ///< Rotation in radians.
+    float m_fXScale = 1.0f; ///< Horizontal scale.
+    float m_fYScale = 1.0f; ///< Vertical scale.
+    float m_fAlpha = 1.0f; ///< Opacity.
+    Vector4 m_f4Tint = Vector4(1.0f, 1.0f, 1.0f, 1.0f); ///< Color multiplier.
+}; //LSpriteDesc2D
+
+#endif //__L4RC_PLATFORM_SPRITEDESC_H__
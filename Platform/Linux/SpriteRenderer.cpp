@@ -0,0 +1,858 @@
+/// \file SpriteRenderer.cpp
+/// \brief Code for the sprite renderer LSpriteRenderer.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef __GLIBC__
+  #include <malloc.h>
+#endif //__GLIBC__
+
+#include "SpriteRenderer.h"
+
+std::string LSpriteRenderer::m_strScreenshot;
+
+/// Premultiply an image by alpha, in place. Opaque pixels, which are most
+/// of them, stay as they are.
+/// \param img Image.
+
+static void Premultiply(LImage& img){
+  for(uint32_t& p: img.m_vPixels){
+    const uint32_t a = p >> 24;
+    if(a == 255)continue;
+
+    uint32_t result = a << 24;
+
+    for(int shift=0; shift<24; shift+=8)
+      result |= (((p >> shift) & 0xFF)*a + 127)/255 << shift;
+
+    p = result;
+  } //for
+} //Premultiply
+
+/// Decode a texture compressed with BC2, also called DXT3, keeping only
+/// alpha, which is all that a sprite font uses. Texels are premultiplied
+/// white.
+/// \param data Compressed texture.
+/// \param w Width in texels, a multiple of 4.
+/// \param h Height in texels, a multiple of 4.
+/// \param pitch Bytes per row of 4x4 blocks.
+/// \param img [out] The texture.
+
+static void DecodeBC2Alpha(const uint8_t* data, int w, int h, size_t pitch, LImage& img){
+  img.m_nWidth = w;
+  img.m_nHeight = h;
+  img.m_vPixels.assign((size_t)w*h, 0);
+
+  for(int by=0; by<h/4; by++)
+    for(int bx=0; bx<w/4; bx++){
+      const uint8_t* block = data + by*pitch + bx*16;
+
+      for(int i=0; i<16; i++){
+        const uint32_t a = ((block[i/2] >> 4*(i & 1)) & 0xF)*17;
+        img.m_vPixels[(size_t)(4*by + i/4)*w + 4*bx + i%4] = a*0x01010101u;
+      } //for
+    } //for
+} //DecodeBC2Alpha
+
+/// Start the worker threads, one fewer than the number of cores, since the
+/// thread that ends the frame draws too.
+/// \param mode Sprite mode, which is ignored since draws are always in order.
+
+LSpriteRenderer::LSpriteRenderer(eSpriteMode mode){
+  (void)mode;
+  m_pSpan = GetSpanFunction();
+  StartWorkers(std::max(1u, std::thread::hardware_concurrency()) - 1);
+} //constructor
+
+/// Stop the worker threads.
+
+LSpriteRenderer::~LSpriteRenderer(){
+  StopWorkers();
+} //destructor
+
+/// Make room for the game's sprites, the framebuffer and the bands, and
+/// load the font named in the settings file. On glibc, large blocks are
+/// pinned to their own pages, since otherwise the first texture unloaded
+/// raises the threshold and later textures come from a heap that never
+/// shrinks, which would undo the point of unloading them.
+/// \param n Number of sprites.
+
+void LSpriteRenderer::Initialize(eSprite n){
+  #ifdef __GLIBC__
+    mallopt(M_MMAP_THRESHOLD, 128*1024);
+  #endif //__GLIBC__
+
+  m_vSprites.assign((size_t)n, LSpriteInfo());
+  m_vFrameBuffer.assign((size_t)m_nWinWidth*m_nWinHeight, 0xFF000000);
+  m_vBands.assign((m_nWinHeight + BandHeight - 1)/BandHeight, std::vector<uint32_t>());
+
+  const LXmlElement* font = m_pXmlSettings? m_pXmlSettings->GetChild("font"): nullptr;
+  const char* file = font? font->GetAttribute("file"): nullptr;
+
+  if(file && !LoadFont(GetMediaPath(nullptr, file)))
+    fprintf(stderr, "cannot read font %s\n", file);
+} //Initialize
+
+/// Load a texture, unless it is loaded already. A texture decoded ahead by
+/// `Prepare()` is taken as it is, after waiting for it if it is still being
+/// decoded, and anything else is decoded here.
+/// \param path Image file name.
+/// \return Texture index, or -1 if the image cannot be read.
+
+int LSpriteRenderer::LoadTexture(const std::string& path){
+  const auto found = m_mapTextures.find(path);
+  if(found != m_mapTextures.end())return found->second;
+
+  LImage img;
+  bool prepared = false;
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutexPrepared);
+    LPreparedTexture& p = m_mapPrepared[path];
+    m_cvPrepared.wait(lock, [&](){return !p.m_bDecoding;});
+
+    if(p.m_bReady){
+      img = std::move(p.m_cImage);
+      prepared = true;
+    } //if
+
+    p.m_bTaken = true;
+  }
+
+  if(!prepared){
+    if(!LoadPng(path.c_str(), img)){
+      fprintf(stderr, "cannot read %s\n", path.c_str());
+      return -1;
+    } //if
+
+    Premultiply(img);
+  } //if
+
+  m_nTextureBytes += img.m_vPixels.size()*sizeof(uint32_t);
+  int i = (int)m_vTextures.size();
+
+  if(m_vFreeTextures.empty())
+    m_vTextures.push_back(std::move(img));
+
+  else{
+    i = m_vFreeTextures.back();
+    m_vFreeTextures.pop_back();
+    m_vTextures[i] = std::move(img);
+  } //else
+
+  return m_mapTextures[path] = i;
+} //LoadTexture
+
+/// Load a sprite font made by DirectXTK's MakeSpriteFont. Only fonts with
+/// BC2 compressed or 32-bit RGBA textures are supported.
+/// \param path File name.
+/// \return true if the font was loaded.
+
+bool LSpriteRenderer::LoadFont(const std::string& path){
+  std::ifstream input(path, std::ios::binary | std::ios::ate);
+  if(!input)return false;
+
+  std::vector<uint8_t> data((size_t)input.tellg());
+  input.seekg(0);
+  if(!input.read((char*)data.data(), data.size()) || data.size() < 12 ||
+    memcmp(data.data(), "DXTKfont", 8) != 0)
+    return false;
+
+  auto u32 = [&](size_t pos){uint32_t x; memcpy(&x, data.data() + pos, 4); return x;};
+  auto f32 = [&](size_t pos){float x; memcpy(&x, data.data() + pos, 4); return x;};
+
+  const uint32_t n = u32(8);
+  size_t pos = 12;
+  if(data.size() < pos + n*32 + 28)return false;
+
+  m_vGlyphs.resize(n);
+
+  for(LGlyph& g: m_vGlyphs){
+    g.m_nChar = u32(pos);
+    for(int i=0; i<4; i++)g.m_pRect[i] = (int)u32(pos + 4 + 4*i);
+    g.m_fXOffset = f32(pos + 20);
+    g.m_fYOffset = f32(pos + 24);
+    g.m_fXAdvance = f32(pos + 28);
+    pos += 32;
+  } //for
+
+  m_fLineSpacing = f32(pos);
+  const uint32_t defaultChar = u32(pos + 4);
+  const int w = (int)u32(pos + 8), h = (int)u32(pos + 12);
+  const uint32_t format = u32(pos + 16);
+  const size_t pitch = u32(pos + 20), rows = u32(pos + 24);
+  pos += 28;
+
+  if(data.size() < pos + pitch*rows)return false;
+
+  if(format == 74 && w%4 == 0 && h%4 == 0 && rows*4 >= (size_t)h) //DXGI_FORMAT_BC2_UNORM
+    DecodeBC2Alpha(data.data() + pos, w, h, pitch, m_cFont);
+
+  else if(format == 28 && pitch >= 4*(size_t)w && rows >= (size_t)h){ //DXGI_FORMAT_R8G8B8A8_UNORM
+    m_cFont.m_nWidth = w;
+    m_cFont.m_nHeight = h;
+    m_cFont.m_vPixels.resize((size_t)w*h);
+
+    for(int y=0; y<h; y++)
+      memcpy(&m_cFont.m_vPixels[(size_t)y*w], data.data() + pos + y*pitch, 4*(size_t)w);
+  } //else if
+
+  else{
+    m_vGlyphs.clear();
+    return false;
+  } //else
+
+  std::sort(m_vGlyphs.begin(), m_vGlyphs.end(),
+    [](const LGlyph& a, const LGlyph& b){return a.m_nChar < b.m_nChar;});
+
+  m_nDefaultGlyph = &FindGlyph(defaultChar) - m_vGlyphs.data();
+  return true;
+} //LoadFont
+
+/// Look up a character in the font.
+/// \param c Character code.
+/// \return The character's glyph, or the default glyph.
+
+const LGlyph& LSpriteRenderer::FindGlyph(uint32_t c) const{
+  const auto i = std::lower_bound(m_vGlyphs.begin(), m_vGlyphs.end(), c,
+    [](const LGlyph& g, uint32_t x){return g.m_nChar < x;});
+
+  return i != m_vGlyphs.end() && i->m_nChar == c? *i: m_vGlyphs[m_nDefaultGlyph];
+} //FindGlyph
+
+/// Look a sprite up in the settings file. A sprite is either an image file
+/// or frames cut from the image file of another sprite. The settings are
+/// only read, so this is safe on any thread.
+/// \param name Sprite name in the settings file.
+/// \param path [out] Path of the image file, empty if there is none.
+/// \return The sprite's settings, or nullptr if there are none.
+
+const LXmlElement* LSpriteRenderer::FindSprite(const char* name, std::string& path) const{
+  const LXmlElement* sprites = m_pXmlSettings? m_pXmlSettings->GetChild("sprites"): nullptr;
+  const LXmlElement* e = sprites? sprites->FindChild("sprite", name): nullptr;
+  path.clear();
+
+  if(e == nullptr)return nullptr;
+
+  const char* file = e->GetAttribute("file");
+
+  if(const char* sheet = e->GetAttribute("sheet")){
+    const LXmlElement* f = sprites->FindChild("sprite", sheet);
+    file = f? f->GetAttribute("file"): nullptr;
+  } //if
+
+  if(file)path = GetMediaPath(sprites->GetAttribute("path"), file);
+  return e;
+} //FindSprite
+
+/// Look a sprite up in the settings file and load its texture.
+/// \param t Sprite type.
+/// \param name Sprite name in the settings file.
+
+void LSpriteRenderer::Load(eSprite t, const char* name){
+  std::string path;
+  const LXmlElement* e = FindSprite(name, path);
+
+  if(e == nullptr || (size_t)t >= m_vSprites.size()){
+    fprintf(stderr, "no sprite %s in settings\n", name);
+    return;
+  } //if
+
+  LSpriteInfo& s = m_vSprites[(size_t)t];
+  s.m_nTexture = path.empty()? -1: LoadTexture(path);
+  if(s.m_nTexture < 0)return;
+
+  s.m_strName = name;
+  SetFrames(s, e);
+} //Load
+
+/// Read a sprite's frames from its settings, clipped to its texture. A
+/// sprite with no frames has one, the whole texture.
+/// \param s Sprite, whose texture is loaded.
+/// \param e Sprite's settings.
+
+void LSpriteRenderer::SetFrames(LSpriteInfo& s, const LXmlElement* e) const{
+  const LImage& img = m_vTextures[s.m_nTexture];
+  s.m_vFrames.clear();
+
+  for(const auto& frame: e->GetChildren())
+    if(frame->GetName() == "frame"){
+      s.m_vFrames.push_back(std::max(0, frame->GetIntAttribute("left", 0)));
+      s.m_vFrames.push_back(std::max(0, frame->GetIntAttribute("top", 0)));
+      s.m_vFrames.push_back(std::min(img.m_nWidth, frame->GetIntAttribute("right", 0) + 1));
+      s.m_vFrames.push_back(std::min(img.m_nHeight, frame->GetIntAttribute("bottom", 0) + 1));
+    } //if
+
+  if(s.m_vFrames.empty())
+    s.m_vFrames = {0, 0, img.m_nWidth, img.m_nHeight};
+} //SetFrames
+
+/// Decode a sprite's texture so that `Load()` need not. Safe to call on any
+/// thread, even while the main thread draws. Sprites that share an image
+/// file share the decode: a second call for the same file waits for the
+/// first to finish.
+/// \param name Sprite name in the settings file.
+/// \return true if the texture was decoded, here or elsewhere.
+
+bool LSpriteRenderer::Prepare(const char* name){
+  std::string path;
+  if(FindSprite(name, path) == nullptr || path.empty())return false;
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutexPrepared);
+    const auto i = m_mapPrepared.find(path);
+
+    if(i != m_mapPrepared.end()){ //decoded, being decoded or loaded
+      LPreparedTexture& p = i->second;
+      m_cvPrepared.wait(lock, [&](){return !p.m_bDecoding;});
+      return true;
+    } //if
+
+    m_mapPrepared[path].m_bDecoding = true;
+  }
+
+  LImage img;
+  const bool ok = LoadPng(path.c_str(), img);
+  if(ok)Premultiply(img);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutexPrepared);
+    LPreparedTexture& p = m_mapPrepared[path];
+
+    if(ok){
+      p.m_cImage = std::move(img);
+      p.m_bReady = true;
+    } //if
+
+    p.m_bDecoding = false;
+  }
+
+  m_cvPrepared.notify_all();
+  return ok;
+} //Prepare
+
+/// Unload a sprite. Its texture is freed unless another sprite uses it, and
+/// a texture that is freed must be decoded again to be loaded again.
+/// \param t Sprite type.
+
+void LSpriteRenderer::Unload(eSprite t){
+  if((size_t)t >= m_vSprites.size() || m_vSprites[(size_t)t].m_nTexture < 0)
+    return;
+
+  LSpriteInfo& s = m_vSprites[(size_t)t];
+  const int texture = s.m_nTexture;
+  s = LSpriteInfo();
+
+  for(const LSpriteInfo& other: m_vSprites)
+    if(other.m_nTexture == texture)return;
+
+  for(auto i=m_mapTextures.begin(); i!=m_mapTextures.end(); ++i)
+    if(i->second == texture){
+      std::lock_guard<std::mutex> lock(m_mutexPrepared);
+      const auto p = m_mapPrepared.find(i->first);
+
+      if(p != m_mapPrepared.end() && !p->second.m_bDecoding)
+        m_mapPrepared.erase(p);
+
+      m_mapTextures.erase(i);
+      break;
+    } //if
+
+  m_nTextureBytes -= m_vTextures[texture].m_vPixels.size()*sizeof(uint32_t);
+  m_vTextures[texture] = LImage();
+  m_vFreeTextures.push_back(texture);
+} //Unload
+
+/// Read an image file again after it has changed. If it is the texture of
+/// loaded sprites, the texture is replaced in place, so every sprite that
+/// uses it stays loaded, and their frames are clipped to its new size. If
+/// the new file cannot be read, which it may not be while it is still being
+/// saved, the texture is kept as it was. An image decoded ahead of loading
+/// is thrown away, so that it is decoded again when it is loaded. Call this
+/// between frames.
+/// \param path Image file name.
+/// \return true if a texture was replaced.
+
+bool LSpriteRenderer::ReloadImage(const std::string& path){
+  const auto found = m_mapTextures.find(path);
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutexPrepared);
+    const auto p = m_mapPrepared.find(path);
+
+    if(p != m_mapPrepared.end()){
+      m_cvPrepared.wait(lock, [&](){return !p->second.m_bDecoding;});
+
+      if(found == m_mapTextures.end()) //a loaded texture keeps its entry, see Prepare()
+        m_mapPrepared.erase(p);
+    } //if
+  }
+
+  if(found == m_mapTextures.end())return false;
+
+  LImage img;
+
+  if(!LoadPng(path.c_str(), img)){
+    fprintf(stderr, "cannot read %s\n", path.c_str());
+    return false;
+  } //if
+
+  Premultiply(img);
+
+  const int texture = found->second;
+  m_nTextureBytes -= m_vTextures[texture].m_vPixels.size()*sizeof(uint32_t);
+  m_nTextureBytes += img.m_vPixels.size()*sizeof(uint32_t);
+  m_vTextures[texture] = std::move(img);
+
+  for(LSpriteInfo& s: m_vSprites)
+    if(s.m_nTexture == texture){
+      std::string unused;
+      if(const LXmlElement* e = FindSprite(s.m_strName.c_str(), unused))
+        SetFrames(s, e);
+    } //if
+
+  return true;
+} //ReloadImage
+
+/// Look every loaded sprite up in the settings again, after they have been
+/// read again. A sprite whose image file has changed is loaded again, and
+/// one whose frames have changed gets the new ones. A sprite that is no
+/// longer in the settings is left as it was. Images decoded ahead of
+/// loading are thrown away, since the settings may no longer name them.
+/// Call this between frames, with nothing decoding ahead.
+/// \return Number of sprites that changed.
+
+size_t LSpriteRenderer::RefreshSprites(){
+  {
+    std::lock_guard<std::mutex> lock(m_mutexPrepared);
+
+    for(auto p=m_mapPrepared.begin(); p!=m_mapPrepared.end(); )
+      if(p->second.m_bReady && !p->second.m_bTaken && !p->second.m_bDecoding)
+        p = m_mapPrepared.erase(p);
+      else ++p;
+  }
+
+  size_t changed = 0;
+
+  for(size_t i=0; i<m_vSprites.size(); i++){
+    LSpriteInfo& s = m_vSprites[i];
+    if(s.m_nTexture < 0)continue;
+
+    std::string path;
+    const LXmlElement* e = FindSprite(s.m_strName.c_str(), path);
+    if(e == nullptr)continue;
+
+    const auto found = m_mapTextures.find(path);
+
+    if(found == m_mapTextures.end() || found->second != s.m_nTexture){ //another image
+      const std::string name = s.m_strName;
+      Unload((eSprite)i);
+      Load((eSprite)i, name.c_str());
+      changed++;
+    } //if
+
+    else{
+      const std::vector<int> frames = s.m_vFrames;
+      SetFrames(s, e);
+      changed += s.m_vFrames != frames;
+    } //else
+  } //for
+
+  return changed;
+} //RefreshSprites
+
+/// Start a frame.
+
+void LSpriteRenderer::BeginFrame(){
+  m_vCommands.clear();
+  m_nDraws = 0;
+  m_nTextDraws = 0;
+  m_nTextureSwitches = 0;
+} //BeginFrame
+
+/// Record a draw. Texture coordinates are found by mapping pixel centers
+/// back into the sprite's frame.
+/// \param tex Texture.
+/// \param frame Left, top, right and bottom of the frame in texels.
+/// \param x Screen x of the sprite's center, in pixels from the left.
+/// \param y Screen y of the sprite's center, in pixels from the top.
+/// \param xscale Horizontal scale.
+/// \param yscale Vertical scale.
+/// \param roll Counterclockwise rotation in radians.
+/// \param color Color multipliers, premultiplied.
+
+void LSpriteRenderer::Submit(const LImage* tex, const int* frame, float x, float y,
+  float xscale, float yscale, float roll, const float* color)
+{
+  if(xscale == 0.0f || yscale == 0.0f || color[3] <= 0.0f)return;
+
+  const float c = cosf(roll), s = sinf(roll);
+  const float w = (float)(frame[2] - frame[0]), h = (float)(frame[3] - frame[1]);
+  const float hw = 0.5f*w*fabsf(xscale), hh = 0.5f*h*fabsf(yscale);
+
+  float left = x, right = x, top = y, bottom = y;
+
+  for(int i=0; i<4; i++){ //corners, rotated
+    const float lx = i & 1? hw: -hw, ly = i & 2? hh: -hh;
+    const float px = x + c*lx - s*ly, py = y - (s*lx + c*ly);
+    left = std::min(left, px); right = std::max(right, px);
+    top = std::min(top, py); bottom = std::max(bottom, py);
+  } //for
+
+  LDrawCommand cmd;
+  cmd.m_pBounds[0] = std::max(0, (int)floorf(left));
+  cmd.m_pBounds[1] = std::max(0, (int)floorf(top));
+  cmd.m_pBounds[2] = std::min(m_nWinWidth, (int)ceilf(right));
+  cmd.m_pBounds[3] = std::min(m_nWinHeight, (int)ceilf(bottom));
+
+  if(cmd.m_pBounds[0] >= cmd.m_pBounds[2] || cmd.m_pBounds[1] >= cmd.m_pBounds[3])
+    return;
+
+  cmd.m_pTexture = tex;
+  memcpy(cmd.m_pFrame, frame, sizeof(cmd.m_pFrame));
+  memcpy(cmd.m_pColor, color, sizeof(cmd.m_pColor));
+
+  //u = uc + lx/xscale and v = vc - ly/yscale, where (lx, ly) is the pixel
+  //center relative to the sprite center, y up, rotated back by roll
+
+  const float uc = frame[0] + 0.5f*w, vc = frame[1] + 0.5f*h;
+  const float dx = 0.5f - x, dy = y - 0.5f;
+
+  cmd.m_fDuDx = c/xscale;
+  cmd.m_fDuDy = -s/xscale;
+  cmd.m_fDvDx = s/yscale;
+  cmd.m_fDvDy = c/yscale;
+  cmd.m_fU = uc + (c*dx + s*dy)/xscale;
+  cmd.m_fV = vc - (c*dy - s*dx)/yscale;
+
+  m_vCommands.push_back(cmd);
+} //Submit
+
+/// Draw a sprite at a position, unscaled.
+/// \param t Sprite type.
+/// \param pos Position of the center, y up.
+
+void LSpriteRenderer::Draw(eSprite t, const Vector2& pos){
+  LSpriteDesc2D desc;
+  desc.m_nSpriteIndex = (UINT)t;
+  desc.m_vPos = pos;
+  Draw(&desc);
+} //Draw
+
+/// Draw a sprite.
+/// \param desc Sprite descriptor.
+
+void LSpriteRenderer::Draw(const LSpriteDesc2D* desc){
+  m_nDraws++;
+
+  if(desc->m_nSpriteIndex >= m_vSprites.size())return;
+  const LSpriteInfo& s = m_vSprites[desc->m_nSpriteIndex];
+  if(s.m_nTexture < 0)return;
+
+  const size_t frame = desc->m_nCurrentFrame % (s.m_vFrames.size()/4);
+  const Vector4& tint = desc->m_f4Tint;
+  const float a = tint.w*desc->m_fAlpha;
+  const float color[4] = {tint.x*a, tint.y*a, tint.z*a, a};
+
+  Submit(&m_vTextures[s.m_nTexture], &s.m_vFrames[4*frame],
+    desc->m_vPos.x, m_nWinHeight - desc->m_vPos.y,
+    desc->m_fXScale, desc->m_fYScale, desc->m_fRoll, color);
+} //Draw
+
+/// Draw a line by stretching a sprite from one point to another.
+/// \param t Sprite index of the line sprite.
+/// \param p0 One end, y up.
+/// \param p1 Other end, y up.
+
+void LSpriteRenderer::DrawLine(UINT t, const Vector2& p0, const Vector2& p1){
+  m_nDraws++;
+
+  if(t >= m_vSprites.size() || m_vSprites[t].m_nTexture < 0)return;
+  const LSpriteInfo& s = m_vSprites[t];
+
+  const Vector2 d = p1 - p0;
+  const Vector2 mid = p0 + 0.5f*d;
+  const float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+  Submit(&m_vTextures[s.m_nTexture], s.m_vFrames.data(), mid.x, m_nWinHeight - mid.y,
+    d.Length()/std::max(1, s.m_vFrames[2] - s.m_vFrames[0]), 1.0f, atan2f(d.y, d.x), color);
+} //DrawLine
+
+/// Draw text in the sprite font, laid out the way DirectXTK does it.
+/// \param text Text.
+/// \param pos Top left, in pixels from the top left of the window.
+/// \param color Text color.
+
+void LSpriteRenderer::DrawScreenText(const char* text, const Vector2& pos,
+  const XMVECTORF32& color)
+{
+  m_nTextDraws++;
+  if(m_vGlyphs.empty())return;
+
+  const float a = color.f[3];
+  const float multiplier[4] = {color.f[0]*a, color.f[1]*a, color.f[2]*a, a};
+  float x = 0.0f, y = 0.0f;
+
+  for(const char* p=text; *p; p++){
+    const uint32_t c = (unsigned char)*p;
+
+    if(c == '\r')continue;
+
+    if(c == '\n'){
+      x = 0.0f;
+      y += m_fLineSpacing;
+      continue;
+    } //if
+
+    const LGlyph& g = FindGlyph(c);
+    const int* r = g.m_pRect;
+    const float w = (float)(r[2] - r[0]), h = (float)(r[3] - r[1]);
+
+    x = std::max(0.0f, x + g.m_fXOffset);
+
+    if(c != ' ' && c != '\t')
+      Submit(&m_cFont, r, pos.x + x + 0.5f*w, pos.y + y + g.m_fYOffset + 0.5f*h,
+        1.0f, 1.0f, 0.0f, multiplier);
+
+    x += w + g.m_fXAdvance;
+  } //for
+} //DrawScreenText
+
+/// Narrow a span of pixels to those at which a linear function is in range.
+/// \param p Function value at pixel 0.
+/// \param dp Change per pixel.
+/// \param lo Smallest value, inclusive.
+/// \param hi Largest value, exclusive.
+/// \param x0 [in, out] First pixel.
+/// \param x1 [in, out] One past the last pixel.
+
+static void ClipSpan(float p, float dp, float lo, float hi, int& x0, int& x1){
+  if(dp == 0.0f){
+    if(p < lo || p >= hi)x1 = x0;
+    return;
+  } //if
+
+  const float t0 = (lo - p)/dp, t1 = (hi - p)/dp;
+
+  if(dp > 0.0f){
+    x0 = std::max(x0, (int)ceilf(t0));
+    x1 = std::min(x1, (int)ceilf(t1));
+  } //if
+
+  else{
+    x0 = std::max(x0, (int)floorf(t1) + 1);
+    x1 = std::min(x1, (int)floorf(t0) + 1);
+  } //else
+} //ClipSpan
+
+/// Clear a band and draw every draw binned into it, in order.
+/// \param b Band index.
+
+void LSpriteRenderer::DrawBand(size_t b){
+  const int y0 = (int)b*BandHeight;
+  const int y1 = std::min(m_nWinHeight, y0 + BandHeight);
+  uint32_t* pixels = m_vFrameBuffer.data();
+
+  std::fill(pixels + (size_t)y0*m_nWinWidth, pixels + (size_t)y1*m_nWinWidth, 0xFF000000);
+
+  for(const uint32_t i: m_vBands[b]){
+    const LDrawCommand& cmd = m_vCommands[i];
+    const int* f = cmd.m_pFrame;
+
+    LSpan span;
+    span.m_pTexels = cmd.m_pTexture->m_vPixels.data();
+    span.m_nPitch = cmd.m_pTexture->m_nWidth;
+    span.m_nMinU = f[0]; span.m_nMaxU = f[2] - 1;
+    span.m_nMinV = f[1]; span.m_nMaxV = f[3] - 1;
+    span.m_fDu = cmd.m_fDuDx;
+    span.m_fDv = cmd.m_fDvDx;
+    memcpy(span.m_pColor, cmd.m_pColor, sizeof(span.m_pColor));
+
+    const int top = std::max(y0, cmd.m_pBounds[1]);
+    const int bottom = std::min(y1, cmd.m_pBounds[3]);
+
+    for(int y=top; y<bottom; y++){
+      const float u = cmd.m_fU + cmd.m_fDuDy*y;
+      const float v = cmd.m_fV + cmd.m_fDvDy*y;
+      int x0 = cmd.m_pBounds[0], x1 = cmd.m_pBounds[2];
+
+      ClipSpan(u, cmd.m_fDuDx, (float)f[0], (float)f[2], x0, x1);
+      ClipSpan(v, cmd.m_fDvDx, (float)f[1], (float)f[3], x0, x1);
+      if(x0 >= x1)continue;
+
+      span.m_fU = u + cmd.m_fDuDx*x0;
+      span.m_fV = v + cmd.m_fDvDx*x0;
+      m_pSpan(span, pixels + (size_t)y*m_nWinWidth + x0, x1 - x0);
+    } //for
+  } //for
+} //DrawBand
+
+/// Draw bands until every band has been taken by some thread.
+
+void LSpriteRenderer::DrawBands(){
+  for(size_t b=m_nNextBand++; b<m_vBands.size(); b=m_nNextBand++)
+    DrawBand(b);
+} //DrawBands
+
+/// Worker thread body. Waits for a frame, helps draw it, and says so.
+
+void LSpriteRenderer::WorkerLoop(){
+  size_t seen = 0;
+
+  for(;;){
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cvStart.wait(lock, [&](){return m_bStop || m_nGeneration != seen;});
+      if(m_bStop)return;
+      seen = m_nGeneration;
+    }
+
+    DrawBands();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(--m_nBusy == 0)m_cvDone.notify_one();
+  } //for
+} //WorkerLoop
+
+/// Start worker threads.
+/// \param n Number of threads.
+
+void LSpriteRenderer::StartWorkers(size_t n){
+  m_bStop = false;
+
+  for(size_t i=0; i<n; i++)
+    m_vWorkers.emplace_back(&LSpriteRenderer::WorkerLoop, this);
+} //StartWorkers
+
+/// Stop and join the worker threads.
+
+void LSpriteRenderer::StopWorkers(){
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bStop = true;
+  }
+
+  m_cvStart.notify_all();
+
+  for(std::thread& t: m_vWorkers)
+    t.join();
+
+  m_vWorkers.clear();
+} //StopWorkers
+
+/// Set the number of threads that draw, including the one that ends the
+/// frame.
+/// \param n Number of threads, at least 1.
+
+void LSpriteRenderer::SetThreadCount(size_t n){
+  StopWorkers();
+  StartWorkers(std::max<size_t>(n, 1) - 1);
+} //SetThreadCount
+
+/// Choose between the SIMD and the portable inner loop.
+/// \param simd true to use SIMD if the CPU has it.
+
+void LSpriteRenderer::SetSimd(bool simd){
+  m_pSpan = simd? GetSpanFunction(): GetScalarSpanFunction();
+} //SetSimd
+
+/// Bin the frame's draws into bands and draw the bands on every thread,
+/// then save a screenshot if one was asked for. Texture switches are
+/// counted in draw order, as a GPU sprite batch would have to flush on
+/// them, the first draw included. With drawing turned off by `SetRaster()`
+/// only the counting is done.
+
+void LSpriteRenderer::EndFrame(){
+  const LImage* texture = nullptr;
+
+  for(const LDrawCommand& cmd: m_vCommands)
+    if(cmd.m_pTexture != texture){
+      texture = cmd.m_pTexture;
+      m_nTextureSwitches++;
+    } //if
+
+  if(!m_bRaster)return;
+
+  for(std::vector<uint32_t>& band: m_vBands)
+    band.clear();
+
+  for(uint32_t i=0; i<(uint32_t)m_vCommands.size(); i++){
+    const int* r = m_vCommands[i].m_pBounds;
+
+    for(int b=r[1]/BandHeight; b<=(r[3] - 1)/BandHeight; b++)
+      m_vBands[b].push_back(i);
+  } //for
+
+  m_nNextBand = 0;
+
+  if(!m_vWorkers.empty()){
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_nBusy = m_vWorkers.size();
+      m_nGeneration++;
+    }
+
+    m_cvStart.notify_all();
+  } //if
+
+  DrawBands();
+
+  if(!m_vWorkers.empty()){
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cvDone.wait(lock, [&](){return m_nBusy == 0;});
+  } //if
+
+  if(!m_strScreenshot.empty()){
+    if(!SaveScreenshot(m_strScreenshot.c_str()))
+      fprintf(stderr, "cannot write %s\n", m_strScreenshot.c_str());
+
+    m_strScreenshot.clear();
+  } //if
+} //EndFrame
+
+/// Save the last frame drawn to a PNG file.
+/// \param path File name.
+/// \return true if the file was written.
+
+bool LSpriteRenderer::SaveScreenshot(const char* path) const{
+  return SavePng(path, m_vFrameBuffer.data(), m_nWinWidth, m_nWinHeight);
+} //SaveScreenshot
+
+/// Ask for the next frame drawn to be saved to a PNG file.
+/// \param path File name.
+
+void LSpriteRenderer::RequestScreenshot(const std::string& path){
+  m_strScreenshot = path;
+} //RequestScreenshot
+
+/// Get the width of a sprite's first frame.
+/// \param t Sprite index.
+/// \return Width in pixels, or 0 if the sprite is not loaded.
+
+UINT LSpriteRenderer::GetWidth(UINT t) const{
+  if(t >= m_vSprites.size() || m_vSprites[t].m_vFrames.empty())return 0;
+  const std::vector<int>& f = m_vSprites[t].m_vFrames;
+  return (UINT)(f[2] - f[0]);
+} //GetWidth
+
+/// Get the height of a sprite's first frame.
+/// \param t Sprite index.
+/// \return Height in pixels, or 0 if the sprite is not loaded.
+
+UINT LSpriteRenderer::GetHeight(UINT t) const{
+  if(t >= m_vSprites.size() || m_vSprites[t].m_vFrames.empty())return 0;
+  const std::vector<int>& f = m_vSprites[t].m_vFrames;
+  return (UINT)(f[3] - f[1]);
+} //GetHeight
+
+/// Get the number of frames in a sprite.
+/// \param t Sprite index.
+/// \return Number of frames, at least 1.
+
+UINT LSpriteRenderer::GetNumFrames(UINT t) const{
+  if(t >= m_vSprites.size())return 1;
+  return (UINT)std::max<size_t>(1, m_vSprites[t].m_vFrames.size()/4);
+} //GetNumFrames
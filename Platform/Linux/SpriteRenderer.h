@@ -0,0 +1,180 @@
+/// \file SpriteRenderer.h
+/// \brief Interface for the sprite renderer LSpriteRenderer.
+
+#ifndef __L4RC_PLATFORM_SPRITERENDERER_H__
+#define __L4RC_PLATFORM_SPRITERENDERER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Png.h"
+#include "Raster.h"
+#include "Settings.h"
+#include "SpriteDesc.h"
+
+/// \brief A sprite's texture and frames.
+
+struct LSpriteInfo{
+  int m_nTexture = -1; ///< Texture index, -1 if not loaded.
+  std::string m_strName; ///< Name in the settings file, empty if not loaded.
+  std::vector<int> m_vFrames; ///< Left, top, right and bottom of each frame, right and bottom exclusive.
+}; //LSpriteInfo
+
+/// \brief A texture decoded ahead of time by `LSpriteRenderer::Prepare()`.
+
+struct LPreparedTexture{
+  LImage m_cImage; ///< Image, premultiplied.
+  bool m_bDecoding = false; ///< The image is being decoded.
+  bool m_bReady = false; ///< The image has been decoded.
+  bool m_bTaken = false; ///< The texture has been loaded.
+}; //LPreparedTexture
+
+/// \brief A character in a sprite font.
+
+struct LGlyph{
+  uint32_t m_nChar; ///< Character code.
+  int m_pRect[4]; ///< Left, top, right and bottom in the font texture.
+  float m_fXOffset; ///< Space before the character.
+  float m_fYOffset; ///< Space above the character.
+  float m_fXAdvance; ///< Space after the character, added to its width.
+}; //LGlyph
+
+/// \brief A sprite to be drawn.
+///
+/// The sprite covers the pixels whose centers map into its frame. Texture
+/// coordinates are linear in pixel coordinates.
+
+struct LDrawCommand{
+  const LImage* m_pTexture; ///< Texture.
+  int m_pFrame[4]; ///< Left, top, right and bottom of the frame in texels.
+  int m_pBounds[4]; ///< Left, top, right and bottom of the pixels it may cover.
+  float m_fU; ///< Texture u at the center of pixel (0, 0).
+  float m_fV; ///< Texture v at the center of pixel (0, 0).
+  float m_fDuDx; ///< Change in u per pixel right.
+  float m_fDuDy; ///< Change in u per pixel down.
+  float m_fDvDx; ///< Change in v per pixel right.
+  float m_fDvDy; ///< Change in v per pixel down.
+  float m_pColor[4]; ///< Color multipliers, premultiplied.
+}; //LDrawCommand
+
+/// \brief The sprite renderer.
+///
+/// A software renderer that draws into a framebuffer in memory instead of
+/// to a window. Sprites and the font are looked up in the game settings
+/// file and their images decoded into textures, premultiplied by alpha.
+///
+/// Draw calls are recorded and drawn in order at the end of the frame.
+/// The screen is cut into bands of rows, each draw is binned into the bands
+/// that it covers, and the bands are drawn in parallel by a pool of threads,
+/// so that each band stays in cache while every sprite in it is drawn.
+/// Sprites are scaled and rotated with bilinear filtering, eight pixels at a
+/// time with AVX2 where the CPU has it. Textures may be decoded ahead of
+/// loading on other threads, see `Prepare()`; everything else is for the
+/// main thread only. Images and settings changed while the game runs can be
+/// read again in place, see `ReloadImage()` and `RefreshSprites()`.
+
+class LSpriteRenderer: public LSettings{
+  private:
+    static const int BandHeight = 32; ///< Rows per band.
+
+    std::vector<LImage> m_vTextures; ///< Textures, empty where unloaded.
+    std::vector<int> m_vFreeTextures; ///< Indices of unloaded textures, for reuse.
+    size_t m_nTextureBytes = 0; ///< Memory used by textures.
+    std::map<std::string, int> m_mapTextures; ///< Texture index by file name.
+    std::vector<LSpriteInfo> m_vSprites; ///< Sprites by index.
+
+    LImage m_cFont; ///< Font texture.
+    std::vector<LGlyph> m_vGlyphs; ///< Font glyphs, in character order.
+    float m_fLineSpacing = 0.0f; ///< Distance between lines of text.
+    size_t m_nDefaultGlyph = 0; ///< Glyph for characters not in the font.
+
+    std::vector<LDrawCommand> m_vCommands; ///< This frame's draws.
+    std::vector<std::vector<uint32_t>> m_vBands; ///< Draws binned by band.
+    std::vector<uint32_t> m_vFrameBuffer; ///< Pixels, red in the low byte, top row first.
+    LSpanFunction m_pSpan; ///< Inner loop.
+
+    size_t m_nDraws = 0; ///< Sprites drawn this frame.
+    size_t m_nTextDraws = 0; ///< Strings drawn this frame.
+    size_t m_nTextureSwitches = 0; ///< Draws this frame that change texture.
+    bool m_bRaster = true; ///< Draw the frame's pixels, not just count its draws.
+
+    std::vector<std::thread> m_vWorkers; ///< Threads other than the caller's.
+    std::mutex m_mutex; ///< Guards the thread pool state.
+    std::condition_variable m_cvStart; ///< Signals a frame to draw.
+    std::condition_variable m_cvDone; ///< Signals a worker done.
+    size_t m_nGeneration = 0; ///< Number of frames handed to the workers.
+    size_t m_nBusy = 0; ///< Number of workers still drawing.
+    bool m_bStop = false; ///< Tell the workers to quit.
+    std::atomic<size_t> m_nNextBand{0}; ///< Next band to draw.
+
+    std::map<std::string, LPreparedTexture> m_mapPrepared; ///< Textures decoded ahead, by file name.
+    std::mutex m_mutexPrepared; ///< Guards the textures decoded ahead.
+    std::condition_variable m_cvPrepared; ///< Signals a texture decoded ahead.
+
+    static std::string m_strScreenshot; ///< File to save the next frame to.
+
+    const LXmlElement* FindSprite(const char* name, std::string& path) const; ///< Look up a sprite.
+    int LoadTexture(const std::string& path); ///< Load a texture.
+    void SetFrames(LSpriteInfo& s, const LXmlElement* e) const; ///< Read a sprite's frames.
+    bool LoadFont(const std::string& path); ///< Load the sprite font.
+    const LGlyph& FindGlyph(uint32_t c) const; ///< Look up a character.
+
+    void Submit(const LImage* tex, const int* frame, float x, float y,
+      float xscale, float yscale, float roll, const float* color); ///< Record a draw.
+
+    void DrawBands(); ///< Draw bands until there are none left.
+    void DrawBand(size_t b); ///< Draw one band.
+    void WorkerLoop(); ///< Worker thread body.
+    void StartWorkers(size_t n); ///< Start worker threads.
+    void StopWorkers(); ///< Stop worker threads.
+
+  public:
+    LSpriteRenderer(eSpriteMode mode); ///< Constructor.
+    ~LSpriteRenderer(); ///< Destructor.
+
+    LSpriteRenderer(const LSpriteRenderer&) = delete; ///< No copying.
+    LSpriteRenderer& operator=(const LSpriteRenderer&) = delete; ///< No copying.
+
+    void Initialize(eSprite n); ///< Make room for sprites.
+    void Load(eSprite t, const char* name); ///< Load a sprite.
+    bool Prepare(const char* name); ///< Decode a sprite's texture, on any thread.
+    void Unload(eSprite t); ///< Unload a sprite.
+    bool ReloadImage(const std::string& path); ///< Read an image file again.
+    size_t RefreshSprites(); ///< Look the loaded sprites up in the settings again.
+    void BeginResourceUpload(){} ///< Start loading sprites.
+    void EndResourceUpload(){} ///< Finish loading sprites.
+
+    void BeginFrame(); ///< Start a frame.
+    void EndFrame(); ///< Draw the frame.
+
+    void Draw(eSprite t, const Vector2& pos); ///< Draw a sprite.
+    void Draw(const LSpriteDesc2D* desc); ///< Draw a sprite.
+    void DrawLine(UINT t, const Vector2& p0, const Vector2& p1); ///< Draw a line.
+    void DrawScreenText(const char* text, const Vector2& pos,
+      const XMVECTORF32& color=Colors::Black); ///< Draw text.
+
+    UINT GetWidth(UINT t) const; ///< Get sprite width.
+    UINT GetHeight(UINT t) const; ///< Get sprite height.
+    UINT GetNumFrames(UINT t) const; ///< Get number of frames.
+    UINT GetWidth(eSprite t) const { return GetWidth((UINT)t); } ///< Get sprite width.
+    UINT GetHeight(eSprite t) const { return GetHeight((UINT)t); } ///< Get sprite height.
+    UINT GetNumFrames(eSprite t) const { return GetNumFrames((UINT)t); } ///< Get number of frames.
+
+    void SetThreadCount(size_t n); ///< Set the number of drawing threads.
+    void SetSimd(bool simd); ///< Use or do not use SIMD.
+    void SetRaster(bool raster){ m_bRaster = raster; } ///< Draw pixels or only count draws.
+    bool SaveScreenshot(const char* path) const; ///< Save the last frame.
+    static void RequestScreenshot(const std::string& path); ///< Save the next frame.
+
+    const uint32_t* GetFrameBuffer() const { return m_vFrameBuffer.data(); } ///< Get the pixels.
+    size_t GetDrawCount() const { return m_nDraws; } ///< Get sprites drawn this frame.
+    size_t GetTextDrawCount() const { return m_nTextDraws; } ///< Get strings drawn this frame.
+    size_t GetTextureSwitchCount() const { return m_nTextureSwitches; } ///< Get texture changes this frame.
+    size_t GetTextureBytes() const { return m_nTextureBytes; } ///< Get memory used by textures.
+}; //LSpriteRenderer
+
+#endif //__L4RC_PLATFORM_SPRITERENDERER_H__
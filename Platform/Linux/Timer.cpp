@@ -0,0 +1,31 @@
+/// \file Timer.cpp
+/// \brief Code for the game timer LTimer.
+
+#include "Timer.h"
+
+/// Start the frame rate interval.
+
+LTimer::LTimer(){
+  m_tLast = std::chrono::steady_clock::now();
+} //constructor
+
+/// Advance game time by one step, then call a function that moves things
+/// along. The frame rate is updated once a second.
+/// \param f Function to call.
+
+void LTimer::Tick(const std::function<void()>& f){
+  m_fTime += m_fFrameTime;
+  m_nFrames++;
+  m_nIntervalFrames++;
+
+  const auto now = std::chrono::steady_clock::now();
+  const double t = std::chrono::duration<double>(now - m_tLast).count();
+
+  if(t >= 1.0){
+    m_nFPS = (int)(m_nIntervalFrames/t + 0.5);
+    m_nIntervalFrames = 0;
+    m_tLast = now;
+  } //if
+
+  f();
+} //Tick
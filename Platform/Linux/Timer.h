@@ -0,0 +1,38 @@
+/// \file Timer.h
+/// \brief Interface for the game timer LTimer.
+
+#ifndef __L4RC_PLATFORM_TIMER_H__
+#define __L4RC_PLATFORM_TIMER_H__
+
+#include <chrono>
+#include <functional>
+
+/// \brief The game timer.
+///
+/// Game time advances by a fixed step each frame, so that a scripted run
+/// plays the same way however fast the machine is. The frame rate is
+/// measured in real time.
+
+class LTimer{
+  private:
+    float m_fFrameTime = 1.0f/60.0f; ///< Game time per frame in seconds.
+    float m_fTime = 0.0f; ///< Game time in seconds.
+    size_t m_nFrames = 0; ///< Number of frames ticked.
+
+    std::chrono::steady_clock::time_point m_tLast; ///< Start of the FPS interval.
+    size_t m_nIntervalFrames = 0; ///< Frames in the FPS interval.
+    int m_nFPS = 0; ///< Frames per second in the last interval.
+
+  public:
+    LTimer(); ///< Constructor.
+
+    void Tick(const std::function<void()>& f); ///< Advance a frame.
+    void SetFrameTime(float t){m_fFrameTime = t;} ///< Set the game time step.
+
+    float GetFrameTime() const { return m_fFrameTime; } ///< Get game time per frame.
+    float GetTime() const { return m_fTime; } ///< Get game time.
+    size_t GetFrames() const { return m_nFrames; } ///< Get number of frames.
+    int GetFPS() const { return m_nFPS; } ///< Get frames per second.
+}; //LTimer
+
+#endif //__L4RC_PLATFORM_TIMER_H__
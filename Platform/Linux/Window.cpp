@@ -0,0 +1,210 @@
+/// \file Window.cpp
+/// \brief Code for the headless window LWindow.
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "Window.h"
+#include "ComponentIncludes.h"
+#include "SpriteRenderer.h"
+
+HWND LWindow::m_Hwnd = nullptr;
+POINT LWindow::m_sCursor;
+bool LWindow::m_bQuit = false;
+int LWindow::m_nExitCode = 0;
+
+/// \brief A key name in input scripts.
+
+struct KeyName{
+  const char* m_pName; ///< Name.
+  WPARAM m_nKey; ///< Virtual key code.
+}; //KeyName
+
+/// Key names other than letters and digits.
+
+static const KeyName g_pKeyName[] = {
+  {"LBUTTON", VK_LBUTTON}, {"RBUTTON", VK_RBUTTON}, {"BACK", VK_BACK},
+  {"TAB", VK_TAB}, {"RETURN", VK_RETURN}, {"SHIFT", VK_SHIFT},
+  {"ESCAPE", VK_ESCAPE}, {"SPACE", VK_SPACE}, {"LEFT", VK_LEFT},
+  {"UP", VK_UP}, {"RIGHT", VK_RIGHT}, {"DOWN", VK_DOWN},
+  {"F1", VK_F1}, {"F2", VK_F2}, {"F3", VK_F3}, {"F4", VK_F4},
+  {"F5", VK_F5}, {"F6", VK_F6}, {"F7", VK_F7}, {"F8", VK_F8},
+  {"F9", VK_F9}, {"F10", VK_F10}, {"F11", VK_F11}, {"F12", VK_F12},
+}; //g_pKeyName
+
+/// Look up a key name.
+/// \param name Key name, or a single letter or digit.
+/// \param k [out] Virtual key code.
+/// \return true if the name is a key.
+
+static bool ParseKey(const std::string& name, WPARAM& k){
+  if(name.size() == 1 && isalnum((unsigned char)name[0])){
+    k = (WPARAM)toupper((unsigned char)name[0]);
+    return true;
+  } //if
+
+  for(const KeyName& key: g_pKeyName)
+    if(name == key.m_pName){
+      k = key.m_nKey;
+      return true;
+    } //if
+
+  return false;
+} //ParseKey
+
+/// Read an input script. Events are sorted by frame, keeping file order
+/// within a frame.
+/// \param path File name.
+/// \param v [out] Events.
+/// \return true if the script was read, false if it cannot be read or has
+/// a bad line, which is reported.
+
+bool LWindow::LoadScript(const std::string& path, std::vector<LInputEvent>& v){
+  std::ifstream input(path);
+
+  if(!input){
+    fprintf(stderr, "cannot read %s\n", path.c_str());
+    return false;
+  } //if
+
+  std::string line;
+
+  for(size_t n=1; std::getline(input, line); n++){
+    const size_t start = line.find_first_not_of(" \t\r");
+    if(start == std::string::npos || line[start] == '#')continue;
+
+    std::istringstream s(line);
+    std::string action, key;
+    LInputEvent e;
+
+    bool ok = (bool)(s >> e.m_nFrame >> action);
+
+    if(!ok);
+    else if(action == "press" || action == "release" || action == "key"){
+      e.m_eAction = action == "press"? LInputEvent::eAction::Press:
+        action == "release"? LInputEvent::eAction::Release: LInputEvent::eAction::Tap;
+      ok = s >> key && ParseKey(key, e.m_nKey);
+    } //else if
+
+    else if(action == "move" || action == "click"){
+      e.m_eAction = action == "move"? LInputEvent::eAction::Move: LInputEvent::eAction::Click;
+      ok = (bool)(s >> e.m_sPos.x >> e.m_sPos.y);
+    } //else if
+
+    else if(action == "shot"){
+      e.m_eAction = LInputEvent::eAction::Screenshot;
+      ok = (bool)(s >> e.m_strFile);
+    } //else if
+
+    else if(action == "quit")
+      e.m_eAction = LInputEvent::eAction::Quit;
+
+    else ok = false;
+
+    if(!ok){
+      fprintf(stderr, "%s(%zu): bad input event\n", path.c_str(), n);
+      return false;
+    } //if
+
+    v.push_back(e);
+  } //for
+
+  std::stable_sort(v.begin(), v.end(), [](const LInputEvent& a, const LInputEvent& b){
+    return a.m_nFrame < b.m_nFrame;});
+
+  return true;
+} //LoadScript
+
+/// Run the game. Keys pressed for one frame by a `key` or `click` event are
+/// released before the next frame's events.
+/// \param desc How to run.
+/// \param init Function to initialize the game.
+/// \param process Function to process a frame.
+/// \param release Function to release the game.
+/// \return The exit code the game asked for, or 1 if it could not start.
+
+int LWindow::Run(const LHeadlessDesc& desc, const std::function<void()>& init,
+  const std::function<void()>& process, const std::function<void()>& release)
+{
+  std::vector<LInputEvent> script;
+
+  if(!LSettings::LoadSettings() ||
+    (!desc.m_strScript.empty() && !LoadScript(desc.m_strScript, script)))
+    return 1;
+
+  LComponent::m_pTimer = new LTimer;
+  LComponent::m_pTimer->SetFrameTime(desc.m_fFrameTime);
+  LComponent::m_pKeyboard = new LKeyboard;
+  LComponent::m_pAudio = new LSound;
+  LComponent::m_pAudio->SetOutput(desc.m_strAudio, desc.m_fFrameTime);
+  LKeyboard* keyboard = LComponent::m_pKeyboard;
+
+  m_bQuit = false;
+  m_nExitCode = 0;
+  init();
+
+  size_t next = 0; //next script event
+  std::vector<WPARAM> tapped; //keys to release before the next frame
+
+  for(size_t frame=0; !m_bQuit && (desc.m_nFrames == 0 || frame < desc.m_nFrames); frame++){
+    for(WPARAM k: tapped)
+      keyboard->Release(k);
+
+    tapped.clear();
+
+    for(; next < script.size() && script[next].m_nFrame <= frame; next++){
+      const LInputEvent& e = script[next];
+
+      switch(e.m_eAction){
+        case LInputEvent::eAction::Press: keyboard->Press(e.m_nKey); break;
+        case LInputEvent::eAction::Release: keyboard->Release(e.m_nKey); break;
+        case LInputEvent::eAction::Move: m_sCursor = e.m_sPos; break;
+        case LInputEvent::eAction::Screenshot: LSpriteRenderer::RequestScreenshot(e.m_strFile); break;
+        case LInputEvent::eAction::Quit: m_bQuit = true; break;
+
+        case LInputEvent::eAction::Tap:
+          keyboard->Press(e.m_nKey);
+          tapped.push_back(e.m_nKey);
+        break;
+
+        case LInputEvent::eAction::Click:
+          m_sCursor = e.m_sPos;
+          keyboard->Press(VK_LBUTTON);
+          tapped.push_back(VK_LBUTTON);
+        break;
+      } //switch
+    } //for
+
+    if(!m_bQuit)process();
+  } //for
+
+  release();
+
+  delete LComponent::m_pAudio;
+  delete LComponent::m_pKeyboard;
+  delete LComponent::m_pTimer;
+  LComponent::m_pAudio = nullptr;
+  LComponent::m_pKeyboard = nullptr;
+  LComponent::m_pTimer = nullptr;
+  LSettings::ReleaseSettings();
+
+  return m_nExitCode;
+} //Run
+
+/// Get the mouse position.
+/// \param p [out] Mouse position in window coordinates.
+
+void LWindow::GetCursor(POINT& p){
+  p = m_sCursor;
+} //GetCursor
+
+/// End the game after the current frame.
+/// \param code Exit code.
+
+void LWindow::Quit(int code){
+  m_bQuit = true;
+  m_nExitCode = code;
+} //Quit
@@ -0,0 +1,77 @@
+/// \file Window.h
+/// \brief Interface for the headless window LWindow.
+
+#ifndef __L4RC_PLATFORM_WINDOW_H__
+#define __L4RC_PLATFORM_WINDOW_H__
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Defines.h"
+
+/// \brief How to run the game without a window.
+
+struct LHeadlessDesc{
+  size_t m_nFrames = 0; ///< Number of frames to run, 0 to run until the game quits.
+  std::string m_strScript; ///< Input script file, empty for no input.
+  float m_fFrameTime = 1.0f/60.0f; ///< Game time per frame in seconds.
+  std::string m_strAudio; ///< WAV file to write the game's sound to, empty for none.
+}; //LHeadlessDesc
+
+/// \brief A scripted input event.
+
+struct LInputEvent{
+  /// \brief What the event does.
+
+  enum class eAction{
+    Press, Release, Tap, Move, Click, Screenshot, Quit
+  }; //eAction
+
+  size_t m_nFrame = 0; ///< Frame the event happens at.
+  eAction m_eAction = eAction::Tap; ///< What the event does.
+  WPARAM m_nKey = 0; ///< Virtual key code.
+  POINT m_sPos; ///< Mouse position.
+  std::string m_strFile; ///< Screenshot file name.
+}; //LInputEvent
+
+/// \brief The headless window.
+///
+/// Stands in for the game window on platforms without one. It creates the
+/// engine components, then calls the game's initialize function once, its
+/// process function once a frame and its release function at the end, with
+/// no real time delay between frames. Keyboard and mouse input comes from an
+/// input script, a text file with one event per line, the frame number
+/// followed by one of
+///
+///     press key      hold a key down
+///     release key    let a key up
+///     key key        press a key for one frame
+///     move x y       move the mouse to window coordinates
+///     click x y      move the mouse and press the left button for one frame
+///     shot file      save the frame to a PNG file
+///     quit           end the game
+///
+/// Keys are names such as `F1`, `RETURN`, `BACK` and `LBUTTON`, or a letter
+/// or digit. Lines starting with `#` are comments.
+
+class LWindow{
+  protected:
+    static HWND m_Hwnd; ///< Window handle, always null.
+
+  private:
+    static POINT m_sCursor; ///< Mouse position in window coordinates.
+    static bool m_bQuit; ///< The game asked to quit.
+    static int m_nExitCode; ///< Exit code the game asked for.
+
+    static bool LoadScript(const std::string& path, std::vector<LInputEvent>& v); ///< Read an input script.
+
+  public:
+    int Run(const LHeadlessDesc& desc, const std::function<void()>& init,
+      const std::function<void()>& process, const std::function<void()>& release); ///< Run the game.
+
+    static void GetCursor(POINT& p); ///< Get the mouse position.
+    static void Quit(int code); ///< End the game after this frame.
+}; //LWindow
+
+#endif //__L4RC_PLATFORM_WINDOW_H__
@@ -0,0 +1,162 @@
+/// \file Xml.cpp
+/// \brief Code for the XML element LXmlElement.
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "Xml.h"
+
+/// Skip white space, comments, declarations and text up to the next tag.
+/// \param p [in, out] Read position.
+
+static void SkipToTag(const char*& p){
+  for(;;){
+    while(*p && *p != '<')p++;
+
+    if(strncmp(p, "<!--", 4) == 0){
+      const char* end = strstr(p, "-->");
+      p = end? end + 3: p + strlen(p);
+    } //if
+
+    else if(p[0] == '<' && (p[1] == '?' || p[1] == '!')){
+      const char* end = strchr(p, '>');
+      p = end? end + 1: p + strlen(p);
+    } //else if
+
+    else return;
+  } //for
+} //SkipToTag
+
+/// Read a name, which ends at white space, `=`, `/` or `>`.
+/// \param p [in, out] Read position.
+/// \return The name.
+
+static std::string ReadName(const char*& p){
+  const char* start = p;
+  while(*p && !strchr(" \t\r\n=/>", *p))p++;
+  return std::string(start, p);
+} //ReadName
+
+/// Skip white space.
+/// \param p [in, out] Read position.
+
+static void SkipSpace(const char*& p){
+  while(*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')p++;
+} //SkipSpace
+
+/// Parse an element and its children.
+/// \param p [in, out] Read position, just after the opening `<`.
+/// \return true if the element is well formed.
+
+bool LXmlElement::Parse(const char*& p){
+  m_strName = ReadName(p);
+  if(m_strName.empty())return false;
+
+  for(;;){ //attributes
+    SkipSpace(p);
+
+    if(p[0] == '/' && p[1] == '>'){p += 2; return true;}
+    if(*p == '>'){p++; break;}
+
+    std::string name = ReadName(p);
+    SkipSpace(p);
+    if(name.empty() || *p++ != '=')return false;
+    SkipSpace(p);
+
+    const char quote = *p++;
+    if(quote != '"' && quote != '\'')return false;
+
+    const char* end = strchr(p, quote);
+    if(!end)return false;
+
+    m_vAttributes.emplace_back(std::move(name), std::string(p, end));
+    p = end + 1;
+  } //for
+
+  for(;;){ //children
+    SkipToTag(p);
+    if(!*p)return false;
+
+    if(p[1] == '/'){
+      p = strchr(p, '>');
+      if(!p)return false;
+      p++;
+      return true;
+    } //if
+
+    p++;
+    m_vChildren.emplace_back(new LXmlElement);
+    if(!m_vChildren.back()->Parse(p))return false;
+  } //for
+} //Parse
+
+/// Read an XML file into this element, which becomes its root element.
+/// \param path File name.
+/// \return true if the file was read and is well formed.
+
+bool LXmlElement::Load(const char* path){
+  std::ifstream input(path, std::ios::binary);
+  if(!input)return false;
+
+  std::stringstream buffer;
+  buffer << input.rdbuf();
+  const std::string text = buffer.str();
+
+  const char* p = text.c_str();
+  SkipToTag(p);
+  if(!*p)return false;
+
+  p++;
+  return Parse(p);
+} //Load
+
+/// Get the value of an attribute.
+/// \param name Attribute name.
+/// \return The value, or nullptr if there is no such attribute.
+
+const char* LXmlElement::GetAttribute(const char* name) const{
+  for(const auto& a: m_vAttributes)
+    if(a.first == name)
+      return a.second.c_str();
+
+  return nullptr;
+} //GetAttribute
+
+/// Get the value of an integer attribute.
+/// \param name Attribute name.
+/// \param value Value to return if there is no such attribute.
+/// \return The value.
+
+int LXmlElement::GetIntAttribute(const char* name, int value) const{
+  const char* s = GetAttribute(name);
+  return s? atoi(s): value;
+} //GetIntAttribute
+
+/// Get the first child element with a given tag name.
+/// \param name Tag name.
+/// \return The child, or nullptr if there is none.
+
+const LXmlElement* LXmlElement::GetChild(const char* name) const{
+  for(const auto& c: m_vChildren)
+    if(c->m_strName == name)
+      return c.get();
+
+  return nullptr;
+} //GetChild
+
+/// Find a child element by tag name and `name` attribute.
+/// \param tag Tag name.
+/// \param name Value of the `name` attribute.
+/// \return The child, or nullptr if there is none.
+
+const LXmlElement* LXmlElement::FindChild(const char* tag, const char* name) const{
+  for(const auto& c: m_vChildren)
+    if(c->m_strName == tag){
+      const char* s = c->GetAttribute("name");
+      if(s && strcmp(s, name) == 0)return c.get();
+    } //if
+
+  return nullptr;
+} //FindChild
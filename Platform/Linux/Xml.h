@@ -0,0 +1,44 @@
+/// \file Xml.h
+/// \brief Interface for the XML element LXmlElement.
+
+#ifndef __L4RC_PLATFORM_XML_H__
+#define __L4RC_PLATFORM_XML_H__
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// \brief An XML element.
+///
+/// A small XML reader for the game settings file, which is all elements and
+/// attributes. Text, comments and declarations are skipped and entities are
+/// not expanded.
+
+class LXmlElement{
+  private:
+    std::string m_strName; ///< Tag name.
+    std::vector<std::pair<std::string, std::string>> m_vAttributes; ///< Attributes in file order.
+    std::vector<std::unique_ptr<LXmlElement>> m_vChildren; ///< Child elements.
+
+    bool Parse(const char*& p); ///< Parse from after the opening `<`.
+
+  public:
+    bool Load(const char* path); ///< Read a file.
+
+    const std::string& GetName() const { return m_strName; } ///< Get tag name.
+    const char* GetAttribute(const char* name) const; ///< Get an attribute.
+    int GetIntAttribute(const char* name, int value) const; ///< Get an integer attribute.
+
+    const LXmlElement* GetChild(const char* name) const; ///< Get the first child with a name.
+    const LXmlElement* FindChild(const char* tag, const char* name) const; ///< Find a child by name attribute.
+
+    /// Get the child elements.
+    /// \return The children in file order.
+
+    const std::vector<std::unique_ptr<LXmlElement>>& GetChildren() const{
+      return m_vChildren;
+    } //GetChildren
+}; //LXmlElement
+
+#endif //__L4RC_PLATFORM_XML_H__
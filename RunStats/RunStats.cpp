@@ -0,0 +1,770 @@
+/// \file RunStats.cpp
+/// \brief The run statistics tool, which stores run and battle records in
+/// column stores and answers questions about them.
+///
+/// Records come from headless runs played here, or from the gameplay
+/// telemetry log that the game writes. There are two tables: `runs.col`,
+/// with a row per run, and `battles.col`, with a row per battle, both
+/// numbered by run so that they can be matched up. Queries filter on any
+/// columns and count, add up and average columns, grouped by a column, over
+/// the mapped files with no database. The report command answers the
+/// common questions: win rate by layer and by path, damage taken by number
+/// of enemies, and what the special card level is worth.
+///
+/// A path is stored as a number, three bits for each layer from the first
+/// layer up, each the index of the level chosen within its layer, or 7 for
+/// a layer that the run never reached.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Balance.h"
+#include "BattleSim.h"
+#include "ColumnStore.h"
+#include "MapGenerator.h"
+#include "Telemetry.h"
+
+static const int NumLayers = CMapGenerator::NumLayers; ///< Layers in a map.
+static const int NoLevel = 7; ///< Path index for a layer not reached.
+
+/// Columns of the runs table.
+
+enum eRunColumn{
+  RunId, RunWon, RunBattles, RunLayer, RunPath, RunNerd, RunNerdLayer,
+  RunHealth, RunDamage, RunTurns, RunColumns
+}; //eRunColumn
+
+static const std::vector<std::string> g_vRunColumns = {
+  "run", "won", "battles", "layer", "path", "nerd", "nerd_layer",
+  "health", "damage", "turns"
+}; //g_vRunColumns
+
+/// Columns of the battles table.
+
+enum eBattleColumn{
+  BattleRun, BattleLayer, BattleLevel, BattleEnemies, BattleBoss, BattleWon,
+  BattleTurns, BattleHealth, BattleDamage, BattleUpgrades, BattleNerd,
+  BattleColumns
+}; //eBattleColumn
+
+static const std::vector<std::string> g_vBattleColumns = {
+  "run", "layer", "level", "enemies", "boss", "won", "turns", "health",
+  "damage", "upgrades", "nerd"
+}; //g_vBattleColumns
+
+/// \brief A run being put together, and the battles played in it.
+
+struct RunRecord{
+  int32_t m_pRun[RunColumns] = {}; ///< Run row.
+  std::vector<int32_t> m_vBattles; ///< Battle rows, one after the other.
+  int32_t m_pBattle[BattleColumns] = {}; ///< Battle being played.
+  bool m_bInBattle = false; ///< A battle is being played.
+  int32_t m_nUpgrades = 0; ///< Cards upgraded so far.
+  MapDesc m_sMap; ///< The run's map, to find levels within their layers.
+}; //RunRecord
+
+/// Make a path number with no layers reached.
+/// \return Path.
+
+static int32_t EmptyPath(){
+  int32_t path = 0;
+
+  for(int i=0; i<NumLayers; i++)
+    path |= NoLevel << 3*i;
+
+  return path;
+} //EmptyPath
+
+/// Put the level chosen in a layer into a path number.
+/// \param path [in, out] Path.
+/// \param layer Layer.
+/// \param index Index of the level within the layer.
+
+static void SetPath(int32_t& path, int layer, int index){
+  if(layer < 0 || layer >= NumLayers)return;
+  path = (path & ~(7 << 3*layer)) | (std::min(index, NoLevel) << 3*layer);
+} //SetPath
+
+/// Write a path number as the level index in each layer, from the first
+/// layer up, with a dash for a layer not reached.
+/// \param path Path.
+/// \return Text.
+
+static std::string PathText(int32_t path){
+  std::string s;
+
+  for(int i=0; i<NumLayers; i++){
+    const int j = path >> 3*i & 7;
+    s += j == NoLevel? '-': (char)('0' + j);
+  } //for
+
+  return s;
+} //PathText
+
+/// Upgrade a card the way `Card::UpgradeCard()` does: damage if it deals
+/// any, otherwise health, otherwise shield.
+/// \param c Card.
+/// \param amount Amount to add.
+
+static void Upgrade(SimCard& c, int amount){
+  if(c.m_nDamage > 0)c.m_nDamage += amount;
+  else if(c.m_nHealth > 0)c.m_nHealth += amount;
+  else if(c.m_nShield > 0)c.m_nShield += amount;
+} //Upgrade
+
+/// Play a headless run, as the tuner does, and record it. The player picks
+/// a whole path at random before setting out, so that runs that die early
+/// still say which path they were on, then upgrades a random card after
+/// each battle won.
+/// \param seed Seed for the map, the battles and the player's choices.
+/// \param run Run number.
+/// \param runs [in, out] Run rows to add to.
+/// \param battles [in, out] Battle rows to add to.
+
+static void PlayRun(uint64_t seed, int32_t run, std::vector<int32_t>& runs,
+  std::vector<int32_t>& battles)
+{
+  const Balance& b = GetBalance();
+
+  MapDesc map;
+  CRng rng(seed);
+  CMapGenerator::Generate(rng, map);
+
+  CBattleSim sim(seed);
+  CRng choice(seed ^ 0xC2B2AE3D27D4EB4FULL);
+  std::vector<SimCard> deck = CBattleSim::GetStartDeck();
+
+  int32_t r[RunColumns] = {};
+  r[RunId] = run;
+  r[RunPath] = EmptyPath();
+  r[RunNerdLayer] = -1;
+
+  std::vector<int> path(1, choice.randn(0, (int)map.m_vLayers[0].size() - 1));
+
+  while(path.back() < (int)map.m_vAdjacency.size() && !map.m_vAdjacency[path.back()].empty()){
+    const std::vector<MapEdge>& next = map.m_vAdjacency[path.back()];
+    path.push_back(next[choice.randn(0, (int)next.size() - 1)].m_nTo);
+  } //while
+
+  for(int level: path){
+    const MapNode& node = map.GetNode(level);
+    SetPath(r[RunPath], node.m_nLayer, level - map.m_vLayers[node.m_nLayer][0].m_nId);
+  } //for
+
+  int upgrades = 0;
+
+  for(int level: path){
+    const MapNode& node = map.GetNode(level);
+    r[RunLayer] = node.m_nLayer;
+
+    if(node.m_bSpecial){
+      for(SimCard& c: deck)
+        Upgrade(c, b.m_nUpgradeAll);
+
+      r[RunNerd] = 1;
+      r[RunNerdLayer] = node.m_nLayer;
+      continue;
+    } //if
+
+    const int32_t health = sim.GetPlayerHealth();
+    const bool boss = node.m_nLayer == NumLayers - 1;
+
+    sim.SetDeck(deck);
+    const BattleResult result = sim.Fight(node.m_nEnemies, boss);
+
+    const int32_t row[BattleColumns] = {
+      run, node.m_nLayer, level, node.m_nEnemies, boss, result.m_bWon,
+      result.m_nTurns, health, result.m_nDamageTaken, upgrades, r[RunNerd]
+    }; //row
+
+    battles.insert(battles.end(), row, row + BattleColumns);
+
+    r[RunBattles]++;
+    r[RunDamage] += result.m_nDamageTaken;
+    r[RunTurns] += result.m_nTurns;
+    r[RunHealth] = result.m_nPlayerHealth;
+
+    if(!result.m_bWon)break;
+
+    r[RunWon] = boss;
+    Upgrade(deck[choice.randn(0, (int)deck.size() - 1)], b.m_nUpgrade);
+    upgrades++;
+  } //for
+
+  runs.insert(runs.end(), r, r + RunColumns);
+} //PlayRun
+
+/// Open the two tables for writing.
+/// \param dir Folder.
+/// \param runs [out] Runs table.
+/// \param battles [out] Battles table.
+/// \return true if both were opened.
+
+static bool OpenTables(const std::string& dir, CColumnWriter& runs, CColumnWriter& battles){
+  const std::string r = dir + "/runs.col", b = dir + "/battles.col";
+
+  if(!runs.Open(r.c_str(), g_vRunColumns)){
+    fprintf(stderr, "cannot write %s\n", r.c_str());
+    return false;
+  } //if
+
+  if(!battles.Open(b.c_str(), g_vBattleColumns)){
+    fprintf(stderr, "cannot write %s\n", b.c_str());
+    return false;
+  } //if
+
+  return true;
+} //OpenTables
+
+/// Add rows to a table.
+/// \param w Table.
+/// \param rows Rows, one after the other.
+/// \param columns Number of columns.
+
+static void AppendRows(CColumnWriter& w, const std::vector<int32_t>& rows, size_t columns){
+  for(size_t i=0; i<rows.size(); i+=columns)
+    w.Append(rows.data() + i);
+} //AppendRows
+
+/// Play runs and write them to the tables. Runs are played in batches, each
+/// split into one stretch of runs per thread, and written in run order, so
+/// the tables do not depend on the number of threads.
+/// \param dir Folder.
+/// \param first Seed of the first run.
+/// \param n Number of runs.
+/// \param threads Number of threads.
+/// \return true if the tables were written.
+
+static bool Simulate(const std::string& dir, uint64_t first, size_t n, size_t threads){
+  CColumnWriter runs, battles;
+  if(!OpenTables(dir, runs, battles))return false;
+
+  const size_t batch = 1 << 16;
+  std::vector<std::vector<int32_t>> r(threads), b(threads);
+
+  for(size_t start=0; start<n; start+=batch){
+    const size_t count = std::min(batch, n - start);
+    const size_t per = (count + threads - 1)/threads;
+    std::vector<std::thread> pool;
+
+    for(size_t t=0; t<threads; t++)
+      pool.emplace_back([&, t](){
+        r[t].clear();
+        b[t].clear();
+
+        for(size_t i=start + t*per; i<std::min(start + count, start + (t + 1)*per); i++)
+          PlayRun(first + i, (int32_t)i, r[t], b[t]);
+      });
+
+    for(std::thread& t: pool)
+      t.join();
+
+    for(size_t t=0; t<threads; t++){
+      AppendRows(runs, r[t], RunColumns);
+      AppendRows(battles, b[t], BattleColumns);
+    } //for
+  } //for
+
+  const bool ok = runs.Close();
+  return battles.Close() && ok;
+} //Simulate
+
+/// Start a run from a telemetry record, with the map generated from its
+/// seed as the game does.
+/// \param t Record.
+/// \param run Run number.
+/// \param r [out] The run.
+
+static void StartRun(const TelemetryRecord& t, int32_t run, RunRecord& r){
+  r = RunRecord();
+  r.m_pRun[RunId] = run;
+  r.m_pRun[RunPath] = EmptyPath();
+  r.m_pRun[RunNerdLayer] = -1;
+  r.m_pRun[RunHealth] = t.m_pValue[4];
+
+  uint64_t seed = 0;
+
+  for(int i=0; i<4; i++)
+    seed |= (uint64_t)(uint16_t)t.m_pValue[i] << 16*i;
+
+  CRng rng(seed);
+  CMapGenerator::Generate(rng, r.m_sMap);
+} //StartRun
+
+/// Read a telemetry log and write the runs in it to the tables. Only runs
+/// that ended, in a death or a win over the boss, are written. A run picked
+/// up from a save carries on from where it was left in the log.
+/// \param path Telemetry log.
+/// \param dir Folder.
+/// \return true if the log was read and the tables written.
+
+static bool Import(const char* path, const std::string& dir){
+  CMappedFile file;
+  TelemetryHeader h;
+
+  if(!file.Open(path) || file.GetSize() < sizeof(h)){
+    fprintf(stderr, "cannot read %s\n", path);
+    return false;
+  } //if
+
+  memcpy(&h, file.GetData(), sizeof(h));
+
+  if(h.m_nMagic != TelemetryHeader::Magic || h.m_nVersion != TelemetryHeader::Version ||
+    h.m_nHeaderSize != sizeof(h) || h.m_nRecordSize != sizeof(TelemetryRecord)){
+    fprintf(stderr, "%s is not a telemetry log\n", path);
+    return false;
+  } //if
+
+  CColumnWriter runs, battles;
+  if(!OpenTables(dir, runs, battles))return false;
+
+  const size_t n = (file.GetSize() - sizeof(h))/sizeof(TelemetryRecord);
+  const uint8_t* p = file.GetData() + sizeof(h);
+
+  RunRecord cur, saved; //the run being played, and the one before it
+  bool playing = false, hasSaved = false;
+  int32_t next = 0;
+  size_t dropped = 0, ended = 0;
+
+  for(size_t i=0; i<n; i++){
+    TelemetryRecord t;
+    memcpy(&t, p + i*sizeof(t), sizeof(t));
+
+    const eTelemetry type = (eTelemetry)t.m_nType;
+    const int16_t* v = t.m_pValue;
+
+    if(type == eTelemetry::RunStart){
+      if(playing){saved = std::move(cur); hasSaved = true;}
+      StartRun(t, next++, cur);
+      playing = true;
+      continue;
+    } //if
+
+    if(type == eTelemetry::RunResume){
+      playing = hasSaved;
+      if(hasSaved){cur = std::move(saved); hasSaved = false;}
+      if(playing)cur.m_pRun[RunHealth] = v[0];
+      continue;
+    } //if
+
+    if(type == eTelemetry::Dropped){
+      dropped += (uint16_t)v[0] | (size_t)(uint16_t)v[1] << 16;
+      continue;
+    } //if
+
+    if(!playing)continue;
+
+    int32_t* run = cur.m_pRun;
+    int32_t* battle = cur.m_pBattle;
+
+    switch(type){
+      case eTelemetry::NodeChosen:
+        run[RunLayer] = v[0];
+
+        if(v[0] >= 0 && v[0] < (int)cur.m_sMap.m_vLayers.size())
+          SetPath(run[RunPath], v[0], t.m_nLevel - cur.m_sMap.m_vLayers[v[0]][0].m_nId);
+
+        if(v[2]){
+          run[RunNerd] = 1;
+          run[RunNerdLayer] = v[0];
+          break;
+        } //if
+
+        std::fill(battle, battle + BattleColumns, 0);
+        battle[BattleRun] = run[RunId];
+        battle[BattleLayer] = v[0];
+        battle[BattleLevel] = t.m_nLevel;
+        battle[BattleEnemies] = v[1];
+        battle[BattleBoss] = v[0] == NumLayers - 1;
+        battle[BattleHealth] = run[RunHealth];
+        battle[BattleUpgrades] = cur.m_nUpgrades;
+        battle[BattleNerd] = run[RunNerd];
+        cur.m_bInBattle = true;
+        break;
+
+      case eTelemetry::CardPlayed:
+        battle[BattleTurns]++; //cards for now, turns at the end
+        break;
+
+      case eTelemetry::DamageTaken:
+        battle[BattleDamage] += v[2];
+        run[RunHealth] = v[4];
+        break;
+
+      case eTelemetry::Upgrade:
+        if(v[0] >= 0)cur.m_nUpgrades++; //not the special card level's
+        break;
+
+      case eTelemetry::LevelComplete:
+      case eTelemetry::Death: {
+        if(!cur.m_bInBattle)break;
+
+        const bool won = type == eTelemetry::LevelComplete;
+        if(won)run[RunHealth] = v[0];
+
+        battle[BattleWon] = won;
+        battle[BattleTurns] = (battle[BattleTurns] + CBattleSim::CardsPerTurn - 1)/CBattleSim::CardsPerTurn;
+        cur.m_vBattles.insert(cur.m_vBattles.end(), battle, battle + BattleColumns);
+        cur.m_bInBattle = false;
+
+        run[RunBattles]++;
+        run[RunDamage] += battle[BattleDamage];
+        run[RunTurns] += battle[BattleTurns];
+
+        if(won && !v[1])break; //on to the next level
+
+        run[RunWon] = won;
+        runs.Append(run);
+        AppendRows(battles, cur.m_vBattles, BattleColumns);
+        playing = false;
+        ended++;
+      } break;
+
+      default: break;
+    } //switch
+  } //for
+
+  fprintf(stderr, "%zu runs ended out of %d started\n", ended, (int)next);
+
+  if(dropped > 0)
+    fprintf(stderr, "%zu records were dropped by the game, so some runs may be off\n", dropped);
+
+  const bool ok = runs.Close();
+  return battles.Close() && ok;
+} //Import
+
+/// Parse a filter such as `layer>=2`.
+/// \param s Filter text.
+/// \param store Table it is for.
+/// \param f [out] Filter.
+/// \return true if the filter names a column and has a comparison and a
+///   number.
+
+static bool ParseFilter(const char* s, const CColumnStore& store, ColumnFilter& f){
+  static const std::pair<const char*, eCompare> op[] = { //two characters first
+    {"!=", eCompare::NotEqual}, {"<=", eCompare::LessEqual},
+    {">=", eCompare::GreaterEqual}, {"==", eCompare::Equal},
+    {"=", eCompare::Equal}, {"<", eCompare::Less}, {">", eCompare::Greater},
+  }; //op
+
+  const char* p = s;
+  while(*p && !strchr("!=<>", *p))p++;
+
+  for(const auto& o: op)
+    if(strncmp(p, o.first, strlen(o.first)) == 0){
+      const int c = store.Find(std::string(s, p).c_str());
+      const char* value = p + strlen(o.first);
+      char* end = nullptr;
+      const long x = strtol(value, &end, 0);
+
+      if(c < 0 || *value == 0 || *end != 0)return false;
+
+      f.m_nColumn = (size_t)c;
+      f.m_eCompare = o.second;
+      f.m_nValue = (int32_t)x;
+      return true;
+    } //if
+
+  return false;
+} //ParseFilter
+
+/// Open a table, saying so if it cannot be opened.
+/// \param path File name.
+/// \param store [out] Table.
+/// \return true if the table was opened.
+
+static bool OpenTable(const std::string& path, CColumnStore& store){
+  if(store.Open(path.c_str()))return true;
+  fprintf(stderr, "cannot read %s\n", path.c_str());
+  return false;
+} //OpenTable
+
+/// Run a query and print the result as a table, with the time it took on
+/// standard error.
+/// \param store Table.
+/// \param q Query.
+/// \param avg For each sum, true to print it as an average instead.
+/// \param threads Number of threads.
+/// \param minCount Leave out groups with fewer rows than this.
+/// \return true if the query ran.
+
+static bool PrintQuery(const CColumnStore& store, const ColumnQuery& q,
+  const std::vector<bool>& avg, size_t threads, uint64_t minCount=0)
+{
+  using clock = std::chrono::steady_clock;
+  const clock::time_point t0 = clock::now();
+
+  std::vector<QueryGroup> result;
+
+  if(!store.Run(q, result, threads)){
+    fprintf(stderr, "the group by column has more than %zu values\n", CColumnStore::MaxGroupKeys);
+    return false;
+  } //if
+
+  const double t = std::chrono::duration<double>(clock::now() - t0).count();
+  const bool path = q.m_nGroupBy >= 0 && store.GetName(q.m_nGroupBy) == "path";
+
+  printf("%12s %12s", q.m_nGroupBy >= 0? store.GetName(q.m_nGroupBy).c_str(): "", "count");
+
+  for(size_t j=0; j<q.m_vSums.size(); j++)
+    printf(" %14s", ((avg[j]? "avg(": "sum(") + store.GetName(q.m_vSums[j]) + ")").c_str());
+
+  printf("\n");
+
+  for(const QueryGroup& g: result){
+    if(g.m_nCount < minCount)continue;
+
+    if(path)printf("%12s", PathText(g.m_nKey).c_str());
+    else if(q.m_nGroupBy >= 0)printf("%12d", g.m_nKey);
+    else printf("%12s", "all");
+
+    printf(" %12llu", (unsigned long long)g.m_nCount);
+
+    for(size_t j=0; j<g.m_vSum.size(); j++)
+      if(avg[j])printf(" %14.4f", g.m_nCount? (double)g.m_vSum[j]/g.m_nCount: 0.0);
+      else printf(" %14lld", (long long)g.m_vSum[j]);
+
+    printf("\n");
+  } //for
+
+  fflush(stdout); //keep the timing after the table it is for
+  fprintf(stderr, "%llu rows in %.3f s, %.0f million rows per second\n",
+    (unsigned long long)store.GetRows(), t, t > 0.0? store.GetRows()*1e-6/t: 0.0);
+  return true;
+} //PrintQuery
+
+/// Make a query that groups by one column and averages others.
+/// \param store Table.
+/// \param by Column to group by.
+/// \param columns Columns to average.
+/// \param where Filter, or empty for none.
+/// \param q [out] Query.
+/// \return true if every column was found.
+
+static bool MakeQuery(const CColumnStore& store, const char* by,
+  const std::vector<const char*>& columns, const char* where, ColumnQuery& q)
+{
+  q = ColumnQuery();
+  q.m_nGroupBy = by? store.Find(by): -1;
+  bool ok = by == nullptr || q.m_nGroupBy >= 0;
+
+  for(const char* c: columns){
+    ok = ok && store.Find(c) >= 0;
+    if(ok)q.m_vSums.push_back((size_t)store.Find(c));
+  } //for
+
+  if(ok && where){
+    ColumnFilter f;
+    ok = ParseFilter(where, store, f);
+    q.m_vFilters.push_back(f);
+  } //if
+
+  return ok;
+} //MakeQuery
+
+/// Print the common questions about the tables: the win rate in each
+/// layer, the damage taken against each number of enemies, the win rate of
+/// the most played paths, and how runs that went through the special card
+/// level did against those that did not.
+/// \param dir Folder with the tables.
+/// \param threads Number of threads.
+/// \return true if the tables could be read.
+
+static bool Report(const std::string& dir, size_t threads){
+  CColumnStore runs, battles;
+
+  if(!OpenTable(dir + "/runs.col", runs) || !OpenTable(dir + "/battles.col", battles))
+    return false;
+
+  struct Item{
+    const char* m_pTitle; ///< Question.
+    const CColumnStore* m_pStore; ///< Table.
+    const char* m_pBy; ///< Column to group by.
+    std::vector<const char*> m_vAvg; ///< Columns to average.
+    const char* m_pWhere; ///< Filter, or null.
+    uint64_t m_nMinCount; ///< Fewest rows in a group to print it.
+  }; //Item
+
+  const uint64_t common = std::max<uint64_t>(1, runs.GetRows()/200); //paths played in at least 0.5% of runs
+
+  const Item item[] = {
+    {"win rate by layer", &battles, "layer", {"won", "turns", "damage"}, nullptr, 0},
+    {"damage taken by number of enemies", &battles, "enemies", {"damage", "won", "turns"}, nullptr, 0},
+    {"win rate by path, for paths in 0.5% of runs or more", &runs, "path", {"won", "layer"}, nullptr, common},
+    {"runs with and without the special card level", &runs, "nerd", {"won", "layer", "health"}, nullptr, 0},
+    {"runs through the special card level, by its layer", &runs, "nerd_layer", {"won", "layer"}, "nerd=1", 0},
+    {"battles after the special card level, by layer", &battles, "layer", {"won", "damage"}, "nerd=1", 0},
+  }; //item
+
+  for(const Item& i: item){
+    ColumnQuery q;
+
+    if(!MakeQuery(*i.m_pStore, i.m_pBy, i.m_vAvg, i.m_pWhere, q)){
+      fprintf(stderr, "the tables are missing columns\n");
+      return false;
+    } //if
+
+    printf("%s\n", i.m_pTitle);
+    if(!PrintQuery(*i.m_pStore, q, std::vector<bool>(q.m_vSums.size(), true), threads, i.m_nMinCount))
+      return false;
+
+    printf("\n");
+  } //for
+
+  return true;
+} //Report
+
+/// Print what is in a table and how well each column compressed.
+/// \param path File name.
+/// \return true if the table could be read.
+
+static bool Info(const char* path){
+  CColumnStore store;
+  if(!OpenTable(path, store))return false;
+
+  printf("%llu rows in %zu row groups\n", (unsigned long long)store.GetRows(), store.GetGroups());
+  printf("%-12s %12s %12s %10s %14s\n", "column", "min", "max", "bits", "bytes");
+
+  for(size_t c=0; c<store.GetColumns(); c++){
+    int32_t lo = 0, hi = 0;
+    store.GetRange(c, lo, hi);
+
+    uint64_t bytes = 0;
+
+    for(size_t g=0; g<store.GetGroups(); g++)
+      bytes += GetPackedBytes(store.GetGroupRows(g), store.GetChunk(g, c).m_nBits);
+
+    printf("%-12s %12d %12d %10.2f %14llu\n", store.GetName(c).c_str(), lo, hi,
+      store.GetRows()? 8.0*bytes/store.GetRows(): 0.0, (unsigned long long)bytes);
+  } //for
+
+  return true;
+} //Info
+
+/// Print how to use the tool.
+/// \param name Program name.
+/// \return Exit code.
+
+static int Usage(const char* name){
+  fprintf(stderr,
+    "usage: %s simulate [--runs n] [--seed n] [--balance file] [--dir folder] [--threads n]\n"
+    "       %s import [--telemetry file] [--dir folder]\n"
+    "       %s query table [--where column<op>value]... [--by column] [--sum column]...\n"
+    "         [--avg column]... [--threads n]\n"
+    "       %s report [--dir folder] [--threads n]\n"
+    "       %s info table\n"
+    "The tables are runs.col and battles.col in the folder, . by default.\n"
+    "Comparisons are = != < <= > >=.\n", name, name, name, name, name);
+  return 2;
+} //Usage
+
+/// Parse the command line and do what it asks.
+/// \param argc Argument count.
+/// \param argv Arguments.
+/// \return 0 on success, 1 on failure, 2 for bad arguments.
+
+int main(int argc, char* argv[]){
+  if(argc < 2)return Usage(argv[0]);
+
+  const std::string cmd = argv[1];
+  std::string dir = ".";
+  const char* table = nullptr;
+  const char* balance = nullptr;
+  const char* telemetry = "telemetry.bin";
+  size_t runs = 1000000;
+  uint64_t seed = 1;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<const char*> where, sum, avg;
+  const char* by = nullptr;
+  int i = 2;
+
+  if((cmd == "query" || cmd == "info") && i < argc)
+    table = argv[i++];
+
+  for(; i<argc; i++){
+    const char* a = argv[i];
+    const bool more = i + 1 < argc;
+
+    if(strcmp(a, "--runs") == 0 && more)runs = strtoull(argv[++i], nullptr, 0);
+    else if(strcmp(a, "--seed") == 0 && more)seed = strtoull(argv[++i], nullptr, 0);
+    else if(strcmp(a, "--balance") == 0 && more)balance = argv[++i];
+    else if(strcmp(a, "--dir") == 0 && more)dir = argv[++i];
+    else if(strcmp(a, "--threads") == 0 && more)threads = std::max(1, atoi(argv[++i]));
+    else if(strcmp(a, "--telemetry") == 0 && more)telemetry = argv[++i];
+    else if(strcmp(a, "--where") == 0 && more)where.push_back(argv[++i]);
+    else if(strcmp(a, "--by") == 0 && more)by = argv[++i];
+    else if(strcmp(a, "--sum") == 0 && more)sum.push_back(argv[++i]);
+    else if(strcmp(a, "--avg") == 0 && more)avg.push_back(argv[++i]);
+    else return Usage(argv[0]);
+  } //for
+
+  if(cmd == "simulate"){
+    Balance b;
+
+    if(balance){
+      if(!LoadBalance(balance, b)){
+        fprintf(stderr, "cannot read %s\n", balance);
+        return 2;
+      } //if
+
+      SetBalance(b);
+    } //if
+
+    using clock = std::chrono::steady_clock;
+    const clock::time_point t0 = clock::now();
+
+    if(!Simulate(dir, seed, runs, threads))return 1;
+
+    const double t = std::chrono::duration<double>(clock::now() - t0).count();
+    fprintf(stderr, "%zu runs in %.2f s\n", runs, t);
+    return 0;
+  } //if
+
+  if(cmd == "import")return Import(telemetry, dir)? 0: 1;
+  if(cmd == "report")return Report(dir, threads)? 0: 1;
+  if(cmd == "info")return table && Info(table)? 0: table? 1: Usage(argv[0]);
+  if(cmd != "query" || table == nullptr)return Usage(argv[0]);
+
+  CColumnStore store;
+  if(!OpenTable(table, store))return 1;
+
+  ColumnQuery q;
+  std::vector<bool> isAvg;
+
+  if(by && (q.m_nGroupBy = store.Find(by)) < 0){
+    fprintf(stderr, "no column %s\n", by);
+    return 2;
+  } //if
+
+  for(const char* w: where){
+    ColumnFilter f;
+
+    if(!ParseFilter(w, store, f)){
+      fprintf(stderr, "cannot use filter %s\n", w);
+      return 2;
+    } //if
+
+    q.m_vFilters.push_back(f);
+  } //for
+
+  for(int pass=0; pass<2; pass++)
+    for(const char* c: pass? avg: sum){
+      const int k = store.Find(c);
+
+      if(k < 0){
+        fprintf(stderr, "no column %s\n", c);
+        return 2;
+      } //if
+
+      q.m_vSums.push_back((size_t)k);
+      isAvg.push_back(pass == 1);
+    } //for
+
+  return PrintQuery(store, q, isAvg, threads)? 0: 1;
+} //main
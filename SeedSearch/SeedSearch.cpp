@@ -0,0 +1,254 @@
+/// \file SeedSearch.cpp
+/// \brief The seed search tool, which finds map seeds with given properties.
+///
+/// Scans a range of map seeds on every core and writes the ones whose maps
+/// have the requested properties to the seed catalog under a name, for
+/// curated and daily runs. Most properties can be tested on the random
+/// choices alone, from `CMapGenerator::DrawLayout()`, which allocates
+/// nothing, so most seeds are thrown out before any map is built. Only
+/// seeds that pass those tests have their map built for the path tests.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MapGenerator.h"
+#include "SeedCatalog.h"
+
+/// \brief The properties a map must have.
+
+struct SeedQuery{
+  int m_nSpecialLayer = -1; ///< Layer of the special card level, or -1 for any.
+  int m_nMinWidth = 0; ///< Some layer must have at least this many levels.
+  int m_nMinPathEnemies = 0; ///< Fewest enemies on any path must be at least this.
+  int m_nMaxPathEnemies = 1 << 30; ///< Fewest enemies on any path must be at most this.
+
+  bool NeedsMap() const; ///< Test for properties that need a built map.
+}; //SeedQuery
+
+/// Test whether the query has properties that need the map to be built.
+/// \return true if the map must be built.
+
+bool SeedQuery::NeedsMap() const{
+  return m_nMinPathEnemies > 0 || m_nMaxPathEnemies < (1 << 30);
+} //NeedsMap
+
+/// Test a map's random choices against the cheap properties.
+/// \param q Query.
+/// \param layout The random choices.
+/// \return true if the map may match.
+
+static bool LayoutMatches(const SeedQuery& q, const MapLayout& layout){
+  if(q.m_nSpecialLayer >= 0 && layout.m_nSpecialLayer != q.m_nSpecialLayer)
+    return false;
+
+  int width = 0;
+
+  for(int i=0; i<CMapGenerator::NumLayers; i++)
+    width = std::max(width, layout.m_pWidth[i]);
+
+  return width >= q.m_nMinWidth;
+} //LayoutMatches
+
+/// Get the fewest enemies the player can fight on the way from the first
+/// level to the boss. The special card level has no battle. Levels are
+/// numbered in layer order and paths only lead upwards, so one backwards
+/// pass does it.
+/// \param map The map.
+/// \return Number of enemies.
+
+static int FewestPathEnemies(MapDesc& map){
+  int n = 0;
+
+  for(const std::vector<MapNode>& layer: map.m_vLayers)
+    n += (int)layer.size();
+
+  std::vector<int> best(n);
+
+  for(int i=n - 1; i>=0; i--){
+    const MapNode& node = map.GetNode(i);
+    int next = 0;
+
+    if(i < (int)map.m_vAdjacency.size() && !map.m_vAdjacency[i].empty()){
+      next = 1 << 30;
+
+      for(const MapEdge& e: map.m_vAdjacency[i])
+        next = std::min(next, best[e.m_nTo]);
+    } //if
+
+    best[i] = (node.m_bSpecial? 0: node.m_nEnemies) + next;
+  } //for
+
+  return best[0];
+} //FewestPathEnemies
+
+/// Test one seed.
+/// \param q Query.
+/// \param seed Seed.
+/// \param map Scratch map, reused between seeds.
+/// \return true if the seed's map matches.
+
+static bool SeedMatches(const SeedQuery& q, uint64_t seed, MapDesc& map){
+  CRng rng(seed);
+  MapLayout layout;
+  CMapGenerator::DrawLayout(rng, layout);
+
+  if(!LayoutMatches(q, layout))return false;
+  if(!q.NeedsMap())return true;
+
+  CMapGenerator::Build(layout, map);
+  const int enemies = FewestPathEnemies(map);
+
+  return enemies >= q.m_nMinPathEnemies && enemies <= q.m_nMaxPathEnemies;
+} //SeedMatches
+
+/// Scan seeds on every core. Blocks of seeds are handed out in order and no
+/// more are handed out once enough matches have been found, so the matches
+/// returned are always the lowest matching seeds, however many threads run.
+/// \param q Query.
+/// \param start First seed.
+/// \param seeds Number of seeds to scan at most.
+/// \param count Number of matches wanted.
+/// \param threads Number of threads.
+/// \param scanned [out] Number of seeds scanned.
+/// \return The matching seeds, lowest first.
+
+static std::vector<uint64_t> Scan(const SeedQuery& q, uint64_t start,
+  uint64_t seeds, size_t count, size_t threads, uint64_t& scanned)
+{
+  const uint64_t blockSize = 1 << 16;
+  const uint64_t blocks = (seeds + blockSize - 1)/blockSize;
+
+  std::atomic<uint64_t> nextBlock(0);
+  std::atomic<size_t> found(0);
+  std::atomic<uint64_t> done(0);
+  std::mutex lock;
+  std::vector<uint64_t> matches;
+
+  auto worker = [&](){
+    MapDesc map;
+    std::vector<uint64_t> local;
+
+    while(found.load(std::memory_order_relaxed) < count){
+      const uint64_t b = nextBlock.fetch_add(1);
+      if(b >= blocks)break;
+
+      const uint64_t first = b*blockSize;
+      const uint64_t last = std::min(first + blockSize, seeds);
+      size_t hits = 0;
+
+      for(uint64_t i=first; i<last; i++)
+        if(SeedMatches(q, start + i, map)){
+          local.push_back(start + i);
+          ++hits;
+        } //if
+
+      found += hits;
+      done += last - first;
+    } //while
+
+    std::lock_guard<std::mutex> guard(lock);
+    matches.insert(matches.end(), local.begin(), local.end());
+  }; //worker
+
+  std::vector<std::thread> pool;
+
+  for(size_t i=0; i<threads; i++)
+    pool.emplace_back(worker);
+
+  for(std::thread& t: pool)
+    t.join();
+
+  std::sort(matches.begin(), matches.end());
+  if(matches.size() > count)matches.resize(count);
+
+  scanned = done;
+  return matches;
+} //Scan
+
+/// Parse the command line, scan and report. Matching seeds are printed one
+/// per line and, if a name is given, added to the catalog. With one match it
+/// gets the name as is, with more they are numbered from 0 after a dash.
+/// The exit code is 2 for a usage error, 1 if too few seeds matched and 0
+/// otherwise.
+/// \param argc Number of arguments.
+/// \param argv Arguments.
+/// \return Exit code.
+
+int main(int argc, char* argv[]){
+  SeedQuery q;
+  uint64_t start = 0;
+  uint64_t seeds = 100000000;
+  size_t count = 1;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  const char* name = nullptr;
+  const char* catalog = "seeds.cat";
+
+  for(int i=1; i<argc; i++){
+    const char* a = argv[i];
+    const bool more = i + 1 < argc;
+
+    if(strcmp(a, "--special-layer") == 0 && more)q.m_nSpecialLayer = atoi(argv[++i]);
+    else if(strcmp(a, "--min-width") == 0 && more)q.m_nMinWidth = atoi(argv[++i]);
+    else if(strcmp(a, "--min-path-enemies") == 0 && more)q.m_nMinPathEnemies = atoi(argv[++i]);
+    else if(strcmp(a, "--max-path-enemies") == 0 && more)q.m_nMaxPathEnemies = atoi(argv[++i]);
+    else if(strcmp(a, "--start") == 0 && more)start = strtoull(argv[++i], nullptr, 0);
+    else if(strcmp(a, "--seeds") == 0 && more)seeds = strtoull(argv[++i], nullptr, 0);
+    else if(strcmp(a, "--count") == 0 && more)count = std::max(1, atoi(argv[++i]));
+    else if(strcmp(a, "--threads") == 0 && more)threads = std::max(1, atoi(argv[++i]));
+    else if(strcmp(a, "--name") == 0 && more)name = argv[++i];
+    else if(strcmp(a, "--catalog") == 0 && more)catalog = argv[++i];
+
+    else{
+      fprintf(stderr, "usage: %s [--special-layer n] [--min-width n] "
+        "[--min-path-enemies n] [--max-path-enemies n] [--start seed] "
+        "[--seeds n] [--count n] [--threads n] [--name name] "
+        "[--catalog file]\n", argv[0]);
+      return 2;
+    } //else
+  } //for
+
+  using clock = std::chrono::steady_clock;
+  const clock::time_point t0 = clock::now();
+
+  uint64_t scanned = 0;
+  const std::vector<uint64_t> matches = Scan(q, start, seeds, count, threads, scanned);
+
+  const double t = std::chrono::duration<double>(clock::now() - t0).count();
+  fprintf(stderr, "%llu seeds in %.2f s, %.1f million per minute, %zu matched\n",
+    (unsigned long long)scanned, t, t > 0.0? scanned*60e-6/t: 0.0, matches.size());
+
+  std::vector<SeedEntry> entries;
+
+  for(size_t i=0; i<matches.size(); i++){
+    printf("%llu\n", (unsigned long long)matches[i]);
+
+    if(name){
+      const std::string s = matches.size() == 1 && count == 1?
+        std::string(name): std::string(name) + "-" + std::to_string(i);
+
+      SeedEntry e;
+
+      if(!CSeedCatalog::MakeEntry(s.c_str(), matches[i], e)){
+        fprintf(stderr, "name %s is too long\n", s.c_str());
+        return 2;
+      } //if
+
+      entries.push_back(e);
+    } //if
+  } //for
+
+  if(!entries.empty() && !CSeedCatalog::Add(catalog, entries)){
+    fprintf(stderr, "cannot write %s\n", catalog);
+    return 2;
+  } //if
+
+  return matches.size() < count? 1: 0;
+} //main
@@ -0,0 +1,545 @@
+/// \file Tuner.cpp
+/// \brief The difficulty tuner, which fits the balance to target win rates.
+///
+/// Plays thousands of headless runs with a candidate balance and counts how
+/// often the player wins the battles in each layer of the map. The balance
+/// is searched with CMA-ES, the covariance matrix adaptation evolution
+/// strategy, which needs nothing but the error of each candidate and copes
+/// with the noise and the rounding of integer parameters.
+///
+/// Every candidate in a generation plays the same runs: the same maps, the
+/// same draws, the same enemy dice and the same path choices. These common
+/// random numbers mean that two candidates differ only by their balance and
+/// not by their luck, so far fewer runs tell them apart. Maps are laid out
+/// once per generation and only built per candidate, and candidates that
+/// round to the same balance share one evaluation.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Balance.h"
+#include "BattleSim.h"
+#include "MapGenerator.h"
+
+static const int NumLayers = CMapGenerator::NumLayers; ///< Layers in a map.
+
+/// \brief Battles fought and won in each layer, over many runs.
+
+struct RunStats{
+  uint32_t m_pFights[NumLayers] = {}; ///< Battles fought in each layer.
+  uint32_t m_pWins[NumLayers] = {}; ///< Battles won in each layer.
+
+  void Add(const RunStats&); ///< Add another set of counts.
+}; //RunStats
+
+/// Add another set of counts to this one.
+/// \param s Counts.
+
+void RunStats::Add(const RunStats& s){
+  for(int i=0; i<NumLayers; i++){
+    m_pFights[i] += s.m_pFights[i];
+    m_pWins[i] += s.m_pWins[i];
+  } //for
+} //Add
+
+/// \brief One run that every candidate plays.
+
+struct RunDesc{
+  uint64_t m_nSeed = 0; ///< Seed for the battles and the player's choices.
+  MapLayout m_sLayout; ///< Random choices of the map.
+}; //RunDesc
+
+/// Upgrade a card the way `Card::UpgradeCard()` does: damage if it deals
+/// any, otherwise health, otherwise shield.
+/// \param c Card.
+/// \param amount Amount to add.
+
+static void Upgrade(SimCard& c, int amount){
+  if(c.m_nDamage > 0)c.m_nDamage += amount;
+  else if(c.m_nHealth > 0)c.m_nHealth += amount;
+  else if(c.m_nShield > 0)c.m_nShield += amount;
+} //Upgrade
+
+/// Play a run with the current balance, from the first level until the
+/// player loses or beats the boss. The player takes a random path and
+/// upgrades a random card after each battle won, as a new player might.
+/// \param run The run.
+/// \param stats [in, out] Counts to add the battles to.
+
+static void PlayRun(const RunDesc& run, RunStats& stats){
+  const Balance& b = GetBalance();
+
+  MapDesc map;
+  CMapGenerator::Build(run.m_sLayout, map);
+
+  CBattleSim sim(run.m_nSeed);
+  CRng choice(run.m_nSeed ^ 0xC2B2AE3D27D4EB4FULL);
+  std::vector<SimCard> deck = CBattleSim::GetStartDeck();
+  int level = 0;
+
+  for(;;){
+    const MapNode& node = map.GetNode(level);
+
+    if(node.m_bSpecial)
+      for(SimCard& c: deck)
+        Upgrade(c, b.m_nUpgradeAll);
+
+    else{
+      sim.SetDeck(deck);
+      const bool boss = node.m_nLayer == NumLayers - 1;
+      const BattleResult r = sim.Fight(node.m_nEnemies, boss);
+
+      ++stats.m_pFights[node.m_nLayer];
+      if(!r.m_bWon)return;
+      ++stats.m_pWins[node.m_nLayer];
+
+      Upgrade(deck[choice.randn(0, (int)deck.size() - 1)], b.m_nUpgrade);
+    } //else
+
+    if(level >= (int)map.m_vAdjacency.size() || map.m_vAdjacency[level].empty())
+      return; //beat the boss
+
+    const std::vector<MapEdge>& next = map.m_vAdjacency[level];
+    level = next[choice.randn(0, (int)next.size() - 1)].m_nTo;
+  } //for
+} //PlayRun
+
+/// Play every run with the current balance. The runs are split evenly
+/// between threads and the counts added up at the end, so the result does
+/// not depend on the number of threads.
+/// \param runs Runs.
+/// \param threads Number of threads.
+/// \return Counts over all runs.
+
+static RunStats PlayRuns(const std::vector<RunDesc>& runs, size_t threads){
+  std::vector<RunStats> partial(threads);
+  std::vector<std::thread> pool;
+
+  for(size_t t=0; t<threads; t++)
+    pool.emplace_back([&, t](){
+      for(size_t i=t; i<runs.size(); i+=threads)
+        PlayRun(runs[i], partial[t]);
+    });
+
+  for(std::thread& t: pool)
+    t.join();
+
+  RunStats total;
+
+  for(const RunStats& s: partial)
+    total.Add(s);
+
+  return total;
+} //PlayRuns
+
+/// Get the fraction of battles won in a layer.
+/// \param s Counts.
+/// \param layer Layer.
+/// \return Win rate, 0 if no battles were fought there.
+
+static double WinRate(const RunStats& s, int layer){
+  return s.m_pFights[layer]? (double)s.m_pWins[layer]/s.m_pFights[layer]: 0.0;
+} //WinRate
+
+/// Get the squared distance of the win rates from their targets.
+/// \param s Counts.
+/// \param target Target win rate for each layer.
+/// \return Error.
+
+static double Error(const RunStats& s, const double* target){
+  double e = 0.0;
+
+  for(int i=0; i<NumLayers; i++){
+    const double d = WinRate(s, i) - target[i];
+    e += d*d;
+  } //for
+
+  return e;
+} //Error
+
+/// Lay out the maps for a generation of runs.
+/// \param first Seed of the first run.
+/// \param n Number of runs.
+/// \return The runs.
+
+static std::vector<RunDesc> MakeRuns(uint64_t first, size_t n){
+  std::vector<RunDesc> runs(n);
+
+  for(size_t i=0; i<n; i++){
+    runs[i].m_nSeed = first + i;
+    CRng rng(runs[i].m_nSeed);
+    CMapGenerator::DrawLayout(rng, runs[i].m_sLayout);
+  } //for
+
+  return runs;
+} //MakeRuns
+
+/// Find the eigenvalues and eigenvectors of a symmetric matrix by cyclic
+/// Jacobi rotations. Fine for the handful of parameters tuned here.
+/// \param a [in, out] Row-major n by n matrix, destroyed.
+/// \param n Size.
+/// \param v [out] Eigenvectors, in the columns.
+/// \param d [out] Eigenvalues.
+
+static void Eigen(std::vector<double>& a, size_t n, std::vector<double>& v,
+  std::vector<double>& d)
+{
+  v.assign(n*n, 0.0);
+  for(size_t i=0; i<n; i++)v[i*n + i] = 1.0;
+
+  for(int sweep=0; sweep<50; sweep++){
+    double off = 0.0;
+
+    for(size_t p=0; p<n; p++)
+      for(size_t q=p + 1; q<n; q++)
+        off += a[p*n + q]*a[p*n + q];
+
+    if(off < 1e-30)break;
+
+    for(size_t p=0; p<n; p++)
+      for(size_t q=p + 1; q<n; q++){
+        if(fabs(a[p*n + q]) < 1e-300)continue;
+
+        const double theta = (a[q*n + q] - a[p*n + p])/(2.0*a[p*n + q]);
+        const double t = (theta >= 0.0? 1.0: -1.0)/(fabs(theta) + sqrt(theta*theta + 1.0));
+        const double c = 1.0/sqrt(t*t + 1.0);
+        const double s = t*c;
+
+        for(size_t k=0; k<n; k++){ //columns p and q
+          const double akp = a[k*n + p], akq = a[k*n + q];
+          a[k*n + p] = c*akp - s*akq;
+          a[k*n + q] = s*akp + c*akq;
+        } //for
+
+        for(size_t k=0; k<n; k++){ //rows p and q
+          const double apk = a[p*n + k], aqk = a[q*n + k];
+          a[p*n + k] = c*apk - s*aqk;
+          a[q*n + k] = s*apk + c*aqk;
+        } //for
+
+        for(size_t k=0; k<n; k++){
+          const double vkp = v[k*n + p], vkq = v[k*n + q];
+          v[k*n + p] = c*vkp - s*vkq;
+          v[k*n + q] = s*vkp + c*vkq;
+        } //for
+      } //for
+  } //for
+
+  d.resize(n);
+  for(size_t i=0; i<n; i++)d[i] = a[i*n + i];
+} //Eigen
+
+/// Get a standard normal random number by the Box-Muller transform.
+/// \param rng Random number generator.
+/// \return Random number.
+
+static double Normal(CRng& rng){
+  const double u = (rng.next() + 1.0)/4294967297.0;
+  const double v = rng.next()/4294967296.0;
+  return sqrt(-2.0*log(u))*cos(6.283185307179586*v);
+} //Normal
+
+/// Split a comma-separated list.
+/// \param s List.
+/// \return Items.
+
+static std::vector<std::string> Split(const char* s){
+  std::vector<std::string> v;
+  std::string item;
+
+  for(const char* p=s; ; p++)
+    if(*p == ',' || *p == 0){
+      if(!item.empty())v.push_back(item);
+      item.clear();
+      if(*p == 0)break;
+    } //if
+    else item += *p;
+
+  return v;
+} //Split
+
+/// Parse the command line, tune and write the best balance found. Each
+/// parameter is searched over its range from `GetBalanceFields()`, scaled to
+/// [0, 1], starting from the default or given balance.
+/// \param argc Number of arguments.
+/// \param argv Arguments.
+/// \return Exit code, 2 for a usage error.
+
+int main(int argc, char* argv[]){
+  double target[NumLayers] = {0.95, 0.9, 0.85, 0.8, 0.6};
+  std::vector<std::string> tune = {"player_health", "enemy_health",
+    "boss_health", "attack", "boss_attack", "heal", "heal_chance", "upgrade",
+    "upgrade_all"};
+
+  size_t runs = 2000;
+  int generations = 40;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  uint64_t seed = 1;
+  const char* in = nullptr;
+  const char* out = "balance.txt";
+  bool usage = false;
+
+  for(int i=1; i<argc && !usage; i++){
+    const char* a = argv[i];
+    const bool more = i + 1 < argc;
+
+    if(strcmp(a, "--runs") == 0 && more)runs = std::max(1, atoi(argv[++i]));
+    else if(strcmp(a, "--generations") == 0 && more)generations = atoi(argv[++i]);
+    else if(strcmp(a, "--threads") == 0 && more)threads = std::max(1, atoi(argv[++i]));
+    else if(strcmp(a, "--seed") == 0 && more)seed = strtoull(argv[++i], nullptr, 0);
+    else if(strcmp(a, "--balance") == 0 && more)in = argv[++i];
+    else if(strcmp(a, "--out") == 0 && more)out = argv[++i];
+    else if(strcmp(a, "--tune") == 0 && more)tune = Split(argv[++i]);
+
+    else if(strcmp(a, "--target") == 0 && more){
+      const std::vector<std::string> v = Split(argv[++i]);
+      usage = v.size() != NumLayers;
+
+      for(size_t j=0; j<v.size() && !usage; j++)
+        target[j] = atof(v[j].c_str());
+    } //else if
+
+    else usage = true;
+  } //for
+
+  size_t numFields = 0;
+  const BalanceField* field = GetBalanceFields(numFields);
+  std::vector<const BalanceField*> param;
+
+  for(const std::string& name: tune){
+    size_t j = 0;
+    while(j < numFields && name != field[j].m_pName)j++;
+
+    if(j == numFields || field[j].m_nMin == field[j].m_nMax)usage = true;
+    else param.push_back(&field[j]);
+  } //for
+
+  if(usage || param.empty()){
+    fprintf(stderr, "usage: %s [--target r0,r1,r2,r3,r4] [--tune name,...] "
+      "[--runs n] [--generations n] [--threads n] [--seed n] "
+      "[--balance file] [--out file]\n", argv[0]);
+    return 2;
+  } //if
+
+  Balance start;
+
+  if(in && !LoadBalance(in, start)){
+    fprintf(stderr, "cannot read %s\n", in);
+    return 2;
+  } //if
+
+  //CMA-ES settings, the defaults from Hansen's tutorial
+
+  const size_t n = param.size();
+  const size_t lambda = 4 + (size_t)(3.0*log((double)n));
+  const size_t mu = lambda/2;
+
+  std::vector<double> w(mu);
+  double wsum = 0.0, w2sum = 0.0;
+
+  for(size_t i=0; i<mu; i++)
+    wsum += w[i] = log(mu + 0.5) - log(i + 1.0);
+
+  for(size_t i=0; i<mu; i++)
+    w2sum += (w[i] /= wsum)*w[i];
+
+  const double mueff = 1.0/w2sum;
+  const double cc = (4.0 + mueff/n)/(n + 4.0 + 2.0*mueff/n);
+  const double cs = (mueff + 2.0)/(n + mueff + 5.0);
+  const double c1 = 2.0/((n + 1.3)*(n + 1.3) + mueff);
+  const double cmu = std::min(1.0 - c1, 2.0*(mueff - 2.0 + 1.0/mueff)/((n + 2.0)*(n + 2.0) + mueff));
+  const double damps = 1.0 + 2.0*std::max(0.0, sqrt((mueff - 1.0)/(n + 1.0)) - 1.0) + cs;
+  const double chiN = sqrt((double)n)*(1.0 - 1.0/(4.0*n) + 1.0/(21.0*n*n));
+
+  //search state, in parameters scaled to [0, 1]
+
+  std::vector<double> mean(n), pc(n, 0.0), ps(n, 0.0), C(n*n, 0.0);
+  std::vector<double> B, D;
+  double sigma = 0.2;
+
+  for(size_t i=0; i<n; i++){
+    const BalanceField& f = *param[i];
+    mean[i] = (double)(start.*f.m_pValue - f.m_nMin)/(f.m_nMax - f.m_nMin);
+    C[i*n + i] = 1.0;
+  } //for
+
+  auto decode = [&](const std::vector<double>& x){
+    Balance b = start;
+
+    for(size_t i=0; i<n; i++){
+      const BalanceField& f = *param[i];
+      const double v = f.m_nMin + std::min(1.0, std::max(0.0, x[i]))*(f.m_nMax - f.m_nMin);
+      b.*f.m_pValue = (int)lround(v);
+    } //for
+
+    return b;
+  }; //decode
+
+  CRng rng(seed);
+  Balance best = start;
+  double bestError = 1e30;
+
+  using clock = std::chrono::steady_clock;
+  const clock::time_point t0 = clock::now();
+  size_t played = 0;
+
+  for(int g=0; g<generations; g++){
+    const std::vector<RunDesc> gen = MakeRuns(seed*1000003ULL + (uint64_t)g*runs, runs);
+    std::map<std::vector<int>, double> cache; //error by rounded balance
+
+    //eigendecomposition C = B diag(D^2) B^T
+
+    std::vector<double> a(C);
+    Eigen(a, n, B, D);
+
+    for(double& d: D)
+      d = sqrt(std::max(d, 1e-20));
+
+    std::vector<std::vector<double>> x(lambda, std::vector<double>(n));
+    std::vector<std::vector<double>> y(lambda, std::vector<double>(n));
+    std::vector<std::pair<double, size_t>> rank(lambda);
+
+    for(size_t k=0; k<lambda; k++){
+      std::vector<double> z(n);
+      for(double& zi: z)zi = Normal(rng);
+
+      for(size_t i=0; i<n; i++){
+        double s = 0.0;
+
+        for(size_t j=0; j<n; j++)
+          s += B[i*n + j]*D[j]*z[j];
+
+        y[k][i] = s;
+        x[k][i] = mean[i] + sigma*s;
+      } //for
+
+      const Balance b = decode(x[k]);
+      std::vector<int> key(n);
+
+      for(size_t i=0; i<n; i++)
+        key[i] = b.*param[i]->m_pValue;
+
+      auto it = cache.find(key);
+
+      if(it == cache.end()){
+        SetBalance(b);
+        it = cache.emplace(key, Error(PlayRuns(gen, threads), target)).first;
+        played += runs;
+      } //if
+
+      rank[k] = std::make_pair(it->second, k);
+
+      if(it->second < bestError){
+        bestError = it->second;
+        best = b;
+      } //if
+    } //for
+
+    std::sort(rank.begin(), rank.end());
+
+    //move the mean towards the best candidates
+
+    std::vector<double> yw(n, 0.0);
+
+    for(size_t i=0; i<mu; i++)
+      for(size_t j=0; j<n; j++)
+        yw[j] += w[i]*y[rank[i].second][j];
+
+    for(size_t j=0; j<n; j++)
+      mean[j] += sigma*yw[j];
+
+    //evolution paths, with C^-1/2 yw = B D^-1 B^T yw
+
+    std::vector<double> t(n, 0.0), cyw(n, 0.0);
+
+    for(size_t j=0; j<n; j++){
+      for(size_t i=0; i<n; i++)
+        t[j] += B[i*n + j]*yw[i];
+
+      t[j] /= D[j];
+    } //for
+
+    for(size_t i=0; i<n; i++)
+      for(size_t j=0; j<n; j++)
+        cyw[i] += B[i*n + j]*t[j];
+
+    double psNorm = 0.0;
+
+    for(size_t i=0; i<n; i++){
+      ps[i] = (1.0 - cs)*ps[i] + sqrt(cs*(2.0 - cs)*mueff)*cyw[i];
+      psNorm += ps[i]*ps[i];
+    } //for
+
+    psNorm = sqrt(psNorm);
+
+    const bool hsig = psNorm/sqrt(1.0 - pow(1.0 - cs, 2.0*(g + 1)))/chiN < 1.4 + 2.0/(n + 1.0);
+
+    for(size_t i=0; i<n; i++)
+      pc[i] = (1.0 - cc)*pc[i] + (hsig? sqrt(cc*(2.0 - cc)*mueff): 0.0)*yw[i];
+
+    //covariance matrix update, rank one and rank mu
+
+    for(size_t i=0; i<n; i++)
+      for(size_t j=0; j<n; j++){
+        double rankMu = 0.0;
+
+        for(size_t k=0; k<mu; k++)
+          rankMu += w[k]*y[rank[k].second][i]*y[rank[k].second][j];
+
+        C[i*n + j] = (1.0 - c1 - cmu)*C[i*n + j] +
+          c1*(pc[i]*pc[j] + (hsig? 0.0: cc*(2.0 - cc)*C[i*n + j])) +
+          cmu*rankMu;
+      } //for
+
+    sigma *= exp((cs/damps)*(psNorm/chiN - 1.0));
+
+    printf("generation %d: error %.5f, best %.5f, sigma %.3f, %zu evaluated\n",
+      g, rank[0].first, bestError, sigma, cache.size());
+  } //for
+
+  const double t = std::chrono::duration<double>(clock::now() - t0).count();
+  fprintf(stderr, "%zu runs in %.2f s, %.0f runs per second\n", played, t,
+    t > 0.0? played/t: 0.0);
+
+  //check the start, the best candidate and the final mean on runs that none
+  //was tuned on, and keep whichever of the last two does better there
+
+  const std::vector<RunDesc> check = MakeRuns(~seed*1000003ULL, runs*4);
+  const Balance final = decode(mean);
+  const Balance* report[] = {&start, &best, &final};
+  const char* label[] = {"start", "best", "mean"};
+  double checkError[3] = {};
+
+  for(int r=0; r<3; r++){
+    SetBalance(*report[r]);
+    const RunStats s = PlayRuns(check, threads);
+    checkError[r] = Error(s, target);
+    printf("%-5s win rate by layer:", label[r]);
+
+    for(int i=0; i<NumLayers; i++)
+      printf(" %.3f", WinRate(s, i));
+
+    printf(", error %.5f\n", checkError[r]);
+  } //for
+
+  if(checkError[2] < checkError[1])
+    best = final;
+
+  for(const BalanceField* f: param)
+    printf("%s %d\n", f->m_pName, best.*f->m_pValue);
+
+  if(!SaveBalance(out, best)){
+    fprintf(stderr, "cannot write %s\n", out);
+    return 2;
+  } //if
+
+  return 0;
+} //main